@@ -51,77 +51,5 @@ public:
 		*/
 	virtual void GenerateTerrain(GLuint textureId, std::string textureFilePath) override;
 
-		/**
-		* @brief Loads the heightfield data
-		*
-		* Takes the relative path to the file that is the .raw image that is to be used
-		* for the heightfield data. It also takes the images size which should be a power
-		* of 2 (eg. 128x128 or 32x32). Returns true if created successfully, false if not.
-		*
-		* @param std::string fileName
-		* @param const int size
-		* @return bool
-		*/
-	bool LoadHeightfield(std::string fileName, const int size);
-
-		/**
-		* @brief Adds texture to mesh
-		*
-		* Creates a temporary texture and returns it.
-		*
-		* @param GLuint textureId
-		* @param std::string filePath
-		* @return Texture
-		*/
-	Texture AddTexture(GLuint textureId, std::string filePath);
-
-		/**
-		* @brief Checks if inbounds
-		*
-		* Checks if the parameter positions given are within that of the terrain.
-		* Returns true if it is, false if not.
-		*
-		* @param int xpos
-		* @param int ypos
-		* @return bool
-		*/
-	bool Inbounds(int xpos, int zpos);
-
-		/**
-		* @brief Gets the height of the terrain
-		*
-		* Returns the height value y of the terrain at the corresponding parameters 
-		* given x and z values.
-		*
-		* @param int xpos
-		* @param int ypos
-		* @return float
-		*/
-	float GetHeight(int xpos, int zpos);
-
-		/**
-		* @brief Gets the colour at a specific height
-		*
-		* Returns the height value y of the terrain at the corresponding parameters
-		* given x and z values to be used in determining the colour of the vertex.
-		*
-		* @param int xpos
-		* @param int ypos
-		* @return unsigned char
-		*/
-	unsigned char GetHeightColour(int xpos, int zpos);
-
-		/**
-		* @brief Gets the average height
-		*
-		* Returns the y value of the x and z position parsed in as parameters. This
-		* function is used for terrain collision.
-		*
-		* @param int xpos
-		* @param int ypos
-		* @return float
-		*/
-	float GetAverageHeight(int xpos, int zpos);
-
 protected:
 };
\ No newline at end of file
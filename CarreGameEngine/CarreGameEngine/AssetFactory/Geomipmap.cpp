@@ -0,0 +1,535 @@
+#include "Geomipmap.h"
+
+/// Patch edges that border a coarser patch
+static const int STITCH_NORTH = 1; // -z
+static const int STITCH_EAST = 2;  // +x
+static const int STITCH_SOUTH = 4; // +z
+static const int STITCH_WEST = 8;  // -x
+static const int STITCH_COMBINATIONS = 16;
+
+Geomipmap::Geomipmap(float scaleX, float scaleY, float scaleZ, int patchSize)
+	: Terrain(scaleX, scaleY, scaleZ), m_patchSize(patchSize), m_patchesPerSide(0), m_maxLod(0), m_lodDistance(0.0f),
+	m_indexBuffer(0), m_patchVAO(0), m_patchVBO(0), m_lodCell(0), m_lodsDirty(true), m_gpuDisplacement(false), m_heightTexture(0),
+	m_visiblePatches(0), m_trianglesDrawn(0)
+{
+	// Patch size must be 2^n + 1 and indices must fit in an unsigned short
+	int cells = m_patchSize - 1;
+	if (cells < 2 || cells > 128 || (cells & (cells - 1)) != 0)
+	{
+		std::cout << "Invalid terrain patch size " << m_patchSize << ", using 33" << std::endl;
+		m_patchSize = 33;
+	}
+}
+
+Geomipmap::~Geomipmap()
+{
+	if (m_patchVBO)
+		glDeleteBuffers(1, &m_patchVBO);
+	if (m_patchVAO)
+		glDeleteVertexArrays(1, &m_patchVAO);
+	if (m_heightTexture)
+		glDeleteTextures(1, &m_heightTexture);
+
+	if (m_indexBuffer)
+		glDeleteBuffers(1, &m_indexBuffer);
+}
+
+void Geomipmap::GenerateTerrain(GLuint textureId, std::string textureFilePath)
+{
+	if (!m_heightfield.IsOpen() || m_heightfieldSize < 2)
+	{
+		std::cout << "Cannot generate terrain without heightfield data" << std::endl;
+		return;
+	}
+
+	// Heightfields too large for one texture keep their positions in the patches instead
+	if (m_gpuDisplacement)
+	{
+		GLint maxTextureSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+		if (m_heightfieldSize > maxTextureSize)
+		{
+			std::cout << "Heightfield of " << m_heightfieldSize << " samples is larger than the " << maxTextureSize
+				<< " texture limit, displacing on the CPU" << std::endl;
+			m_gpuDisplacement = false;
+		}
+	}
+
+	int cells = m_patchSize - 1;
+	m_patchesPerSide = (m_heightfieldSize - 1 + cells - 1) / cells;
+
+	m_maxLod = 0;
+	while ((1 << (m_maxLod + 1)) <= cells)
+		m_maxLod++;
+
+	// Full detail up to two patch widths away
+	if (m_lodDistance <= 0.0f)
+		m_lodDistance = cells * m_scaleX * 2.0f;
+
+	// Bounding box of every patch
+	m_patches.clear();
+	m_patches.reserve(m_patchesPerSide * m_patchesPerSide);
+	for (int pz = 0; pz < m_patchesPerSide; pz++)
+	{
+		for (int px = 0; px < m_patchesPerSide; px++)
+		{
+			TerrainPatch patch;
+			patch.lod = 0;
+			patch.stitchMask = 0;
+
+			m_patches.push_back(patch);
+			UpdatePatchBounds(px, pz);
+		}
+	}
+
+	// Triangulations for every level of detail and stitch mask
+	m_indices.clear();
+	m_indexRanges.clear();
+	for (int lod = 0; lod <= m_maxLod; lod++)
+	{
+		for (int mask = 0; mask < STITCH_COMBINATIONS; mask++)
+		{
+			size_t first = m_indices.size();
+			BuildPatchIndices(lod, mask, m_indices);
+
+			IndexRange range;
+			range.offset = first * sizeof(unsigned short);
+			range.count = (GLsizei)(m_indices.size() - first);
+
+			m_indexRanges.push_back(range);
+		}
+	}
+
+	m_lodsDirty = true;
+
+	m_textureId = textureId;
+	m_terrainModel->GetTextures().push_back(AddTexture(textureId, textureFilePath));
+	m_terrainModel->SetScale(glm::vec3(1.0, 1.0, 1.0));
+
+	std::cout << "Terrain split into " << m_patches.size() << " patches of " << m_patchSize << "x" << m_patchSize << " vertices" << std::endl;
+}
+
+void Geomipmap::UpdatePatchBounds(int patchX, int patchZ)
+{
+	int cells = m_patchSize - 1;
+	int startX = patchX * cells;
+	int startZ = patchZ * cells;
+	int endX = std::min(startX + cells, m_heightfieldSize - 1);
+	int endZ = std::min(startZ + cells, m_heightfieldSize - 1);
+
+	float minHeight = GetSampleHeight(startX, startZ);
+	float maxHeight = minHeight;
+	for (int z = startZ; z <= endZ; z++)
+	{
+		for (int x = startX; x <= endX; x++)
+		{
+			float height = GetSampleHeight(x, z);
+			minHeight = std::min(minHeight, height);
+			maxHeight = std::max(maxHeight, height);
+		}
+	}
+
+	TerrainPatch& patch = m_patches[patchZ * m_patchesPerSide + patchX];
+	patch.boundsMin = glm::vec3(startX * m_scaleX, minHeight, startZ * m_scaleZ);
+	patch.boundsMax = glm::vec3(endX * m_scaleX, maxHeight, endZ * m_scaleZ);
+}
+
+void Geomipmap::FillPatchPositions(int patchX, int patchZ, std::vector<glm::vec3>& positions)
+{
+	int cells = m_patchSize - 1;
+	positions.resize(m_patchSize * m_patchSize);
+
+	for (int z = 0; z < m_patchSize; z++)
+	{
+		for (int x = 0; x < m_patchSize; x++)
+		{
+			int sampleX = std::min(patchX * cells + x, m_heightfieldSize - 1);
+			int sampleZ = std::min(patchZ * cells + z, m_heightfieldSize - 1);
+
+			positions[z * m_patchSize + x] = glm::vec3(sampleX * m_scaleX, GetSampleHeight(sampleX, sampleZ), sampleZ * m_scaleZ);
+		}
+	}
+}
+
+void Geomipmap::BuildPatchIndices(int lod, int stitchMask, std::vector<unsigned short>& indices)
+{
+	int cells = m_patchSize - 1;
+	int step = 1 << lod;
+	int cellsAtLod = cells / step;
+
+	// Coarsest level is a single quad
+	if (cellsAtLod == 1)
+	{
+		unsigned short topLeft = 0;
+		unsigned short topRight = (unsigned short)cells;
+		unsigned short bottomLeft = (unsigned short)(cells * m_patchSize);
+		unsigned short bottomRight = (unsigned short)(cells * m_patchSize + cells);
+
+		indices.push_back(topLeft);
+		indices.push_back(bottomLeft);
+		indices.push_back(topRight);
+
+		indices.push_back(topRight);
+		indices.push_back(bottomLeft);
+		indices.push_back(bottomRight);
+		return;
+	}
+
+	int blocks = cellsAtLod / 2;
+	for (int bz = 0; bz < blocks; bz++)
+	{
+		for (int bx = 0; bx < blocks; bx++)
+		{
+			int cx = bx * 2 * step + step;
+			int cz = bz * 2 * step + step;
+
+			unsigned short centre = (unsigned short)(cz * m_patchSize + cx);
+
+			// Ring around the centre, counter clockwise when looking down on the terrain
+			unsigned short ring[8];
+			ring[0] = (unsigned short)((cz + step) * m_patchSize + cx);        // South
+			ring[1] = (unsigned short)((cz + step) * m_patchSize + cx + step); // South east
+			ring[2] = (unsigned short)(cz * m_patchSize + cx + step);          // East
+			ring[3] = (unsigned short)((cz - step) * m_patchSize + cx + step); // North east
+			ring[4] = (unsigned short)((cz - step) * m_patchSize + cx);        // North
+			ring[5] = (unsigned short)((cz - step) * m_patchSize + cx - step); // North west
+			ring[6] = (unsigned short)(cz * m_patchSize + cx - step);          // West
+			ring[7] = (unsigned short)((cz + step) * m_patchSize + cx - step); // South west
+
+			// Each side of the block runs corner, middle, corner around the ring
+			bool stitched[4];
+			stitched[0] = (stitchMask & STITCH_SOUTH) && bz == blocks - 1; // South west, south, south east
+			stitched[1] = (stitchMask & STITCH_EAST) && bx == blocks - 1;  // South east, east, north east
+			stitched[2] = (stitchMask & STITCH_NORTH) && bz == 0;          // North east, north, north west
+			stitched[3] = (stitchMask & STITCH_WEST) && bx == 0;           // North west, west, south west
+
+			for (int side = 0; side < 4; side++)
+			{
+				unsigned short first = ring[(side * 2 + 7) % 8];
+				unsigned short middle = ring[side * 2];
+				unsigned short last = ring[side * 2 + 1];
+
+				if (stitched[side])
+				{
+					// Skip the middle vertex so the edge matches the coarser neighbour
+					indices.push_back(centre);
+					indices.push_back(first);
+					indices.push_back(last);
+				}
+				else
+				{
+					indices.push_back(centre);
+					indices.push_back(first);
+					indices.push_back(middle);
+
+					indices.push_back(centre);
+					indices.push_back(middle);
+					indices.push_back(last);
+				}
+			}
+		}
+	}
+}
+
+void Geomipmap::Prepare(OpenGl& renderer, Shader* shader)
+{
+	m_terrainModel->SetShader(shader);
+
+	if (m_patches.empty())
+		return;
+
+	glGenBuffers(1, &m_indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(unsigned short), &m_indices[0], GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	std::cout << "Terrain index buffer: " << m_indices.size() << " indices for " << m_indexRanges.size() << " patch variants" << std::endl;
+
+	// Only the ranges are needed once the indices are on the GPU
+	std::vector<unsigned short>().swap(m_indices);
+
+	// Every patch is drawn from this vertex array, the base vertex of the draw picks the patch
+	glGenVertexArrays(1, &m_patchVAO);
+	glBindVertexArray(m_patchVAO);
+
+	// The element buffer binding is part of the vertex array state
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+
+	if (m_gpuDisplacement)
+	{
+		// No vertex attributes, the shader finds the patch and grid vertex from gl_VertexID
+		glBindVertexArray(0);
+
+		// Heightmap as a single channel texture, read with texelFetch so no filtering or mipmaps
+		glGenTextures(1, &m_heightTexture);
+		glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		// 16-bit heightfields keep their precision, normalized so the shader scale is the same
+		if (m_heightfield.GetBitDepth() == 16)
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, m_heightfieldSize, m_heightfieldSize, 0, GL_RED, GL_UNSIGNED_SHORT, NULL);
+		else
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m_heightfieldSize, m_heightfieldSize, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+		UploadHeightTiles(0, 0, m_heightfield.GetTilesPerSide() - 1, m_heightfield.GetTilesPerSide() - 1);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return;
+	}
+
+	// Positions of every patch one after the other, patch i starting at vertex i * patchSize^2
+	size_t patchVertices = (size_t)(m_patchSize * m_patchSize);
+	glGenBuffers(1, &m_patchVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, m_patchVBO);
+	glBufferData(GL_ARRAY_BUFFER, m_patches.size() * patchVertices * sizeof(glm::vec3), NULL, GL_STATIC_DRAW);
+
+	// vertex positions
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), 0);
+	glEnableVertexAttribArray(0);
+
+	glBindVertexArray(0);
+
+	std::vector<glm::vec3> positions;
+	for (int pz = 0; pz < m_patchesPerSide; pz++)
+	{
+		for (int px = 0; px < m_patchesPerSide; px++)
+		{
+			FillPatchPositions(px, pz, positions);
+
+			size_t patch = (size_t)(pz * m_patchesPerSide + px);
+			glBufferSubData(GL_ARRAY_BUFFER, patch * patchVertices * sizeof(glm::vec3), positions.size() * sizeof(glm::vec3), &positions[0]);
+		}
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Geomipmap::UploadHeightTiles(int firstTileX, int firstTileZ, int lastTileX, int lastTileZ)
+{
+	// Uploaded a tile at a time straight from the mapping, so the heightfield is never copied whole
+	int bytesPerSample = m_heightfield.GetBitDepth() / 8;
+	GLenum type = bytesPerSample == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE;
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (int tileZ = firstTileZ; tileZ <= lastTileZ; tileZ++)
+	{
+		for (int tileX = firstTileX; tileX <= lastTileX; tileX++)
+		{
+			HeightfieldTile tile = m_heightfield.GetTile(tileX, tileZ);
+			if (!tile.data)
+				continue;
+
+			glPixelStorei(GL_UNPACK_ROW_LENGTH, (GLint)(tile.rowPitch / bytesPerSample));
+			glTexSubImage2D(GL_TEXTURE_2D, 0, tile.x, tile.z, tile.width, tile.height, GL_RED, type, tile.data);
+		}
+	}
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void Geomipmap::UpdateHeightRegion(int xpos, int zpos, int width, int height, const unsigned char* data)
+{
+	if (!m_heightfield.IsOpen() || !data)
+		return;
+
+	// Clip the region to the heightfield
+	int startX = std::max(xpos, 0);
+	int startZ = std::max(zpos, 0);
+	int endX = std::min(xpos + width, m_heightfieldSize);
+	int endZ = std::min(zpos + height, m_heightfieldSize);
+	if (startX >= endX || startZ >= endZ)
+		return;
+
+	m_heightfield.SetSamples(xpos, zpos, width, height, data);
+
+	if (m_gpuDisplacement && m_heightTexture)
+	{
+		// Only the tiles the region touches are uploaded again
+		int tileSize = m_heightfield.GetTileSize();
+		glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+		UploadHeightTiles(startX / tileSize, startZ / tileSize, (endX - 1) / tileSize, (endZ - 1) / tileSize);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	// Patches share their border samples, so a sample can touch the patch before it too
+	int cells = m_patchSize - 1;
+	int firstPatchX = std::max((startX - 1) / cells, 0);
+	int firstPatchZ = std::max((startZ - 1) / cells, 0);
+	int lastPatchX = std::min((endX - 1) / cells, m_patchesPerSide - 1);
+	int lastPatchZ = std::min((endZ - 1) / cells, m_patchesPerSide - 1);
+
+	size_t patchVertices = (size_t)(m_patchSize * m_patchSize);
+	std::vector<glm::vec3> positions;
+	if (m_patchVBO)
+		glBindBuffer(GL_ARRAY_BUFFER, m_patchVBO);
+
+	for (int pz = firstPatchZ; pz <= lastPatchZ; pz++)
+	{
+		for (int px = firstPatchX; px <= lastPatchX; px++)
+		{
+			UpdatePatchBounds(px, pz);
+			if (!m_patchVBO)
+				continue;
+
+			FillPatchPositions(px, pz, positions);
+			size_t patch = (size_t)(pz * m_patchesPerSide + px);
+			glBufferSubData(GL_ARRAY_BUFFER, patch * patchVertices * sizeof(glm::vec3), positions.size() * sizeof(glm::vec3), &positions[0]);
+		}
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// The bounds the levels were picked from have changed
+	m_lodsDirty = true;
+}
+
+void Geomipmap::SelectLods(const glm::vec3& cameraPosition)
+{
+	// Level from the distance to the closest point of each patch
+	for (size_t i = 0; i < m_patches.size(); i++)
+	{
+		glm::vec3 closest = glm::clamp(cameraPosition, m_patches[i].boundsMin, m_patches[i].boundsMax);
+		float distance = glm::length(cameraPosition - closest);
+
+		int lod = 0;
+		float lodRange = m_lodDistance;
+		while (lod < m_maxLod && distance > lodRange)
+		{
+			lod++;
+			lodRange *= 2.0f;
+		}
+
+		m_patches[i].lod = lod;
+	}
+
+	// A patch may be at most one level coarser than any neighbour, which is the smallest of its
+	// own level and each patch's level plus their distance in patches. Sweeping forwards then
+	// backwards carries every patch's limit across the grid in two passes.
+	for (int pz = 0; pz < m_patchesPerSide; pz++)
+	{
+		for (int px = 0; px < m_patchesPerSide; px++)
+		{
+			int& lod = m_patches[pz * m_patchesPerSide + px].lod;
+			if (px > 0)
+				lod = std::min(lod, m_patches[pz * m_patchesPerSide + px - 1].lod + 1);
+			if (pz > 0)
+				lod = std::min(lod, m_patches[(pz - 1) * m_patchesPerSide + px].lod + 1);
+		}
+	}
+	for (int pz = m_patchesPerSide - 1; pz >= 0; pz--)
+	{
+		for (int px = m_patchesPerSide - 1; px >= 0; px--)
+		{
+			int& lod = m_patches[pz * m_patchesPerSide + px].lod;
+			if (px < m_patchesPerSide - 1)
+				lod = std::min(lod, m_patches[pz * m_patchesPerSide + px + 1].lod + 1);
+			if (pz < m_patchesPerSide - 1)
+				lod = std::min(lod, m_patches[(pz + 1) * m_patchesPerSide + px].lod + 1);
+		}
+	}
+
+	for (int pz = 0; pz < m_patchesPerSide; pz++)
+	{
+		for (int px = 0; px < m_patchesPerSide; px++)
+			m_patches[pz * m_patchesPerSide + px].stitchMask = GetStitchMask(px, pz);
+	}
+}
+
+int Geomipmap::GetStitchMask(int patchX, int patchZ)
+{
+	int lod = m_patches[patchZ * m_patchesPerSide + patchX].lod;
+	int mask = 0;
+
+	if (patchZ > 0 && m_patches[(patchZ - 1) * m_patchesPerSide + patchX].lod > lod)
+		mask |= STITCH_NORTH;
+	if (patchX < m_patchesPerSide - 1 && m_patches[patchZ * m_patchesPerSide + patchX + 1].lod > lod)
+		mask |= STITCH_EAST;
+	if (patchZ < m_patchesPerSide - 1 && m_patches[(patchZ + 1) * m_patchesPerSide + patchX].lod > lod)
+		mask |= STITCH_SOUTH;
+	if (patchX > 0 && m_patches[patchZ * m_patchesPerSide + patchX - 1].lod > lod)
+		mask |= STITCH_WEST;
+
+	return mask;
+}
+
+void Geomipmap::Render(OpenGl& renderer)
+{
+	if (m_patches.empty() || !m_indexBuffer)
+		return;
+
+	Shader* shader = m_terrainModel->GetShader();
+	Camera* camera = m_terrainModel->GetCamera();
+
+	glm::mat4 projectionMatrix = camera->GetProjectionMatrix();
+	const glm::mat4& modelMatrix = m_terrainModel->GetTransform().GetWorldMatrix();
+	glm::mat4 viewMatrix = CreateViewMatrix(camera);
+
+	// Cull and pick levels in terrain space so patch bounds can be used as they are
+	m_frustum.Extract(projectionMatrix * viewMatrix * modelMatrix);
+	glm::vec3 localCamera = glm::vec3(glm::inverse(modelMatrix) * glm::vec4(camera->GetPosition(), 1.0f));
+
+	// Levels only change enough to matter once the camera has moved a patch width
+	float patchWidth = (m_patchSize - 1) * m_scaleX;
+	glm::ivec3 cell = glm::ivec3(glm::floor(localCamera / patchWidth));
+	if (m_lodsDirty || cell != m_lodCell)
+	{
+		SelectLods(localCamera);
+		m_lodCell = cell;
+		m_lodsDirty = false;
+	}
+
+	shader->TurnOn();
+
+	shader->SetMatrix4(shader->GetVariable("model"), 1, false, &modelMatrix[0][0]);
+	shader->SetMatrix4(shader->GetVariable("view"), 1, false, &viewMatrix[0][0]);
+	shader->SetMatrix4(shader->GetVariable("projection"), 1, false, &projectionMatrix[0][0]);
+	shader->SetFloat2(shader->GetVariable("terrainSize"), (m_heightfieldSize - 1) * m_scaleX, (m_heightfieldSize - 1) * m_scaleZ);
+
+	glActiveTexture(GL_TEXTURE0);
+	shader->SetInt(shader->GetVariable("texture_diffuse1"), 0);
+	glBindTexture(GL_TEXTURE_2D, m_textureId);
+
+	if (m_gpuDisplacement)
+	{
+		// R8 texels are normalized, so a full texel is 255 heightfield units
+		shader->SetFloat3(shader->GetVariable("terrainScale"), m_scaleX, m_scaleY * 255.0f, m_scaleZ);
+		shader->SetInt(shader->GetVariable("heightfieldSize"), m_heightfieldSize);
+		shader->SetInt(shader->GetVariable("patchSize"), m_patchSize);
+		shader->SetInt(shader->GetVariable("patchesPerSide"), m_patchesPerSide);
+
+		glActiveTexture(GL_TEXTURE1);
+		shader->SetInt(shader->GetVariable("heightmap"), 1);
+		glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	m_visiblePatches = 0;
+	m_trianglesDrawn = 0;
+
+	m_drawCounts.clear();
+	m_drawOffsets.clear();
+	m_drawBaseVertices.clear();
+
+	GLint patchVertices = m_patchSize * m_patchSize;
+	for (size_t i = 0; i < m_patches.size(); i++)
+	{
+		const TerrainPatch& patch = m_patches[i];
+		if (!m_frustum.IsBoxVisible(patch.boundsMin, patch.boundsMax))
+			continue;
+
+		const IndexRange& range = m_indexRanges[patch.lod * STITCH_COMBINATIONS + patch.stitchMask];
+		m_drawCounts.push_back(range.count);
+		m_drawOffsets.push_back((const GLvoid*)range.offset);
+		m_drawBaseVertices.push_back((GLint)i * patchVertices);
+
+		m_visiblePatches++;
+		m_trianglesDrawn += range.count / 3;
+	}
+
+	if (!m_drawCounts.empty())
+	{
+		glBindVertexArray(m_patchVAO);
+		glMultiDrawElementsBaseVertex(GL_TRIANGLES, &m_drawCounts[0], GL_UNSIGNED_SHORT, &m_drawOffsets[0], (GLsizei)m_drawCounts.size(), &m_drawBaseVertices[0]);
+		glBindVertexArray(0);
+	}
+
+	shader->TurnOff();
+}
@@ -0,0 +1,324 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#include "Terrain.h"
+#include "..\Common\Frustum.h"
+
+	/**
+	* @class Geomipmap
+	* @brief Chunked geomipmapped terrain class
+	*
+	* This class inherits from the base Terrain class. Instead of one giant unindexed mesh the
+	* heightfield is split into square patches of patchSize x patchSize vertices (patchSize must
+	* be 2^n + 1). The positions of every patch lie one after the other in a single vertex buffer,
+	* and all patches share one index buffer holding a triangulation for each level of detail and
+	* each combination of stitched edges. The visible patches are drawn from one vertex array in a
+	* single glMultiDrawElementsBaseVertex() call, the base vertex picking the patch.
+	*
+	* When the camera moves into another patch sized cell the level of detail of each patch is
+	* picked from the camera distance, neighbouring patches are limited to differ by at most one
+	* level, and the edges that border a coarser patch are stitched by skipping their odd vertices
+	* so the terrain has no cracks. Patches outside of the view frustum are not drawn.
+	*
+	* With GPU displacement enabled no vertex positions are kept at all. Terrain.shader finds the
+	* patch and grid vertex from gl_VertexID and displaces it by reading the heightmap, which is
+	* uploaded as a single channel texture. CPU memory for the terrain is then the heightmap only,
+	* and editing heights costs a texture sub-update of the edited region.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class Geomipmap : public Terrain
+{
+public:
+		/**
+		* @brief Constructor
+		*
+		* Parameterised constructor that takes the desired scale of the terrain to be generated
+		* and the number of vertices along each side of a patch.
+		*
+		* @param float scaleX
+		* @param float scaleY
+		* @param float scaleZ
+		* @param int patchSize
+		* @return null
+		*/
+	Geomipmap(float scaleX, float scaleY, float scaleZ, int patchSize = 33);
+
+		/**
+		* @brief Destructor
+		*
+		* Deletes the patch vertex array, the vertex buffer and the shared index buffer.
+		*
+		* @return null
+		*/
+	~Geomipmap();
+
+		/**
+		* @brief Generates the terrain
+		*
+		* Splits the heightfield into patches, calculates the bounding box of each patch and
+		* builds the index lists for every level of detail and stitch combination.
+		*
+		* @param GLuint textureId
+		* @param std::string textureFilePath
+		* @return void
+		*/
+	virtual void GenerateTerrain(GLuint textureId, std::string textureFilePath) override;
+
+		/**
+		* @brief Prepares the terrain for rendering
+		*
+		* Uploads the shared index buffer and the positions of every patch into one vertex buffer,
+		* or the heightmap texture with GPU displacement, and creates the vertex array they are
+		* drawn with.
+		*
+		* @param OpenGl& renderer
+		* @param Shader* shader
+		* @return void
+		*/
+	virtual void Prepare(OpenGl& renderer, Shader* shader) override;
+
+		/**
+		* @brief Renders the terrain
+		*
+		* Selects the level of detail of each patch if the camera has moved into another cell,
+		* culls patches against the view frustum and draws the visible ones in one call.
+		*
+		* @param OpenGl& renderer
+		* @return void
+		*/
+	virtual void Render(OpenGl& renderer) override;
+
+		/**
+		* @brief Gets the terrain shader defines
+		*
+		* Geomipmapped patches only store positions, so the terrain shader derives texture
+		* coordinates from them.
+		*
+		* @return std::string
+		*/
+	virtual std::string GetShaderDefines() const override { return m_gpuDisplacement ? "GEOMIPMAP;GPU_DISPLACEMENT" : "GEOMIPMAP"; }
+
+		/**
+		* @brief Sets GPU displacement
+		*
+		* Enables or disables displacing the patches from a height texture in the terrain shader
+		* instead of storing their vertex positions. Must be set before Prepare().
+		*
+		* @param bool enabled
+		* @return void
+		*/
+	void SetGpuDisplacement(bool enabled) { m_gpuDisplacement = enabled; }
+
+		/**
+		* @brief Updates a region of the heightfield
+		*
+		* Copies width x height new samples, starting at sample (xpos, zpos), into the heightfield
+		* and updates the patch bounds. With GPU displacement only the edited region of the height
+		* texture is re-uploaded, otherwise the positions of the touched patches are rewritten.
+		*
+		* @param int xpos
+		* @param int zpos
+		* @param int width
+		* @param int height
+		* @param const unsigned char* data
+		* @return void
+		*/
+	void UpdateHeightRegion(int xpos, int zpos, int width, int height, const unsigned char* data);
+
+		/**
+		* @brief Sets the level of detail distance
+		*
+		* Sets the camera distance up to which patches are drawn at full detail. Each level of
+		* detail after that covers twice the distance of the previous one.
+		*
+		* @param float distance
+		* @return void
+		*/
+	void SetLodDistance(float distance) { m_lodDistance = distance; m_lodsDirty = true; }
+
+		/**
+		* @brief Gets the number of patches
+		*
+		* Returns the total number of patches the terrain is split into.
+		*
+		* @return int
+		*/
+	int GetPatchCount() const { return (int)m_patches.size(); }
+
+		/**
+		* @brief Gets the number of patches drawn
+		*
+		* Returns the number of patches that passed frustum culling in the last rendered frame.
+		*
+		* @return int
+		*/
+	int GetVisiblePatchCount() const { return m_visiblePatches; }
+
+		/**
+		* @brief Gets the number of triangles drawn
+		*
+		* Returns the number of terrain triangles drawn in the last rendered frame.
+		*
+		* @return int
+		*/
+	int GetTriangleCount() const { return m_trianglesDrawn; }
+
+protected:
+		/**
+		* @struct TerrainPatch
+		* @brief A single square patch of the terrain
+		*/
+	struct TerrainPatch
+	{
+		/// Local space bounding box
+		glm::vec3 boundsMin, boundsMax;
+
+		/// Level of detail selected for the camera cell
+		int lod;
+
+		/// Edges bordering a coarser patch
+		int stitchMask;
+	};
+
+		/**
+		* @struct IndexRange
+		* @brief Location of one triangulation inside the shared index buffer
+		*/
+	struct IndexRange
+	{
+		/// Offset in bytes
+		size_t offset;
+
+		/// Number of indices
+		GLsizei count;
+	};
+
+		/**
+		* @brief Builds the indices of a patch triangulation
+		*
+		* Appends the triangle indices for the given level of detail to the indices vector. The
+		* patch is built from blocks of 2x2 cells that are each drawn as a fan of eight triangles
+		* around their centre. Edges set in the stitch mask leave out the middle vertex of the
+		* border blocks so they line up with a neighbour one level coarser.
+		*
+		* @param int lod
+		* @param int stitchMask
+		* @param std::vector<unsigned short>& indices
+		* @return void
+		*/
+	void BuildPatchIndices(int lod, int stitchMask, std::vector<unsigned short>& indices);
+
+		/**
+		* @brief Updates the bounds of a patch
+		*
+		* Recalculates the bounding box of a patch from the heightfield.
+		*
+		* @param int patchX
+		* @param int patchZ
+		* @return void
+		*/
+	void UpdatePatchBounds(int patchX, int patchZ);
+
+		/**
+		* @brief Fills the vertex positions of a patch
+		*
+		* Writes the terrain space position of every vertex of a patch to the positions vector.
+		* Samples past the edge of the heightfield are clamped onto it.
+		*
+		* @param int patchX
+		* @param int patchZ
+		* @param std::vector<glm::vec3>& positions
+		* @return void
+		*/
+	void FillPatchPositions(int patchX, int patchZ, std::vector<glm::vec3>& positions);
+
+		/**
+		* @brief Selects the level of detail of every patch
+		*
+		* Picks the level of detail of each patch from its distance to the camera, then lowers
+		* the detail of patches so no two neighbours differ by more than one level and finds the
+		* stitch mask of each patch.
+		*
+		* @param const glm::vec3& cameraPosition
+		* @return void
+		*/
+	void SelectLods(const glm::vec3& cameraPosition);
+
+		/**
+		* @brief Gets the stitch mask of a patch
+		*
+		* Returns a bit mask of the patch edges that border a patch with a coarser level of
+		* detail.
+		*
+		* @param int patchX
+		* @param int patchZ
+		* @return int
+		*/
+	int GetStitchMask(int patchX, int patchZ);
+
+	/// Number of vertices along each side of a patch
+	int m_patchSize;
+
+	/// Number of patches along each side of the terrain
+	int m_patchesPerSide;
+
+	/// Coarsest level of detail, at which a patch is two triangles
+	int m_maxLod;
+
+	/// Camera distance up to which patches are drawn at full detail
+	float m_lodDistance;
+
+	/// All patches, row by row along z
+	std::vector<TerrainPatch> m_patches;
+
+	/// Indices of every triangulation, built by GenerateTerrain() and uploaded by Prepare()
+	std::vector<unsigned short> m_indices;
+
+	/// Triangulation for each level of detail and stitch mask, indexed by lod * 16 + mask
+	std::vector<IndexRange> m_indexRanges;
+
+	/// Index buffer shared by every patch
+	GLuint m_indexBuffer;
+
+	/// Vertex array every patch is drawn with, and the positions of all patches without GPU displacement
+	GLuint m_patchVAO, m_patchVBO;
+
+	/// Cell the levels of detail were selected in, and whether they must be selected again
+	glm::ivec3 m_lodCell;
+	bool m_lodsDirty;
+
+	/// Index counts, index offsets and base vertices of the visible patches, reused every frame
+	std::vector<GLsizei> m_drawCounts;
+	std::vector<const GLvoid*> m_drawOffsets;
+	std::vector<GLint> m_drawBaseVertices;
+
+	/// Displace the patches in the shader from the height texture instead of storing their positions
+	bool m_gpuDisplacement;
+
+		/**
+		* @brief Uploads heightfield tiles to the height texture
+		*
+		* Copies the tiles from firstTile to lastTile, inclusive, into the bound height texture.
+		*
+		* @param int firstTileX
+		* @param int firstTileZ
+		* @param int lastTileX
+		* @param int lastTileZ
+		* @return void
+		*/
+	void UploadHeightTiles(int firstTileX, int firstTileZ, int lastTileX, int lastTileZ);
+
+	/// Heightmap texture used for GPU displacement
+	GLuint m_heightTexture;
+
+	/// View frustum in terrain space
+	Frustum m_frustum;
+
+	/// Statistics of the last rendered frame
+	int m_visiblePatches, m_trianglesDrawn;
+};
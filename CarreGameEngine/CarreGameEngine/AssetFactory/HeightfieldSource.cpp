@@ -0,0 +1,287 @@
+#include "HeightfieldSource.h"
+
+/// Identifies a tiled heightfield file
+static const uint32_t TILED_HEIGHTFIELD_MAGIC = 0x46544843; // "CHTF"
+
+/// Changing the tiled layout must change this so old files are rejected
+static const uint32_t TILED_HEIGHTFIELD_VERSION = 1;
+
+/// Samples along each side of the tiles raw files are split into
+static const int RAW_TILE_SIZE = 256;
+
+/**
+* @struct TiledHeightfieldHeader
+* @brief Header at the start of a tiled heightfield file, followed by the tiles row by row
+*/
+struct TiledHeightfieldHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;
+	uint32_t tileSize;
+	uint32_t bitDepth;
+	uint32_t padding;
+};
+
+// Reads a sample as 8-bit units, 16-bit samples are little endian
+static inline float DecodeSample(const unsigned char* sample, int bytesPerSample)
+{
+	if (bytesPerSample == 1)
+		return (float)sample[0];
+
+	return (float)(sample[0] | (sample[1] << 8)) / 257.0f;
+}
+
+HeightfieldSource::HeightfieldSource()
+	: m_size(0), m_tileSize(0), m_tilesPerSide(0), m_bytesPerSample(1), m_tiled(false), m_dataOffset(0)
+{
+}
+
+bool HeightfieldSource::Open(const std::string& filePath, int size, int bitDepth)
+{
+	Close();
+
+	if (!m_file.Open(filePath))
+	{
+		std::cout << "Cannot open heightfield: " << filePath << std::endl;
+		return false;
+	}
+
+	size_t bytes = m_file.GetSize();
+	TiledHeightfieldHeader header;
+	if (bytes >= sizeof(header))
+		memcpy(&header, m_file.GetData(), sizeof(header));
+
+	if (bytes >= sizeof(header) && header.magic == TILED_HEIGHTFIELD_MAGIC)
+	{
+		if (header.version != TILED_HEIGHTFIELD_VERSION || header.size < 2 || header.tileSize < 1
+			|| (header.bitDepth != 8 && header.bitDepth != 16))
+		{
+			std::cout << "Invalid tiled heightfield: " << filePath << std::endl;
+			Close();
+			return false;
+		}
+
+		m_tiled = true;
+		m_size = (int)header.size;
+		m_tileSize = (int)header.tileSize;
+		m_bytesPerSample = (int)header.bitDepth / 8;
+		m_dataOffset = sizeof(header);
+	}
+	else
+	{
+		// The bit depth and size of raw files can only come from their length
+		if (size <= 0)
+		{
+			// A square of 8-bit samples, otherwise of 16-bit samples
+			int size8 = (int)(std::sqrt((double)bytes) + 0.5);
+			int size16 = (int)(std::sqrt((double)(bytes / 2)) + 0.5);
+			if (bitDepth == 0)
+				bitDepth = ((size_t)size8 * size8 == bytes || (size_t)size16 * size16 * 2 != bytes) ? 8 : 16;
+			size = bitDepth == 16 ? size16 : size8;
+		}
+		if (bitDepth == 0)
+			bitDepth = (bytes == (size_t)size * size * 2) ? 16 : 8;
+		if (bitDepth != 8 && bitDepth != 16)
+		{
+			std::cout << "Heightfields must be 8 or 16 bits, not " << bitDepth << ": " << filePath << std::endl;
+			Close();
+			return false;
+		}
+
+		m_tiled = false;
+		m_size = size;
+		m_tileSize = std::min(RAW_TILE_SIZE, size);
+		m_bytesPerSample = bitDepth / 8;
+		m_dataOffset = 0;
+	}
+
+	m_tilesPerSide = m_tileSize > 0 ? (m_size + m_tileSize - 1) / m_tileSize : 0;
+
+	// Every sample must be inside the file
+	size_t needed = m_tiled
+		? m_dataOffset + (size_t)m_tilesPerSide * m_tilesPerSide * m_tileSize * m_tileSize * m_bytesPerSample
+		: (size_t)m_size * m_size * m_bytesPerSample;
+	if (m_size < 2 || bytes < needed)
+	{
+		std::cout << "Heightfield " << filePath << " is " << bytes << " bytes, a " << m_size << "x" << m_size << " "
+			<< GetBitDepth() << "-bit heightfield needs " << needed << std::endl;
+		Close();
+		return false;
+	}
+
+	m_editedTiles.resize((size_t)m_tilesPerSide * m_tilesPerSide);
+
+	return true;
+}
+
+void HeightfieldSource::Close()
+{
+	m_file.Close();
+	m_size = 0;
+	m_tileSize = 0;
+	m_tilesPerSide = 0;
+	m_tiled = false;
+	std::vector<std::vector<unsigned char> >().swap(m_editedTiles);
+}
+
+const unsigned char* HeightfieldSource::GetMappedTile(int tile, size_t& rowPitch) const
+{
+	if (m_tiled)
+	{
+		rowPitch = (size_t)m_tileSize * m_bytesPerSample;
+		return m_file.GetData() + m_dataOffset + (size_t)tile * m_tileSize * rowPitch;
+	}
+
+	// Tiles of raw files are windows onto the rows of the whole heightfield
+	int tileX = tile % m_tilesPerSide;
+	int tileZ = tile / m_tilesPerSide;
+	rowPitch = (size_t)m_size * m_bytesPerSample;
+	return m_file.GetData() + (size_t)tileZ * m_tileSize * rowPitch + (size_t)tileX * m_tileSize * m_bytesPerSample;
+}
+
+HeightfieldTile HeightfieldSource::GetTile(int tileX, int tileZ) const
+{
+	HeightfieldTile result;
+	memset(&result, 0, sizeof(result));
+	if (tileX < 0 || tileZ < 0 || tileX >= m_tilesPerSide || tileZ >= m_tilesPerSide)
+		return result;
+
+	int tile = tileZ * m_tilesPerSide + tileX;
+	result.x = tileX * m_tileSize;
+	result.z = tileZ * m_tileSize;
+	result.width = std::min(m_tileSize, m_size - result.x);
+	result.height = std::min(m_tileSize, m_size - result.z);
+
+	if (!m_editedTiles[tile].empty())
+	{
+		result.data = &m_editedTiles[tile][0];
+		result.rowPitch = (size_t)m_tileSize * m_bytesPerSample;
+	}
+	else
+	{
+		result.data = GetMappedTile(tile, result.rowPitch);
+	}
+
+	return result;
+}
+
+float HeightfieldSource::GetSample(int xpos, int zpos) const
+{
+	if (m_size == 0)
+		return 0.0f;
+
+	// Clamp to the edge of the heightfield
+	xpos = std::max(0, std::min(xpos, m_size - 1));
+	zpos = std::max(0, std::min(zpos, m_size - 1));
+
+	int tileX = xpos / m_tileSize;
+	int tileZ = zpos / m_tileSize;
+	int tile = tileZ * m_tilesPerSide + tileX;
+	size_t offset = (size_t)(zpos - tileZ * m_tileSize);
+	size_t column = (size_t)(xpos - tileX * m_tileSize) * m_bytesPerSample;
+
+	if (!m_editedTiles[tile].empty())
+		return DecodeSample(&m_editedTiles[tile][offset * m_tileSize * m_bytesPerSample + column], m_bytesPerSample);
+
+	size_t rowPitch;
+	const unsigned char* data = GetMappedTile(tile, rowPitch);
+
+	return DecodeSample(data + offset * rowPitch + column, m_bytesPerSample);
+}
+
+void HeightfieldSource::SetSamples(int xpos, int zpos, int width, int height, const unsigned char* data)
+{
+	if (m_size == 0 || !data)
+		return;
+
+	// Clip the region to the heightfield
+	int startX = std::max(xpos, 0);
+	int startZ = std::max(zpos, 0);
+	int endX = std::min(xpos + width, m_size);
+	int endZ = std::min(zpos + height, m_size);
+
+	for (int z = startZ; z < endZ; z++)
+	{
+		for (int x = startX; x < endX; x++)
+		{
+			int tileX = x / m_tileSize;
+			int tileZ = z / m_tileSize;
+			int tile = tileZ * m_tilesPerSide + tileX;
+			std::vector<unsigned char>& edited = m_editedTiles[tile];
+
+			// The tile is copied out of the mapping the first time it changes
+			if (edited.empty())
+			{
+				HeightfieldTile mapped = GetTile(tileX, tileZ);
+				size_t tilePitch = (size_t)m_tileSize * m_bytesPerSample;
+				edited.assign(tilePitch * m_tileSize, 0);
+				for (int row = 0; row < mapped.height; row++)
+					memcpy(&edited[row * tilePitch], mapped.data + row * mapped.rowPitch, (size_t)mapped.width * m_bytesPerSample);
+			}
+
+			unsigned char value = data[(z - zpos) * width + (x - xpos)];
+			unsigned char* sample = &edited[((size_t)(z - tileZ * m_tileSize) * m_tileSize + (x - tileX * m_tileSize)) * m_bytesPerSample];
+			sample[0] = value;
+			if (m_bytesPerSample == 2)
+				sample[1] = value;
+		}
+	}
+}
+
+bool HeightfieldSource::WriteTiled(const std::string& filePath, int tileSize) const
+{
+	if (m_size == 0 || tileSize < 1)
+		return false;
+
+	std::ofstream outfile(filePath.c_str(), std::ios::binary);
+	if (!outfile)
+	{
+		std::cout << "Cannot write tiled heightfield: " << filePath << std::endl;
+		return false;
+	}
+
+	TiledHeightfieldHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = TILED_HEIGHTFIELD_MAGIC;
+	header.version = TILED_HEIGHTFIELD_VERSION;
+	header.size = (uint32_t)m_size;
+	header.tileSize = (uint32_t)tileSize;
+	header.bitDepth = (uint32_t)GetBitDepth();
+	outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	// Tiles are written one at a time, so the heightfield is never held in memory
+	int tilesPerSide = (m_size + tileSize - 1) / tileSize;
+	std::vector<unsigned char> tile((size_t)tileSize * tileSize * m_bytesPerSample);
+	for (int tileZ = 0; tileZ < tilesPerSide; tileZ++)
+	{
+		for (int tileX = 0; tileX < tilesPerSide; tileX++)
+		{
+			for (int z = 0; z < tileSize; z++)
+			{
+				for (int x = 0; x < tileSize; x++)
+				{
+					// Samples are copied as they are stored, not through GetSample(), so 16-bit maps keep their precision
+					int sampleX = std::min(tileX * tileSize + x, m_size - 1);
+					int sampleZ = std::min(tileZ * tileSize + z, m_size - 1);
+					HeightfieldTile source = GetTile(sampleX / m_tileSize, sampleZ / m_tileSize);
+					const unsigned char* sample = source.data + (size_t)(sampleZ - source.z) * source.rowPitch + (size_t)(sampleX - source.x) * m_bytesPerSample;
+					memcpy(&tile[((size_t)z * tileSize + x) * m_bytesPerSample], sample, m_bytesPerSample);
+				}
+			}
+
+			outfile.write(reinterpret_cast<const char*>(&tile[0]), tile.size());
+		}
+	}
+
+	if (!outfile)
+	{
+		std::cout << "Cannot write tiled heightfield: " << filePath << std::endl;
+		return false;
+	}
+
+	std::cout << "Tiled heightfield written to " << filePath << ": " << tilesPerSide << "x" << tilesPerSide
+		<< " tiles of " << tileSize << "x" << tileSize << " " << GetBitDepth() << "-bit samples" << std::endl;
+
+	return true;
+}
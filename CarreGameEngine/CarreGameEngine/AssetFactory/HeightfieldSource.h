@@ -0,0 +1,227 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "..\Common\MappedFile.h"
+
+	/**
+	* @struct HeightfieldTile
+	* @brief A square block of heightfield samples, read in place from the mapped file
+	*/
+struct HeightfieldTile
+{
+	/// First sample of the tile, NULL if the tile is outside the heightfield
+	const unsigned char* data;
+
+	/// Index of the first sample along x and z
+	int x, z;
+
+	/// Samples along x and z, fewer than the tile size at the far edges of the heightfield
+	int width, height;
+
+	/// Bytes from one row of the tile to the next
+	size_t rowPitch;
+};
+
+	/**
+	* @class HeightfieldSource
+	* @brief Heightfield samples read on demand from a memory mapped file
+	*
+	* Terrains used to read the whole .raw file into a buffer sized from the fileSize of the
+	* script, so a file of the wrong size overran the buffer, and only square 8-bit maps could be
+	* used. The heightfield source maps the file instead and checks its size, so samples are paged
+	* in by the operating system as they are touched and terrains larger than memory can be used.
+	*
+	* Two layouts are read:
+	* - Raw files, size * size samples of 8 or 16 bits (little endian) row by row. The bit depth
+	*   is taken from the file size if it is not given.
+	* - Tiled files written by WriteTiled(), which store each tile contiguously after a header so
+	*   a tile is a single run of pages. The size and bit depth come from the header.
+	*
+	* The heightfield is split into tiles for both layouts, and GetTile() returns the samples of a
+	* tile where they lie in the mapping, so the renderer and physics can work a tile at a time.
+	* Samples are returned in 8-bit units, so a 16-bit map gives finer steps with the same scale.
+	*
+	* The mapping is read only. Edited tiles are copied out of the mapping the first time they
+	* are changed.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class HeightfieldSource
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates a heightfield source with nothing open.
+		*
+		* @return null
+		*/
+	HeightfieldSource();
+
+		/**
+		* @brief Destructor
+		*
+		* Closes the file.
+		*
+		* @return null
+		*/
+	~HeightfieldSource() { Close(); }
+
+		/**
+		* @brief Opens a heightfield
+		*
+		* Maps a raw or tiled heightfield file. For raw files size is the number of samples along
+		* each side, 0 to take it from the file size, and bitDepth is 8, 16 or 0 to take it from
+		* the file size. Both are read from the header of tiled files. Returns false if the file
+		* cannot be mapped or is too small for the heightfield.
+		*
+		* @param const std::string& filePath
+		* @param int size
+		* @param int bitDepth
+		* @return bool
+		*/
+	bool Open(const std::string& filePath, int size = 0, int bitDepth = 0);
+
+		/**
+		* @brief Closes the heightfield
+		*
+		* Unmaps the file and discards any edits.
+		*
+		* @return void
+		*/
+	void Close();
+
+		/**
+		* @brief Checks if a heightfield is open
+		*
+		* @return bool
+		*/
+	bool IsOpen() const { return m_file.IsOpen(); }
+
+		/**
+		* @brief Gets the number of samples along each side
+		*
+		* @return int
+		*/
+	int GetSize() const { return m_size; }
+
+		/**
+		* @brief Gets the bits per sample
+		*
+		* @return int
+		*/
+	int GetBitDepth() const { return m_bytesPerSample * 8; }
+
+		/**
+		* @brief Checks if the file is tiled
+		*
+		* @return bool
+		*/
+	bool IsTiled() const { return m_tiled; }
+
+		/**
+		* @brief Gets the number of samples along each side of a tile
+		*
+		* @return int
+		*/
+	int GetTileSize() const { return m_tileSize; }
+
+		/**
+		* @brief Gets the number of tiles along each side
+		*
+		* @return int
+		*/
+	int GetTilesPerSide() const { return m_tilesPerSide; }
+
+		/**
+		* @brief Gets a tile
+		*
+		* Returns where the samples of the tile are, in the mapping or in the copy of an edited
+		* tile. Touching the samples pages them in.
+		*
+		* @param int tileX
+		* @param int tileZ
+		* @return HeightfieldTile
+		*/
+	HeightfieldTile GetTile(int tileX, int tileZ) const;
+
+		/**
+		* @brief Gets a sample
+		*
+		* Returns the sample at the given x and z indices in 8-bit units. Indices outside of the
+		* heightfield are clamped to its edge.
+		*
+		* @param int xpos
+		* @param int zpos
+		* @return float
+		*/
+	float GetSample(int xpos, int zpos) const;
+
+		/**
+		* @brief Changes a region of samples
+		*
+		* Copies width * height 8-bit samples into the heightfield at the given position, clipped
+		* to the heightfield. The tiles changed are copied out of the mapping first.
+		*
+		* @param int xpos
+		* @param int zpos
+		* @param int width
+		* @param int height
+		* @param const unsigned char* data
+		* @return void
+		*/
+	void SetSamples(int xpos, int zpos, int width, int height, const unsigned char* data);
+
+		/**
+		* @brief Writes the heightfield as a tiled file
+		*
+		* Writes every tile of the open heightfield, edits included, contiguously after a header.
+		* Tiles at the far edges are padded with their last sample. Opening the written file
+		* gives the same samples.
+		*
+		* @param const std::string& filePath
+		* @param int tileSize
+		* @return bool
+		*/
+	bool WriteTiled(const std::string& filePath, int tileSize) const;
+
+private:
+		/**
+		* @brief Gets the samples of a tile in the mapping
+		*
+		* @param int tile
+		* @param size_t& rowPitch
+		* @return const unsigned char*
+		*/
+	const unsigned char* GetMappedTile(int tile, size_t& rowPitch) const;
+
+	/// Mapped heightfield file
+	MappedFile m_file;
+
+	/// Samples along each side of the heightfield and of a tile
+	int m_size, m_tileSize;
+
+	/// Tiles along each side
+	int m_tilesPerSide;
+
+	/// 1 for 8-bit and 2 for 16-bit samples
+	int m_bytesPerSample;
+
+	/// Whether the file stores each tile contiguously
+	bool m_tiled;
+
+	/// Offset of the first sample in the file
+	size_t m_dataOffset;
+
+	/// Copies of the edited tiles, row by row at the tile size, empty for tiles read from the file
+	std::vector<std::vector<unsigned char> > m_editedTiles;
+};
@@ -0,0 +1,108 @@
+#include "KeyframeSet.h"
+
+KeyframeSet::KeyframeSet()
+	: m_frameCount(0), m_vertexCount(0), m_buffer(0), m_texture(0)
+{
+}
+
+void KeyframeSet::SetFrames(int frameCount, int vertexCount, std::vector<glm::vec4> positions)
+{
+	m_frameCount = frameCount;
+	m_vertexCount = vertexCount;
+	m_positions = std::move(positions);
+}
+
+int KeyframeSet::FindClip(const std::string& name) const
+{
+	for (size_t i = 0; i < m_clips.size(); i++)
+	{
+		if (m_clips[i].name == name)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+// Gets the frames of the clip a playback plays, the whole set without clips
+static void GetClipFrames(const std::vector<KeyframeClip>& clips, int frameCount, int clip, int& firstFrame, int& clipFrames)
+{
+	firstFrame = 0;
+	clipFrames = frameCount;
+	if (clip >= 0 && clip < (int)clips.size())
+	{
+		firstFrame = clips[clip].firstFrame;
+		clipFrames = clips[clip].frameCount;
+	}
+}
+
+void KeyframeSet::Advance(KeyframePlayback& playback, float seconds) const
+{
+	int firstFrame, frameCount;
+	GetClipFrames(m_clips, m_frameCount, playback.clip, firstFrame, frameCount);
+
+	// Wrapped so the time keeps its precision however long the clip plays
+	playback.time += seconds;
+	if (playback.framesPerSecond > 0.0f && frameCount > 0)
+		playback.time = std::fmod(playback.time, frameCount / playback.framesPerSecond);
+}
+
+void KeyframeSet::Sample(const KeyframePlayback& playback, int& from, int& to, float& blend) const
+{
+	int firstFrame, frameCount;
+	GetClipFrames(m_clips, m_frameCount, playback.clip, firstFrame, frameCount);
+
+	if (frameCount <= 1)
+	{
+		from = to = firstFrame;
+		blend = 0.0f;
+		return;
+	}
+
+	float position = std::max(0.0f, playback.time * playback.framesPerSecond);
+	float whole = std::floor(position);
+	int frame = (int)std::fmod(whole, (float)frameCount);
+
+	from = firstFrame + frame;
+	to = firstFrame + (frame + 1) % frameCount;
+	blend = position - whole;
+}
+
+bool KeyframeSet::Upload()
+{
+	if (m_texture)
+		return true;
+	if (m_positions.empty())
+		return false;
+
+	// A position is one RGBA32F texel
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	if (m_positions.size() > (size_t)maxTexels)
+	{
+		std::cout << "Keyframes of " << m_frameCount << " frames of " << m_vertexCount << " vertices are larger than a buffer texture!" << std::endl;
+		return false;
+	}
+
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+	glBufferData(GL_TEXTURE_BUFFER, GetBytes(), &m_positions[0], GL_STATIC_DRAW);
+
+	glGenTextures(1, &m_texture);
+	glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_buffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	return true;
+}
+
+void KeyframeSet::Release()
+{
+	if (m_texture)
+		glDeleteTextures(1, &m_texture);
+	if (m_buffer)
+		glDeleteBuffers(1, &m_buffer);
+
+	m_texture = 0;
+	m_buffer = 0;
+}
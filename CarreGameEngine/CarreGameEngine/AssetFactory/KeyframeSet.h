@@ -0,0 +1,205 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <GL\glew.h>
+#include <GLM\glm.hpp>
+
+	/**
+	* @struct KeyframeClip
+	* @brief A named run of frames, such as a walk cycle
+	*/
+struct KeyframeClip
+{
+	/// Name of the clip, eg. "run"
+	std::string name;
+
+	/// First frame of the clip and the number of frames in it
+	int firstFrame, frameCount;
+};
+
+	/**
+	* @struct KeyframePlayback
+	* @brief Where a model is in its clip
+	*
+	* Kept by every model, so models sharing a keyframe set animate on their own.
+	*/
+struct KeyframePlayback
+{
+	/// Clip being played, an index into the clips of the set
+	int clip;
+
+	/// Seconds since the clip started
+	float time;
+
+	/// Frames played per second
+	float framesPerSecond;
+};
+
+	/**
+	* @class KeyframeSet
+	* @brief Vertex positions of every frame of a vertex animated mesh
+	*
+	* Vertex animated models, such as MD2 models, store a full copy of the vertex positions for
+	* every frame. The frames are uploaded once into a buffer texture that the vertex shader
+	* reads, frame after frame, with the vertices of a frame in the order of the mesh vertices.
+	* The shader blends the two frames a model is between, so animating a model costs nothing
+	* per vertex on the CPU and models in different frames still draw as instances of one mesh.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class KeyframeSet
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates a set with no frames.
+		*
+		* @return null
+		*/
+	KeyframeSet();
+
+		/**
+		* @brief Destructor
+		*
+		* Empty destructor, Release() deletes the OpenGL objects while the context exists.
+		*
+		* @return null
+		*/
+	~KeyframeSet() { }
+
+		/**
+		* @brief Sets the frames
+		*
+		* Positions holds frameCount frames of vertexCount positions each.
+		*
+		* @param int frameCount
+		* @param int vertexCount
+		* @param std::vector<glm::vec4> positions
+		* @return void
+		*/
+	void SetFrames(int frameCount, int vertexCount, std::vector<glm::vec4> positions);
+
+		/**
+		* @brief Adds a clip
+		*
+		* @param const KeyframeClip& clip
+		* @return void
+		*/
+	void AddClip(const KeyframeClip& clip) { m_clips.push_back(clip); }
+
+		/**
+		* @brief Gets the clips
+		*
+		* @return const std::vector<KeyframeClip>&
+		*/
+	const std::vector<KeyframeClip>& GetClips() const { return m_clips; }
+
+		/**
+		* @brief Finds a clip by name
+		*
+		* Returns the index of the clip, or -1 if the set has no clip of that name.
+		*
+		* @param const std::string& name
+		* @return int
+		*/
+	int FindClip(const std::string& name) const;
+
+		/**
+		* @brief Gets the number of frames
+		*
+		* @return int
+		*/
+	int GetFrameCount() const { return m_frameCount; }
+
+		/**
+		* @brief Gets the number of vertices of a frame
+		*
+		* @return int
+		*/
+	int GetVertexCount() const { return m_vertexCount; }
+
+		/**
+		* @brief Gets the bytes of frame data
+		*
+		* @return size_t
+		*/
+	size_t GetBytes() const { return m_positions.size() * sizeof(glm::vec4); }
+
+		/**
+		* @brief Advances a playback
+		*
+		* Moves the playback on by the given seconds, wrapped to the length of its clip.
+		*
+		* @param KeyframePlayback& playback
+		* @param float seconds
+		* @return void
+		*/
+	void Advance(KeyframePlayback& playback, float seconds) const;
+
+		/**
+		* @brief Finds the frames a playback is between
+		*
+		* Sets from and to to the frames of the set the playback is between, and blend to how
+		* far it is from one to the other. Clips loop, the last frame blends into the first.
+		*
+		* @param const KeyframePlayback& playback
+		* @param int& from
+		* @param int& to
+		* @param float& blend
+		* @return void
+		*/
+	void Sample(const KeyframePlayback& playback, int& from, int& to, float& blend) const;
+
+		/**
+		* @brief Uploads the frames
+		*
+		* Creates the buffer and buffer texture of the frames on the calling thread's context if
+		* they do not exist yet. Returns false if the frames are larger than buffer textures can
+		* be, the mesh is then drawn in its first frame.
+		*
+		* @return bool
+		*/
+	bool Upload();
+
+		/**
+		* @brief Checks if the frames are uploaded
+		*
+		* @return bool
+		*/
+	bool IsUploaded() const { return m_texture != 0; }
+
+		/**
+		* @brief Gets the buffer texture of the frames
+		*
+		* @return GLuint
+		*/
+	GLuint GetTexture() const { return m_texture; }
+
+		/**
+		* @brief Deletes the frames from the GPU
+		*
+		* Deletes the buffer and its buffer texture.
+		*
+		* @return void
+		*/
+	void Release();
+
+private:
+	/// Number of frames and of vertices in each
+	int m_frameCount, m_vertexCount;
+
+	/// Positions of every frame, the w component is unused
+	std::vector<glm::vec4> m_positions;
+
+	/// Named runs of frames
+	std::vector<KeyframeClip> m_clips;
+
+	/// Buffer holding the positions and the buffer texture the shader reads them through
+	GLuint m_buffer, m_texture;
+};
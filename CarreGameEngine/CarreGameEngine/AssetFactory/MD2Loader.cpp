@@ -0,0 +1,298 @@
+#include "MD2Loader.h"
+#include <cctype>
+#include <cfloat>
+
+	/**
+	* @struct MD2Header
+	* @brief Header at the start of an MD2 file, the offsets are from the start of the file
+	*/
+struct MD2Header
+{
+	char ident[4];
+	int32_t version;
+	int32_t skinWidth, skinHeight;
+	int32_t frameSize;
+	int32_t skinCount, vertexCount, texCoordCount, triangleCount, glCommandCount, frameCount;
+	int32_t skinOffset, texCoordOffset, triangleOffset, frameOffset, glCommandOffset, endOffset;
+};
+
+	/**
+	* @struct MD2TexCoord
+	* @brief Texture coordinate in texels of the skin
+	*/
+struct MD2TexCoord
+{
+	int16_t s, t;
+};
+
+	/**
+	* @struct MD2Triangle
+	* @brief Position and texture coordinate indices of a triangle
+	*/
+struct MD2Triangle
+{
+	uint16_t vertex[3];
+	uint16_t texCoord[3];
+};
+
+	/**
+	* @struct MD2Vertex
+	* @brief Position of a vertex in a frame, quantized with the scale and offset of the frame
+	*/
+struct MD2Vertex
+{
+	uint8_t position[3];
+	uint8_t normalIndex;
+};
+
+/// Bytes of the scale, offset and name at the start of every frame, before its vertices
+static const size_t FRAME_HEADER_BYTES = 40;
+
+// Checks if count items of a given size at offset are inside the file
+static bool IsInFile(int32_t offset, int32_t count, size_t itemBytes, size_t fileBytes)
+{
+	return offset >= 0 && count >= 0 && (unsigned long long)offset + (unsigned long long)count * itemBytes <= fileBytes;
+}
+
+bool MD2Loader::IsMD2File(const std::string& filePath)
+{
+	size_t dot = filePath.find_last_of('.');
+	if (dot == std::string::npos)
+		return false;
+
+	std::string extension = filePath.substr(dot);
+	for (size_t i = 0; i < extension.size(); i++)
+		extension[i] = (char)tolower((unsigned char)extension[i]);
+
+	return extension == ".md2";
+}
+
+bool MD2Loader::Load(const std::string& filePath, ModelResource& resource)
+{
+	MappedFile file;
+	if (!file.Open(filePath))
+	{
+		std::cout << "Failed to open MD2 model " << filePath << std::endl;
+		return false;
+	}
+
+	const unsigned char* data = file.GetData();
+	size_t fileBytes = file.GetSize();
+
+	MD2Header header;
+	if (fileBytes < sizeof(header))
+	{
+		std::cout << "Invalid MD2 model " << filePath << std::endl;
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	if (memcmp(header.ident, "IDP2", 4) != 0 || header.version != 8 || header.skinWidth <= 0 || header.skinHeight <= 0
+		|| header.vertexCount <= 0 || header.texCoordCount <= 0 || header.triangleCount <= 0 || header.frameCount <= 0
+		|| header.frameSize < (int32_t)(FRAME_HEADER_BYTES + header.vertexCount * sizeof(MD2Vertex))
+		|| !IsInFile(header.texCoordOffset, header.texCoordCount, sizeof(MD2TexCoord), fileBytes)
+		|| !IsInFile(header.triangleOffset, header.triangleCount, sizeof(MD2Triangle), fileBytes)
+		|| !IsInFile(header.frameOffset, header.frameCount, header.frameSize, fileBytes))
+	{
+		std::cout << "Invalid MD2 model " << filePath << std::endl;
+		return false;
+	}
+
+	const MD2TexCoord* texCoords = reinterpret_cast<const MD2TexCoord*>(data + header.texCoordOffset);
+	const MD2Triangle* triangles = reinterpret_cast<const MD2Triangle*>(data + header.triangleOffset);
+
+	// Each distinct pair of position and texture coordinate is a vertex, the position index in the top half
+	std::unordered_map<uint32_t, unsigned int> lookup;
+	std::vector<uint32_t> corners;
+	std::vector<unsigned int> indices;
+	indices.reserve((size_t)header.triangleCount * 3);
+
+	// The file's triangles are clockwise
+	static const int CORNER_ORDER[3] = { 0, 2, 1 };
+
+	for (int32_t i = 0; i < header.triangleCount; i++)
+	{
+		const MD2Triangle& triangle = triangles[i];
+
+		bool valid = true;
+		for (int k = 0; k < 3; k++)
+			valid = valid && triangle.vertex[k] < header.vertexCount && triangle.texCoord[k] < header.texCoordCount;
+		if (!valid)
+			continue;
+
+		for (int k = 0; k < 3; k++)
+		{
+			int corner = CORNER_ORDER[k];
+			uint32_t key = ((uint32_t)triangle.vertex[corner] << 16) | triangle.texCoord[corner];
+
+			std::unordered_map<uint32_t, unsigned int>::iterator itr = lookup.find(key);
+			if (itr == lookup.end())
+			{
+				itr = lookup.insert(std::make_pair(key, (unsigned int)corners.size())).first;
+				corners.push_back(key);
+			}
+			indices.push_back(itr->second);
+		}
+	}
+
+	if (indices.empty())
+	{
+		std::cout << "MD2 model " << filePath << " has no triangles" << std::endl;
+		return false;
+	}
+
+	// The frames are decoded in the order the reordered triangles first use the vertices
+	MeshOptimizer::OptimizeVertexCache(&indices[0], indices.size(), corners.size());
+
+	std::vector<unsigned int> remap(corners.size(), 0xFFFFFFFF);
+	std::vector<uint32_t> orderedCorners;
+	orderedCorners.reserve(corners.size());
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		if (remap[indices[i]] == 0xFFFFFFFF)
+		{
+			remap[indices[i]] = (unsigned int)orderedCorners.size();
+			orderedCorners.push_back(corners[indices[i]]);
+		}
+		indices[i] = remap[indices[i]];
+	}
+	corners.swap(orderedCorners);
+
+	int vertexCount = (int)corners.size();
+	std::vector<glm::vec4> positions((size_t)header.frameCount * vertexCount);
+	glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+	std::vector<KeyframeClip> clips;
+
+	for (int32_t i = 0; i < header.frameCount; i++)
+	{
+		const unsigned char* frame = data + header.frameOffset + (size_t)i * header.frameSize;
+
+		float scale[3], translate[3];
+		char name[17] = { 0 };
+		memcpy(scale, frame, sizeof(scale));
+		memcpy(translate, frame + sizeof(scale), sizeof(translate));
+		memcpy(name, frame + sizeof(scale) + sizeof(translate), 16);
+
+		const MD2Vertex* frameVertices = reinterpret_cast<const MD2Vertex*>(frame + FRAME_HEADER_BYTES);
+		glm::vec4* framePositions = &positions[(size_t)i * vertexCount];
+		for (int j = 0; j < vertexCount; j++)
+		{
+			const MD2Vertex& vertex = frameVertices[corners[j] >> 16];
+			float x = vertex.position[0] * scale[0] + translate[0];
+			float y = vertex.position[1] * scale[1] + translate[1];
+			float z = vertex.position[2] * scale[2] + translate[2];
+
+			// Z up turned Y up
+			glm::vec3 position(x, z, -y);
+			framePositions[j] = glm::vec4(position, 1.0f);
+
+			// Bounds of every frame, so the model stays inside them whatever it plays
+			boundsMin = glm::min(boundsMin, position);
+			boundsMax = glm::max(boundsMax, position);
+		}
+
+		// Frames of a clip follow each other
+		std::string clipName = GetClipName(name);
+		if (clips.empty() || clips.back().name != clipName)
+		{
+			KeyframeClip clip;
+			clip.name = clipName;
+			clip.firstFrame = i;
+			clip.frameCount = 0;
+			clips.push_back(clip);
+		}
+		clips.back().frameCount++;
+	}
+
+	// The mesh holds the first frame, which is drawn if the keyframes cannot be uploaded
+	resource.meshes.emplace_back();
+	Mesh& mesh = resource.meshes.back();
+	std::vector<Vertex3>& vertices = mesh.GetVertices();
+	vertices.resize(vertexCount);
+	for (int i = 0; i < vertexCount; i++)
+	{
+		const MD2TexCoord& texCoord = texCoords[corners[i] & 0xFFFF];
+		vertices[i].m_position = glm::vec3(positions[i]);
+		vertices[i].m_texCoords = glm::vec2(texCoord.s / (float)header.skinWidth, texCoord.t / (float)header.skinHeight);
+		vertices[i].m_colour = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	}
+
+	size_t indexCount = indices.size();
+	mesh.SetIndices(std::move(indices));
+	mesh.SetFullIndexCount((unsigned int)indexCount);
+	mesh.SetLayout(VertexLayout::CreatePacked(true, false, false));
+
+	// Loaded by LoadTextures() on the thread that owns the GL context
+	std::string skin = FindSkin(filePath);
+	if (!skin.empty())
+	{
+		Texture texture;
+		texture.m_id = 0;
+		texture.m_type = "texture_diffuse";
+		texture.m_path = skin;
+		mesh.GetTextures().push_back(texture);
+	}
+	else
+	{
+		std::cout << "No skin found for MD2 model " << filePath << std::endl;
+	}
+
+	KeyframeSet* keyframes = new KeyframeSet();
+	keyframes->SetFrames(header.frameCount, vertexCount, std::move(positions));
+	for (size_t i = 0; i < clips.size(); i++)
+		keyframes->AddClip(clips[i]);
+
+	resource.keyframes = keyframes;
+	resource.boundsMin = boundsMin;
+	resource.boundsMax = boundsMax;
+	resource.xDim = glm::vec2(boundsMin.x, boundsMax.x);
+	resource.yDim = glm::vec2(boundsMin.y, boundsMax.y);
+	resource.zDim = glm::vec2(boundsMin.z, boundsMax.z);
+
+	std::cout << "Loaded MD2 model " << filePath << ": " << vertexCount << " vertices, " << indexCount / 3 << " triangles, "
+		<< header.frameCount << " frames in " << clips.size() << " clips, " << keyframes->GetBytes() / 1024 << " KB of keyframes" << std::endl;
+
+	return true;
+}
+
+std::string MD2Loader::FindSkin(const std::string& filePath)
+{
+	size_t slash = filePath.find_last_of("/\\");
+	size_t start = slash == std::string::npos ? 0 : slash + 1;
+	size_t dot = filePath.find_last_of('.');
+	if (dot == std::string::npos || dot < start)
+		dot = filePath.size();
+
+	std::string directory = filePath.substr(0, start);
+	std::string name = filePath.substr(start, dot - start);
+
+	// Formats the texture manager can decode
+	static const char* EXTENSIONS[] = { ".png", ".tga", ".bmp", ".jpg" };
+	for (size_t i = 0; i < sizeof(EXTENSIONS) / sizeof(EXTENSIONS[0]); i++)
+	{
+		std::ifstream skin(directory + name + EXTENSIONS[i], std::ios::binary);
+		if (skin.is_open())
+			return name + EXTENSIONS[i];
+	}
+
+	return "";
+}
+
+std::string MD2Loader::GetClipName(const char* frameName)
+{
+	std::string name(frameName);
+	size_t end = name.size();
+
+	// "death101" is frame one of the clip "death1"
+	if (end >= 2 && isdigit((unsigned char)name[end - 1]) && isdigit((unsigned char)name[end - 2]))
+	{
+		end -= 2;
+	}
+	else
+	{
+		while (end > 0 && isdigit((unsigned char)name[end - 1]))
+			end--;
+	}
+
+	return name.substr(0, end);
+}
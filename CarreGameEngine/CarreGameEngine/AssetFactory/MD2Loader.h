@@ -0,0 +1,86 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <GLM\glm.hpp>
+
+#include "Mesh.h"
+#include "ModelCache.h"
+#include "KeyframeSet.h"
+#include "MeshOptimizer.h"
+#include "..\Common\MappedFile.h"
+
+	/**
+	* @class MD2Loader
+	* @brief Loads Quake II MD2 models as a mesh and a set of keyframes
+	*
+	* An MD2 model is one textured mesh stored as a full copy of its vertex positions for every
+	* frame, quantized to bytes with a scale and offset per frame. Assimp only reads the first
+	* frame, so MD2 files are read here instead.
+	*
+	* Each distinct pair of position and texture coordinate of the triangles becomes a vertex of
+	* an indexed mesh, ordered for the vertex cache. The positions of every frame are decoded
+	* for those vertices into a KeyframeSet, which the vertex shader blends between, and the
+	* frames are grouped into clips by their names, "run01" to "run06" being the clip "run".
+	*
+	* MD2 models are Z up with clockwise triangles, they are turned Y up with counter clockwise
+	* triangles. The file has no usable skin path, the skins name PCX files in Quake's own
+	* directories, so the skin is an image of the same name as the model in its directory, such
+	* as knight.bmp for knight.md2.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class MD2Loader
+{
+public:
+		/**
+		* @brief Checks if a file is an MD2 model
+		*
+		* Checks the extension of the file path.
+		*
+		* @param const std::string& filePath
+		* @return bool
+		*/
+	static bool IsMD2File(const std::string& filePath);
+
+		/**
+		* @brief Loads an MD2 model
+		*
+		* Loads the mesh, keyframes and bounds of the file into the resource. Makes no OpenGL or
+		* texture manager calls, so models can be loaded on worker threads. Returns false if the
+		* file cannot be read or is not a valid MD2 model.
+		*
+		* @param const std::string& filePath
+		* @param ModelResource& resource
+		* @return bool
+		*/
+	static bool Load(const std::string& filePath, ModelResource& resource);
+
+private:
+		/**
+		* @brief Finds the skin of a model
+		*
+		* Returns the file name, relative to the model directory, of the first image with the name
+		* of the model, or an empty string if there is none.
+		*
+		* @param const std::string& filePath
+		* @return std::string
+		*/
+	static std::string FindSkin(const std::string& filePath);
+
+		/**
+		* @brief Gets the clip a frame belongs to
+		*
+		* Returns the frame name without its two digit frame number.
+		*
+		* @param const char* frameName
+		* @return std::string
+		*/
+	static std::string GetClipName(const char* frameName);
+};
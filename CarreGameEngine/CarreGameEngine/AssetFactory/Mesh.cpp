@@ -1,8 +1,113 @@
 #include "Mesh.h"
+#include "MeshSimplifier.h"
 
 Mesh::Mesh(std::vector<Vertex3> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
+	: VAO(0), VBO(0), EBO(0), m_layout(VertexLayout::CreatePacked(true, true, true)), m_shader(NULL), m_fullIndexCount(0),
+	m_cookedVertices(NULL), m_cookedIndices(NULL), m_cookedVertexCount(0), m_cookedIndexCount(0)
 {
-	m_vertices = vertices;
-	m_indices = indices;
-	m_textures = textures;
+	m_vertices = std::move(vertices);
+	m_indices = std::move(indices);
+	m_textures = std::move(textures);
+}
+
+std::vector<Vertex3>& Mesh::GetVertices()
+{
+	// Culling and physics read the vertices, the renderer uploads the blob directly
+	if (m_cookedVertices && m_vertices.size() != m_cookedVertexCount)
+		m_layout.Unpack(m_cookedVertices, m_cookedVertexCount, m_vertices);
+
+	return m_vertices;
+}
+
+void Mesh::GetTrianglePositions(std::vector<glm::vec3>& positions)
+{
+	std::vector<Vertex3>& vertices = GetVertices();
+	if (m_fullIndexCount == 0)
+	{
+		for (size_t i = 0; i + 2 < vertices.size(); i += 3)
+		{
+			positions.push_back(vertices[i].m_position);
+			positions.push_back(vertices[i + 1].m_position);
+			positions.push_back(vertices[i + 2].m_position);
+		}
+		return;
+	}
+
+	const unsigned int* indices = m_cookedIndices ? m_cookedIndices : &m_indices[0];
+	for (unsigned int i = 0; i < m_fullIndexCount; i++)
+		positions.push_back(vertices[indices[i]].m_position);
+}
+
+void Mesh::ReleaseBuffers()
+{
+	if (!VAO)
+		return;
+
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteBuffers(1, &EBO);
+	VAO = VBO = EBO = 0;
+}
+
+void Mesh::SetCooked(const unsigned char* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount)
+{
+	m_cookedVertices = vertices;
+	m_cookedVertexCount = vertexCount;
+	m_cookedIndices = indices;
+	m_cookedIndexCount = indexCount;
+	m_vertices.clear();
+	m_indices.clear();
+}
+
+void Mesh::GenerateLods(const std::vector<float>& fractions, size_t minTriangles)
+{
+	// Levels follow the full mesh of an indexed mesh, an unindexed one is read as a triangle list
+	std::vector<unsigned int> corners;
+	const unsigned int* indices = NULL;
+	size_t indexCount = m_fullIndexCount;
+	if (indexCount > 0)
+	{
+		m_indices.resize(indexCount);
+		indices = &m_indices[0];
+	}
+	else
+	{
+		m_indices.clear();
+		indexCount = m_vertices.size();
+	}
+	m_lods.clear();
+
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount < minTriangles)
+		return;
+
+	if (!indices)
+	{
+		corners.resize(indexCount);
+		for (size_t i = 0; i < indexCount; i++)
+			corners[i] = (unsigned int)i;
+		indices = &corners[0];
+	}
+
+	MeshSimplifier simplifier(m_vertices, indices, indexCount);
+	size_t previousCount = triangleCount;
+	std::vector<unsigned int> levelIndices;
+
+	for (size_t i = 0; i < fractions.size(); i++)
+	{
+		simplifier.Simplify((size_t)(triangleCount * fractions[i]));
+
+		// Stop once the mesh cannot be simplified much further
+		if (simplifier.GetTriangleCount() > previousCount * 9 / 10)
+			break;
+		previousCount = simplifier.GetTriangleCount();
+
+		simplifier.GetIndices(levelIndices);
+
+		MeshLod lod;
+		lod.firstIndex = (unsigned int)m_indices.size();
+		lod.indexCount = (unsigned int)levelIndices.size();
+		m_lods.push_back(lod);
+		m_indices.insert(m_indices.end(), levelIndices.begin(), levelIndices.end());
+	}
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <utility>
 #include <GLM\glm.hpp>									// Used for the GLM math library
 #include <GLM\gtc\matrix_transform.hpp>					
 #include <GLM\gtx\transform2.hpp>						
@@ -11,7 +12,20 @@
 #include "..\Texture\TextureManager.h"
 #include "..\Common\Vertex3.h"
 #include "..\Renderer\Shader.h"
+#include "..\Renderer\VertexLayout.h"
 
+	/**
+	* @struct MeshLod
+	* @brief A reduced level of detail of a mesh, a range of its index buffer
+	*/
+struct MeshLod
+{
+	/// First index of the level in the index buffer
+	unsigned int firstIndex;
+
+	/// Number of indices, three per triangle
+	unsigned int indexCount;
+};
 
 	/**
 	* @class Mesh
@@ -19,7 +33,8 @@
 	*
 	* The mesh class is what holds all the vertex information about an objects model. There may
 	* be many meshes that make up a model. Each mesh contains vertices, indices and textures that
-	* are used to draw the specific model.
+	* are used to draw the specific model. Meshes have no transform of their own, they are drawn
+	* with the world matrix of the model that owns them.
 	* 
 	* @author Cordell Smith
 	* @version 01
@@ -32,11 +47,12 @@ public:
 		/**
 		* @brief Constructor
 		*
-		* Empty default constructor.
+		* Default constructor, the mesh uses the packed layout with every attribute.
 		*
 		* @return null
 		*/
-	Mesh() { }
+	Mesh() : VAO(0), VBO(0), EBO(0), m_layout(VertexLayout::CreatePacked(true, true, true)), m_shader(NULL), m_fullIndexCount(0),
+		m_cookedVertices(NULL), m_cookedIndices(NULL), m_cookedVertexCount(0), m_cookedIndexCount(0) { }
 
 		/**
 		* @brief Destructor
@@ -48,80 +64,66 @@ public:
 	~Mesh() { }
 
 		/**
-		* @brief Constructor
+		* @brief Copy constructor
 		*
-		* This constructor takes in vertices, indices and texture data and assigns them to
-		* member variables of the mesh.
+		* Default member wise copy.
 		*
 		* @return null
 		*/
-	Mesh(std::vector<Vertex3> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
+	Mesh(const Mesh& other) = default;
 
 		/**
-		* @brief Sets the position
+		* @brief Move constructor
 		*
-		* Sets the position of the mesh to the 3 component vector parsed in.
+		* Declared because the destructor would otherwise turn every move of a mesh, such as
+		* the mesh vector growing, into a copy of its vertices.
 		*
-		* @param glm::vec3 position
-		* @return void
+		* @return null
 		*/
-	void SetPosition(glm::vec3 position) { m_position = position; }
+	Mesh(Mesh&& other) = default;
 
 		/**
-		* @brief Gets the position
+		* @brief Copy assignment
 		*
-		* Gets the position of the mesh.
-		*
-		* @return glm::vec3 position
+		* @return Mesh&
 		*/
-	const glm::vec3& GetPosition() { return m_position; }
+	Mesh& operator=(const Mesh& other) = default;
 
 		/**
-		* @brief Sets the rotation
-		*
-		* Sets the rotation of the mesh to the 3 component vector parsed in.
+		* @brief Move assignment
 		*
-		* @param const glm::vec3 rotation
-		* @return void
+		* @return Mesh&
 		*/
-	void SetRotation(glm::vec3 rotation) { m_rotation = rotation; }
+	Mesh& operator=(Mesh&& other) = default;
 
 		/**
-		* @brief Gets the rotation
-		*
-		* Gets the rotation of the mesh.
-		*
-		* @return const glm::vec3 rotation
-		*/
-	const glm::vec3& GetRotation() { return m_rotation; }
-
-		/**
-		* @brief Sets the scale
+		* @brief Constructor
 		*
-		* Sets the scale of the mesh to the 3 component vector parsed in.
+		* This constructor takes in vertices, indices and texture data and moves them into the
+		* member variables of the mesh, pass them with std::move() to avoid copying them.
 		*
-		* @param glm::vec3 scale
-		* @return void
+		* @return null
 		*/
-	void SetScale(glm::vec3 scale) { m_scale = scale; }
+	Mesh(std::vector<Vertex3> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
 
 		/**
-		* @brief Gets the scale
+		* @brief Gets the vertices of the mesh
 		*
-		* Gets the scale of the mesh.
+		* Returns the vertices data of the mesh by reference. Cooked meshes are unpacked from
+		* their blob the first time this is called.
 		*
-		* @return const glm::vec3 scale
+		* @return std::vector<Vertex3>&
 		*/
-	const glm::vec3& GetScale() { return m_scale; }
+	std::vector<Vertex3>& GetVertices();
 
 		/**
-		* @brief Gets the vertices of the mesh
+		* @brief Gets the number of vertices
 		*
-		* Returns the vertices data of the mesh by reference.
+		* Returns the vertex count without unpacking a cooked mesh.
 		*
-		* @return std::vector<Vertex3>&
+		* @return size_t
 		*/
-	std::vector<Vertex3>& GetVertices() { return m_vertices; }
+	size_t GetVertexCount() const { return m_cookedVertices ? m_cookedVertexCount : m_vertices.size(); }
 
 		/**
 		* @brief Sets the vertices of the mesh
@@ -131,7 +133,7 @@ public:
 		* @param std::vector<Vertex3> vertices
 		* @return void
 		*/
-	void SetVertices(std::vector<Vertex3> vertices) { m_vertices = vertices; }
+	void SetVertices(std::vector<Vertex3> vertices) { m_vertices = std::move(vertices); }
 
 		/**
 		* @brief Gets the indices of the mesh
@@ -150,7 +152,7 @@ public:
 		* @param std::vector<unsigned int> indices
 		* @return void
 		*/
-	void SetIndices(std::vector<unsigned int> indices) { m_indices = indices; }
+	void SetIndices(std::vector<unsigned int> indices) { m_indices = std::move(indices); }
 
 		/**
 		* @brief Gets the textures of the mesh
@@ -160,6 +162,170 @@ public:
 		* @return std::vector<Texture>&
 		*/
 	std::vector<Texture>& GetTextures() { return m_textures; }
+
+		/**
+		* @brief Gets the vertex layout of the mesh
+		*
+		* Returns the layout the vertices of the mesh are packed into on the GPU. It lists the
+		* attributes the mesh has data for.
+		*
+		* @return const VertexLayout&
+		*/
+	const VertexLayout& GetLayout() const { return m_layout; }
+
+		/**
+		* @brief Sets the vertex layout of the mesh
+		*
+		* Sets the layout the vertices of the mesh are packed into on the GPU.
+		*
+		* @param const VertexLayout& layout
+		* @return void
+		*/
+	void SetLayout(const VertexLayout& layout) { m_layout = layout; }
+
+		/**
+		* @brief Gets the shader of the mesh
+		*
+		* Returns the shader program the mesh is drawn with, or NULL if it is drawn with the
+		* shader of its model.
+		*
+		* @return Shader*
+		*/
+	Shader* GetShader() const { return m_shader; }
+
+		/**
+		* @brief Sets the shader of the mesh
+		*
+		* Sets a shader program that overrides the shader of the model for this mesh, for
+		* example the texture array variant when the mesh texture was packed into an array.
+		*
+		* @param Shader* shader
+		* @return void
+		*/
+	void SetShader(Shader* shader) { m_shader = shader; }
+
+		/**
+		* @brief Gets the reduced levels of detail
+		*
+		* Returns the simplified versions of the mesh, coarsest last. Level 0 is the full mesh,
+		* the first GetFullIndexCount() indices, so lods[0] is level 1. Each level is a range of
+		* the indices of the mesh.
+		*
+		* @return const std::vector<MeshLod>&
+		*/
+	const std::vector<MeshLod>& GetLods() const { return m_lods; }
+
+		/**
+		* @brief Sets the reduced levels of detail
+		*
+		* Sets levels that were generated before, for meshes read from the mesh cache.
+		*
+		* @param const std::vector<MeshLod>& lods
+		* @return void
+		*/
+	void SetLods(const std::vector<MeshLod>& lods) { m_lods = lods; }
+
+		/**
+		* @brief Gets the index count of the full mesh
+		*
+		* Returns the number of indices at the start of the index buffer that draw the full mesh.
+		* Meshes built in code have none and are drawn from the vertices directly, three per
+		* triangle.
+		*
+		* @return unsigned int
+		*/
+	unsigned int GetFullIndexCount() const { return m_fullIndexCount; }
+
+		/**
+		* @brief Sets the index count of the full mesh
+		*
+		* @param unsigned int fullIndexCount
+		* @return void
+		*/
+	void SetFullIndexCount(unsigned int fullIndexCount) { m_fullIndexCount = fullIndexCount; }
+
+		/**
+		* @brief Gets the triangles of the full mesh
+		*
+		* Adds the three corner positions of every triangle of the full mesh to positions,
+		* whether it is indexed or not.
+		*
+		* @param std::vector<glm::vec3>& positions
+		* @return void
+		*/
+	void GetTrianglePositions(std::vector<glm::vec3>& positions);
+
+		/**
+		* @brief Sets cooked vertex and index data
+		*
+		* Points the mesh at vertices already packed in its layout and at its indices, which are
+		* uploaded as they are. The data must stay valid for as long as the mesh, it usually
+		* lives in a mapped cooked mesh file.
+		*
+		* @param const unsigned char* vertices
+		* @param size_t vertexCount
+		* @param const unsigned int* indices
+		* @param size_t indexCount
+		* @return void
+		*/
+	void SetCooked(const unsigned char* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount);
+
+		/**
+		* @brief Checks if the mesh is cooked
+		*
+		* Returns true if the mesh data comes from SetCooked().
+		*
+		* @return bool
+		*/
+	bool IsCooked() const { return m_cookedVertices != NULL; }
+
+		/**
+		* @brief Gets the cooked vertices
+		*
+		* Returns the vertices packed in the layout of the mesh, GetVertexCount() * stride bytes.
+		*
+		* @return const unsigned char*
+		*/
+	const unsigned char* GetCookedVertices() const { return m_cookedVertices; }
+
+		/**
+		* @brief Gets the cooked indices
+		*
+		* @return const unsigned int*
+		*/
+	const unsigned int* GetCookedIndices() const { return m_cookedIndices; }
+
+		/**
+		* @brief Gets the number of cooked indices
+		*
+		* @return size_t
+		*/
+	size_t GetCookedIndexCount() const { return m_cookedIndexCount; }
+
+		/**
+		* @brief Generates the levels of detail
+		*
+		* Simplifies the mesh to each fraction of its triangle count in turn and stores every
+		* level as indices into the original vertices, after the indices of the full mesh. A
+		* mesh that is not indexed yet is read as a triangle list. A level is only kept if it
+		* removes a tenth of the triangles of the level before. Meshes with fewer than
+		* minTriangles triangles keep the full mesh only.
+		*
+		* @param const std::vector<float>& fractions
+		* @param size_t minTriangles
+		* @return void
+		*/
+	void GenerateLods(const std::vector<float>& fractions, size_t minTriangles);
+
+		/**
+		* @brief Deletes the OpenGL buffers of the mesh
+		*
+		* Deletes the vertex array and buffers created by OpenGl::Prepare(), if there are any.
+		* Must be called on the thread the context is current on.
+		*
+		* @return void
+		*/
+	void ReleaseBuffers();
 		
 	unsigned int VAO, VBO, EBO;
 
@@ -168,7 +334,20 @@ protected:
 	std::vector<unsigned int> m_indices;
 	std::vector<Texture> m_textures;
 
-	glm::vec3 m_position;
-	glm::vec3 m_rotation;
-	glm::vec3 m_scale;
+	/// Packed GPU vertex format
+	VertexLayout m_layout;
+
+	/// Shader overriding the model shader, NULL to use the model shader
+	Shader* m_shader;
+
+	/// Reduced levels of detail in the index buffer
+	std::vector<MeshLod> m_lods;
+
+	/// Indices of the full mesh at the start of the index buffer, 0 to draw the vertices directly
+	unsigned int m_fullIndexCount;
+
+	/// Packed vertices and indices of a cooked mesh, owned by the mapped file
+	const unsigned char* m_cookedVertices;
+	const unsigned int* m_cookedIndices;
+	size_t m_cookedVertexCount, m_cookedIndexCount;
 };
\ No newline at end of file
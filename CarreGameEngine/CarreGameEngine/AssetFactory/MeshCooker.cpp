@@ -0,0 +1,340 @@
+#include "MeshCooker.h"
+#include <cstring>
+#include <chrono>
+
+/// Identifies a cooked mesh file written by the mesh cooker
+static const uint32_t COOKED_MESH_MAGIC = 0x48534D43; // "CMSH"
+
+/// Changing the import, optimisation or level of detail code must change this so old cache files are cooked again
+static const uint32_t COOKED_MESH_VERSION = 3;
+
+/// Vertex and index blobs start on this boundary so they can be uploaded from the mapping as they are
+static const size_t COOKED_BLOB_ALIGNMENT = 16;
+
+/**
+* @struct CookedMeshHeader
+* @brief Header at the start of a cooked mesh file, followed by the mesh table
+*/
+struct CookedMeshHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceHash;
+	uint32_t meshCount;
+	uint32_t padding;
+	float boundsMin[3];
+	float boundsMax[3];
+	float xDim[2];
+	float yDim[2];
+	float zDim[2];
+};
+
+/**
+* @struct CookedMeshEntry
+* @brief A mesh of a cooked mesh file, offsets are from the start of the file
+*/
+struct CookedMeshEntry
+{
+	uint32_t vertexCount;
+	uint32_t vertexOffset;
+	uint32_t vertexBytes;
+	uint32_t indexOffset;
+	uint32_t indexCount;
+
+	/// Indices of the full mesh at the start of the indices, 0 if it is drawn unindexed
+	uint32_t fullIndexCount;
+	uint32_t lodOffset;
+	uint32_t lodCount;
+
+	/// Each texture is its type then its path, both as a length then the characters
+	uint32_t textureOffset;
+	uint32_t textureCount;
+
+	/// Each element is its attribute << 8 | its format
+	uint32_t elementCount;
+	uint32_t elements[ATTRIB_COUNT];
+};
+
+// Appends bytes to a blob, padded so they start at an aligned offset from the start of the file
+static uint32_t AppendBlob(std::vector<char>& blob, size_t base, const void* data, size_t size, size_t alignment)
+{
+	while ((base + blob.size()) % alignment != 0)
+		blob.push_back(0);
+
+	uint32_t offset = (uint32_t)(base + blob.size());
+	if (size > 0)
+		blob.insert(blob.end(), (const char*)data, (const char*)data + size);
+
+	return offset;
+}
+
+// Appends a length prefixed string
+static void AppendString(std::vector<char>& blob, const std::string& text)
+{
+	uint32_t length = (uint32_t)text.size();
+	blob.insert(blob.end(), (const char*)&length, (const char*)&length + sizeof(length));
+	blob.insert(blob.end(), text.begin(), text.end());
+}
+
+// Reads a length prefixed string, returns false if it runs past the end of the file
+static bool ReadString(const unsigned char* data, size_t size, size_t& offset, std::string& text)
+{
+	uint32_t length;
+	if (offset + sizeof(length) > size)
+		return false;
+	memcpy(&length, data + offset, sizeof(length));
+	offset += sizeof(length);
+
+	if (offset + length > size)
+		return false;
+	text.assign((const char*)data + offset, length);
+	offset += length;
+
+	return true;
+}
+
+MeshCooker::MeshCooker()
+	: m_cacheDirectory("Resources/objects/cache"), m_enabled(true), m_forceRecook(false),
+	m_cookedLoads(0), m_imports(0), m_cookedSeconds(0.0), m_importSeconds(0.0), m_saveSeconds(0.0)
+{
+}
+
+std::string MeshCooker::GetCachePath(const std::string& filePath) const
+{
+	return m_cacheDirectory + "/" + HashToString(HashString(filePath)) + ".cmesh";
+}
+
+bool MeshCooker::Load(const std::string& filePath, unsigned int importFlags, ModelResource* resource, uint64_t& sourceHash)
+{
+	sourceHash = 0;
+	if (!m_enabled)
+		return false;
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	// Cooked models are keyed by their source contents, so an edited model is imported again
+	MappedFile source;
+	if (!source.Open(filePath))
+		return false;
+
+	sourceHash = HashBytes(source.GetData(), source.GetSize());
+	sourceHash = HashBytes(&importFlags, sizeof(importFlags), sourceHash);
+	sourceHash = HashBytes(&COOKED_MESH_VERSION, sizeof(COOKED_MESH_VERSION), sourceHash);
+	source.Close();
+
+	if (m_forceRecook)
+		return false;
+
+	MappedFile* file = new MappedFile();
+	if (!file->Open(GetCachePath(filePath)) || !ReadCooked(*file, sourceHash, resource))
+	{
+		resource->meshes.clear();
+		delete file;
+		return false;
+	}
+	resource->file = file;
+
+	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+	std::lock_guard<std::mutex> lock(m_statsMutex);
+	m_cookedLoads++;
+	m_cookedSeconds += elapsed.count();
+
+	return true;
+}
+
+bool MeshCooker::LoadBounds(const std::string& filePath, ModelResource& resource)
+{
+	if (!m_enabled || m_forceRecook)
+		return false;
+
+	std::ifstream infile(GetCachePath(filePath).c_str(), std::ios::binary);
+	CookedMeshHeader header;
+	if (!infile.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+	if (header.magic != COOKED_MESH_MAGIC || header.version != COOKED_MESH_VERSION)
+		return false;
+
+	resource.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+	resource.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+	resource.xDim = glm::vec2(header.xDim[0], header.xDim[1]);
+	resource.yDim = glm::vec2(header.yDim[0], header.yDim[1]);
+	resource.zDim = glm::vec2(header.zDim[0], header.zDim[1]);
+
+	return true;
+}
+
+bool MeshCooker::ReadCooked(const MappedFile& file, uint64_t sourceHash, ModelResource* resource)
+{
+	const unsigned char* data = file.GetData();
+	size_t size = file.GetSize();
+
+	CookedMeshHeader header;
+	if (size < sizeof(header))
+		return false;
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != COOKED_MESH_MAGIC || header.version != COOKED_MESH_VERSION || header.sourceHash != sourceHash)
+		return false;
+
+	if (sizeof(header) + (uint64_t)header.meshCount * sizeof(CookedMeshEntry) > size)
+		return false;
+
+	resource->boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+	resource->boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+	resource->xDim = glm::vec2(header.xDim[0], header.xDim[1]);
+	resource->yDim = glm::vec2(header.yDim[0], header.yDim[1]);
+	resource->zDim = glm::vec2(header.zDim[0], header.zDim[1]);
+	resource->meshes.resize(header.meshCount);
+
+	for (uint32_t i = 0; i < header.meshCount; i++)
+	{
+		CookedMeshEntry entry;
+		memcpy(&entry, data + sizeof(header) + i * sizeof(entry), sizeof(entry));
+
+		if (entry.elementCount > ATTRIB_COUNT)
+			return false;
+
+		VertexLayout layout;
+		for (uint32_t j = 0; j < entry.elementCount; j++)
+		{
+			uint32_t attribute = entry.elements[j] >> 8;
+			uint32_t format = entry.elements[j] & 0xFF;
+			if (attribute >= ATTRIB_COUNT || format > FORMAT_UINT8_4)
+				return false;
+
+			layout.AddElement((VertexAttribute)attribute, (VertexFormat)format);
+		}
+
+		// Every range must lie inside the file
+		if ((uint64_t)entry.vertexCount * layout.GetStride() != entry.vertexBytes
+			|| (uint64_t)entry.vertexOffset + entry.vertexBytes > size
+			|| (uint64_t)entry.indexOffset + (uint64_t)entry.indexCount * sizeof(unsigned int) > size
+			|| entry.fullIndexCount > entry.indexCount
+			|| (uint64_t)entry.lodOffset + (uint64_t)entry.lodCount * sizeof(MeshLod) > size
+			|| entry.vertexOffset % COOKED_BLOB_ALIGNMENT != 0 || entry.indexOffset % COOKED_BLOB_ALIGNMENT != 0)
+			return false;
+
+		std::vector<MeshLod> lods(entry.lodCount);
+		for (uint32_t j = 0; j < entry.lodCount; j++)
+		{
+			memcpy(&lods[j], data + entry.lodOffset + j * sizeof(MeshLod), sizeof(MeshLod));
+			if ((uint64_t)lods[j].firstIndex + lods[j].indexCount > entry.indexCount)
+				return false;
+		}
+
+		Mesh& mesh = resource->meshes[i];
+		size_t textureOffset = entry.textureOffset;
+		for (uint32_t j = 0; j < entry.textureCount; j++)
+		{
+			Texture texture;
+			texture.m_id = 0;
+			if (!ReadString(data, size, textureOffset, texture.m_type) || !ReadString(data, size, textureOffset, texture.m_path))
+				return false;
+
+			mesh.GetTextures().push_back(texture);
+		}
+
+		mesh.SetLayout(layout);
+		mesh.SetCooked(data + entry.vertexOffset, entry.vertexCount, (const unsigned int*)(data + entry.indexOffset), entry.indexCount);
+		mesh.SetLods(lods);
+		mesh.SetFullIndexCount(entry.fullIndexCount);
+	}
+
+	return true;
+}
+
+void MeshCooker::Save(const std::string& filePath, uint64_t sourceHash, ModelResource& resource)
+{
+	if (!m_enabled || sourceHash == 0)
+		return;
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	if (!MakeDirectory(m_cacheDirectory))
+		return;
+
+	CookedMeshHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = COOKED_MESH_MAGIC;
+	header.version = COOKED_MESH_VERSION;
+	header.sourceHash = sourceHash;
+	header.meshCount = (uint32_t)resource.meshes.size();
+	memcpy(header.boundsMin, &resource.boundsMin[0], sizeof(header.boundsMin));
+	memcpy(header.boundsMax, &resource.boundsMax[0], sizeof(header.boundsMax));
+	memcpy(header.xDim, &resource.xDim[0], sizeof(header.xDim));
+	memcpy(header.yDim, &resource.yDim[0], sizeof(header.yDim));
+	memcpy(header.zDim, &resource.zDim[0], sizeof(header.zDim));
+
+	// Blobs follow the mesh table
+	std::vector<CookedMeshEntry> entries(resource.meshes.size());
+	size_t base = sizeof(header) + entries.size() * sizeof(CookedMeshEntry);
+	std::vector<char> blob;
+	std::vector<unsigned char> packedVertices;
+
+	for (size_t i = 0; i < resource.meshes.size(); i++)
+	{
+		Mesh& mesh = resource.meshes[i];
+		const VertexLayout& layout = mesh.GetLayout();
+		CookedMeshEntry& entry = entries[i];
+		memset(&entry, 0, sizeof(entry));
+
+		const std::vector<VertexElement>& elements = layout.GetElements();
+		entry.elementCount = (uint32_t)elements.size();
+		for (size_t j = 0; j < elements.size(); j++)
+			entry.elements[j] = ((uint32_t)elements[j].attribute << 8) | (uint32_t)elements[j].format;
+
+		layout.Pack(mesh.GetVertices(), packedVertices);
+		entry.vertexCount = (uint32_t)mesh.GetVertexCount();
+		entry.vertexBytes = (uint32_t)packedVertices.size();
+		entry.vertexOffset = AppendBlob(blob, base, packedVertices.empty() ? NULL : &packedVertices[0], packedVertices.size(), COOKED_BLOB_ALIGNMENT);
+
+		const std::vector<unsigned int>& indices = mesh.GetIndices();
+		entry.indexCount = (uint32_t)indices.size();
+		entry.fullIndexCount = mesh.GetFullIndexCount();
+		entry.indexOffset = AppendBlob(blob, base, indices.empty() ? NULL : &indices[0], indices.size() * sizeof(unsigned int), COOKED_BLOB_ALIGNMENT);
+
+		const std::vector<MeshLod>& lods = mesh.GetLods();
+		entry.lodCount = (uint32_t)lods.size();
+		entry.lodOffset = AppendBlob(blob, base, lods.empty() ? NULL : &lods[0], lods.size() * sizeof(MeshLod), sizeof(uint32_t));
+
+		const std::vector<Texture>& textures = mesh.GetTextures();
+		entry.textureCount = (uint32_t)textures.size();
+		entry.textureOffset = (uint32_t)(base + blob.size());
+		for (size_t j = 0; j < textures.size(); j++)
+		{
+			AppendString(blob, textures[j].m_type);
+			AppendString(blob, textures[j].m_path);
+		}
+	}
+
+	std::string cachePath = GetCachePath(filePath);
+	std::ofstream outfile(cachePath.c_str(), std::ios::binary);
+	if (!outfile)
+	{
+		std::cout << "Cannot write mesh cache: " << cachePath << std::endl;
+		return;
+	}
+
+	outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (!entries.empty())
+		outfile.write(reinterpret_cast<const char*>(&entries[0]), entries.size() * sizeof(CookedMeshEntry));
+	if (!blob.empty())
+		outfile.write(&blob[0], blob.size());
+
+	if (!outfile)
+		std::cout << "Cannot write mesh cache: " << cachePath << std::endl;
+	else
+		std::cout << "Cooked mesh: " << filePath << std::endl;
+
+	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+	std::lock_guard<std::mutex> lock(m_statsMutex);
+	m_saveSeconds += elapsed.count();
+}
+
+void MeshCooker::RecordImport(double seconds)
+{
+	std::lock_guard<std::mutex> lock(m_statsMutex);
+	m_imports++;
+	m_importSeconds += seconds;
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <mutex>
+
+#include "ModelCache.h"
+#include "..\Common\FileUtils.h"
+#include "..\Common\MappedFile.h"
+
+	/**
+	* @class MeshCooker
+	* @brief Caches imported models on disk in a binary format that is mapped straight into memory
+	*
+	* Importing a model through Assimp parses the text of the file, triangulates it, joins
+	* identical vertices, simplifies every mesh into its levels of detail and then optimises the
+	* meshes with the MeshOptimizer, on every run. The mesh cooker writes the result of the first
+	* import to the cache directory: a header with the bounds of the model, a table of its meshes
+	* with their vertex layouts, levels of detail and material textures, and the packed vertex and
+	* index blobs of every mesh.
+	*
+	* Later runs map the cooked file and point the meshes at the blobs, which are uploaded with
+	* glBufferData() as they are, so a cached model is neither parsed nor copied. A cooked file
+	* is only used while the hash of its source file, the import flags and the format version
+	* match, so edited models are imported again.
+	*
+	* Load() and Save() make no OpenGL calls and may be called from worker threads.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class MeshCooker
+{
+public:
+		/**
+		* @brief Singleton instance
+		*
+		* This function returns a singleton instance of the mesh cooker class so that there is only
+		* one mesh cache.
+		*
+		* @return static MeshCooker&
+		*/
+	static MeshCooker& Instance()
+	{
+		static MeshCooker instance;
+
+		return instance;
+	}
+
+		/**
+		* @brief Loads a cooked model
+		*
+		* Maps the cooked file of the source model and fills the resource with its meshes and
+		* bounds. Mesh textures only have their type and path set, the caller loads them.
+		* Returns false if the model has to be imported, in which case sourceHash is the hash to
+		* pass to Save(), or 0 if the source cannot be read.
+		*
+		* @param const std::string& filePath
+		* @param unsigned int importFlags
+		* @param ModelResource* resource
+		* @param uint64_t& sourceHash
+		* @return bool
+		*/
+	bool Load(const std::string& filePath, unsigned int importFlags, ModelResource* resource, uint64_t& sourceHash);
+
+		/**
+		* @brief Loads the bounds of a cooked model
+		*
+		* Reads only the header of the cooked file of the source model and fills the bounds of
+		* the resource. The source is not hashed, so the bounds may be those of an older version
+		* of the model, they are only meant as a placeholder until the model is loaded. Returns
+		* false if the model has not been cooked.
+		*
+		* @param const std::string& filePath
+		* @param ModelResource& resource
+		* @return bool
+		*/
+	bool LoadBounds(const std::string& filePath, ModelResource& resource);
+
+		/**
+		* @brief Saves an imported model
+		*
+		* Writes the meshes of a resource filled by an import to the cooked file of the source
+		* model.
+		*
+		* @param const std::string& filePath
+		* @param uint64_t sourceHash
+		* @param ModelResource& resource
+		* @return void
+		*/
+	void Save(const std::string& filePath, uint64_t sourceHash, ModelResource& resource);
+
+		/**
+		* @brief Records an import
+		*
+		* Adds a model imported through Assimp and the seconds it took to the statistics, to
+		* compare against cooked loads.
+		*
+		* @param double seconds
+		* @return void
+		*/
+	void RecordImport(double seconds);
+
+		/**
+		* @brief Enables the mesh cache
+		*
+		* A disabled cache neither reads nor writes cooked files, every model is imported.
+		*
+		* @param bool enabled
+		* @return void
+		*/
+	void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+		/**
+		* @brief Checks if the mesh cache is enabled
+		*
+		* @return bool
+		*/
+	bool IsEnabled() const { return m_enabled; }
+
+		/**
+		* @brief Forces every model to be cooked again
+		*
+		* Existing cooked files are ignored and overwritten, to measure a cold cache.
+		*
+		* @param bool recook
+		* @return void
+		*/
+	void SetForceRecook(bool recook) { m_forceRecook = recook; }
+
+		/**
+		* @brief Sets the cache directory
+		*
+		* Sets the directory cooked models are written to and read from.
+		*
+		* @param const std::string& directory
+		* @return void
+		*/
+	void SetCacheDirectory(const std::string& directory) { m_cacheDirectory = directory; }
+
+		/**
+		* @brief Gets the number of cooked loads
+		*
+		* @return int
+		*/
+	int GetCookedLoads() const { return m_cookedLoads; }
+
+		/**
+		* @brief Gets the number of imports
+		*
+		* @return int
+		*/
+	int GetImports() const { return m_imports; }
+
+		/**
+		* @brief Gets the time spent loading cooked models
+		*
+		* Returns the total number of seconds spent in successful Load() calls, hashing the
+		* source included.
+		*
+		* @return double
+		*/
+	double GetCookedSeconds() const { return m_cookedSeconds; }
+
+		/**
+		* @brief Gets the time spent importing
+		*
+		* Returns the total number of seconds passed to RecordImport().
+		*
+		* @return double
+		*/
+	double GetImportSeconds() const { return m_importSeconds; }
+
+		/**
+		* @brief Gets the time spent writing cooked files
+		*
+		* @return double
+		*/
+	double GetSaveSeconds() const { return m_saveSeconds; }
+
+private:
+		/**
+		* @brief Default constructor
+		*
+		* Sets the default cache directory.
+		*
+		* @return null
+		*/
+	MeshCooker();
+
+		/**
+		* @brief Destructor
+		*
+		* Empty destructor.
+		*
+		* @return null
+		*/
+	~MeshCooker() { }
+
+		/**
+		* @brief Gets the cooked file of a model
+		*
+		* @param const std::string& filePath
+		* @return std::string
+		*/
+	std::string GetCachePath(const std::string& filePath) const;
+
+		/**
+		* @brief Reads the meshes of a mapped cooked file
+		*
+		* Returns false if the file is not a valid cooked model for the source hash.
+		*
+		* @param const MappedFile& file
+		* @param uint64_t sourceHash
+		* @param ModelResource* resource
+		* @return bool
+		*/
+	bool ReadCooked(const MappedFile& file, uint64_t sourceHash, ModelResource* resource);
+
+	/// Directory the cooked models are cached in
+	std::string m_cacheDirectory;
+
+	/// Whether cooked files are used, and whether existing ones are ignored
+	bool m_enabled, m_forceRecook;
+
+	/// Models loaded from cooked files and imported through Assimp
+	int m_cookedLoads, m_imports;
+
+	/// Time spent loading cooked files, importing and writing cooked files
+	double m_cookedSeconds, m_importSeconds, m_saveSeconds;
+
+	/// Guards the statistics, which are updated from worker threads
+	std::mutex m_statsMutex;
+};
@@ -0,0 +1,695 @@
+#include "MeshOptimizer.h"
+#include <cfloat>
+
+/// Entries of the post-transform cache the statistics and overdraw clusters are measured with
+static const unsigned int VERTEX_CACHE_SIZE = 16;
+
+/// Entries of the cache the vertex cache optimisation scores vertices for
+static const int FORSYTH_CACHE_SIZE = 32;
+
+/// Cache miss ratio an overdraw cluster may have over the triangles it was cut from
+static const float OVERDRAW_THRESHOLD = 1.05f;
+
+/// Pixels along each side of the views overdraw is measured from
+static const int OVERDRAW_GRID = 256;
+
+/// Size and number of the memory lines the vertex fetch is measured with
+static const size_t FETCH_LINE_BYTES = 64;
+static const size_t FETCH_CACHE_LINES = 64;
+
+/// Marks an empty slot or a vertex not yet renumbered
+static const unsigned int INVALID_INDEX = 0xFFFFFFFF;
+
+// Hashes the bytes of a vertex, vertices are value initialized so there is no padding to differ
+static size_t HashVertex(const Vertex3& vertex)
+{
+	const uint32_t* words = reinterpret_cast<const uint32_t*>(&vertex);
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < sizeof(Vertex3) / sizeof(uint32_t); i++)
+	{
+		hash ^= words[i];
+		hash *= 16777619u;
+	}
+
+	return hash ^ (hash >> 16);
+}
+
+// Checks if two meshes can be drawn as one
+static bool IsSameMaterial(Mesh& a, Mesh& b)
+{
+	if (a.IsCooked() || b.IsCooked() || a.GetFullIndexCount() == 0 || b.GetFullIndexCount() == 0)
+		return false;
+
+	const std::vector<VertexElement>& elementsA = a.GetLayout().GetElements();
+	const std::vector<VertexElement>& elementsB = b.GetLayout().GetElements();
+	if (elementsA.size() != elementsB.size())
+		return false;
+	for (size_t i = 0; i < elementsA.size(); i++)
+	{
+		if (elementsA[i].attribute != elementsB[i].attribute || elementsA[i].format != elementsB[i].format)
+			return false;
+	}
+
+	std::vector<Texture>& texturesA = a.GetTextures();
+	std::vector<Texture>& texturesB = b.GetTextures();
+	if (texturesA.size() != texturesB.size())
+		return false;
+	for (size_t i = 0; i < texturesA.size(); i++)
+	{
+		if (texturesA[i].m_type != texturesB[i].m_type || texturesA[i].m_path != texturesB[i].m_path)
+			return false;
+	}
+
+	return true;
+}
+
+// Score of a vertex for the vertex cache optimisation, from its position in the cache and the triangles it has left
+static float GetVertexScore(int cachePosition, unsigned int remaining)
+{
+	if (remaining == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+	if (cachePosition >= 0)
+	{
+		// The vertices of the last triangle score the same, whichever order they were used in
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+			score = std::pow(1.0f - (float)(cachePosition - 3) / (FORSYTH_CACHE_SIZE - 3), 1.5f);
+	}
+
+	// Vertices with few triangles left are finished first, so they leave the cache for good
+	score += 2.0f * std::pow((float)remaining, -0.5f);
+
+	return score;
+}
+
+// Rasterizes the triangles from six views along the axes with a depth test, in the order they are drawn
+static float MeasureOverdraw(const std::vector<glm::vec3>& corners)
+{
+	if (corners.size() < 3)
+		return 0.0f;
+
+	glm::vec3 boundsMin = corners[0], boundsMax = corners[0];
+	for (size_t i = 1; i < corners.size(); i++)
+	{
+		boundsMin = glm::min(boundsMin, corners[i]);
+		boundsMax = glm::max(boundsMax, corners[i]);
+	}
+	glm::vec3 size = boundsMax - boundsMin;
+	float extent = std::max(size.x, std::max(size.y, size.z));
+	if (extent <= 0.0f)
+		return 0.0f;
+
+	// The model fills the views along its longest side
+	float scale = (OVERDRAW_GRID - 1) / extent;
+	std::vector<float> depth((size_t)OVERDRAW_GRID * OVERDRAW_GRID);
+	size_t shaded = 0, covered = 0;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		int u = (axis + 1) % 3;
+		int v = (axis + 2) % 3;
+
+		for (int direction = -1; direction <= 1; direction += 2)
+		{
+			std::fill(depth.begin(), depth.end(), FLT_MAX);
+
+			for (size_t i = 0; i + 2 < corners.size(); i += 3)
+			{
+				// Back faces are culled as they are when drawn, the view looks along the axis times direction
+				glm::vec3 normal = glm::cross(corners[i + 1] - corners[i], corners[i + 2] - corners[i]);
+				if (normal[axis] * direction >= 0.0f)
+					continue;
+
+				float x[3], y[3], z[3];
+				for (int k = 0; k < 3; k++)
+				{
+					x[k] = (corners[i + k][u] - boundsMin[u]) * scale;
+					y[k] = (corners[i + k][v] - boundsMin[v]) * scale;
+					z[k] = (corners[i + k][axis] - boundsMin[axis]) * direction;
+				}
+
+				float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+				if (area == 0.0f)
+					continue;
+
+				int minX = std::max(0, (int)std::floor(std::min(x[0], std::min(x[1], x[2]))));
+				int maxX = std::min(OVERDRAW_GRID - 1, (int)std::ceil(std::max(x[0], std::max(x[1], x[2]))));
+				int minY = std::max(0, (int)std::floor(std::min(y[0], std::min(y[1], y[2]))));
+				int maxY = std::min(OVERDRAW_GRID - 1, (int)std::ceil(std::max(y[0], std::max(y[1], y[2]))));
+
+				for (int py = minY; py <= maxY; py++)
+				{
+					for (int px = minX; px <= maxX; px++)
+					{
+						float l0 = ((x[1] - px) * (y[2] - py) - (x[2] - px) * (y[1] - py)) / area;
+						float l1 = ((x[2] - px) * (y[0] - py) - (x[0] - px) * (y[2] - py)) / area;
+						float l2 = 1.0f - l0 - l1;
+						if (l0 < 0.0f || l1 < 0.0f || l2 < 0.0f)
+							continue;
+
+						float pixelDepth = l0 * z[0] + l1 * z[1] + l2 * z[2];
+						float& stored = depth[(size_t)py * OVERDRAW_GRID + px];
+						if (pixelDepth < stored)
+						{
+							stored = pixelDepth;
+							shaded++;
+						}
+					}
+				}
+			}
+
+			for (size_t i = 0; i < depth.size(); i++)
+			{
+				if (depth[i] != FLT_MAX)
+					covered++;
+			}
+		}
+	}
+
+	return covered > 0 ? (float)shaded / covered : 0.0f;
+}
+
+void MeshOptimizer::Optimize(std::vector<Mesh>& meshes, MeshOptimizerStats& before, MeshOptimizerStats& after)
+{
+	for (size_t i = 0; i < meshes.size(); i++)
+		IndexMesh(meshes[i]);
+
+	before = Analyze(meshes);
+
+	MergeMeshes(meshes);
+
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		Mesh& mesh = meshes[i];
+		if (mesh.IsCooked() || mesh.GetFullIndexCount() == 0)
+			continue;
+
+		std::vector<unsigned int>& indices = mesh.GetIndices();
+		size_t vertexCount = mesh.GetVertices().size();
+
+		OptimizeVertexCache(&indices[0], mesh.GetFullIndexCount(), vertexCount);
+		OptimizeOverdraw(&indices[0], mesh.GetFullIndexCount(), mesh.GetVertices(), OVERDRAW_THRESHOLD);
+
+		// Reduced levels are drawn small, where overdraw costs little
+		const std::vector<MeshLod>& lods = mesh.GetLods();
+		for (size_t j = 0; j < lods.size(); j++)
+			OptimizeVertexCache(&indices[lods[j].firstIndex], lods[j].indexCount, vertexCount);
+
+		OptimizeVertexFetch(mesh);
+	}
+
+	after = Analyze(meshes);
+}
+
+MeshOptimizerStats MeshOptimizer::Analyze(std::vector<Mesh>& meshes)
+{
+	MeshOptimizerStats stats;
+	memset(&stats, 0, sizeof(stats));
+
+	size_t misses = 0, fetchedBytes = 0, vertexBytes = 0;
+	std::vector<glm::vec3> corners;
+
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		Mesh& mesh = meshes[i];
+		std::vector<Vertex3>& vertices = mesh.GetVertices();
+		unsigned int stride = mesh.GetLayout().GetStride();
+		unsigned int fullIndexCount = mesh.GetFullIndexCount();
+
+		stats.meshes++;
+		stats.vertices += vertices.size();
+		vertexBytes += vertices.size() * stride;
+
+		if (fullIndexCount == 0)
+		{
+			// Every corner is shaded and read once
+			stats.triangles += vertices.size() / 3;
+			misses += vertices.size();
+			fetchedBytes += vertices.size() * stride;
+		}
+		else
+		{
+			const unsigned int* indices = mesh.IsCooked() ? mesh.GetCookedIndices() : &mesh.GetIndices()[0];
+			stats.triangles += fullIndexCount / 3;
+			misses += CountCacheMisses(indices, fullIndexCount, vertices.size());
+			fetchedBytes += CountFetchedBytes(indices, fullIndexCount, stride);
+		}
+
+		// Meshes are drawn one after another, so they overdraw each other too
+		mesh.GetTrianglePositions(corners);
+	}
+
+	stats.acmr = stats.triangles > 0 ? (float)misses / stats.triangles : 0.0f;
+	stats.overfetch = vertexBytes > 0 ? (float)fetchedBytes / vertexBytes : 0.0f;
+	stats.overdraw = MeasureOverdraw(corners);
+
+	return stats;
+}
+
+void MeshOptimizer::IndexMesh(Mesh& mesh)
+{
+	if (mesh.IsCooked() || mesh.GetFullIndexCount() > 0)
+		return;
+
+	std::vector<Vertex3>& corners = mesh.GetVertices();
+	if (corners.empty())
+		return;
+
+	// Open addressing table of the distinct vertices, at most half full
+	size_t tableSize = 1;
+	while (tableSize < corners.size() * 2)
+		tableSize *= 2;
+	std::vector<unsigned int> table(tableSize, INVALID_INDEX);
+
+	std::vector<Vertex3> vertices;
+	vertices.reserve(corners.size() / 2);
+	std::vector<unsigned int> indices(corners.size());
+
+	for (size_t i = 0; i < corners.size(); i++)
+	{
+		size_t slot = HashVertex(corners[i]) & (tableSize - 1);
+		while (table[slot] != INVALID_INDEX && memcmp(&vertices[table[slot]], &corners[i], sizeof(Vertex3)) != 0)
+			slot = (slot + 1) & (tableSize - 1);
+
+		if (table[slot] == INVALID_INDEX)
+		{
+			table[slot] = (unsigned int)vertices.size();
+			vertices.push_back(corners[i]);
+		}
+		indices[i] = table[slot];
+	}
+
+	// The levels of detail index the corners, they follow the full mesh and index the vertices
+	unsigned int fullIndexCount = (unsigned int)indices.size();
+	std::vector<MeshLod> lods = mesh.GetLods();
+	const std::vector<unsigned int>& levelIndices = mesh.GetIndices();
+	for (size_t i = 0; i < lods.size(); i++)
+	{
+		unsigned int firstIndex = (unsigned int)indices.size();
+		for (unsigned int j = 0; j < lods[i].indexCount; j++)
+			indices.push_back(indices[levelIndices[lods[i].firstIndex + j]]);
+		lods[i].firstIndex = firstIndex;
+	}
+
+	mesh.SetVertices(std::move(vertices));
+	mesh.SetIndices(std::move(indices));
+	mesh.SetLods(lods);
+	mesh.SetFullIndexCount(fullIndexCount);
+}
+
+void MeshOptimizer::MergeMeshes(std::vector<Mesh>& meshes)
+{
+	std::vector<Mesh> merged;
+	merged.reserve(meshes.size());
+	std::vector<char> used(meshes.size(), 0);
+
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		if (used[i])
+			continue;
+
+		// Meshes are merged into the first mesh of their material, so the draw order stays close
+		std::vector<size_t> group(1, i);
+		for (size_t j = i + 1; j < meshes.size(); j++)
+		{
+			if (!used[j] && IsSameMaterial(meshes[i], meshes[j]))
+			{
+				group.push_back(j);
+				used[j] = 1;
+			}
+		}
+
+		if (group.size() == 1)
+		{
+			merged.push_back(std::move(meshes[i]));
+			continue;
+		}
+
+		std::vector<Vertex3> vertices;
+		std::vector<unsigned int> bases;
+		size_t levels = 0;
+		for (size_t k = 0; k < group.size(); k++)
+		{
+			std::vector<Vertex3>& partVertices = meshes[group[k]].GetVertices();
+			bases.push_back((unsigned int)vertices.size());
+			vertices.insert(vertices.end(), partVertices.begin(), partVertices.end());
+			levels = std::max(levels, meshes[group[k]].GetLods().size());
+		}
+
+		// Each level is the same level of every part, so it stays one range of the indices
+		std::vector<unsigned int> indices;
+		std::vector<MeshLod> lods;
+		unsigned int fullIndexCount = 0;
+		for (size_t level = 0; level <= levels; level++)
+		{
+			unsigned int firstIndex = (unsigned int)indices.size();
+			for (size_t k = 0; k < group.size(); k++)
+			{
+				Mesh& part = meshes[group[k]];
+				const std::vector<MeshLod>& partLods = part.GetLods();
+
+				MeshLod range;
+				range.firstIndex = 0;
+				range.indexCount = part.GetFullIndexCount();
+				if (level > 0 && !partLods.empty())
+					range = partLods[std::min(level, partLods.size()) - 1];
+
+				const std::vector<unsigned int>& partIndices = part.GetIndices();
+				for (unsigned int j = 0; j < range.indexCount; j++)
+					indices.push_back(partIndices[range.firstIndex + j] + bases[k]);
+			}
+
+			if (level == 0)
+			{
+				fullIndexCount = (unsigned int)indices.size();
+			}
+			else
+			{
+				MeshLod lod;
+				lod.firstIndex = firstIndex;
+				lod.indexCount = (unsigned int)indices.size() - firstIndex;
+				lods.push_back(lod);
+			}
+		}
+
+		Mesh result;
+		result.SetLayout(meshes[i].GetLayout());
+		result.GetTextures() = meshes[i].GetTextures();
+		result.SetVertices(std::move(vertices));
+		result.SetIndices(std::move(indices));
+		result.SetLods(lods);
+		result.SetFullIndexCount(fullIndexCount);
+		merged.push_back(std::move(result));
+	}
+
+	meshes.swap(merged);
+}
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount)
+{
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount < 2)
+		return;
+
+	// Triangles of each vertex, the ones not drawn yet are kept at the front of each list
+	std::vector<unsigned int> remaining(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		remaining[indices[i]]++;
+
+	std::vector<unsigned int> offsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < vertexCount; i++)
+		offsets[i + 1] = offsets[i] + remaining[i];
+
+	std::vector<unsigned int> adjacency(triangleCount * 3);
+	std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++)
+		vertexScore[i] = GetVertexScore(-1, remaining[i]);
+
+	std::vector<float> triangleScore(triangleCount);
+	size_t best = 0;
+	for (size_t i = 0; i < triangleCount; i++)
+	{
+		triangleScore[i] = vertexScore[indices[i * 3]] + vertexScore[indices[i * 3 + 1]] + vertexScore[indices[i * 3 + 2]];
+		if (triangleScore[i] > triangleScore[best])
+			best = i;
+	}
+
+	std::vector<char> emitted(triangleCount, 0);
+	std::vector<unsigned int> result;
+	result.reserve(triangleCount * 3);
+	std::vector<unsigned int> cache, newCache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+	size_t cursor = 0;
+
+	while (result.size() < triangleCount * 3)
+	{
+		// Nothing in the cache has triangles left, carry on from the next triangle of the input
+		if (best == INVALID_INDEX)
+		{
+			while (emitted[cursor])
+				cursor++;
+			best = cursor;
+		}
+
+		emitted[best] = 1;
+		const unsigned int* triangle = indices + best * 3;
+		result.insert(result.end(), triangle, triangle + 3);
+
+		// The triangle is taken out of the lists of its vertices
+		for (int k = 0; k < 3; k++)
+		{
+			unsigned int vertex = triangle[k];
+			unsigned int* begin = &adjacency[offsets[vertex]];
+			unsigned int* end = begin + remaining[vertex];
+			unsigned int* found = std::find(begin, end, (unsigned int)best);
+			if (found != end)
+			{
+				std::swap(*found, *(end - 1));
+				remaining[vertex]--;
+			}
+		}
+
+		// The vertices of the triangle move to the front of the cache
+		newCache.clear();
+		for (int k = 0; k < 3; k++)
+		{
+			if (std::find(newCache.begin(), newCache.end(), triangle[k]) == newCache.end())
+				newCache.push_back(triangle[k]);
+		}
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			if (cache[i] != triangle[0] && cache[i] != triangle[1] && cache[i] != triangle[2])
+				newCache.push_back(cache[i]);
+		}
+
+		// Vertices pushed out of the cache are scored again too
+		for (size_t i = 0; i < newCache.size(); i++)
+		{
+			unsigned int vertex = newCache[i];
+			cachePosition[vertex] = i < (size_t)FORSYTH_CACHE_SIZE ? (int)i : -1;
+			vertexScore[vertex] = GetVertexScore(cachePosition[vertex], remaining[vertex]);
+		}
+
+		// The next triangle is the best of those around the cache
+		best = INVALID_INDEX;
+		float bestScore = -FLT_MAX;
+		for (size_t i = 0; i < newCache.size(); i++)
+		{
+			unsigned int vertex = newCache[i];
+			for (unsigned int j = 0; j < remaining[vertex]; j++)
+			{
+				unsigned int t = adjacency[offsets[vertex] + j];
+				triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+				if (triangleScore[t] > bestScore)
+				{
+					bestScore = triangleScore[t];
+					best = t;
+				}
+			}
+		}
+
+		if (newCache.size() > (size_t)FORSYTH_CACHE_SIZE)
+			newCache.resize(FORSYTH_CACHE_SIZE);
+		cache.swap(newCache);
+	}
+
+	std::copy(result.begin(), result.end(), indices);
+}
+
+void MeshOptimizer::OptimizeOverdraw(unsigned int* indices, size_t indexCount, const std::vector<Vertex3>& vertices, float threshold)
+{
+	size_t triangleCount = indexCount / 3;
+	if (triangleCount < 2)
+		return;
+
+	// A vertex is in the cache while fewer than the cache size of misses have happened since it was added
+	std::vector<unsigned int> stamps(vertices.size(), 0);
+	unsigned int timestamp = VERTEX_CACHE_SIZE + 1;
+
+	// Hard boundaries are where the cache order starts again, a triangle with no vertex in the cache
+	std::vector<size_t> hardClusters;
+	for (size_t i = 0; i < triangleCount; i++)
+	{
+		int misses = 0;
+		for (int k = 0; k < 3; k++)
+		{
+			unsigned int vertex = indices[i * 3 + k];
+			if (timestamp - stamps[vertex] > VERTEX_CACHE_SIZE)
+			{
+				stamps[vertex] = timestamp++;
+				misses++;
+			}
+		}
+
+		if (i == 0 || misses == 3)
+			hardClusters.push_back(i);
+	}
+	hardClusters.push_back(triangleCount);
+
+	// Soft boundaries cut the hard clusters wherever the cache misses so far are close to those of the whole cluster
+	std::vector<size_t> clusters;
+	for (size_t c = 0; c + 1 < hardClusters.size(); c++)
+	{
+		size_t start = hardClusters[c];
+		size_t end = hardClusters[c + 1];
+		float limit = threshold * CountCacheMisses(indices + start * 3, (end - start) * 3, vertices.size()) / (float)(end - start);
+
+		timestamp += VERTEX_CACHE_SIZE + 1;
+		clusters.push_back(start);
+		size_t clusterStart = start, clusterMisses = 0;
+		for (size_t i = start; i < end; i++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				unsigned int vertex = indices[i * 3 + k];
+				if (timestamp - stamps[vertex] > VERTEX_CACHE_SIZE)
+				{
+					stamps[vertex] = timestamp++;
+					clusterMisses++;
+				}
+			}
+
+			if (i + 1 < end && (float)clusterMisses / (i - clusterStart + 1) <= limit)
+			{
+				clusters.push_back(i + 1);
+				clusterStart = i + 1;
+				clusterMisses = 0;
+				timestamp += VERTEX_CACHE_SIZE + 1;
+			}
+		}
+	}
+	clusters.push_back(triangleCount);
+
+	// Centre of the mesh, weighted by the area of the triangles
+	glm::vec3 meshCentre(0.0f);
+	float meshArea = 0.0f;
+	for (size_t i = 0; i < triangleCount; i++)
+	{
+		const glm::vec3& a = vertices[indices[i * 3]].m_position;
+		const glm::vec3& b = vertices[indices[i * 3 + 1]].m_position;
+		const glm::vec3& c = vertices[indices[i * 3 + 2]].m_position;
+		float area = glm::length(glm::cross(b - a, c - a));
+		meshCentre += (a + b + c) * (area / 3.0f);
+		meshArea += area;
+	}
+	if (meshArea > 0.0f)
+		meshCentre /= meshArea;
+
+	// Clusters further out along the way they face are more likely to hide the others, so they are drawn first
+	size_t clusterCount = clusters.size() - 1;
+	std::vector<std::pair<float, size_t> > order(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		glm::vec3 centre(0.0f), normal(0.0f);
+		float clusterArea = 0.0f;
+		for (size_t i = clusters[c]; i < clusters[c + 1]; i++)
+		{
+			const glm::vec3& a = vertices[indices[i * 3]].m_position;
+			const glm::vec3& b = vertices[indices[i * 3 + 1]].m_position;
+			const glm::vec3& d = vertices[indices[i * 3 + 2]].m_position;
+			glm::vec3 cross = glm::cross(b - a, d - a);
+			float area = glm::length(cross);
+			centre += (a + b + d) * (area / 3.0f);
+			normal += cross;
+			clusterArea += area;
+		}
+
+		float key = 0.0f;
+		float normalLength = glm::length(normal);
+		if (clusterArea > 0.0f && normalLength > 0.0f)
+			key = glm::dot(centre / clusterArea - meshCentre, normal / normalLength);
+
+		order[c] = std::make_pair(-key, c);
+	}
+	std::stable_sort(order.begin(), order.end(), [](const std::pair<float, size_t>& a, const std::pair<float, size_t>& b) { return a.first < b.first; });
+
+	std::vector<unsigned int> result;
+	result.reserve(triangleCount * 3);
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		size_t cluster = order[c].second;
+		result.insert(result.end(), indices + clusters[cluster] * 3, indices + clusters[cluster + 1] * 3);
+	}
+
+	std::copy(result.begin(), result.end(), indices);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(Mesh& mesh)
+{
+	std::vector<unsigned int>& indices = mesh.GetIndices();
+	if (mesh.IsCooked() || indices.empty())
+		return;
+
+	std::vector<Vertex3>& vertices = mesh.GetVertices();
+	std::vector<unsigned int> remap(vertices.size(), INVALID_INDEX);
+	std::vector<Vertex3> ordered;
+	ordered.reserve(vertices.size());
+
+	// The full mesh comes first, so its vertices are read front to back
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		unsigned int vertex = indices[i];
+		if (remap[vertex] == INVALID_INDEX)
+		{
+			remap[vertex] = (unsigned int)ordered.size();
+			ordered.push_back(vertices[vertex]);
+		}
+		indices[i] = remap[vertex];
+	}
+
+	mesh.SetVertices(std::move(ordered));
+}
+
+size_t MeshOptimizer::CountCacheMisses(const unsigned int* indices, size_t indexCount, size_t vertexCount)
+{
+	std::vector<unsigned int> stamps(vertexCount, 0);
+	unsigned int timestamp = VERTEX_CACHE_SIZE + 1;
+	size_t misses = 0;
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		unsigned int vertex = indices[i];
+		if (timestamp - stamps[vertex] > VERTEX_CACHE_SIZE)
+		{
+			stamps[vertex] = timestamp++;
+			misses++;
+		}
+	}
+
+	return misses;
+}
+
+size_t MeshOptimizer::CountFetchedBytes(const unsigned int* indices, size_t indexCount, unsigned int stride)
+{
+	// First in first out memory lines
+	size_t lines[FETCH_CACHE_LINES];
+	for (size_t i = 0; i < FETCH_CACHE_LINES; i++)
+		lines[i] = (size_t)-1;
+	size_t next = 0, bytes = 0;
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		size_t first = (size_t)indices[i] * stride / FETCH_LINE_BYTES;
+		size_t last = ((size_t)indices[i] * stride + stride - 1) / FETCH_LINE_BYTES;
+		for (size_t line = first; line <= last; line++)
+		{
+			if (std::find(lines, lines + FETCH_CACHE_LINES, line) != lines + FETCH_CACHE_LINES)
+				continue;
+
+			lines[next] = line;
+			next = (next + 1) % FETCH_CACHE_LINES;
+			bytes += FETCH_LINE_BYTES;
+		}
+	}
+
+	return bytes;
+}
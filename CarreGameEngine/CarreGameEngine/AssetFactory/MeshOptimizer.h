@@ -0,0 +1,163 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <GLM\glm.hpp>
+
+#include "Mesh.h"
+#include "..\Common\Vertex3.h"
+
+	/**
+	* @struct MeshOptimizerStats
+	* @brief How well the meshes of a model use the vertex cache, depth test and vertex fetch
+	*/
+struct MeshOptimizerStats
+{
+	/// Meshes, vertices and triangles of the model
+	size_t meshes, vertices, triangles;
+
+	/// Average cache miss ratio, the vertices shaded per triangle with a post-transform cache
+	float acmr;
+
+	/// Pixels shaded per pixel covered, averaged over six views along the axes
+	float overdraw;
+
+	/// Bytes of vertex data read from memory per byte of vertex data
+	float overfetch;
+};
+
+	/**
+	* @class MeshOptimizer
+	* @brief Reorders imported meshes for the vertex cache, overdraw and vertex fetch
+	*
+	* Meshes are imported with their triangles and vertices in the order the file has them, which
+	* misses the vertex cache and fetches the vertices from all over the buffer. The optimizer
+	* runs on the meshes of a model after the import and before they are cooked:
+	*
+	* - meshes that are still triangle lists are welded into indexed meshes, the levels of
+	*   detail are remapped, meshes Assimp already welded are left as they are;
+	* - meshes with the same textures and vertex layout are merged, so they are one draw;
+	* - the triangles of every level are ordered for a post-transform vertex cache, with Tom
+	*   Forsyth's linear-speed vertex cache optimisation;
+	* - the triangles of the full mesh are then split into clusters that keep the cache order
+	*   within a threshold and the clusters facing out of the mesh are drawn first, from Sander,
+	*   Nehab and Barczak's "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw";
+	* - the vertices are renumbered in the order the indices first use them, so the vertex fetch
+	*   reads the buffer front to back.
+	*
+	* The vertex cache, overdraw and vertex fetch of the model are measured before and after.
+	* The statistics before are those of the welded meshes in the order they were imported.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class MeshOptimizer
+{
+public:
+		/**
+		* @brief Optimises the meshes of a model
+		*
+		* The meshes may be indexed or unindexed triangle lists, with levels of detail or not.
+		* Fills before and after with the statistics of the model.
+		*
+		* @param std::vector<Mesh>& meshes
+		* @param MeshOptimizerStats& before
+		* @param MeshOptimizerStats& after
+		* @return void
+		*/
+	static void Optimize(std::vector<Mesh>& meshes, MeshOptimizerStats& before, MeshOptimizerStats& after);
+
+		/**
+		* @brief Measures the meshes of a model
+		*
+		* @param std::vector<Mesh>& meshes
+		* @return MeshOptimizerStats
+		*/
+	static MeshOptimizerStats Analyze(std::vector<Mesh>& meshes);
+
+		/**
+		* @brief Welds identical vertices
+		*
+		* Turns an unindexed triangle list into indexed vertices, with the full mesh at the start
+		* of the indices and the levels of detail remapped after it. Indexed meshes are left as
+		* they are.
+		*
+		* @param Mesh& mesh
+		* @return void
+		*/
+	static void IndexMesh(Mesh& mesh);
+
+		/**
+		* @brief Merges meshes with the same material
+		*
+		* Meshes with the same textures and vertex layout are merged into the first of them. Each
+		* level of detail of a merged mesh is the same level of every mesh merged into it, or its
+		* coarsest if it has fewer.
+		*
+		* @param std::vector<Mesh>& meshes
+		* @return void
+		*/
+	static void MergeMeshes(std::vector<Mesh>& meshes);
+
+		/**
+		* @brief Orders triangles for the vertex cache
+		*
+		* @param unsigned int* indices
+		* @param size_t indexCount
+		* @param size_t vertexCount
+		* @return void
+		*/
+	static void OptimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount);
+
+		/**
+		* @brief Orders triangles for overdraw
+		*
+		* The indices must already be ordered for the vertex cache. Clusters are only cut where
+		* their vertex cache miss ratio stays within threshold times that of the triangles they
+		* were cut from.
+		*
+		* @param unsigned int* indices
+		* @param size_t indexCount
+		* @param const std::vector<Vertex3>& vertices
+		* @param float threshold
+		* @return void
+		*/
+	static void OptimizeOverdraw(unsigned int* indices, size_t indexCount, const std::vector<Vertex3>& vertices, float threshold);
+
+		/**
+		* @brief Orders vertices for the vertex fetch
+		*
+		* Renumbers the vertices of an indexed mesh in the order its indices first use them.
+		*
+		* @param Mesh& mesh
+		* @return void
+		*/
+	static void OptimizeVertexFetch(Mesh& mesh);
+
+private:
+		/**
+		* @brief Counts the vertex cache misses of triangles
+		*
+		* Simulates a first in first out post-transform cache.
+		*
+		* @param const unsigned int* indices
+		* @param size_t indexCount
+		* @param size_t vertexCount
+		* @return size_t
+		*/
+	static size_t CountCacheMisses(const unsigned int* indices, size_t indexCount, size_t vertexCount);
+
+		/**
+		* @brief Counts the bytes of vertex data fetched
+		*
+		* Simulates a cache of memory lines in front of the vertex buffer.
+		*
+		* @param const unsigned int* indices
+		* @param size_t indexCount
+		* @param unsigned int stride
+		* @return size_t
+		*/
+	static size_t CountFetchedBytes(const unsigned int* indices, size_t indexCount, unsigned int stride);
+};
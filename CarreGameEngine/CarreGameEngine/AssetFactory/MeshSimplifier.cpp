@@ -0,0 +1,342 @@
+#include "MeshSimplifier.h"
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
+/// Boundary edges weigh this much more than the faces around them
+static const double BOUNDARY_WEIGHT = 10.0;
+
+/// Smallest cosine between a triangle normal before and after a collapse
+static const float MIN_NORMAL_COSINE = 0.2f;
+
+// Orders positions so identical positions can be welded with a map
+struct PositionLess
+{
+	bool operator()(const glm::vec3& a, const glm::vec3& b) const
+	{
+		if (a.x != b.x)
+			return a.x < b.x;
+		if (a.y != b.y)
+			return a.y < b.y;
+		return a.z < b.z;
+	}
+};
+
+void MeshSimplifier::Quadric::AddPlane(const glm::dvec4& plane, double weight)
+{
+	m[0] += weight * plane.x * plane.x;
+	m[1] += weight * plane.x * plane.y;
+	m[2] += weight * plane.x * plane.z;
+	m[3] += weight * plane.x * plane.w;
+	m[4] += weight * plane.y * plane.y;
+	m[5] += weight * plane.y * plane.z;
+	m[6] += weight * plane.y * plane.w;
+	m[7] += weight * plane.z * plane.z;
+	m[8] += weight * plane.z * plane.w;
+	m[9] += weight * plane.w * plane.w;
+}
+
+double MeshSimplifier::Quadric::Evaluate(const glm::vec3& position) const
+{
+	double x = position.x, y = position.y, z = position.z;
+
+	return m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x
+		+ m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y
+		+ m[7] * z * z + 2.0 * m[8] * z
+		+ m[9];
+}
+
+MeshSimplifier::MeshSimplifier(const std::vector<Vertex3>& vertices, const unsigned int* indices, size_t indexCount)
+	: m_vertices(vertices), m_triangleCount(0)
+{
+	// Weld the vertices sharing a position, keeping one original vertex per texture coordinate
+	std::map<glm::vec3, unsigned int, PositionLess> welded;
+	std::vector<unsigned int> weldedIds(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		std::map<glm::vec3, unsigned int, PositionLess>::iterator itr = welded.find(vertices[i].m_position);
+		unsigned int id;
+		if (itr == welded.end())
+		{
+			id = (unsigned int)m_positions.size();
+			welded[vertices[i].m_position] = id;
+			m_positions.push_back(vertices[i].m_position);
+			m_variants.push_back(std::vector<unsigned int>());
+		}
+		else
+			id = itr->second;
+
+		weldedIds[i] = id;
+
+		std::vector<unsigned int>& variants = m_variants[id];
+		bool found = false;
+		for (size_t j = 0; j < variants.size() && !found; j++)
+			found = vertices[variants[j]].m_texCoords == vertices[i].m_texCoords;
+		if (!found)
+			variants.push_back((unsigned int)i);
+	}
+
+	m_quadrics.resize(m_positions.size());
+	m_vertexTriangles.resize(m_positions.size());
+	m_versions.assign(m_positions.size(), 0);
+	m_removed.assign(m_positions.size(), 0);
+
+	// Edges used by a single triangle are on the boundary
+	std::map<std::pair<unsigned int, unsigned int>, int> edgeUses;
+
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		Triangle triangle;
+		triangle.removed = false;
+		for (int j = 0; j < 3; j++)
+		{
+			triangle.vertices[j] = weldedIds[indices[i + j]];
+			triangle.corners[j] = indices[i + j];
+		}
+
+		// Triangles collapsed by welding are dropped
+		if (triangle.vertices[0] == triangle.vertices[1] || triangle.vertices[1] == triangle.vertices[2]
+			|| triangle.vertices[0] == triangle.vertices[2])
+			continue;
+
+		unsigned int index = (unsigned int)m_triangles.size();
+		m_triangles.push_back(triangle);
+
+		for (int j = 0; j < 3; j++)
+		{
+			m_vertexTriangles[triangle.vertices[j]].push_back(index);
+
+			unsigned int a = triangle.vertices[j], b = triangle.vertices[(j + 1) % 3];
+			edgeUses[std::make_pair(std::min(a, b), std::max(a, b))]++;
+		}
+
+		// Plane quadric weighted by area, so large faces keep their shape
+		glm::vec3 p0 = m_positions[triangle.vertices[0]];
+		glm::vec3 normal = glm::cross(m_positions[triangle.vertices[1]] - p0, m_positions[triangle.vertices[2]] - p0);
+		float length = glm::length(normal);
+		if (length <= 0.0f)
+			continue;
+
+		normal /= length;
+		glm::dvec4 plane(normal.x, normal.y, normal.z, -glm::dot(normal, p0));
+		for (int j = 0; j < 3; j++)
+			m_quadrics[triangle.vertices[j]].AddPlane(plane, length * 0.5);
+	}
+	m_triangleCount = m_triangles.size();
+
+	// A plane through each boundary edge, perpendicular to its triangle, holds the outline in place
+	for (size_t i = 0; i < m_triangles.size(); i++)
+	{
+		const Triangle& triangle = m_triangles[i];
+		glm::vec3 p0 = m_positions[triangle.vertices[0]];
+		glm::vec3 faceNormal = glm::cross(m_positions[triangle.vertices[1]] - p0, m_positions[triangle.vertices[2]] - p0);
+
+		for (int j = 0; j < 3; j++)
+		{
+			unsigned int a = triangle.vertices[j], b = triangle.vertices[(j + 1) % 3];
+			if (edgeUses[std::make_pair(std::min(a, b), std::max(a, b))] != 1)
+				continue;
+
+			glm::vec3 edge = m_positions[b] - m_positions[a];
+			glm::vec3 normal = glm::cross(edge, faceNormal);
+			float length = glm::length(normal);
+			if (length <= 0.0f)
+				continue;
+
+			normal /= length;
+			glm::dvec4 plane(normal.x, normal.y, normal.z, -glm::dot(normal, m_positions[a]));
+			double weight = BOUNDARY_WEIGHT * glm::dot(edge, edge);
+			m_quadrics[a].AddPlane(plane, weight);
+			m_quadrics[b].AddPlane(plane, weight);
+		}
+	}
+
+	for (std::map<std::pair<unsigned int, unsigned int>, int>::iterator itr = edgeUses.begin(); itr != edgeUses.end(); itr++)
+		QueueEdge(itr->first.first, itr->first.second);
+}
+
+void MeshSimplifier::Simplify(size_t targetTriangles)
+{
+	while (m_triangleCount > targetTriangles && !m_collapses.empty())
+	{
+		Collapse collapse = m_collapses.top();
+		m_collapses.pop();
+
+		if (m_removed[collapse.from] || m_removed[collapse.to] || m_versions[collapse.from] != collapse.fromVersion
+			|| m_versions[collapse.to] != collapse.toVersion)
+			continue;
+
+		if (!IsCollapseValid(collapse.from, collapse.to))
+			continue;
+
+		CollapseEdge(collapse.from, collapse.to);
+	}
+}
+
+void MeshSimplifier::GetIndices(std::vector<unsigned int>& indices) const
+{
+	indices.clear();
+	indices.reserve(m_triangleCount * 3);
+
+	for (size_t i = 0; i < m_triangles.size(); i++)
+	{
+		const Triangle& triangle = m_triangles[i];
+		if (triangle.removed)
+			continue;
+
+		for (int j = 0; j < 3; j++)
+		{
+			// A moved corner keeps the texture coordinate closest to the one it had
+			const std::vector<unsigned int>& variants = m_variants[triangle.vertices[j]];
+			const glm::vec2& texCoords = m_vertices[triangle.corners[j]].m_texCoords;
+
+			unsigned int best = variants[0];
+			float bestDistance = glm::dot(m_vertices[best].m_texCoords - texCoords, m_vertices[best].m_texCoords - texCoords);
+			for (size_t k = 1; k < variants.size(); k++)
+			{
+				glm::vec2 offset = m_vertices[variants[k]].m_texCoords - texCoords;
+				float distance = glm::dot(offset, offset);
+				if (distance < bestDistance)
+				{
+					best = variants[k];
+					bestDistance = distance;
+				}
+			}
+
+			indices.push_back(best);
+		}
+	}
+}
+
+void MeshSimplifier::QueueEdge(unsigned int a, unsigned int b)
+{
+	Quadric quadric = m_quadrics[a];
+	quadric.Add(m_quadrics[b]);
+
+	double costToA = quadric.Evaluate(m_positions[a]);
+	double costToB = quadric.Evaluate(m_positions[b]);
+
+	Collapse collapse;
+	collapse.cost = std::min(costToA, costToB);
+	collapse.from = costToB <= costToA ? a : b;
+	collapse.to = costToB <= costToA ? b : a;
+	collapse.fromVersion = m_versions[collapse.from];
+	collapse.toVersion = m_versions[collapse.to];
+	m_collapses.push(collapse);
+}
+
+bool MeshSimplifier::IsCollapseValid(unsigned int from, unsigned int to) const
+{
+	// An edge has at most two triangles, so its ends may only share the two vertices opposite it
+	std::vector<unsigned int> fromNeighbours, toNeighbours;
+	for (size_t i = 0; i < m_vertexTriangles[from].size(); i++)
+	{
+		const Triangle& triangle = m_triangles[m_vertexTriangles[from][i]];
+		for (int j = 0; j < 3; j++)
+		{
+			if (triangle.vertices[j] != from)
+				fromNeighbours.push_back(triangle.vertices[j]);
+		}
+	}
+	for (size_t i = 0; i < m_vertexTriangles[to].size(); i++)
+	{
+		const Triangle& triangle = m_triangles[m_vertexTriangles[to][i]];
+		for (int j = 0; j < 3; j++)
+		{
+			if (triangle.vertices[j] != to)
+				toNeighbours.push_back(triangle.vertices[j]);
+		}
+	}
+	std::sort(fromNeighbours.begin(), fromNeighbours.end());
+	fromNeighbours.erase(std::unique(fromNeighbours.begin(), fromNeighbours.end()), fromNeighbours.end());
+	std::sort(toNeighbours.begin(), toNeighbours.end());
+	toNeighbours.erase(std::unique(toNeighbours.begin(), toNeighbours.end()), toNeighbours.end());
+
+	std::vector<unsigned int> shared;
+	std::set_intersection(fromNeighbours.begin(), fromNeighbours.end(), toNeighbours.begin(), toNeighbours.end(),
+		std::back_inserter(shared));
+	if (shared.size() > 2)
+		return false;
+
+	// Triangles that are kept must not flip over or become slivers
+	for (size_t i = 0; i < m_vertexTriangles[from].size(); i++)
+	{
+		const Triangle& triangle = m_triangles[m_vertexTriangles[from][i]];
+		if (triangle.vertices[0] == to || triangle.vertices[1] == to || triangle.vertices[2] == to)
+			continue;
+
+		glm::vec3 before[3], after[3];
+		for (int j = 0; j < 3; j++)
+		{
+			before[j] = m_positions[triangle.vertices[j]];
+			after[j] = triangle.vertices[j] == from ? m_positions[to] : before[j];
+		}
+
+		glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+		glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+		float lengthBefore = glm::length(normalBefore);
+		float lengthAfter = glm::length(normalAfter);
+		if (lengthAfter <= 0.0f)
+			return false;
+		if (lengthBefore > 0.0f && glm::dot(normalBefore, normalAfter) < MIN_NORMAL_COSINE * lengthBefore * lengthAfter)
+			return false;
+	}
+
+	return true;
+}
+
+void MeshSimplifier::CollapseEdge(unsigned int from, unsigned int to)
+{
+	std::vector<unsigned int>& toTriangles = m_vertexTriangles[to];
+
+	for (size_t i = 0; i < m_vertexTriangles[from].size(); i++)
+	{
+		unsigned int index = m_vertexTriangles[from][i];
+		Triangle& triangle = m_triangles[index];
+		if (triangle.removed)
+			continue;
+
+		bool hasTo = triangle.vertices[0] == to || triangle.vertices[1] == to || triangle.vertices[2] == to;
+		if (hasTo)
+		{
+			// Triangles on the collapsed edge disappear
+			triangle.removed = true;
+			m_triangleCount--;
+
+			for (int j = 0; j < 3; j++)
+			{
+				unsigned int vertex = triangle.vertices[j];
+				if (vertex == from)
+					continue;
+
+				std::vector<unsigned int>& triangles = m_vertexTriangles[vertex];
+				triangles.erase(std::remove(triangles.begin(), triangles.end(), index), triangles.end());
+			}
+		}
+		else
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				if (triangle.vertices[j] == from)
+					triangle.vertices[j] = to;
+			}
+			toTriangles.push_back(index);
+		}
+	}
+
+	m_vertexTriangles[from].clear();
+	m_removed[from] = 1;
+	m_quadrics[to].Add(m_quadrics[from]);
+	m_versions[to]++;
+
+	// Every edge of the moved vertex has a new cost
+	for (size_t i = 0; i < toTriangles.size(); i++)
+	{
+		const Triangle& triangle = m_triangles[toTriangles[i]];
+		for (int j = 0; j < 3; j++)
+		{
+			if (triangle.vertices[j] != to)
+				QueueEdge(to, triangle.vertices[j]);
+		}
+	}
+}
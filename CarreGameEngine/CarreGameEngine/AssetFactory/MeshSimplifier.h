@@ -0,0 +1,200 @@
+#pragma once
+
+#include <vector>
+#include <queue>
+#include <map>
+#include <functional>
+#include <GLM\glm.hpp>
+
+#include "..\Common\Vertex3.h"
+
+	/**
+	* @class MeshSimplifier
+	* @brief Reduces the triangle count of a mesh by quadric error edge collapses
+	*
+	* Vertices with the same position are welded, then the edge whose removal changes the surface
+	* least, measured by the sum of squared distances to the planes of the triangles around it,
+	* is collapsed until the target triangle count is reached. Edges are collapsed onto one of
+	* their end points, so every simplified triangle still uses vertices of the original mesh and
+	* the result is an index list into the original vertex buffer.
+	*
+	* Collapses that would fold a triangle over or pinch the surface are skipped, and edges on the
+	* boundary of an open mesh are weighted so the outline keeps its shape.
+	*
+	* Simplify() can be called with smaller and smaller targets to build a chain of detail levels
+	* from a single simplifier.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class MeshSimplifier
+{
+public:
+		/**
+		* @brief Constructor
+		*
+		* Welds the vertices of an indexed triangle list by position and computes the error
+		* quadric of every vertex. The vertices must outlive the simplifier, the indices are only
+		* read here.
+		*
+		* @param const std::vector<Vertex3>& vertices
+		* @param const unsigned int* indices
+		* @param size_t indexCount
+		* @return null
+		*/
+	MeshSimplifier(const std::vector<Vertex3>& vertices, const unsigned int* indices, size_t indexCount);
+
+		/**
+		* @brief Destructor
+		*
+		* Empty destructor.
+		*
+		* @return null
+		*/
+	~MeshSimplifier() { }
+
+		/**
+		* @brief Simplifies the mesh
+		*
+		* Collapses edges until at most targetTriangles triangles are left, or no edge can be
+		* collapsed without damaging the mesh.
+		*
+		* @param size_t targetTriangles
+		* @return void
+		*/
+	void Simplify(size_t targetTriangles);
+
+		/**
+		* @brief Gets the simplified triangles
+		*
+		* Fills indices with three indices into the original vertices for every triangle left.
+		* Each corner uses the original vertex at its position with the closest texture coordinate.
+		*
+		* @param std::vector<unsigned int>& indices
+		* @return void
+		*/
+	void GetIndices(std::vector<unsigned int>& indices) const;
+
+		/**
+		* @brief Gets the triangle count
+		*
+		* @return size_t
+		*/
+	size_t GetTriangleCount() const { return m_triangleCount; }
+
+private:
+		/**
+		* @struct Quadric
+		* @brief Symmetric 4x4 error matrix, the sum of the squared distances to a set of planes
+		*/
+	struct Quadric
+	{
+		double m[10];
+
+		Quadric() { for (int i = 0; i < 10; i++) m[i] = 0.0; }
+
+			/**
+			* @brief Adds the quadric of the plane ax + by + cz + d = 0
+			*
+			* @param const glm::dvec4& plane
+			* @param double weight
+			* @return void
+			*/
+		void AddPlane(const glm::dvec4& plane, double weight);
+
+			/**
+			* @brief Adds another quadric
+			*
+			* @param const Quadric& other
+			* @return void
+			*/
+		void Add(const Quadric& other) { for (int i = 0; i < 10; i++) m[i] += other.m[i]; }
+
+			/**
+			* @brief Gets the error of a position
+			*
+			* @param const glm::vec3& position
+			* @return double
+			*/
+		double Evaluate(const glm::vec3& position) const;
+	};
+
+		/**
+		* @struct Triangle
+		* @brief A triangle of welded vertices and the original vertices of its corners
+		*/
+	struct Triangle
+	{
+		unsigned int vertices[3];
+		unsigned int corners[3];
+		bool removed;
+	};
+
+		/**
+		* @struct Collapse
+		* @brief A candidate edge collapse, valid while neither vertex has changed since it was queued
+		*/
+	struct Collapse
+	{
+		double cost;
+		unsigned int from, to;
+		unsigned int fromVersion, toVersion;
+
+		bool operator>(const Collapse& other) const { return cost > other.cost; }
+	};
+
+		/**
+		* @brief Queues the cheaper direction of collapsing an edge
+		*
+		* @param unsigned int a
+		* @param unsigned int b
+		* @return void
+		*/
+	void QueueEdge(unsigned int a, unsigned int b);
+
+		/**
+		* @brief Checks if a collapse keeps the mesh intact
+		*
+		* Returns false if moving from onto to would flip or flatten a triangle, or join two
+		* surfaces that only share the edge.
+		*
+		* @param unsigned int from
+		* @param unsigned int to
+		* @return bool
+		*/
+	bool IsCollapseValid(unsigned int from, unsigned int to) const;
+
+		/**
+		* @brief Collapses an edge
+		*
+		* Moves every triangle of from onto to and removes the triangles that used both.
+		*
+		* @param unsigned int from
+		* @param unsigned int to
+		* @return void
+		*/
+	void CollapseEdge(unsigned int from, unsigned int to);
+
+	/// Original unindexed vertices
+	const std::vector<Vertex3>& m_vertices;
+
+	/// Position, error quadric and triangles of each welded vertex
+	std::vector<glm::vec3> m_positions;
+	std::vector<Quadric> m_quadrics;
+	std::vector<std::vector<unsigned int>> m_vertexTriangles;
+
+	/// Original vertices with distinct texture coordinates at each welded vertex
+	std::vector<std::vector<unsigned int>> m_variants;
+
+	/// Incremented when a vertex changes, so queued collapses using it are skipped
+	std::vector<unsigned int> m_versions;
+	std::vector<char> m_removed;
+
+	std::vector<Triangle> m_triangles;
+
+	/// Triangles not yet removed
+	size_t m_triangleCount;
+
+	/// Candidate collapses, cheapest first
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_collapses;
+};
@@ -2,41 +2,609 @@
 
 //#include "..\ImageDB\stb_image.h"
 
-unsigned int TextureFromFile(const char* path, const std::string& directory);
+TextureHandle TextureFromFile(const char* path, const std::string& directory);
+
+/// Fractions of the full triangle count each level of detail is simplified to
+static const float LOD_FRACTIONS[] = { 0.5f, 0.25f, 0.1f };
+
+/// Meshes smaller than this are cheap enough to always draw in full
+static const size_t MIN_LOD_TRIANGLES = 64;
+
+/// Frames per second keyframe animations play at, the rate MD2 animations were made for
+static const float DEFAULT_FRAMES_PER_SECOND = 9.0f;
+
+/// Samples per second skeletal clips are resampled at when they are imported
+static const float SKELETAL_SAMPLE_RATE = 30.0f;
+
+/// Ticks per second of animations that do not give their own rate
+static const double DEFAULT_TICKS_PER_SECOND = 25.0;
+
+// Simplified copies of the imported meshes for drawing them far away
+static void GenerateMeshLods(std::vector<Mesh>& meshes)
+{
+	std::vector<float> fractions(LOD_FRACTIONS, LOD_FRACTIONS + sizeof(LOD_FRACTIONS) / sizeof(LOD_FRACTIONS[0]));
+	for (size_t i = 0; i < meshes.size(); i++)
+		meshes[i].GenerateLods(fractions, MIN_LOD_TRIANGLES);
+}
+
+/// Bones a vertex is weighted to, the strongest are kept
+static const int BONES_PER_VERTEX = 4;
+
+/// Bones a skeleton can have, vertices store 8 bit bone indices
+static const int MAX_SKIN_BONES = 256;
+
+/// Joints of the skeleton generated by the skeleton benchmark, about a game character
+static const int BENCHMARK_JOINTS = 64;
+
+/// Skeletons posed by one job, enough work to be worth a job of its own
+static const int SKELETONS_PER_JOB = 16;
+
+/// Assimp post processing of every model, part of the model cache key
+static const unsigned int IMPORT_FLAGS = aiProcess_FlipUVs
+	| aiProcess_CalcTangentSpace
+	| aiProcess_Triangulate
+	| aiProcess_JoinIdenticalVertices
+	| aiProcess_SortByPType;
 
 Model::Model()
 {
-	SetScale(glm::vec3(1.0, 1.0, 1.0));
-	m_shader = new Shader();
+	m_shader = NULL;
 	m_compAI = NULL;
+	m_boundsMin = glm::vec3(0.0f);
+	m_boundsMax = glm::vec3(0.0f);
+	m_lodLevel = 0;
+	m_resident = true;
+	m_playback.clip = 0;
+	m_playback.time = 0.0f;
+	m_playback.framesPerSecond = DEFAULT_FRAMES_PER_SECOND;
+
+	// Skinned models play their first clip until told otherwise
+	m_skeletalPlayback.clip = 0;
+	m_skeletalPlayback.time = 0.0f;
+	m_skeletalPlayback.previousClip = -1;
+	m_skeletalPlayback.previousTime = 0.0f;
+	m_skeletalPlayback.fade = 0.0f;
+	m_skeletalPlayback.fadeDuration = 0.0f;
+	m_skeletalPlayback.speed = 1.0f;
+
+	// Models built in code fill a resource of their own
+	m_resource = ModelCache::Instance().Create();
 }
 
 void Model::LoadModel(std::string filePath)
 {
-	Assimp::Importer import;
-	const aiScene *scene = import.ReadFile(filePath, aiProcess_FlipUVs 
-		| aiProcess_CalcTangentSpace
-		| aiProcess_Triangulate 
-		| aiProcess_JoinIdenticalVertices 
-		| aiProcess_SortByPType);
+	LoadMeshes(filePath);
+	LoadTextures();
+}
+
+void Model::LoadMeshes(const std::string& filePath)
+{
+	TimelineScope scope("Load " + filePath);
+
+	ModelCache::Instance().Release(m_resource);
+
+	m_resource = ModelCache::Instance().Acquire(filePath + "|" + std::to_string(IMPORT_FLAGS), [this, &filePath](ModelResource* resource)
+	{
+		m_resource = resource;
+		resource->directory = filePath.substr(0, filePath.find_last_of('/'));
+
+		// Assimp only reads the first frame of vertex animated models
+		if (MD2Loader::IsMD2File(filePath))
+		{
+			MD2Loader::Load(filePath, *resource);
+			return;
+		}
+
+		// A cooked copy of the model is mapped instead of importing it again
+		uint64_t sourceHash;
+		if (MeshCooker::Instance().Load(filePath, IMPORT_FLAGS, resource, sourceHash))
+			return;
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+		Assimp::Importer import;
+		const aiScene *scene = import.ReadFile(filePath, IMPORT_FLAGS);
+
+		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+		{
+			std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
+			return;
+		}
+
+		resource->meshes.reserve(scene->mNumMeshes);
+		ProcessSkeleton(scene);
+		ProcessNode(scene->mRootNode, scene);
+		GenerateMeshLods(resource->meshes);
+
+		resource->boundsMin = m_boundsMin;
+		resource->boundsMax = m_boundsMax;
+		resource->xDim = m_Xdim;
+		resource->yDim = m_Ydim;
+		resource->zDim = m_Zdim;
+
+		std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+		MeshCooker::Instance().RecordImport(elapsed.count());
+
+		// Optimised once here, the cooked copy is mapped already optimised
+		start = std::chrono::high_resolution_clock::now();
+		MeshOptimizerStats before, after;
+		MeshOptimizer::Optimize(resource->meshes, before, after);
+		std::chrono::duration<double, std::milli> optimiseMs = std::chrono::high_resolution_clock::now() - start;
+
+		std::cout << "Optimised meshes of " << filePath << " in " << optimiseMs.count() << " ms: "
+			<< before.meshes << " -> " << after.meshes << " meshes, "
+			<< before.vertices << " -> " << after.vertices << " vertices, "
+			<< "ACMR " << before.acmr << " -> " << after.acmr << ", "
+			<< "overdraw " << before.overdraw << " -> " << after.overdraw << ", "
+			<< "overfetch " << before.overfetch << " -> " << after.overfetch << std::endl;
+
+		// The cooked format has no skeleton, skinned models are imported every time
+		if (resource->skeleton)
+		{
+			const Skeleton* skeleton = resource->skeleton;
+			std::cout << "Skeleton of " << filePath << ": " << skeleton->GetJointCount() << " joints, "
+				<< skeleton->GetBoneCount() << " bones, " << skeleton->GetClipCount() << " clips, "
+				<< skeleton->GetClipBytes() / 1024 << " KB of keys (" << skeleton->GetUncompressedClipBytes() / 1024 << " KB as floats)" << std::endl;
+		}
+		else
+		{
+			MeshCooker::Instance().Save(filePath, sourceHash, *resource);
+		}
+	});
+
+	// Models sharing the file start from the dimensions it was loaded with
+	m_boundsMin = m_resource->boundsMin;
+	m_boundsMax = m_resource->boundsMax;
+	m_Xdim = m_resource->xDim;
+	m_Ydim = m_resource->yDim;
+	m_Zdim = m_resource->zDim;
+	m_firstVertex = false;
+}
+
+bool Model::PlayAnimation(const std::string& clipName, float framesPerSecond, float startTime)
+{
+	KeyframeSet* keyframes = GetKeyframes();
+	if (!keyframes)
+		return false;
+
+	int clip = keyframes->FindClip(clipName);
+	if (clip < 0)
+	{
+		std::cout << "Model has no animation named " << clipName << std::endl;
+		return false;
+	}
+
+	m_playback.clip = clip;
+	m_playback.time = 0.0f;
+	m_playback.framesPerSecond = framesPerSecond;
+	keyframes->Advance(m_playback, startTime);
+
+	return true;
+}
+
+void Model::UpdateAnimation(float seconds)
+{
+	KeyframeSet* keyframes = GetKeyframes();
+	if (keyframes)
+		keyframes->Advance(m_playback, seconds);
+}
+
+bool Model::PlaySkeletalAnimation(const std::string& clipName, float fadeSeconds)
+{
+	const Skeleton* skeleton = GetSkeleton();
+	if (!skeleton)
+		return false;
+
+	int clip = skeleton->FindClip(clipName);
+	if (clip < 0)
+	{
+		std::cout << "Model has no skeletal animation named " << clipName << std::endl;
+		return false;
+	}
+
+	skeleton->Play(m_skeletalPlayback, clip, fadeSeconds);
+
+	return true;
+}
+
+void Model::UpdateSkeleton(float seconds)
+{
+	const Skeleton* skeleton = GetSkeleton();
+	if (!skeleton)
+		return;
+
+	skeleton->Advance(m_skeletalPlayback, seconds);
+	skeleton->Pose(m_skeletalPlayback, m_pose);
+}
+
+bool Model::LoadBounds(const std::string& filePath)
+{
+	ModelResource bounds;
+	if (!MeshCooker::Instance().LoadBounds(filePath, bounds))
+		return false;
+
+	m_boundsMin = bounds.boundsMin;
+	m_boundsMax = bounds.boundsMax;
+	m_Xdim = bounds.xDim;
+	m_Ydim = bounds.yDim;
+	m_Zdim = bounds.zDim;
+	m_firstVertex = false;
+
+	return true;
+}
+
+void Model::LoadTextures()
+{
+	// Models sharing the resource find the textures already loaded by the first one
+	for (size_t i = 0; i < m_resource->meshes.size(); i++)
+	{
+		std::vector<Texture>& textures = m_resource->meshes[i].GetTextures();
+		for (size_t j = 0; j < textures.size(); j++)
+		{
+			if (textures[j].m_handle == 0)
+				textures[j] = LoadTexture(textures[j].m_path, textures[j].m_type);
+		}
+	}
+}
+
+int Model::BenchmarkImport(const std::string& filePath, int runs)
+{
+	double bestImportMs = 0.0, totalImportMs = 0.0;
+	double bestProcessMs = 0.0, totalProcessMs = 0.0;
+	double bestLodMs = 0.0, totalLodMs = 0.0;
+	AllocationStats allocations = { 0, 0 }, lodAllocations = { 0, 0 };
+	size_t vertexCount = 0;
+
+	for (int run = 0; run < runs; run++)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+		Assimp::Importer import;
+		const aiScene *scene = import.ReadFile(filePath, IMPORT_FLAGS);
+		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+		{
+			std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
+			return 1;
+		}
 
-	m_directory = filePath.substr(0, filePath.find_last_of('/'));
+		std::chrono::high_resolution_clock::time_point imported = std::chrono::high_resolution_clock::now();
+
+		// Processed the same way LoadMeshes() does, into a resource of its own
+		Model model;
+		AllocationStats before = GetAllocationStats();
+		model.m_resource->meshes.reserve(scene->mNumMeshes);
+		model.ProcessSkeleton(scene);
+		model.ProcessNode(scene->mRootNode, scene);
+		AllocationStats after = GetAllocationStats();
+
+		std::chrono::high_resolution_clock::time_point processed = std::chrono::high_resolution_clock::now();
+
+		// Timed and counted on their own, the simplifier allocates as it goes
+		AllocationStats beforeLods = GetAllocationStats();
+		GenerateMeshLods(model.m_resource->meshes);
+		AllocationStats afterLods = GetAllocationStats();
+
+		std::chrono::high_resolution_clock::time_point simplified = std::chrono::high_resolution_clock::now();
+
+		std::chrono::duration<double, std::milli> importMs = imported - start;
+		std::chrono::duration<double, std::milli> processMs = processed - imported;
+		std::chrono::duration<double, std::milli> lodMs = simplified - processed;
+		if (run == 0 || importMs.count() < bestImportMs)
+			bestImportMs = importMs.count();
+		if (run == 0 || processMs.count() < bestProcessMs)
+			bestProcessMs = processMs.count();
+		if (run == 0 || lodMs.count() < bestLodMs)
+			bestLodMs = lodMs.count();
+		totalImportMs += importMs.count();
+		totalProcessMs += processMs.count();
+		totalLodMs += lodMs.count();
+
+		// Every run makes the same allocations
+		allocations.count = after.count - before.count;
+		allocations.bytes = after.bytes - before.bytes;
+		lodAllocations.count = afterLods.count - beforeLods.count;
+		lodAllocations.bytes = afterLods.bytes - beforeLods.bytes;
+
+		vertexCount = 0;
+		for (size_t i = 0; i < model.m_resource->meshes.size(); i++)
+			vertexCount += model.m_resource->meshes[i].GetVertexCount();
+
+		model.Destroy();
+	}
 
-	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	std::cout << "Import benchmark: " << filePath << ", " << runs << " runs, " << vertexCount << " vertices" << std::endl;
+	std::cout << "  Assimp: " << bestImportMs << " ms best, " << totalImportMs / std::max(runs, 1) << " ms average" << std::endl;
+	std::cout << "  ProcessNode: " << bestProcessMs << " ms best, " << totalProcessMs / std::max(runs, 1) << " ms average" << std::endl;
+	std::cout << "  Levels of detail: " << bestLodMs << " ms best, " << totalLodMs / std::max(runs, 1) << " ms average" << std::endl;
+	if (IsCountingAllocations())
 	{
-		std::cout << "ERROR::ASSIMP::" << import.GetErrorString() << std::endl;
+		std::cout << "  ProcessNode allocations: " << allocations.count << " (" << allocations.bytes / 1024 << " KB)" << std::endl;
+		std::cout << "  Level of detail allocations: " << lodAllocations.count << " (" << lodAllocations.bytes / 1024 << " KB)" << std::endl;
 	}
 	else
-		ProcessNode(scene->mRootNode, scene);
+		std::cout << "  Allocations are only counted in builds with CARRE_COUNT_ALLOCATIONS defined" << std::endl;
+
+	return 0;
+}
+
+// Generates the skeleton of the skeleton benchmark, a binary tree of joints each a step above
+// its parent, with a slow and a fast clip swinging every joint and bobbing the root
+static Skeleton* CreateBenchmarkSkeleton()
+{
+	Skeleton* skeleton = new Skeleton();
+	std::vector<JointPose> bindPose(BENCHMARK_JOINTS);
+	for (int i = 0; i < BENCHMARK_JOINTS; i++)
+	{
+		bindPose[i].translation = i == 0 ? glm::vec3(0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		bindPose[i].rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		bindPose[i].scale = glm::vec3(1.0f);
+		skeleton->AddJoint("joint" + std::to_string(i), i == 0 ? -1 : (i - 1) / 2, bindPose[i]);
+	}
+
+	// Every joint is a bone, its offset undoes the bind pose
+	std::vector<glm::mat4> world, palette;
+	skeleton->ComputePalette(bindPose, world, palette);
+	for (int i = 0; i < BENCHMARK_JOINTS; i++)
+		skeleton->AddBone(i, glm::inverse(world[i]));
+
+	static const char* CLIP_NAMES[] = { "walk", "run" };
+	static const float CLIP_SECONDS[] = { 1.2f, 0.7f };
+	for (int c = 0; c < 2; c++)
+	{
+		SkeletalClip clip(CLIP_NAMES[c], CLIP_SECONDS[c], SKELETAL_SAMPLE_RATE);
+		std::vector<JointPose> samples(clip.GetSampleCount());
+		for (int i = 0; i < BENCHMARK_JOINTS; i++)
+		{
+			glm::vec3 axis = glm::normalize(glm::vec3(1.0f, 0.0f, (float)(i % 3)));
+			for (int k = 0; k < clip.GetSampleCount(); k++)
+			{
+				float phase = 6.2831853f * k / (clip.GetSampleCount() - 1) + i * 0.3f;
+				samples[k] = bindPose[i];
+				float angle = 0.5f * std::sin(phase);
+				samples[k].rotation = glm::quat(std::cos(angle * 0.5f), axis * std::sin(angle * 0.5f));
+				if (i == 0)
+					samples[k].translation.y = 0.1f * std::sin(2.0f * phase);
+			}
+			clip.AddJoint(i, samples);
+		}
+		skeleton->AddClip(clip);
+	}
+
+	return skeleton;
+}
+
+int Model::BenchmarkSkeletons(const std::string& filePath, int count, int runs)
+{
+	count = std::max(count, 1);
+	runs = std::max(runs, 1);
+
+	Model model;
+	Skeleton* generated = NULL;
+	const Skeleton* skeleton = NULL;
+	if (filePath.empty())
+	{
+		generated = CreateBenchmarkSkeleton();
+		skeleton = generated;
+	}
+	else
+	{
+		model.LoadMeshes(filePath);
+		skeleton = model.GetSkeleton();
+		if (!skeleton || skeleton->GetClipCount() == 0)
+		{
+			std::cout << filePath << " has no skeletal animations" << std::endl;
+			return 1;
+		}
+	}
+
+	// Every skeleton at a time of its own, every second one fading into the next clip
+	int clips = skeleton->GetClipCount();
+	std::vector<SkeletalPlayback> playbacks(count);
+	std::vector<SkeletalPose> poses(count);
+	for (int i = 0; i < count; i++)
+	{
+		SkeletalPlayback& playback = playbacks[i];
+		playback.clip = i % clips;
+		playback.time = 0.0f;
+		playback.previousClip = -1;
+		playback.previousTime = 0.0f;
+		playback.fade = playback.fadeDuration = 0.0f;
+		playback.speed = 1.0f;
+		skeleton->Advance(playback, i * 0.037f);
+
+		if (i % 2 == 1)
+		{
+			skeleton->Play(playback, (i + 1) % clips, 0.25f);
+			skeleton->Advance(playback, 0.1f);
+		}
+	}
+
+	double bestMainMs = 0.0;
+	for (int run = 0; run < runs; run++)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < count; i++)
+			skeleton->Pose(playbacks[i], poses[i]);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+		if (run == 0 || elapsed.count() < bestMainMs)
+			bestMainMs = elapsed.count();
+	}
+
+	double bestWorkerMs = 0.0;
+	for (int run = 0; run < runs; run++)
+	{
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		JobCounter posed;
+		for (int first = 0; first < count; first += SKELETONS_PER_JOB)
+		{
+			int last = std::min(first + SKELETONS_PER_JOB, count);
+			JobSystem::Instance().Submit([skeleton, &playbacks, &poses, first, last]()
+			{
+				for (int i = first; i < last; i++)
+					skeleton->Pose(playbacks[i], poses[i]);
+			}, &posed);
+		}
+		JobSystem::Instance().Wait(posed);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+		if (run == 0 || elapsed.count() < bestWorkerMs)
+			bestWorkerMs = elapsed.count();
+	}
+
+	std::cout << "Skeleton benchmark: " << (filePath.empty() ? "generated skeleton" : filePath) << ", " << count << " skeletons, " << runs << " runs" << std::endl;
+	std::cout << "  " << skeleton->GetJointCount() << " joints, " << skeleton->GetBoneCount() << " bones, " << clips << " clips" << std::endl;
+	std::cout << "  Clips: " << skeleton->GetClipBytes() << " bytes quantized, " << skeleton->GetUncompressedClipBytes() << " bytes as floats" << std::endl;
+	std::cout << "  Main thread: " << bestMainMs << " ms, " << count / std::max(bestMainMs, 1e-6) << " skeletons per ms" << std::endl;
+	std::cout << "  " << JobSystem::Instance().GetWorkerCount() << " workers: " << bestWorkerMs << " ms, " << count / std::max(bestWorkerMs, 1e-6) << " skeletons per ms" << std::endl;
+
+	delete generated;
+
+	return 0;
+}
+
+// Converts an Assimp matrix, which is row major
+static glm::mat4 ToGlm(const aiMatrix4x4& m)
+{
+	return glm::mat4(m.a1, m.b1, m.c1, m.d1,
+		m.a2, m.b2, m.c2, m.d2,
+		m.a3, m.b3, m.c3, m.d3,
+		m.a4, m.b4, m.c4, m.d4);
+}
+
+// Adds a node and every node below it to the skeleton, parents first
+static void AddJoints(const aiNode* node, int parent, Skeleton& skeleton)
+{
+	aiVector3D scaling, position;
+	aiQuaternion rotation;
+	node->mTransformation.Decompose(scaling, rotation, position);
+
+	JointPose bindPose;
+	bindPose.translation = glm::vec3(position.x, position.y, position.z);
+	bindPose.rotation = glm::quat(rotation.w, rotation.x, rotation.y, rotation.z);
+	bindPose.scale = glm::vec3(scaling.x, scaling.y, scaling.z);
+
+	int joint = skeleton.AddJoint(node->mName.C_Str(), parent, bindPose);
+	for (unsigned int i = 0; i < node->mNumChildren; i++)
+		AddJoints(node->mChildren[i], joint, skeleton);
+}
+
+// Interpolates translation or scale keys, searching on from cursor as the times only increase
+static glm::vec3 SampleVectorKeys(const aiVectorKey* keys, unsigned int count, double time, unsigned int& cursor, const glm::vec3& fallback)
+{
+	if (count == 0)
+		return fallback;
+
+	while (cursor + 1 < count && keys[cursor + 1].mTime <= time)
+		cursor++;
+
+	const aiVector3D& from = keys[cursor].mValue;
+	if (cursor + 1 >= count || time <= keys[cursor].mTime)
+		return glm::vec3(from.x, from.y, from.z);
+
+	const aiVector3D& to = keys[cursor + 1].mValue;
+	float blend = (float)((time - keys[cursor].mTime) / (keys[cursor + 1].mTime - keys[cursor].mTime));
+	return glm::mix(glm::vec3(from.x, from.y, from.z), glm::vec3(to.x, to.y, to.z), blend);
+}
+
+// Interpolates rotation keys, searching on from cursor as the times only increase
+static glm::quat SampleRotationKeys(const aiQuatKey* keys, unsigned int count, double time, unsigned int& cursor, const glm::quat& fallback)
+{
+	if (count == 0)
+		return fallback;
+
+	while (cursor + 1 < count && keys[cursor + 1].mTime <= time)
+		cursor++;
+
+	aiQuaternion rotation = keys[cursor].mValue;
+	if (cursor + 1 < count && time > keys[cursor].mTime)
+	{
+		float blend = (float)((time - keys[cursor].mTime) / (keys[cursor + 1].mTime - keys[cursor].mTime));
+		aiQuaternion::Interpolate(rotation, keys[cursor].mValue, keys[cursor + 1].mValue, blend);
+	}
+	rotation.Normalize();
+
+	return glm::quat(rotation.w, rotation.x, rotation.y, rotation.z);
+}
+
+void Model::ProcessSkeleton(const aiScene* scene)
+{
+	bool hasBones = false;
+	for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+		hasBones = hasBones || scene->mMeshes[i]->HasBones();
+	if (!hasBones)
+		return;
+
+	Skeleton* skeleton = new Skeleton();
+	AddJoints(scene->mRootNode, -1, *skeleton);
+
+	// A bone several meshes are weighted to keeps one index
+	for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+	{
+		const aiMesh* mesh = scene->mMeshes[i];
+		for (unsigned int j = 0; j < mesh->mNumBones; j++)
+		{
+			int joint = skeleton->FindJoint(mesh->mBones[j]->mName.C_Str());
+			if (joint < 0)
+				continue;
+
+			if (skeleton->FindBone(joint) < 0 && skeleton->GetBoneCount() >= MAX_SKIN_BONES)
+			{
+				std::cout << "Model has more than " << MAX_SKIN_BONES << " bones, it is drawn without its skeleton" << std::endl;
+				delete skeleton;
+				return;
+			}
+			skeleton->AddBone(joint, ToGlm(mesh->mBones[j]->mOffsetMatrix));
+		}
+	}
+
+	// Bone offsets are from the space of the mesh, which is below the root node's transform
+	skeleton->SetRootTransform(glm::inverse(ToGlm(scene->mRootNode->mTransformation)));
+
+	// Every channel is resampled at the same evenly spaced times, the clip's samples
+	std::vector<JointPose> samples;
+	for (unsigned int i = 0; i < scene->mNumAnimations; i++)
+	{
+		const aiAnimation* animation = scene->mAnimations[i];
+		double ticksPerSecond = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : DEFAULT_TICKS_PER_SECOND;
+		std::string name = animation->mName.length > 0 ? animation->mName.C_Str() : "clip" + std::to_string(i);
+		SkeletalClip clip(name, (float)(animation->mDuration / ticksPerSecond), SKELETAL_SAMPLE_RATE);
+
+		int sampleCount = clip.GetSampleCount();
+		samples.resize(sampleCount);
+		for (unsigned int j = 0; j < animation->mNumChannels; j++)
+		{
+			const aiNodeAnim* channel = animation->mChannels[j];
+			int joint = skeleton->FindJoint(channel->mNodeName.C_Str());
+			if (joint < 0)
+				continue;
+
+			const JointPose& bindPose = skeleton->GetJoint(joint).bindPose;
+			unsigned int positionKey = 0, rotationKey = 0, scaleKey = 0;
+			for (int k = 0; k < sampleCount; k++)
+			{
+				double ticks = sampleCount > 1 ? animation->mDuration * k / (sampleCount - 1) : 0.0;
+				samples[k].translation = SampleVectorKeys(channel->mPositionKeys, channel->mNumPositionKeys, ticks, positionKey, bindPose.translation);
+				samples[k].rotation = SampleRotationKeys(channel->mRotationKeys, channel->mNumRotationKeys, ticks, rotationKey, bindPose.rotation);
+				samples[k].scale = SampleVectorKeys(channel->mScalingKeys, channel->mNumScalingKeys, ticks, scaleKey, bindPose.scale);
+			}
+			clip.AddJoint(joint, samples);
+		}
+
+		skeleton->AddClip(clip);
+	}
+
+	m_resource->skeleton = skeleton;
 }
 
 void Model::ProcessNode(aiNode* node, const aiScene* scene)
 {
-	// process all the node's meshes (if any)
+	// process all the node's meshes (if any), built in place so the vertices are never copied
 	for (unsigned int i = 0; i < node->mNumMeshes; i++)
 	{
 		aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-		m_meshBatch.push_back(ProcessMesh(mesh, scene));
+		m_resource->meshes.emplace_back();
+		ProcessMesh(mesh, scene, m_resource->meshes.back());
 	}
 	// then do the same for each of its children
 	for (unsigned int i = 0; i < node->mNumChildren; i++)
@@ -45,133 +613,200 @@ void Model::ProcessNode(aiNode* node, const aiScene* scene)
 	}
 }
 
-Mesh Model::ProcessMesh(aiMesh *mesh, const aiScene *scene)
+void Model::ProcessMesh(aiMesh *mesh, const aiScene *scene, Mesh& result)
 {
-	std::vector<Vertex3> vertices;
-	std::vector<unsigned int> indices;
-	std::vector<Texture> textures;
-
-	// process face data
+	// aiProcess_JoinIdenticalVertices has already welded the vertices, so they are copied as they
+	// are and the faces become the indices. The vertices are value initialized, missing attributes
+	// stay zero
+	std::vector<Vertex3>& vertices = result.GetVertices();
+	vertices.resize(mesh->mNumVertices);
+	if (vertices.empty())
+		return;
+
+	// Points and lines that aiProcess_SortByPType left in the mesh are not drawn
+	std::vector<unsigned int>& indices = result.GetIndices();
+	indices.reserve((size_t)mesh->mNumFaces * 3);
 	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
 	{
-		Vertex3 vertex;
-		glm::vec3 vertexPos;
-		glm::vec4 colour;
-		glm::vec3 normalCoord;
-		glm::vec2 texCoord;
-		glm::vec3 tangent;
-		glm::vec3 biTangent;
-
-		aiFace face = mesh->mFaces[i];
-		for (unsigned int j = 0; j < 3; j++)
+		const aiFace& face = mesh->mFaces[i];
+		if (face.mNumIndices == 3)
+			indices.insert(indices.end(), face.mIndices, face.mIndices + 3);
+	}
+	result.SetFullIndexCount((unsigned int)indices.size());
+
+	// Each attribute is copied in a loop of its own, so what the mesh has is only checked once
+	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+	{
+		// vertex positions
+		const aiVector3D& v = mesh->mVertices[i];
+		vertices[i].m_position = glm::vec3(v.x, v.y, v.z);
+
+		ReadDimensions(vertices[i].m_position);
+	}
+
+	// colours, only stored on the GPU if the asset has them
+	if (mesh->HasVertexColors(0))
+	{
+		const aiColor4D* colours = mesh->mColors[0];
+		for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+			vertices[i].m_colour = glm::vec4(colours[i].r, colours[i].g, colours[i].b, colours[i].a);
+	}
+	else
+	{
+		for (size_t i = 0; i < vertices.size(); i++)
+			vertices[i].m_colour = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	}
+
+	// normals
+	if (mesh->HasNormals())
+	{
+		const aiVector3D* normals = mesh->mNormals;
+		for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+			vertices[i].m_normal = glm::vec3(normals[i].x, normals[i].y, normals[i].z);
+	}
+
+	// texture coordinates
+	// Largest texture coordinate, decides if half floats are precise enough
+	float maxTexCoord = 0.0f;
+	if (mesh->mTextureCoords[0])
+	{
+		const aiVector3D* texCoords = mesh->mTextureCoords[0];
+		for (unsigned int i = 0; i < mesh->mNumVertices; i++)
 		{
-			// vertex positions
-			auto const &v = mesh->mVertices[face.mIndices[j]];
-			vertexPos.x = v.x; 
-			vertexPos.y = v.y; 
-			vertexPos.z = v.z;
-			vertex.m_position = vertexPos;
-
-			// colours (randomised)
-			colour = glm::vec4(((float)rand() / (RAND_MAX)), ((float)rand() / (RAND_MAX)), ((float)rand() / (RAND_MAX)), 1.0f);
-			vertex.m_colour = colour;
-
-			// normals
-			if (mesh->HasNormals())
-			{
-				auto const &n = mesh->mNormals[face.mIndices[j]];
-				normalCoord.x = n.x;
-				normalCoord.y = n.y;
-				normalCoord.z = n.z;
-				vertex.m_normal = normalCoord;
-			}
-			else
-				vertex.m_normal = glm::vec3(0.0f, 0.0f, 0.0f);
+			const aiVector3D& uv = texCoords[i];
+			vertices[i].m_texCoords = glm::vec2(uv.x, uv.y);
 
-			// texture coordinates
-			if (mesh->mTextureCoords[0])
-			{
-				auto const &uv = mesh->mTextureCoords[0][face.mIndices[j]];
-				texCoord.x = uv.x;
-				texCoord.y = uv.y;
-				vertex.m_texCoords = texCoord;
-			}
-			else
-				vertex.m_texCoords = glm::vec2(0.0f, 0.0f);
-
-			//// tangents and bitangents
-			//if (mesh->HasTangentsAndBitangents())
-			//{
-			//	auto const &t = mesh->mTangents[face.mIndices[j]];
-			//	tangent.x = t.x;
-			//	tangent.y = t.y;
-			//	tangent.z = t.z;
-			//	vertex.m_tangent = tangent;
-
-			//	auto const &bt = mesh->mBitangents[face.mIndices[j]];
-			//	biTangent.x = bt.x;
-			//	biTangent.y = bt.y;
-			//	biTangent.z = bt.z;
-			//	vertex.m_biTangent = biTangent;
-			//}
-
-			ReadDimensions(vertexPos);
-
-			vertices.push_back(vertex);
-			indices.push_back(face.mIndices[j]);
+			maxTexCoord = std::max(maxTexCoord, std::max(std::abs(uv.x), std::abs(uv.y)));
 		}
 	}
+
 	// process materials
 	aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+	std::vector<Texture>& textures = result.GetTextures();
 	// diffuse maps
-	std::vector<Texture> diffuseMaps = LoadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-	textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+	LoadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", textures);
 	// specular maps
-	std::vector<Texture> specularMaps = LoadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-	textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+	LoadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", textures);
 	// normal maps
-	std::vector<Texture> normalMaps = LoadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-	textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+	LoadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal", textures);
 	// height maps
-	std::vector<Texture> heightMaps = LoadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-	textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
+	LoadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height", textures);
+
+	// bone weights, the strongest of each vertex
+	const Skeleton* skeleton = m_resource->skeleton;
+	bool skinned = skeleton && mesh->HasBones();
+	if (skinned)
+	{
+		std::vector<unsigned char> bones((size_t)mesh->mNumVertices * BONES_PER_VERTEX, 0);
+		std::vector<float> weights((size_t)mesh->mNumVertices * BONES_PER_VERTEX, 0.0f);
+		for (unsigned int i = 0; i < mesh->mNumBones; i++)
+		{
+			const aiBone* bone = mesh->mBones[i];
+			int index = skeleton->FindBone(skeleton->FindJoint(bone->mName.C_Str()));
+			if (index < 0)
+				continue;
+
+			for (unsigned int j = 0; j < bone->mNumWeights; j++)
+			{
+				const aiVertexWeight& weight = bone->mWeights[j];
+				if (weight.mVertexId >= mesh->mNumVertices)
+					continue;
+
+				// Replaces the weakest bone of the vertex if this one is stronger
+				float* vertexWeights = &weights[(size_t)weight.mVertexId * BONES_PER_VERTEX];
+				int weakest = 0;
+				for (int k = 1; k < BONES_PER_VERTEX; k++)
+				{
+					if (vertexWeights[k] < vertexWeights[weakest])
+						weakest = k;
+				}
+
+				if (weight.mWeight > vertexWeights[weakest])
+				{
+					vertexWeights[weakest] = weight.mWeight;
+					bones[(size_t)weight.mVertexId * BONES_PER_VERTEX + weakest] = (unsigned char)index;
+				}
+			}
+		}
+
+		// Scaled to sum to 255, the strongest bone takes what rounding leaves over. Vertices no
+		// bone is weighted to keep zero weights and are drawn where they are
+		for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+		{
+			const unsigned char* vertexBones = &bones[(size_t)i * BONES_PER_VERTEX];
+			const float* vertexWeights = &weights[(size_t)i * BONES_PER_VERTEX];
+
+			float total = 0.0f;
+			int strongest = 0;
+			for (int k = 0; k < BONES_PER_VERTEX; k++)
+			{
+				total += vertexWeights[k];
+				if (vertexWeights[k] > vertexWeights[strongest])
+					strongest = k;
+			}
+			if (total <= 0.0f)
+				continue;
+
+			Vertex3& vertex = vertices[i];
+			int sum = 0;
+			for (int k = 0; k < BONES_PER_VERTEX; k++)
+			{
+				vertex.m_boneIndices[k] = vertexBones[k];
+				vertex.m_boneWeights[k] = (unsigned char)(vertexWeights[k] / total * 255.0f + 0.5f);
+				sum += vertex.m_boneWeights[k];
+			}
+			vertex.m_boneWeights[strongest] = (unsigned char)(vertex.m_boneWeights[strongest] + 255 - sum);
+		}
+	}
+
+	// Only pack the attributes this mesh has data for
+	VertexLayout layout = VertexLayout::CreatePacked(mesh->mTextureCoords[0] != NULL, mesh->HasNormals(), mesh->HasVertexColors(0), maxTexCoord > 4.0f);
+	if (skinned)
+	{
+		layout.AddElement(ATTRIB_BONE_INDICES, FORMAT_UINT8_4);
+		layout.AddElement(ATTRIB_BONE_WEIGHTS, FORMAT_UNORM8_4);
+	}
+	result.SetLayout(layout);
 
-	return Mesh(vertices, indices, textures);
 }
 
-std::vector<Texture> Model::LoadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName)
+void Model::LoadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName, std::vector<Texture>& textures)
 {
-	std::vector<Texture> textures;
 	for (unsigned int i = 0; i < mat->GetTextureCount(type); i++)
 	{
 		aiString str;
 		mat->GetTexture(type, i, &str);
-		// check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-		bool skip = false;
 
 		if (std::strcmp(str.C_Str(), "$texture_dummy.bmp") == 0)
-			skip = true;
+			continue;
+
+		// Loaded by LoadTextures() on the thread that owns the GL context
+		Texture texture;
+		texture.m_id = 0;
+		texture.m_type = typeName;
+		texture.m_path = str.C_Str();
+		textures.push_back(texture);
+	}
+}
 
-		for (unsigned int j = 0; j < m_texturesLoaded.size(); j++)
-		{
-			if (std::strcmp(m_texturesLoaded[j].m_path.data(), str.C_Str()) == 0)
-			{
-				textures.push_back(m_texturesLoaded[j]);
-				skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
-				break;
-			}
-		}
-		if (!skip)
-		{   // if texture hasn't been loaded already, load it
-			Texture texture;
-			texture.m_id = TextureFromFile(str.C_Str(), this->m_directory);
-			texture.m_type = typeName;
-			texture.m_path = str.C_Str();
-			textures.push_back(texture);
-			m_texturesLoaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
-		}
+Texture Model::LoadTexture(const std::string& path, const std::string& typeName)
+{
+	// check if texture was loaded before and if so, return it: skip loading a new texture
+	std::vector<Texture>& texturesLoaded = m_resource->textures;
+	for (unsigned int j = 0; j < texturesLoaded.size(); j++)
+	{
+		if (texturesLoaded[j].m_path == path)
+			return texturesLoaded[j];
 	}
-	return textures;
+
+	Texture texture;
+	texture.m_handle = TextureFromFile(path.c_str(), m_resource->directory);
+	texture.m_id = TextureManager::Instance().GetTextureName(texture.m_handle);
+	texture.m_type = typeName;
+	texture.m_path = path;
+	texturesLoaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
+
+	return texture;
 }
 
 const void Model::CalculateDimensions()
@@ -186,9 +821,9 @@ const void Model::CalculateDimensions()
 
 const void Model::ScaleDimensions()
 {
-	m_Xdim *= m_scale.x;
-	m_Ydim *= m_scale.y;
-	m_Zdim *= m_scale.z;
+	m_Xdim *= GetScale().x;
+	m_Ydim *= GetScale().y;
+	m_Zdim *= GetScale().z;
 }
 
 const void Model::ReadDimensions(glm::vec3 vertexPos)
@@ -196,6 +831,8 @@ const void Model::ReadDimensions(glm::vec3 vertexPos)
 	// First vertex gets made the initial values of dimensions to be compared to
 	if (m_firstVertex)
 	{
+		m_boundsMin = vertexPos;
+		m_boundsMax = vertexPos;
 		m_Xdim = glm::vec2(vertexPos.x, vertexPos.x);
 		m_Ydim = glm::vec2(vertexPos.y, vertexPos.y);
 		m_Zdim = glm::vec2(vertexPos.z, vertexPos.z);
@@ -205,6 +842,9 @@ const void Model::ReadDimensions(glm::vec3 vertexPos)
 	// Read and compare the vertex
 	else
 	{
+		m_boundsMin = glm::min(m_boundsMin, vertexPos);
+		m_boundsMax = glm::max(m_boundsMax, vertexPos);
+
 		// Compare for X
 		if (vertexPos.x < m_Xdim.x) {
 			// x is min
@@ -236,41 +876,18 @@ const void Model::ReadDimensions(glm::vec3 vertexPos)
 void Model::Destroy()
 {
 	// Todo: implement destroy function of all meshes of the model
-	return void();
-}
-
-
-void Model::SetPosition(glm::vec3 position)
-{
-	m_position = position;
-	for (size_t i = 0; i < m_meshBatch.size(); i++)
-	{
-		m_meshBatch[i].SetPosition(position);
-	}
-}
 
-void Model::SetRotation(glm::vec3 rotation)
-{
-	m_rotation = rotation;
-	for (size_t i = 0; i < m_meshBatch.size(); i++)
-	{
-		m_meshBatch[i].SetRotation(rotation);
-	}
+	// The textures are given back once no other model shares the resource
+	ModelCache::Instance().Release(m_resource);
+	m_resource = NULL;
 }
 
-void Model::SetScale(glm::vec3 scale)
-{
-	m_scale = scale;
-	for (size_t i = 0; i < m_meshBatch.size(); i++)
-	{
-		m_meshBatch[i].SetScale(scale);
-	}
-}
 
-unsigned int TextureFromFile(const char* path, const std::string& directory)
+TextureHandle TextureFromFile(const char* path, const std::string& directory)
 {
 	std::string filePath = std::string(path);
 	filePath = directory + '/' + filePath;
 
-	return TextureManager::Instance().GetTextureID(filePath);
+	// Decoded on a worker thread, the texture holds a placeholder until it is uploaded
+	return TextureManager::Instance().AcquireTexture(filePath);
 }
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
 #include <GLM\glm.hpp>									// Used for the GLM math library
 #include <GLM\gtc\matrix_transform.hpp>					
 #include <GLM\gtx\transform2.hpp>					
@@ -10,6 +13,14 @@
 #include <assimp/postprocess.h>
 
 #include "Mesh.h"
+#include "ModelCache.h"
+#include "MeshCooker.h"
+#include "MeshOptimizer.h"
+#include "MD2Loader.h"
+#include "..\Common\Transform.h"
+#include "..\Common\StartupTimeline.h"
+#include "..\Common\AllocationCounter.h"
+#include "..\Common\JobSystem.h"
 #include "..\Controllers\Camera.h"
 #include "..\Renderer\Shader.h"
 #include "..\Texture\TextureManager.h"
@@ -35,8 +46,9 @@ public:
 		/**
 		* @brief Constructor
 		*
-		* This is the default constuctor that sets the scale value of the model to 1,
-		* initializes the models shader as well as setting the AI of the model to NULL.
+		* This is the default constuctor, the model starts with an identity transform (scale of 1)
+		* and sets the shader and AI of the model to NULL. The shader is shared and assigned
+		* when the model is prepared for rendering.
 		*
 		* @return null
 		*/
@@ -59,11 +71,92 @@ public:
 		* uses the assimp import asset library to read the file and with other helper functions, store
 		* the data in the correct member variable data structures.
 		*
+		* The meshes and textures are shared through the ModelCache, so a file loaded by another
+		* model is not read again and the models draw the same meshes.
+		*
+		* Same as LoadMeshes() followed by LoadTextures(), so it must be called on the thread that
+		* owns the GL context.
+		*
 		* @param std::string filePath
 		* @return void
 		*/
 	void LoadModel(std::string filePath);
 
+		/**
+		* @brief Loads the meshes of the model
+		*
+		* Imports or maps the meshes of the file without loading their textures. Makes no
+		* OpenGL or texture manager calls, so models can be loaded on worker threads.
+		*
+		* @param const std::string& filePath
+		* @return void
+		*/
+	void LoadMeshes(const std::string& filePath);
+
+		/**
+		* @brief Loads the textures of the model
+		*
+		* Loads the material textures of the meshes loaded by LoadMeshes(). Must be called on the
+		* thread that owns the GL context.
+		*
+		* @return void
+		*/
+	void LoadTextures();
+
+		/**
+		* @brief Loads the bounds of the model
+		*
+		* Reads the bounds from the cooked copy of the file without loading its meshes, so a
+		* streamed model has placeholder dimensions for its collision body before it is loaded.
+		* Returns false if the file has not been cooked yet.
+		*
+		* @param const std::string& filePath
+		* @return bool
+		*/
+	bool LoadBounds(const std::string& filePath);
+
+		/**
+		* @brief Swaps the meshes with another model
+		*
+		* Swaps the meshes and textures of the two models, everything else, the bounds included,
+		* stays with the model. Used to load a streamed model into a spare model on a worker and
+		* swap it in once it is loaded.
+		*
+		* @param Model& other
+		* @return void
+		*/
+	void SwapMeshes(Model& other) { std::swap(m_resource, other.m_resource); }
+
+		/**
+		* @brief Benchmarks importing a model
+		*
+		* Imports the file through Assimp the given number of times without the model or mesh
+		* cache, and prints the best and average time spent in Assimp, in ProcessNode() and in
+		* generating the levels of detail, and the allocations ProcessNode() and the levels of
+		* detail made, each on their own. Returns 0, or 1 if the file cannot be imported.
+		*
+		* @param const std::string& filePath
+		* @param int runs
+		* @return int
+		*/
+	static int BenchmarkImport(const std::string& filePath, int runs);
+
+		/**
+		* @brief Benchmarks posing skeletons
+		*
+		* Poses count skeletons the given number of times, half of them fading between two clips,
+		* first on the calling thread and then spread over the workers, and prints the best time
+		* and the skeletons posed per millisecond of each, and the size of the quantized clips.
+		* The skeleton of the given model file is used, or a generated one if the path is empty.
+		* Returns 0, or 1 if the file has no skeleton.
+		*
+		* @param const std::string& filePath
+		* @param int count
+		* @param int runs
+		* @return int
+		*/
+	static int BenchmarkSkeletons(const std::string& filePath, int count, int runs);
+
 		/**
 		* @brief Processes the node of an aiScene	
 		*
@@ -76,35 +169,62 @@ public:
 		*/
 	void ProcessNode(aiNode* node, const aiScene* scene);
 
+		/**
+		* @brief Processes the skeleton of an aiScene
+		*
+		* Reads the node hierarchy the bones of the meshes hang off into a skeleton, and resamples
+		* the animations of the scene into quantized clips. Does nothing if no mesh has bones. Must
+		* be called before the meshes are processed, which weight their vertices to its bones.
+		*
+		* @param const aiScene* scene
+		* @return void
+		*/
+	void ProcessSkeleton(const aiScene* scene);
+
 		/**
 		* @brief Processes the mesh
 		*
 		* For each node that is contained in a scene, if it contains a mesh, then this function processes it.
-		* It reads the vertex data in the aiNode object and stores them in the correct member data structures.
+		* It reads the vertex data in the aiNode object and stores them in the given mesh, which
+		* is filled in place. The vertices are allocated once at their final size.
 		*
 		* @param aiMesh* mesh
 		* @param const aiScene* scene
+		* @param Mesh& result
 		* @return void
 		*/
-	Mesh ProcessMesh(aiMesh* mesh, const aiScene* scene);
+	void ProcessMesh(aiMesh* mesh, const aiScene* scene, Mesh& result);
 
 		/**
-		* @brief Loads the material textures
+		* @brief Reads the material textures
 		*
-		* Reads in the materials of the aiMesh and stores them in a temporary Texture data
-		* structure that is then returned.
+		* Reads in the materials of the aiMesh and appends their types and paths to the textures
+		* of a mesh. The textures are loaded by LoadTextures().
 		*
 		* @param aiMaterial* mat
 		* @param aiTextureType type
-		* @param std::string typeName
-		* @return std::vector<Texture>
+		* @param const std::string& typeName
+		* @param std::vector<Texture>& textures
+		* @return void
 		*/
-	std::vector<Texture> LoadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName);
+	void LoadMaterialTextures(aiMaterial* mat, aiTextureType type, const std::string& typeName, std::vector<Texture>& textures);
+
+		/**
+		* @brief Loads a material texture
+		*
+		* Returns the texture of the given path relative to the model directory, loading it only
+		* the first time the model uses the path.
+		*
+		* @param const std::string& path
+		* @param const std::string& typeName
+		* @return Texture
+		*/
+	Texture LoadTexture(const std::string& path, const std::string& typeName);
 
 		/**
 		* @brief Destroys the model
 		*
-		* Deallocates any memory used by the model object.
+		* Deallocates any memory used by the model object and releases its shared meshes.
 		*
 		* @return void
 		*/
@@ -115,9 +235,9 @@ public:
 		*
 		* Returns the position of the model as a glm::vec3.
 		*
-		* @return glm::vec3&
+		* @return const glm::vec3&
 		*/
-	glm::vec3& GetPosition() { return m_position; }
+	const glm::vec3& GetPosition() const { return m_transform.GetPosition(); }
 	
 		/**
 		* @brief Sets the models position
@@ -127,16 +247,16 @@ public:
 		* @param glm::vec3 position
 		* @return void
 		*/
-	void SetPosition(glm::vec3 position);
+	void SetPosition(glm::vec3 position) { m_transform.SetPosition(position); }
 
 		/**
 		* @brief Gets the models rotation
 		*
 		* Returns the rotation of the model as a glm::vec3.
 		*
-		* @return glm::vec3&
+		* @return const glm::vec3&
 		*/
-	glm::vec3& GetRotation() { return m_rotation; }
+	const glm::vec3& GetRotation() const { return m_transform.GetRotation(); }
 	
 		/**
 		* @brief Sets the models rotation
@@ -146,16 +266,16 @@ public:
 		* @param glm::vec3 rotation
 		* @return void
 		*/
-	void SetRotation(glm::vec3 rotation);
+	void SetRotation(glm::vec3 rotation) { m_transform.SetRotation(rotation); }
 
 		/**
 		* @brief Gets the models scale
 		*
 		* Returns the scale of the model as a glm::vec3.
 		*
-		* @return glm::vec3&
+		* @return const glm::vec3&
 		*/
-	glm::vec3& GetScale() { return m_scale; }
+	const glm::vec3& GetScale() const { return m_transform.GetScale(); }
 	
 		/**
 		* @brief Sets the models scale
@@ -165,7 +285,17 @@ public:
 		* @param glm::vec3 scale
 		* @return void
 		*/
-	void SetScale(glm::vec3 scale);
+	void SetScale(glm::vec3 scale) { m_transform.SetScale(scale); }
+
+		/**
+		* @brief Gets the models transform
+		*
+		* Returns the scene graph transform of the model. Its meshes are drawn with its world
+		* matrix, and it can be parented to other transforms.
+		*
+		* @return Transform&
+		*/
+	Transform& GetTransform() { return m_transform; }
 
 		/**
 		* @brief Gets the camera object
@@ -190,11 +320,12 @@ public:
 		/**
 		* @brief Gets the mesh batch
 		*
-		* Returns the vector of meshes of the model by reference.
+		* Returns the vector of meshes of the model by reference. Models loaded from the same file
+		* share their meshes.
 		*
 		* @return std::vector<Mesh>&
 		*/
-	std::vector<Mesh>& GetMeshBatch() { return m_meshBatch; }
+	std::vector<Mesh>& GetMeshBatch() { return m_resource->meshes; }
 
 		/**
 		* @brief Gets the textures
@@ -203,7 +334,7 @@ public:
 		*
 		* @return std::vector<Texture>&
 		*/
-	std::vector<Texture>& GetTextures() { return m_texturesLoaded; }
+	std::vector<Texture>& GetTextures() { return m_resource->textures; }
 
 		/**
 		* @brief Gets the shader
@@ -244,6 +375,127 @@ public:
 		*/
 	ComputerAI* GetAI() { return m_compAI; }
 
+		/**
+		* @brief Gets the level of detail
+		*
+		* Returns the level of detail the model was last drawn at, 0 being the full mesh.
+		*
+		* @return int
+		*/
+	int GetLodLevel() const { return m_lodLevel; }
+
+		/**
+		* @brief Sets the level of detail
+		*
+		* Sets the level of detail the meshes of the model are drawn at. Meshes with fewer levels
+		* use their coarsest one.
+		*
+		* @param int level
+		* @return void
+		*/
+	void SetLodLevel(int level) { m_lodLevel = level; }
+
+		/**
+		* @brief Checks if the model is resident
+		*
+		* Returns false while a streamed model is not loaded, or not uploaded yet, and must not
+		* be drawn.
+		*
+		* @return bool
+		*/
+	bool IsResident() const { return m_resident; }
+
+		/**
+		* @brief Sets if the model is resident
+		*
+		* @param bool resident
+		* @return void
+		*/
+	void SetResident(bool resident) { m_resident = resident; }
+
+		/**
+		* @brief Gets the keyframes of the model
+		*
+		* Returns the frames of a vertex animated model, or NULL if the model is static.
+		*
+		* @return KeyframeSet*
+		*/
+	KeyframeSet* GetKeyframes() { return m_resource->keyframes; }
+
+		/**
+		* @brief Plays an animation
+		*
+		* Plays the clip of the given name in a loop, starting startTime seconds into it so models
+		* playing the same clip need not move in step. Returns false if the model is static or
+		* has no clip of that name.
+		*
+		* @param const std::string& clipName
+		* @param float framesPerSecond
+		* @param float startTime
+		* @return bool
+		*/
+	bool PlayAnimation(const std::string& clipName, float framesPerSecond, float startTime);
+
+		/**
+		* @brief Updates the animation
+		*
+		* Moves the animation on by the given seconds. Does nothing for static models.
+		*
+		* @param float seconds
+		* @return void
+		*/
+	void UpdateAnimation(float seconds);
+
+		/**
+		* @brief Gets where the model is in its animation
+		*
+		* @return const KeyframePlayback&
+		*/
+	const KeyframePlayback& GetPlayback() const { return m_playback; }
+
+		/**
+		* @brief Gets the skeleton of the model
+		*
+		* Returns the bones and clips of a skinned model, or NULL if the model has no bones.
+		*
+		* @return const Skeleton*
+		*/
+	const Skeleton* GetSkeleton() const { return m_resource->skeleton; }
+
+		/**
+		* @brief Plays a skeletal animation
+		*
+		* Plays the clip of the given name in a loop, fading from the clip playing over
+		* fadeSeconds. Returns false if the model has no bones or no clip of that name.
+		*
+		* @param const std::string& clipName
+		* @param float fadeSeconds
+		* @return bool
+		*/
+	bool PlaySkeletalAnimation(const std::string& clipName, float fadeSeconds);
+
+		/**
+		* @brief Updates the skeleton
+		*
+		* Moves the skeletal animation on by the given seconds and poses the skeleton, ready for
+		* GetBonePalette(). Does nothing for models without bones. Only touches this model, so
+		* models are updated on the workers at once.
+		*
+		* @param float seconds
+		* @return void
+		*/
+	void UpdateSkeleton(float seconds);
+
+		/**
+		* @brief Gets the bone palette
+		*
+		* Returns one matrix per bone of the pose found by the last UpdateSkeleton(), empty for
+		* models without bones.
+		*
+		* @return const std::vector<glm::mat4>&
+		*/
+	const std::vector<glm::mat4>& GetBonePalette() const { return m_pose.palette; }
+
 	unsigned int VAO;
 
 	const void CalculateDimensions();
@@ -252,17 +504,36 @@ public:
 
 	glm::vec3& GetDimensions() { return m_dimensions; }
 
+		/**
+		* @brief Gets the minimum corner of the model bounds
+		*
+		* Returns the minimum corner of the axis aligned box around every vertex of the model, in
+		* model space before the transform is applied.
+		*
+		* @return const glm::vec3&
+		*/
+	const glm::vec3& GetBoundsMin() const { return m_boundsMin; }
+
+		/**
+		* @brief Gets the maximum corner of the model bounds
+		*
+		* Returns the maximum corner of the axis aligned box around every vertex of the model, in
+		* model space before the transform is applied.
+		*
+		* @return const glm::vec3&
+		*/
+	const glm::vec3& GetBoundsMax() const { return m_boundsMax; }
+
 protected:
-	std::vector<Mesh> m_meshBatch;
-	std::vector<Texture> m_texturesLoaded;
-	std::string m_directory;
+	/// Meshes and textures, shared with the other models loaded from the same file
+	ModelResource* m_resource;
+
 
 	Shader* m_shader;
 	Camera* m_camera;
 
-	glm::vec3 m_position;
-	glm::vec3 m_rotation;
-	glm::vec3 m_scale;
+	/// Position, rotation, scale and cached matrices of the model
+	Transform m_transform;
 	
 	ComputerAI* m_compAI;
 
@@ -275,6 +546,22 @@ protected:
 	glm::vec2 m_Ydim;
 	glm::vec2 m_Zdim;
 
+	/// Model space bounding box of every vertex, unaffected by scale
+	glm::vec3 m_boundsMin, m_boundsMax;
+
+	/// Level of detail the model is drawn at
+	int m_lodLevel;
+
+	/// Whether the meshes are loaded and uploaded
+	bool m_resident;
+
+	/// Clip and time of the animation, models sharing keyframes animate on their own
+	KeyframePlayback m_playback;
+
+	/// Clips of the skeleton the model is playing, and its pose
+	SkeletalPlayback m_skeletalPlayback;
+	SkeletalPose m_pose;
+
 	bool m_firstVertex = true;
 };
 
@@ -0,0 +1,118 @@
+#include "ModelCache.h"
+
+// Creates an empty resource with one reference
+static ModelResource* NewResource(const std::string& key)
+{
+	ModelResource* resource = new ModelResource();
+	resource->boundsMin = glm::vec3(0.0f);
+	resource->boundsMax = glm::vec3(0.0f);
+	resource->xDim = resource->yDim = resource->zDim = glm::vec2(0.0f);
+	resource->file = NULL;
+	resource->keyframes = NULL;
+	resource->skeleton = NULL;
+	resource->key = key;
+	resource->references = 1;
+	resource->loaded = false;
+
+	return resource;
+}
+
+ModelResource* ModelCache::Acquire(const std::string& key, const std::function<void(ModelResource*)>& load)
+{
+	ModelResource* resource;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		std::unordered_map<std::string, ModelResource*>::iterator itr = m_resources.find(key);
+		if (itr != m_resources.end())
+		{
+			// Another model may still be loading it
+			resource = itr->second;
+			resource->references++;
+			m_hits++;
+			m_loaded.wait(lock, [resource] { return resource->loaded; });
+
+			return resource;
+		}
+
+		resource = NewResource(key);
+		m_resources[key] = resource;
+		m_loads++;
+	}
+
+	// Loaded outside the lock so other files can load at the same time
+	load(resource);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		resource->loaded = true;
+	}
+	m_loaded.notify_all();
+
+	return resource;
+}
+
+ModelResource* ModelCache::Create()
+{
+	ModelResource* resource = NewResource("");
+	resource->loaded = true;
+
+	return resource;
+}
+
+void ModelCache::Forget(const std::string& filePath)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Keys are the file path and the import flags
+	std::string prefix = filePath + "|";
+	std::unordered_map<std::string, ModelResource*>::iterator itr = m_resources.begin();
+	while (itr != m_resources.end())
+	{
+		if (itr->first.compare(0, prefix.size(), prefix) != 0)
+		{
+			itr++;
+			continue;
+		}
+
+		// Without a key the last release does not remove the resource loaded after it
+		itr->second->key.clear();
+		itr = m_resources.erase(itr);
+	}
+}
+
+void ModelCache::Release(ModelResource* resource)
+{
+	if (!resource)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (--resource->references > 0)
+			return;
+
+		if (!resource->key.empty())
+			m_resources.erase(resource->key);
+	}
+
+	// Give back the textures acquired for the meshes
+	for (size_t i = 0; i < resource->textures.size(); i++)
+		TextureManager::Instance().ReleaseTexture(resource->textures[i].m_handle);
+
+	// Prepared meshes, the context is current on the thread releasing them
+	for (size_t i = 0; i < resource->meshes.size(); i++)
+		resource->meshes[i].ReleaseBuffers();
+
+	if (resource->keyframes)
+	{
+		resource->keyframes->Release();
+		delete resource->keyframes;
+	}
+	delete resource->skeleton;
+
+	// Cooked meshes point into the mapping
+	resource->meshes.clear();
+	delete resource->file;
+	delete resource;
+}
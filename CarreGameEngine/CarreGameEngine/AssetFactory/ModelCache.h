@@ -0,0 +1,185 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <GLM\glm.hpp>
+
+#include "Mesh.h"
+#include "KeyframeSet.h"
+#include "Skeleton.h"
+#include "..\Common\MappedFile.h"
+#include "..\Texture\TextureManager.h"
+
+	/**
+	* @struct ModelResource
+	* @brief The meshes and textures of a model file, shared by every model loaded from it
+	*
+	* Only the loader writes to a resource. Everything that differs between instances, such as
+	* the transform, level of detail and AI, stays in Model.
+	*/
+struct ModelResource
+{
+	/// Meshes of the file, prepared for drawing once for every model sharing them
+	std::vector<Mesh> meshes;
+
+	/// Textures acquired for the meshes, released when the resource is deleted
+	std::vector<Texture> textures;
+
+	/// Cooked mesh file the vertices and indices of cooked meshes point into, NULL if imported
+	MappedFile* file;
+
+	/// Frames of vertex animated models, NULL for static models
+	KeyframeSet* keyframes;
+
+	/// Bones and clips of skinned models, NULL for models without bones
+	Skeleton* skeleton;
+
+	/// Directory the file is in, material textures are loaded relative to it
+	std::string directory;
+
+	/// Model space bounding box of every vertex
+	glm::vec3 boundsMin, boundsMax;
+
+	/// Minimum and maximum of each axis, as Model::ReadDimensions() found them
+	glm::vec2 xDim, yDim, zDim;
+
+	/// Cache key, empty for resources that are not shared
+	std::string key;
+
+	/// Models using the resource
+	int references;
+
+	/// Set once the loader has finished
+	bool loaded;
+};
+
+	/**
+	* @class ModelCache
+	* @brief Loads every model file once and shares it between the models using it
+	*
+	* Every model used to run its own Assimp import, so the three persons parsed Person.obj three
+	* times and each kept its own copy of the meshes. The cache keys resources by file path and
+	* import flags, runs the loader for the first model that asks for a key and gives every later
+	* model the same resource, so an extra instance costs neither load time nor mesh memory.
+	*
+	* Resources are reference counted and deleted, textures and buffers included, once the last
+	* model using them releases them. A model asking for a resource another thread is still
+	* loading waits for it to finish.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class ModelCache
+{
+public:
+		/**
+		* @brief Singleton instance
+		*
+		* This function returns a singleton instance of the model cache so that every model file
+		* is only loaded once.
+		*
+		* @return static ModelCache&
+		*/
+	static ModelCache& Instance()
+	{
+		static ModelCache instance;
+
+		return instance;
+	}
+
+		/**
+		* @brief Acquires a shared resource
+		*
+		* Returns the resource of the key and adds a reference to it. The first time a key is
+		* acquired the resource is created and passed to load to fill in. Every acquire must be
+		* matched by a Release().
+		*
+		* @param const std::string& key
+		* @param const std::function<void(ModelResource*)>& load
+		* @return ModelResource*
+		*/
+	ModelResource* Acquire(const std::string& key, const std::function<void(ModelResource*)>& load);
+
+		/**
+		* @brief Creates a resource that is not shared
+		*
+		* Returns an empty resource with a single reference, for models built in code such as
+		* terrains.
+		*
+		* @return ModelResource*
+		*/
+	ModelResource* Create();
+
+		/**
+		* @brief Releases a resource
+		*
+		* Removes a reference from the resource and deletes it once nothing uses it, with the
+		* OpenGL buffers of its meshes, so the last release of a prepared resource must be made
+		* on the thread the context is current on.
+		*
+		* @param ModelResource* resource
+		* @return void
+		*/
+	void Release(ModelResource* resource);
+
+		/**
+		* @brief Forgets the resources of a file
+		*
+		* Removes every resource loaded from the file from the cache, so the next acquire loads
+		* the file again. Models already using them keep them until they release them.
+		*
+		* @param const std::string& filePath
+		* @return void
+		*/
+	void Forget(const std::string& filePath);
+
+		/**
+		* @brief Gets the number of files loaded
+		*
+		* @return int
+		*/
+	int GetLoadCount() const { return m_loads; }
+
+		/**
+		* @brief Gets the number of acquires served without loading
+		*
+		* @return int
+		*/
+	int GetHitCount() const { return m_hits; }
+
+private:
+		/**
+		* @brief Default constructor
+		*
+		* Private so the cache can only be used through Instance().
+		*
+		* @return null
+		*/
+	ModelCache() : m_loads(0), m_hits(0) { }
+
+		/**
+		* @brief Destructor
+		*
+		* Empty destructor.
+		*
+		* @return null
+		*/
+	~ModelCache() { }
+
+	/// Shared resources by key
+	std::unordered_map<std::string, ModelResource*> m_resources;
+
+	/// Guards the map, the reference counts and the loaded flags
+	std::mutex m_mutex;
+
+	/// Signalled when a resource finishes loading
+	std::condition_variable m_loaded;
+
+	/// Files loaded and acquires served from the cache
+	int m_loads, m_hits;
+};
@@ -19,12 +19,22 @@ const void Object::Destroy()
 
 void Object::AddTexutre(GLuint textureId, std::string textureFilePath)
 {
+	// Models loaded from the same file share their meshes, so another instance may have added it
+	std::vector<Texture>& meshTextures = m_model->GetMeshBatch()[0].GetTextures();
+	for (size_t i = 0; i < meshTextures.size(); i++)
+	{
+		if (meshTextures[i].m_path == textureFilePath)
+			return;
+	}
+
 	Texture texture;
 
 	texture.m_id = textureId;
 	texture.m_path = textureFilePath;
+	texture.m_handle = TextureManager::Instance().AcquireTexture(textureFilePath);
 	texture.m_type = "texture_diffuse";
 
+	// Released with the rest of the model textures
 	m_model->GetTextures().push_back(texture);
-	m_model->GetMeshBatch()[0].GetTextures().push_back(texture);
+	meshTextures.push_back(texture);
 }
@@ -0,0 +1,164 @@
+#include "SkeletalClip.h"
+
+/// Largest quantized translation or scale component
+static const float VECTOR_KEY_MAX = 65535.0f;
+
+/// Largest quantized rotation component, the components are in -1..1
+static const float ROTATION_KEY_MAX = 32767.0f;
+
+/// Channels moving less than this during the clip keep a single key
+static const float CONSTANT_EPSILON = 1e-5f;
+
+SkeletalClip::SkeletalClip(const std::string& name, float duration, float sampleRate)
+	: m_name(name), m_duration(std::max(duration, 0.0f))
+{
+	m_sampleCount = (int)std::ceil(m_duration * sampleRate) + 1;
+}
+
+// Quantizes a translation or scale channel over the range it moves through, returns its key count
+static int QuantizeVectors(const std::vector<glm::vec3>& values, std::vector<uint16_t>& stream, size_t& offset, glm::vec3& minimum, glm::vec3& extent)
+{
+	minimum = values[0];
+	glm::vec3 maximum = values[0];
+	for (size_t i = 1; i < values.size(); i++)
+	{
+		minimum = glm::min(minimum, values[i]);
+		maximum = glm::max(maximum, values[i]);
+	}
+	extent = maximum - minimum;
+
+	int keys = (int)values.size();
+	if (extent.x <= CONSTANT_EPSILON && extent.y <= CONSTANT_EPSILON && extent.z <= CONSTANT_EPSILON)
+	{
+		// Decoded as the minimum alone
+		minimum = values[0];
+		extent = glm::vec3(0.0f);
+		keys = 1;
+	}
+
+	offset = stream.size() / 3;
+	for (int i = 0; i < keys; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			float unit = extent[j] > 0.0f ? (values[i][j] - minimum[j]) / extent[j] : 0.0f;
+			stream.push_back((uint16_t)(glm::clamp(unit, 0.0f, 1.0f) * VECTOR_KEY_MAX + 0.5f));
+		}
+	}
+
+	return keys;
+}
+
+void SkeletalClip::AddJoint(int joint, const std::vector<JointPose>& samples)
+{
+	if (samples.empty())
+		return;
+
+	Track track;
+	track.joint = joint;
+
+	std::vector<glm::vec3> vectors(samples.size());
+	for (size_t i = 0; i < samples.size(); i++)
+		vectors[i] = samples[i].translation;
+	track.translationKeys = QuantizeVectors(vectors, m_vectors, track.translationOffset, track.translationMin, track.translationExtent);
+
+	for (size_t i = 0; i < samples.size(); i++)
+		vectors[i] = samples[i].scale;
+	track.scaleKeys = QuantizeVectors(vectors, m_vectors, track.scaleOffset, track.scaleMin, track.scaleExtent);
+
+	// Neighbouring keys are kept in the same hemisphere, so blending them takes the short way round
+	std::vector<glm::quat> rotations(samples.size());
+	bool constant = true;
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		glm::quat rotation = glm::normalize(samples[i].rotation);
+		if (i > 0 && glm::dot(rotation, rotations[i - 1]) < 0.0f)
+			rotation = -rotation;
+		rotations[i] = rotation;
+
+		constant = constant && std::abs(glm::dot(rotation, rotations[0])) >= 1.0f - CONSTANT_EPSILON;
+	}
+
+	track.rotationKeys = constant ? 1 : (int)rotations.size();
+	track.rotationOffset = m_rotations.size() / 4;
+	for (int i = 0; i < track.rotationKeys; i++)
+	{
+		const glm::quat& rotation = rotations[i];
+		m_rotations.push_back((int16_t)std::floor(rotation.x * ROTATION_KEY_MAX + 0.5f));
+		m_rotations.push_back((int16_t)std::floor(rotation.y * ROTATION_KEY_MAX + 0.5f));
+		m_rotations.push_back((int16_t)std::floor(rotation.z * ROTATION_KEY_MAX + 0.5f));
+		m_rotations.push_back((int16_t)std::floor(rotation.w * ROTATION_KEY_MAX + 0.5f));
+	}
+
+	m_tracks.push_back(track);
+}
+
+// Reads a rotation key
+static glm::quat ReadRotation(const int16_t* key)
+{
+	return glm::quat(key[3] / ROTATION_KEY_MAX, key[0] / ROTATION_KEY_MAX, key[1] / ROTATION_KEY_MAX, key[2] / ROTATION_KEY_MAX);
+}
+
+// Reads a translation or scale key
+static glm::vec3 ReadVector(const uint16_t* key, const glm::vec3& minimum, const glm::vec3& extent)
+{
+	return minimum + extent * (glm::vec3(key[0], key[1], key[2]) / VECTOR_KEY_MAX);
+}
+
+void SkeletalClip::Sample(float time, std::vector<JointPose>& pose) const
+{
+	if (m_sampleCount == 0)
+		return;
+
+	float position = 0.0f;
+	if (m_duration > 0.0f)
+		position = glm::clamp(time / m_duration, 0.0f, 1.0f) * (m_sampleCount - 1);
+
+	int first = std::min((int)position, m_sampleCount - 1);
+	int second = std::min(first + 1, m_sampleCount - 1);
+	float blend = position - first;
+
+	for (size_t i = 0; i < m_tracks.size(); i++)
+	{
+		const Track& track = m_tracks[i];
+		JointPose& joint = pose[track.joint];
+
+		if (track.rotationKeys == 1)
+		{
+			joint.rotation = glm::normalize(ReadRotation(&m_rotations[track.rotationOffset * 4]));
+		}
+		else
+		{
+			glm::quat from = ReadRotation(&m_rotations[(track.rotationOffset + first) * 4]);
+			glm::quat to = ReadRotation(&m_rotations[(track.rotationOffset + second) * 4]);
+			joint.rotation = glm::normalize(from * (1.0f - blend) + to * blend);
+		}
+
+		if (track.translationKeys == 1)
+		{
+			joint.translation = track.translationMin;
+		}
+		else
+		{
+			glm::vec3 from = ReadVector(&m_vectors[(track.translationOffset + first) * 3], track.translationMin, track.translationExtent);
+			glm::vec3 to = ReadVector(&m_vectors[(track.translationOffset + second) * 3], track.translationMin, track.translationExtent);
+			joint.translation = glm::mix(from, to, blend);
+		}
+
+		if (track.scaleKeys == 1)
+		{
+			joint.scale = track.scaleMin;
+		}
+		else
+		{
+			glm::vec3 from = ReadVector(&m_vectors[(track.scaleOffset + first) * 3], track.scaleMin, track.scaleExtent);
+			glm::vec3 to = ReadVector(&m_vectors[(track.scaleOffset + second) * 3], track.scaleMin, track.scaleExtent);
+			joint.scale = glm::mix(from, to, blend);
+		}
+	}
+}
+
+size_t SkeletalClip::GetBytes() const
+{
+	return m_tracks.size() * sizeof(Track) + m_rotations.size() * sizeof(int16_t) + m_vectors.size() * sizeof(uint16_t);
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <GLM\glm.hpp>
+#include <GLM\gtc\quaternion.hpp>
+
+	/**
+	* @struct JointPose
+	* @brief Transform of a joint relative to its parent
+	*/
+struct JointPose
+{
+	glm::vec3 translation;
+	glm::quat rotation;
+	glm::vec3 scale;
+};
+
+	/**
+	* @class SkeletalClip
+	* @brief An animation of the joints of a skeleton, sampled at a fixed rate with quantized keys
+	*
+	* Assimp gives every channel its own key times, which would need a search per joint to sample.
+	* The channels are instead resampled at a fixed rate when the clip is imported, so sampling
+	* is two lookups and a blend per joint at any time.
+	*
+	* Rotations are stored as four 16 bit normalized integers, translations and scales as three
+	* 16 bit integers over the range the joint moves through in the clip. A key takes 20 bytes
+	* instead of 40 as floats, and a channel that does not move during the clip keeps a single
+	* key, which is most scale channels and the translation of every joint but the root.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class SkeletalClip
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates an empty clip.
+		*
+		* @return null
+		*/
+	SkeletalClip() : m_duration(0.0f), m_sampleCount(0) { }
+
+		/**
+		* @brief Constructor
+		*
+		* Creates a clip of the given length sampled at sampleRate samples per second, the last
+		* sample at the end of the clip.
+		*
+		* @param const std::string& name
+		* @param float duration
+		* @param float sampleRate
+		* @return null
+		*/
+	SkeletalClip(const std::string& name, float duration, float sampleRate);
+
+		/**
+		* @brief Destructor
+		*
+		* Empty destructor.
+		*
+		* @return null
+		*/
+	~SkeletalClip() { }
+
+		/**
+		* @brief Adds the samples of a joint
+		*
+		* Quantizes the poses of the joint at each sample time, GetSampleCount() of them. Joints
+		* without samples keep the pose given to Sample().
+		*
+		* @param int joint
+		* @param const std::vector<JointPose>& samples
+		* @return void
+		*/
+	void AddJoint(int joint, const std::vector<JointPose>& samples);
+
+		/**
+		* @brief Samples the clip
+		*
+		* Writes the pose of every joint the clip animates at the given time, blended between the
+		* two nearest samples, into pose. The time is clamped to the clip.
+		*
+		* @param float time
+		* @param std::vector<JointPose>& pose
+		* @return void
+		*/
+	void Sample(float time, std::vector<JointPose>& pose) const;
+
+		/**
+		* @brief Gets the name of the clip
+		*
+		* @return const std::string&
+		*/
+	const std::string& GetName() const { return m_name; }
+
+		/**
+		* @brief Gets the length of the clip in seconds
+		*
+		* @return float
+		*/
+	float GetDuration() const { return m_duration; }
+
+		/**
+		* @brief Gets the number of samples of each joint
+		*
+		* @return int
+		*/
+	int GetSampleCount() const { return m_sampleCount; }
+
+		/**
+		* @brief Gets the bytes of the quantized keys
+		*
+		* @return size_t
+		*/
+	size_t GetBytes() const;
+
+		/**
+		* @brief Gets the bytes the keys would take as floats
+		*
+		* Every channel of every animated joint at every sample, as the clip was imported.
+		*
+		* @return size_t
+		*/
+	size_t GetUncompressedBytes() const { return m_tracks.size() * m_sampleCount * sizeof(float) * 10; }
+
+private:
+		/**
+		* @struct Track
+		* @brief The keys of one joint
+		*/
+	struct Track
+	{
+		int joint;
+
+		/// Keys of each channel, 1 if the channel does not move during the clip
+		int rotationKeys, translationKeys, scaleKeys;
+
+		/// First key of each channel, in key units of its stream
+		size_t rotationOffset, translationOffset, scaleOffset;
+
+		/// Range the translation and scale keys are quantized over
+		glm::vec3 translationMin, translationExtent, scaleMin, scaleExtent;
+	};
+
+	/// Name of the clip, eg. "walk"
+	std::string m_name;
+
+	/// Length in seconds and samples per joint
+	float m_duration;
+	int m_sampleCount;
+
+	/// Animated joints
+	std::vector<Track> m_tracks;
+
+	/// Rotation keys, four components each
+	std::vector<int16_t> m_rotations;
+
+	/// Translation and scale keys, three components each
+	std::vector<uint16_t> m_vectors;
+};
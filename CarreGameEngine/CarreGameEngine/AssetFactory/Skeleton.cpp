@@ -0,0 +1,190 @@
+#include "Skeleton.h"
+
+int Skeleton::AddJoint(const std::string& name, int parent, const JointPose& bindPose)
+{
+	SkeletonJoint joint;
+	joint.name = name;
+	joint.parent = parent;
+	joint.bindPose = bindPose;
+
+	m_joints.push_back(joint);
+	m_jointBones.push_back(-1);
+
+	return (int)m_joints.size() - 1;
+}
+
+int Skeleton::FindJoint(const std::string& name) const
+{
+	for (size_t i = 0; i < m_joints.size(); i++)
+	{
+		if (m_joints[i].name == name)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+int Skeleton::AddBone(int joint, const glm::mat4& offset)
+{
+	if (m_jointBones[joint] >= 0)
+		return m_jointBones[joint];
+
+	SkinBone bone;
+	bone.joint = joint;
+	bone.offset = offset;
+	m_bones.push_back(bone);
+
+	m_jointBones[joint] = (int)m_bones.size() - 1;
+	return m_jointBones[joint];
+}
+
+int Skeleton::FindBone(int joint) const
+{
+	if (joint < 0 || joint >= (int)m_jointBones.size())
+		return -1;
+
+	return m_jointBones[joint];
+}
+
+int Skeleton::FindClip(const std::string& name) const
+{
+	for (size_t i = 0; i < m_clips.size(); i++)
+	{
+		if (m_clips[i].GetName() == name)
+			return (int)i;
+	}
+
+	return -1;
+}
+
+size_t Skeleton::GetClipBytes() const
+{
+	size_t bytes = 0;
+	for (size_t i = 0; i < m_clips.size(); i++)
+		bytes += m_clips[i].GetBytes();
+
+	return bytes;
+}
+
+size_t Skeleton::GetUncompressedClipBytes() const
+{
+	size_t bytes = 0;
+	for (size_t i = 0; i < m_clips.size(); i++)
+		bytes += m_clips[i].GetUncompressedBytes();
+
+	return bytes;
+}
+
+void Skeleton::Play(SkeletalPlayback& playback, int clip, float fadeSeconds) const
+{
+	if (clip == playback.clip)
+		return;
+
+	// The clip being replaced keeps playing underneath the new one until the fade is over
+	playback.previousClip = -1;
+	if (fadeSeconds > 0.0f && playback.clip >= 0 && playback.clip < (int)m_clips.size())
+	{
+		playback.previousClip = playback.clip;
+		playback.previousTime = playback.time;
+		playback.fade = 0.0f;
+		playback.fadeDuration = fadeSeconds;
+	}
+
+	playback.clip = clip;
+	playback.time = 0.0f;
+}
+
+// Moves a clip time on, wrapped to the length of the clip
+static float AdvanceClipTime(const std::vector<SkeletalClip>& clips, int clip, float time, float seconds)
+{
+	if (clip < 0 || clip >= (int)clips.size())
+		return 0.0f;
+
+	float duration = clips[clip].GetDuration();
+	time += seconds;
+	if (duration > 0.0f)
+	{
+		time = std::fmod(time, duration);
+		if (time < 0.0f)
+			time += duration;
+	}
+
+	return time;
+}
+
+void Skeleton::Advance(SkeletalPlayback& playback, float seconds) const
+{
+	seconds *= playback.speed;
+	playback.time = AdvanceClipTime(m_clips, playback.clip, playback.time, seconds);
+
+	if (playback.previousClip >= 0)
+	{
+		playback.previousTime = AdvanceClipTime(m_clips, playback.previousClip, playback.previousTime, seconds);
+		playback.fade += seconds;
+		if (playback.fade >= playback.fadeDuration)
+			playback.previousClip = -1;
+	}
+}
+
+void Skeleton::GetBindPose(std::vector<JointPose>& joints) const
+{
+	joints.resize(m_joints.size());
+	for (size_t i = 0; i < m_joints.size(); i++)
+		joints[i] = m_joints[i].bindPose;
+}
+
+void Skeleton::Pose(const SkeletalPlayback& playback, SkeletalPose& pose) const
+{
+	// Joints no clip moves stay in the bind pose
+	GetBindPose(pose.current);
+	if (playback.clip >= 0 && playback.clip < (int)m_clips.size())
+		m_clips[playback.clip].Sample(playback.time, pose.current);
+
+	if (playback.previousClip >= 0 && playback.previousClip < (int)m_clips.size() && playback.fadeDuration > 0.0f)
+	{
+		GetBindPose(pose.previous);
+		m_clips[playback.previousClip].Sample(playback.previousTime, pose.previous);
+		BlendPoses(pose.previous, pose.current, std::min(playback.fade / playback.fadeDuration, 1.0f), pose.current);
+	}
+
+	ComputePalette(pose.current, pose.world, pose.palette);
+}
+
+void Skeleton::BlendPoses(const std::vector<JointPose>& from, const std::vector<JointPose>& to, float weight, std::vector<JointPose>& result)
+{
+	result.resize(to.size());
+	for (size_t i = 0; i < to.size(); i++)
+	{
+		// Blended the short way round, then normalized
+		glm::quat target = to[i].rotation;
+		if (glm::dot(from[i].rotation, target) < 0.0f)
+			target = -target;
+
+		result[i].translation = glm::mix(from[i].translation, to[i].translation, weight);
+		result[i].rotation = glm::normalize(from[i].rotation * (1.0f - weight) + target * weight);
+		result[i].scale = glm::mix(from[i].scale, to[i].scale, weight);
+	}
+}
+
+void Skeleton::ComputePalette(const std::vector<JointPose>& joints, std::vector<glm::mat4>& world, std::vector<glm::mat4>& palette) const
+{
+	world.resize(m_joints.size());
+	for (size_t i = 0; i < m_joints.size(); i++)
+	{
+		// Scale, then rotate, then translate
+		const JointPose& joint = joints[i];
+		glm::mat4 local = glm::mat4_cast(joint.rotation);
+		local[0] *= joint.scale.x;
+		local[1] *= joint.scale.y;
+		local[2] *= joint.scale.z;
+		local[3] = glm::vec4(joint.translation, 1.0f);
+
+		// Parents come first, so their transform is already known
+		int parent = m_joints[i].parent;
+		world[i] = (parent >= 0 ? world[parent] : m_rootTransform) * local;
+	}
+
+	palette.resize(m_bones.size());
+	for (size_t i = 0; i < m_bones.size(); i++)
+		palette[i] = world[m_bones[i].joint] * m_bones[i].offset;
+}
@@ -0,0 +1,330 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <GLM\glm.hpp>
+#include <GLM\gtc\quaternion.hpp>
+
+#include "SkeletalClip.h"
+
+	/**
+	* @struct SkeletonJoint
+	* @brief A node of the bone hierarchy
+	*/
+struct SkeletonJoint
+{
+	/// Name of the node in the model file
+	std::string name;
+
+	/// Index of the parent joint, -1 for the root, always lower than the joint's own index
+	int parent;
+
+	/// Transform relative to the parent when no clip moves the joint
+	JointPose bindPose;
+};
+
+	/**
+	* @struct SkinBone
+	* @brief A joint that vertices are skinned to
+	*/
+struct SkinBone
+{
+	/// Joint the bone follows
+	int joint;
+
+	/// Takes a vertex from model space into the space of the joint in the bind pose
+	glm::mat4 offset;
+};
+
+	/**
+	* @struct SkeletalPlayback
+	* @brief The clips a skinned model is playing
+	*
+	* Kept by every model, so models sharing a skeleton animate on their own. While a new clip
+	* fades in, the clip it replaced keeps playing underneath until the fade is over.
+	*/
+struct SkeletalPlayback
+{
+	/// Clip playing and seconds into it, -1 for the bind pose
+	int clip;
+	float time;
+
+	/// Clip fading out and seconds into it, -1 once the fade is over
+	int previousClip;
+	float previousTime;
+
+	/// Seconds into the fade and its length
+	float fade, fadeDuration;
+
+	/// Rate the clips play at, 1 being their own speed
+	float speed;
+};
+
+	/**
+	* @struct SkeletalPose
+	* @brief A posed skeleton
+	*
+	* The working memory of posing a skeleton and its result, kept by every model so posing
+	* allocates nothing once the vectors have grown to the skeleton.
+	*/
+struct SkeletalPose
+{
+	/// Joint transforms of the clip playing and of the clip fading out
+	std::vector<JointPose> current, previous;
+
+	/// Model space transform of every joint
+	std::vector<glm::mat4> world;
+
+	/// Takes bind pose vertices to the pose, one matrix per bone, read by the skinning shader
+	std::vector<glm::mat4> palette;
+};
+
+	/**
+	* @class Skeleton
+	* @brief Bone hierarchy and animation clips of a skinned model
+	*
+	* Assimp imports the bones and animations of a model along with its meshes. The skeleton keeps
+	* the node hierarchy the bones hang off as joints in parent first order, so the model space
+	* transforms are found in a single pass, the bones the vertices are weighted to and the clips
+	* that move the joints.
+	*
+	* Posing samples the clip playing, blends in the clip fading out and writes one matrix per
+	* bone into the palette the vertex shader skins with. It only reads the skeleton, so many
+	* models sharing it are posed on the workers at once.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class Skeleton
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates a skeleton without joints.
+		*
+		* @return null
+		*/
+	Skeleton() : m_rootTransform(1.0f) { }
+
+		/**
+		* @brief Destructor
+		*
+		* Empty destructor.
+		*
+		* @return null
+		*/
+	~Skeleton() { }
+
+		/**
+		* @brief Adds a joint
+		*
+		* Returns the index of the joint. The parent must have been added first.
+		*
+		* @param const std::string& name
+		* @param int parent
+		* @param const JointPose& bindPose
+		* @return int
+		*/
+	int AddJoint(const std::string& name, int parent, const JointPose& bindPose);
+
+		/**
+		* @brief Finds a joint by name
+		*
+		* Returns the index of the joint, or -1 if there is no joint of that name.
+		*
+		* @param const std::string& name
+		* @return int
+		*/
+	int FindJoint(const std::string& name) const;
+
+		/**
+		* @brief Adds a bone
+		*
+		* Makes the joint a bone vertices can be weighted to and returns the index of the bone
+		* in the palette. A joint that is already a bone keeps its index.
+		*
+		* @param int joint
+		* @param const glm::mat4& offset
+		* @return int
+		*/
+	int AddBone(int joint, const glm::mat4& offset);
+
+		/**
+		* @brief Finds the bone of a joint
+		*
+		* Returns the palette index of the joint, or -1 if it is not a bone.
+		*
+		* @param int joint
+		* @return int
+		*/
+	int FindBone(int joint) const;
+
+		/**
+		* @brief Adds a clip
+		*
+		* @param const SkeletalClip& clip
+		* @return void
+		*/
+	void AddClip(const SkeletalClip& clip) { m_clips.push_back(clip); }
+
+		/**
+		* @brief Finds a clip by name
+		*
+		* Returns the index of the clip, or -1 if there is no clip of that name.
+		*
+		* @param const std::string& name
+		* @return int
+		*/
+	int FindClip(const std::string& name) const;
+
+		/**
+		* @brief Sets the root transform
+		*
+		* Sets the transform applied above the root joint, the inverse of the root node's own
+		* transform for imported models, so the pose is in the space of the mesh vertices.
+		*
+		* @param const glm::mat4& rootTransform
+		* @return void
+		*/
+	void SetRootTransform(const glm::mat4& rootTransform) { m_rootTransform = rootTransform; }
+
+		/**
+		* @brief Gets a joint
+		*
+		* @param int joint
+		* @return const SkeletonJoint&
+		*/
+	const SkeletonJoint& GetJoint(int joint) const { return m_joints[joint]; }
+
+		/**
+		* @brief Gets a clip
+		*
+		* @param int clip
+		* @return const SkeletalClip&
+		*/
+	const SkeletalClip& GetClip(int clip) const { return m_clips[clip]; }
+
+		/**
+		* @brief Gets the number of joints
+		*
+		* @return int
+		*/
+	int GetJointCount() const { return (int)m_joints.size(); }
+
+		/**
+		* @brief Gets the number of bones
+		*
+		* @return int
+		*/
+	int GetBoneCount() const { return (int)m_bones.size(); }
+
+		/**
+		* @brief Gets the number of clips
+		*
+		* @return int
+		*/
+	int GetClipCount() const { return (int)m_clips.size(); }
+
+		/**
+		* @brief Gets the bytes of the quantized clips
+		*
+		* @return size_t
+		*/
+	size_t GetClipBytes() const;
+
+		/**
+		* @brief Gets the bytes the clips would take as floats
+		*
+		* @return size_t
+		*/
+	size_t GetUncompressedClipBytes() const;
+
+		/**
+		* @brief Plays a clip
+		*
+		* Starts the clip from its beginning, fading it in over fadeSeconds while the clip it
+		* replaces fades out. Playing the clip already playing does nothing.
+		*
+		* @param SkeletalPlayback& playback
+		* @param int clip
+		* @param float fadeSeconds
+		* @return void
+		*/
+	void Play(SkeletalPlayback& playback, int clip, float fadeSeconds) const;
+
+		/**
+		* @brief Advances a playback
+		*
+		* Moves the clips of the playback on by the given seconds, looping them, and ends the fade
+		* once it is over.
+		*
+		* @param SkeletalPlayback& playback
+		* @param float seconds
+		* @return void
+		*/
+	void Advance(SkeletalPlayback& playback, float seconds) const;
+
+		/**
+		* @brief Poses the skeleton
+		*
+		* Samples the clips of the playback, blends them and computes the palette of the pose.
+		*
+		* @param const SkeletalPlayback& playback
+		* @param SkeletalPose& pose
+		* @return void
+		*/
+	void Pose(const SkeletalPlayback& playback, SkeletalPose& pose) const;
+
+		/**
+		* @brief Blends two poses
+		*
+		* Sets result to from moved weight of the way to to, joint by joint. result may be either
+		* of the poses.
+		*
+		* @param const std::vector<JointPose>& from
+		* @param const std::vector<JointPose>& to
+		* @param float weight
+		* @param std::vector<JointPose>& result
+		* @return void
+		*/
+	static void BlendPoses(const std::vector<JointPose>& from, const std::vector<JointPose>& to, float weight, std::vector<JointPose>& result);
+
+		/**
+		* @brief Computes the palette of a pose
+		*
+		* Finds the model space transform of every joint from the joint transforms of the pose,
+		* then the palette matrix of every bone.
+		*
+		* @param const std::vector<JointPose>& joints
+		* @param std::vector<glm::mat4>& world
+		* @param std::vector<glm::mat4>& palette
+		* @return void
+		*/
+	void ComputePalette(const std::vector<JointPose>& joints, std::vector<glm::mat4>& world, std::vector<glm::mat4>& palette) const;
+
+private:
+		/**
+		* @brief Sets a pose to the bind pose
+		*
+		* @param std::vector<JointPose>& joints
+		* @return void
+		*/
+	void GetBindPose(std::vector<JointPose>& joints) const;
+
+	/// Joints in parent first order
+	std::vector<SkeletonJoint> m_joints;
+
+	/// Joints vertices are weighted to, in palette order
+	std::vector<SkinBone> m_bones;
+
+	/// Palette index of each joint, -1 for joints that are not bones
+	std::vector<int> m_jointBones;
+
+	/// Animations of the joints
+	std::vector<SkeletalClip> m_clips;
+
+	/// Transform above the root joint
+	glm::mat4 m_rootTransform;
+};
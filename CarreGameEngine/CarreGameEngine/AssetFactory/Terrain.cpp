@@ -10,4 +10,74 @@ Terrain::Terrain(float scaleX, float scaleY, float scaleZ)
 	: m_scaleX(scaleX), m_scaleY(scaleY), m_scaleZ(scaleZ), m_heightfieldSize(0)
 {
 	m_terrainModel = new Model();
-}
\ No newline at end of file
+}
+
+Texture Terrain::AddTexture(GLuint textureId, std::string textureFilePath)
+{
+	Texture temp;
+
+	temp.m_id = textureId;
+	temp.m_path = textureFilePath;
+	temp.m_type = "texture_diffuse";
+	// Released with the rest of the terrain model textures
+	temp.m_handle = TextureManager::Instance().AcquireTexture(textureFilePath);
+
+	return temp;
+}
+
+bool Terrain::LoadHeightfield(std::string fileName, const int size, int bitDepth)
+{
+	// Mapped rather than read, the samples are paged in as the terrain touches them
+	if (!m_heightfield.Open(fileName, size, bitDepth))
+		return false;
+
+	m_heightfieldSize = m_heightfield.GetSize();
+	if (size > 0 && size != m_heightfieldSize)
+		std::cout << "Heightfield " << fileName << " is " << m_heightfieldSize << "x" << m_heightfieldSize << ", not " << size << "x" << size << std::endl;
+
+	std::cout << "Heightfield Load Successful! " << m_heightfieldSize << "x" << m_heightfieldSize << ", " << m_heightfield.GetBitDepth()
+		<< "-bit" << (m_heightfield.IsTiled() ? ", tiled" : "") << std::endl;
+	
+	return true;
+}
+
+bool Terrain::Inbounds(int xpos, int zpos)
+{
+	if ((xpos >= 0 && xpos < m_heightfieldSize * m_scaleX) && (zpos >= 0 && zpos < m_heightfieldSize * m_scaleZ))
+		return true;
+	else
+		return false;
+}
+
+float Terrain::GetHeight(int xpos, int zpos)
+{
+	// Samples outside the heightfield are clamped to its edge
+	return m_heightfield.GetSample(xpos, zpos) * m_scaleY;
+}
+
+float Terrain::GetSampleHeight(int xpos, int zpos)
+{
+	// Clamped to the edge of the heightfield by the source
+	return m_heightfield.GetSample(xpos, zpos) * m_scaleY;
+}
+
+unsigned char Terrain::GetHeightColour(int xpos, int zpos)
+{
+	if (Inbounds(xpos, zpos))
+	{
+		return (unsigned char)m_heightfield.GetSample(xpos, zpos);
+	}
+	return 1;
+}
+
+float Terrain::GetAverageHeight(int xpos, int zpos)
+{
+	if (Inbounds(xpos, zpos))
+	{
+		return m_heightfield.GetSample((int)(xpos / m_scaleX), (int)(zpos / m_scaleZ)) * m_scaleY;
+	}
+	return 1;
+}
+
+
+
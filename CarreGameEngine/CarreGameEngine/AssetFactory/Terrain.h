@@ -5,7 +5,9 @@
 #include <string>
 
 #include "Model.h"
+#include "HeightfieldSource.h"
 #include "..\Texture\TextureManager.h"
+#include "..\Renderer\OpenGl.h"
 
 	/**
 	* @class Terrain
@@ -37,11 +39,11 @@ public:
 		/**
 		* @brief Destructor
 		*
-		* Empty default destructor.
+		* Empty destructor, the heightfield file is unmapped by its source.
 		*
 		* @return null
 		*/
-	~Terrain() { }
+	virtual ~Terrain() { }
 
 		/**
 		* @brief Constructor
@@ -65,6 +67,144 @@ public:
 		*/
 	virtual void GenerateTerrain(GLuint textureId, std::string textureFilePath) = 0;
 
+		/**
+		* @brief Prepares the terrain for rendering
+		*
+		* Uploads the terrain to the GPU. By default the terrain model is prepared by the renderer
+		* like any other model, terrains that manage their own buffers override this.
+		*
+		* @param OpenGl& renderer
+		* @param Shader* shader
+		* @return void
+		*/
+	virtual void Prepare(OpenGl& renderer, Shader* shader) { renderer.Prepare(m_terrainModel, shader); }
+
+		/**
+		* @brief Renders the terrain
+		*
+		* Renders the terrain using the renderer given. By default the terrain model is rendered
+		* like any other model.
+		*
+		* @param OpenGl& renderer
+		* @return void
+		*/
+	virtual void Render(OpenGl& renderer) { renderer.Render(m_terrainModel); }
+
+		/**
+		* @brief Gets the terrain shader defines
+		*
+		* Returns the defines the terrain shader must be built with for this terrain method.
+		*
+		* @return std::string
+		*/
+	virtual std::string GetShaderDefines() const { return ""; }
+
+		/**
+		* @brief Loads the heightfield data
+		*
+		* Takes the relative path to the file that is the .raw image that is to be used
+		* for the heightfield data. It also takes the images size which should be a power
+		* of 2 (eg. 128x128 or 32x32). Returns true if created successfully, false if not.
+		*
+		* The file is memory mapped by a HeightfieldSource rather than read, so it may be an 8 or
+		* 16-bit raw file or a tiled heightfield. A bitDepth of 0 takes it from the file size.
+		*
+		* @param std::string fileName
+		* @param const int size
+		* @param int bitDepth
+		* @return bool
+		*/
+	bool LoadHeightfield(std::string fileName, const int size, int bitDepth = 0);
+
+		/**
+		* @brief Gets the heightfield
+		*
+		* Returns the source the heightfield samples are read from.
+		*
+		* @return const HeightfieldSource&
+		*/
+	const HeightfieldSource& GetHeightfield() const { return m_heightfield; }
+
+		/**
+		* @brief Gets the heightfield scale
+		*
+		* Returns the distance between samples along x and z, and the height of one 8-bit unit.
+		*
+		* @return glm::vec3
+		*/
+	glm::vec3 GetHeightfieldScale() const { return glm::vec3(m_scaleX, m_scaleY, m_scaleZ); }
+
+		/**
+		* @brief Adds texture to mesh
+		*
+		* Creates a temporary texture and returns it.
+		*
+		* @param GLuint textureId
+		* @param std::string filePath
+		* @return Texture
+		*/
+	Texture AddTexture(GLuint textureId, std::string filePath);
+
+		/**
+		* @brief Checks if inbounds
+		*
+		* Checks if the parameter positions given are within that of the terrain.
+		* Returns true if it is, false if not.
+		*
+		* @param int xpos
+		* @param int ypos
+		* @return bool
+		*/
+	bool Inbounds(int xpos, int zpos);
+
+		/**
+		* @brief Gets the height of the terrain
+		*
+		* Returns the height value y of the terrain at the corresponding parameters 
+		* given x and z values.
+		*
+		* @param int xpos
+		* @param int ypos
+		* @return float
+		*/
+	float GetHeight(int xpos, int zpos);
+
+		/**
+		* @brief Gets the height of a heightfield sample
+		*
+		* Returns the scaled height of the heightfield sample at the given x and z sample
+		* indices. Indices outside of the heightfield are clamped to its edge.
+		*
+		* @param int xpos
+		* @param int zpos
+		* @return float
+		*/
+	float GetSampleHeight(int xpos, int zpos);
+
+		/**
+		* @brief Gets the colour at a specific height
+		*
+		* Returns the height value y of the terrain at the corresponding parameters
+		* given x and z values to be used in determining the colour of the vertex.
+		*
+		* @param int xpos
+		* @param int ypos
+		* @return unsigned char
+		*/
+	unsigned char GetHeightColour(int xpos, int zpos);
+
+		/**
+		* @brief Gets the average height
+		*
+		* Returns the y value of the x and z position parsed in as parameters. This
+		* function is used for terrain collision.
+		*
+		* @param int xpos
+		* @param int ypos
+		* @return float
+		*/
+	float GetAverageHeight(int xpos, int zpos);
+
 		/**
 		* @brief Sets the camera object
 		*
@@ -107,7 +247,10 @@ public:
 	
 protected:
 	Model* m_terrainModel;
-	unsigned char* m_terrainData;
+
+	/// Mapped heightfield samples
+	HeightfieldSource m_heightfield;
+
 	float m_scaleX, m_scaleY, m_scaleZ;
 	int m_heightfieldSize;
 
@@ -0,0 +1,70 @@
+#include "AllocationCounter.h"
+
+#ifdef CARRE_COUNT_ALLOCATIONS
+
+#include <cstdlib>
+#include <new>
+#include <atomic>
+
+/// Allocations and bytes counted by the replaced operator new
+static std::atomic<size_t> s_allocationCount(0);
+static std::atomic<size_t> s_allocationBytes(0);
+
+void* operator new(size_t size)
+{
+	s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+	s_allocationBytes.fetch_add(size, std::memory_order_relaxed);
+
+	void* memory = malloc(size ? size : 1);
+	if (!memory)
+		throw std::bad_alloc();
+
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	free(memory);
+}
+
+bool IsCountingAllocations()
+{
+	return true;
+}
+
+AllocationStats GetAllocationStats()
+{
+	AllocationStats stats;
+	stats.count = s_allocationCount.load(std::memory_order_relaxed);
+	stats.bytes = s_allocationBytes.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
+#else
+
+bool IsCountingAllocations()
+{
+	return false;
+}
+
+AllocationStats GetAllocationStats()
+{
+	AllocationStats stats;
+	stats.count = 0;
+	stats.bytes = 0;
+
+	return stats;
+}
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+	/**
+	* @struct AllocationStats
+	* @brief Heap allocations made through operator new since the program started
+	*/
+struct AllocationStats
+{
+	/// Number of allocations
+	size_t count;
+
+	/// Bytes requested by the allocations
+	size_t bytes;
+};
+
+	/**
+	* @brief Checks if allocations are counted
+	*
+	* Allocations are only counted in builds with CARRE_COUNT_ALLOCATIONS defined, which replaces
+	* the global operator new of the engine. Memory allocated inside the Assimp and Bullet
+	* libraries is not seen.
+	*
+	* @return bool
+	*/
+bool IsCountingAllocations();
+
+	/**
+	* @brief Gets the allocation statistics
+	*
+	* Returns the allocations made on every thread so far. Take the difference of two calls to
+	* measure a piece of code. Returns zeros if allocations are not counted.
+	*
+	* @return AllocationStats
+	*/
+AllocationStats GetAllocationStats();
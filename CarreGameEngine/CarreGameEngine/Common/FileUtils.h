@@ -0,0 +1,140 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdint>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+	/**
+	* @brief Hashes a block of memory
+	*
+	* Computes a 64 bit FNV-1a hash of the given bytes. The seed parameter allows hashes to be
+	* chained together so several strings or blobs can be combined into one key.
+	*
+	* @param const void* data
+	* @param size_t size
+	* @param uint64_t seed
+	* @return uint64_t
+	*/
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ULL)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = seed;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+	/**
+	* @brief Hashes a string
+	*
+	* Convenience overload of HashBytes() for std::string.
+	*
+	* @param const std::string& text
+	* @param uint64_t seed
+	* @return uint64_t
+	*/
+inline uint64_t HashString(const std::string& text, uint64_t seed = 14695981039346656037ULL)
+{
+	return HashBytes(text.data(), text.size(), seed);
+}
+
+	/**
+	* @brief Converts a hash to a file name friendly string
+	*
+	* Returns the hash as a 16 character hexadecimal string.
+	*
+	* @param uint64_t hash
+	* @return std::string
+	*/
+inline std::string HashToString(uint64_t hash)
+{
+	std::stringstream ss;
+	ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+
+	return ss.str();
+}
+
+	/**
+	* @brief Checks if a file exists
+	*
+	* Returns true if the file at the given path can be found on disk.
+	*
+	* @param const std::string& filePath
+	* @return bool
+	*/
+inline bool FileExists(const std::string& filePath)
+{
+	struct stat info;
+
+	return stat(filePath.c_str(), &info) == 0;
+}
+
+	/**
+	* @brief Creates a directory
+	*
+	* Creates every directory along the given path that does not already exist. Returns
+	* true if the directory exists once the function has finished.
+	*
+	* @param const std::string& directory
+	* @return bool
+	*/
+inline bool MakeDirectory(const std::string& directory)
+{
+	for (size_t i = 1; i <= directory.size(); i++)
+	{
+		if (i != directory.size() && directory[i] != '/' && directory[i] != '\\')
+			continue;
+
+		std::string partial = directory.substr(0, i);
+		if (FileExists(partial))
+			continue;
+
+#ifdef _WIN32
+		_mkdir(partial.c_str());
+#else
+		mkdir(partial.c_str(), 0755);
+#endif
+	}
+
+	return FileExists(directory);
+}
+
+	/**
+	* @brief Reads a whole file
+	*
+	* Reads the file at the given path into a byte vector. Returns false if the file could
+	* not be opened.
+	*
+	* @param const std::string& filePath
+	* @param std::vector<char>& data
+	* @return bool
+	*/
+inline bool ReadFileBytes(const std::string& filePath, std::vector<char>& data)
+{
+	std::ifstream infile(filePath.c_str(), std::ios::binary);
+	if (!infile)
+		return false;
+
+	infile.seekg(0, std::ios::end);
+	std::streamoff length = infile.tellg();
+	infile.seekg(0, std::ios::beg);
+
+	data.resize((size_t)length);
+	if (length > 0)
+		infile.read(&data[0], length);
+
+	return !infile.fail();
+}
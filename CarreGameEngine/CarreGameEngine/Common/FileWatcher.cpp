@@ -0,0 +1,154 @@
+#include "FileWatcher.h"
+
+/// Seconds between checks of every file when the operating system cannot report changes
+static const double POLL_INTERVAL = 0.25;
+
+/// Seconds a file must go unchanged before the change is reported
+static const double SETTLE_TIME = 0.1;
+
+FileWatcher::FileWatcher()
+	: m_lastPoll(0.0)
+{
+#ifdef __linux__
+	m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_inotify < 0)
+		std::cout << "inotify unavailable, polling watched files" << std::endl;
+#endif
+}
+
+FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+	if (m_inotify >= 0)
+		close(m_inotify);
+#endif
+}
+
+bool FileWatcher::ReadState(const std::string& filePath, time_t& modified, long long& size)
+{
+	struct stat info;
+	if (stat(filePath.c_str(), &info) != 0)
+		return false;
+
+	modified = info.st_mtime;
+	size = (long long)info.st_size;
+
+	return true;
+}
+
+void FileWatcher::Watch(const std::string& filePath)
+{
+	if (filePath.empty() || IsWatching(filePath))
+		return;
+
+	WatchedFile file;
+	file.path = filePath;
+	file.modified = 0;
+	file.size = -1;
+	ReadState(filePath, file.modified, file.size);
+	file.pending = false;
+	file.changedTime = 0.0;
+	file.pendingModified = file.modified;
+	file.pendingSize = file.size;
+	file.notified = false;
+
+	m_lookup[filePath] = m_files.size();
+	m_files.push_back(file);
+
+#ifdef __linux__
+	if (m_inotify < 0)
+		return;
+
+	// The directory is watched, editors often replace the file instead of writing to it
+	size_t slash = filePath.find_last_of("/\\");
+	std::string directory = slash == std::string::npos ? "." : filePath.substr(0, slash);
+	int watch = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (watch >= 0)
+		m_directories[watch] = directory;
+#endif
+}
+
+void FileWatcher::MarkChanged(WatchedFile& file, double time)
+{
+	file.pending = true;
+	file.changedTime = time;
+	ReadState(file.path, file.pendingModified, file.pendingSize);
+}
+
+void FileWatcher::Poll(double time, std::vector<std::string>& changed)
+{
+	if (m_files.empty())
+		return;
+
+	bool polled = false;
+
+#ifdef __linux__
+	if (m_inotify >= 0)
+	{
+		// Events are read until the queue is empty, the descriptor never blocks
+		char buffer[4096];
+		ssize_t length;
+		while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0)
+		{
+			for (char* event = buffer; event < buffer + length; )
+			{
+				const inotify_event* notification = reinterpret_cast<const inotify_event*>(event);
+				event += sizeof(inotify_event) + notification->len;
+
+				std::unordered_map<int, std::string>::iterator directory = m_directories.find(notification->wd);
+				if (notification->len == 0 || directory == m_directories.end())
+					continue;
+
+				std::string path = directory->second == "." ? notification->name : directory->second + "/" + notification->name;
+				std::unordered_map<std::string, size_t>::iterator it = m_lookup.find(path);
+				if (it == m_lookup.end())
+					continue;
+
+				MarkChanged(m_files[it->second], time);
+				m_files[it->second].notified = true;
+			}
+		}
+
+		polled = true;
+	}
+#endif
+
+	if (!polled && time - m_lastPoll >= POLL_INTERVAL)
+	{
+		m_lastPoll = time;
+		for (size_t i = 0; i < m_files.size(); i++)
+		{
+			WatchedFile& file = m_files[i];
+			time_t modified;
+			long long size;
+			if (!file.pending && ReadState(file.path, modified, size) && (modified != file.modified || size != file.size))
+				MarkChanged(file, time);
+		}
+	}
+
+	for (size_t i = 0; i < m_files.size(); i++)
+	{
+		WatchedFile& file = m_files[i];
+		if (!file.pending || time - file.changedTime < SETTLE_TIME)
+			continue;
+
+		// Still being written, wait for it to settle again
+		time_t modified;
+		long long size;
+		if (!ReadState(file.path, modified, size))
+			continue;
+		if (modified != file.pendingModified || size != file.pendingSize)
+		{
+			MarkChanged(file, time);
+			continue;
+		}
+
+		if (file.notified || modified != file.modified || size != file.size)
+			changed.push_back(file.path);
+
+		file.modified = modified;
+		file.size = size;
+		file.pending = false;
+		file.notified = false;
+	}
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <ctime>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
+
+	/**
+	* @class FileWatcher
+	* @brief Reports files that have changed on disk
+	*
+	* Files are watched by path. On Linux the directories of the watched files are watched with
+	* inotify, so nothing is read from disk until a file is written. Elsewhere the modification
+	* time and size of every watched file are checked a few times a second, which costs one stat
+	* per file.
+	*
+	* Editors write a file in several steps, or write a copy and rename it over the original,
+	* so a change is only reported once the file has stopped changing for a moment, and only
+	* once however many writes it took.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class FileWatcher
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates a watcher with no files.
+		*
+		* @return null
+		*/
+	FileWatcher();
+
+		/**
+		* @brief Destructor
+		*
+		* Stops watching every file.
+		*
+		* @return null
+		*/
+	~FileWatcher();
+
+		/**
+		* @brief Watches a file
+		*
+		* Files already watched are ignored. The file does not need to exist yet.
+		*
+		* @param const std::string& filePath
+		* @return void
+		*/
+	void Watch(const std::string& filePath);
+
+		/**
+		* @brief Checks if a file is watched
+		*
+		* @param const std::string& filePath
+		* @return bool
+		*/
+	bool IsWatching(const std::string& filePath) const { return m_lookup.find(filePath) != m_lookup.end(); }
+
+		/**
+		* @brief Gets the number of files watched
+		*
+		* @return int
+		*/
+	int GetWatchCount() const { return (int)m_files.size(); }
+
+		/**
+		* @brief Finds the changed files
+		*
+		* Adds the watched files that have changed and settled since the last call to changed,
+		* with the path they were watched by. Called once per frame with the current time in
+		* seconds.
+		*
+		* @param double time
+		* @param std::vector<std::string>& changed
+		* @return void
+		*/
+	void Poll(double time, std::vector<std::string>& changed);
+
+private:
+		/**
+		* @struct WatchedFile
+		* @brief A file being watched and the last state of it that was reported
+		*/
+	struct WatchedFile
+	{
+		std::string path;
+
+		/// Modification time and size of the file when it was last reported
+		time_t modified;
+		long long size;
+
+		/// Set from a change until the file settles
+		bool pending;
+
+		/// Last time the file was seen changing, and its state then
+		double changedTime;
+		time_t pendingModified;
+		long long pendingSize;
+
+		/// The change came from the operating system, so it is reported even if the state matches
+		bool notified;
+	};
+
+		/**
+		* @brief Reads the modification time and size of a file
+		*
+		* Returns false if the file does not exist.
+		*
+		* @param const std::string& filePath
+		* @param time_t& modified
+		* @param long long& size
+		* @return bool
+		*/
+	static bool ReadState(const std::string& filePath, time_t& modified, long long& size);
+
+		/**
+		* @brief Marks a file as changing
+		*
+		* @param WatchedFile& file
+		* @param double time
+		* @return void
+		*/
+	void MarkChanged(WatchedFile& file, double time);
+
+	/// Watched files, and their index by path
+	std::vector<WatchedFile> m_files;
+	std::unordered_map<std::string, size_t> m_lookup;
+
+	/// Time the files were last checked without inotify
+	double m_lastPoll;
+
+#ifdef __linux__
+	/// inotify instance, -1 if it could not be created
+	int m_inotify;
+
+	/// Directory of each inotify watch
+	std::unordered_map<int, std::string> m_directories;
+#endif
+};
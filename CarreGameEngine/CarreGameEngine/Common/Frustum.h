@@ -0,0 +1,113 @@
+#pragma once
+
+#include <GLM\glm.hpp>
+
+	/**
+	* @class Frustum
+	* @brief View frustum used for visibility culling
+	*
+	* Holds the six planes of a view frustum extracted from a combined projection * view (* model)
+	* matrix. If a model matrix is included in the combined matrix the planes are in that model's
+	* local space, so local space bounding boxes can be tested directly.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class Frustum
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates a frustum whose planes accept everything until Extract() is called.
+		*
+		* @return null
+		*/
+	Frustum()
+	{
+		for (int i = 0; i < 6; i++)
+			m_planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+		/**
+		* @brief Extracts the frustum planes
+		*
+		* Extracts the left, right, bottom, top, near and far planes from the combined matrix
+		* given. Plane normals point into the frustum and are normalized.
+		*
+		* @param const glm::mat4& matrix
+		* @return void
+		*/
+	void Extract(const glm::mat4& matrix)
+	{
+		// GLM matrices are column major, so matrix[column][row]
+		glm::vec4 row0(matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]);
+		glm::vec4 row1(matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]);
+		glm::vec4 row2(matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]);
+		glm::vec4 row3(matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]);
+
+		m_planes[0] = row3 + row0; // Left
+		m_planes[1] = row3 - row0; // Right
+		m_planes[2] = row3 + row1; // Bottom
+		m_planes[3] = row3 - row1; // Top
+		m_planes[4] = row3 + row2; // Near
+		m_planes[5] = row3 - row2; // Far
+
+		for (int i = 0; i < 6; i++)
+		{
+			float length = glm::length(glm::vec3(m_planes[i]));
+			if (length > 0.0f)
+				m_planes[i] /= length;
+		}
+	}
+
+		/**
+		* @brief Tests an axis aligned bounding box
+		*
+		* Returns false if the box is completely outside of any frustum plane, true if it is
+		* inside or intersecting the frustum.
+		*
+		* @param const glm::vec3& boxMin
+		* @param const glm::vec3& boxMax
+		* @return bool
+		*/
+	bool IsBoxVisible(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			// Corner of the box furthest along the plane normal
+			glm::vec3 positive(m_planes[i].x > 0.0f ? boxMax.x : boxMin.x,
+				m_planes[i].y > 0.0f ? boxMax.y : boxMin.y,
+				m_planes[i].z > 0.0f ? boxMax.z : boxMin.z);
+
+			if (glm::dot(glm::vec3(m_planes[i]), positive) + m_planes[i].w < 0.0f)
+				return false;
+		}
+
+		return true;
+	}
+
+		/**
+		* @brief Tests a bounding sphere
+		*
+		* Returns false if the sphere is completely outside of any frustum plane.
+		*
+		* @param const glm::vec3& centre
+		* @param float radius
+		* @return bool
+		*/
+	bool IsSphereVisible(const glm::vec3& centre, float radius) const
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			if (glm::dot(glm::vec3(m_planes[i]), centre) + m_planes[i].w < -radius)
+				return false;
+		}
+
+		return true;
+	}
+
+private:
+	/// Left, right, bottom, top, near and far planes as (normal, distance)
+	glm::vec4 m_planes[6];
+};
@@ -0,0 +1,120 @@
+#include "JobSystem.h"
+
+void JobSystem::Start(unsigned int workerCount)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_workers.empty())
+		return;
+
+	if (workerCount == 0)
+	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	m_stopping = false;
+	for (unsigned int i = 0; i < workerCount; i++)
+		m_workers.push_back(std::thread(&JobSystem::WorkerLoop, this));
+}
+
+void JobSystem::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_condition.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+		m_workers[i].join();
+	m_workers.clear();
+}
+
+void JobSystem::Submit(const Job& job, JobCounter* counter, JobCounter* dependency)
+{
+	if (m_workers.empty())
+		Start();
+
+	if (counter)
+		counter->pending++;
+
+	QueuedJob queued;
+	queued.job = job;
+	queued.counter = counter;
+	queued.dependency = dependency;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queue.push_back(queued);
+	}
+	m_condition.notify_one();
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	while (counter.pending > 0)
+	{
+		// Help with the jobs being waited on rather than sitting idle
+		QueuedJob queued;
+		bool haveJob = false;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			haveJob = TakeRunnableJob(queued, &counter);
+		}
+
+		if (haveJob)
+			RunJob(queued);
+		else
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::WorkerLoop()
+{
+	while (true)
+	{
+		QueuedJob queued;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			bool haveJob = false;
+			m_condition.wait(lock, [this, &queued, &haveJob]
+			{
+				haveJob = TakeRunnableJob(queued);
+				return haveJob || (m_stopping && m_queue.empty());
+			});
+
+			// Queued jobs are still finished when stopping
+			if (!haveJob)
+				return;
+		}
+
+		RunJob(queued);
+	}
+}
+
+bool JobSystem::TakeRunnableJob(QueuedJob& queued, const JobCounter* counter)
+{
+	for (std::deque<QueuedJob>::iterator itr = m_queue.begin(); itr != m_queue.end(); itr++)
+	{
+		if ((counter && itr->counter != counter) || (itr->dependency && itr->dependency->pending > 0))
+			continue;
+
+		queued = *itr;
+		m_queue.erase(itr);
+		return true;
+	}
+
+	return false;
+}
+
+void JobSystem::RunJob(QueuedJob& queued)
+{
+	queued.job();
+
+	if (queued.counter && --queued.counter->pending == 0)
+	{
+		// Jobs depending on the counter can start, the lock keeps a worker from missing the wake up
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_condition.notify_all();
+	}
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+	/**
+	* @struct JobCounter
+	* @brief Counts the unfinished jobs of a group so they can be waited on together
+	*/
+struct JobCounter
+{
+	JobCounter() : pending(0) { }
+
+	/// Jobs submitted with this counter that have not finished
+	std::atomic<int> pending;
+};
+
+	/**
+	* @class JobSystem
+	* @brief Pool of worker threads that run jobs in the background
+	*
+	* Jobs are functions that are run on one of the worker threads in the order they were
+	* submitted. Jobs must not make OpenGL calls, as the context is only current on the main
+	* thread, so work such as decoding is done in a job and its result handed back to the main
+	* thread to be uploaded.
+	*
+	* A job may depend on the jobs of a counter, it is only run once they have all finished, so
+	* work such as building a mesh from a file that is read by another job can be queued up
+	* front as a graph and run as soon as its inputs are ready.
+	*
+	* The workers are started the first time a job is submitted, one per hardware thread minus
+	* the main thread, unless Start() was called first.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class JobSystem
+{
+public:
+		/**
+		* @brief Job function type
+		*/
+	typedef std::function<void()> Job;
+
+		/**
+		* @brief Singleton instance
+		*
+		* This function returns a singleton instance of the job system class so that there is only
+		* one pool of worker threads.
+		*
+		* @return static JobSystem&
+		*/
+	static JobSystem& Instance()
+	{
+		static JobSystem instance;
+
+		return instance;
+	}
+
+		/**
+		* @brief Starts the worker threads
+		*
+		* Starts the given number of worker threads, or one per hardware thread minus one if
+		* workerCount is 0. Does nothing if the workers are already running.
+		*
+		* @param unsigned int workerCount
+		* @return void
+		*/
+	void Start(unsigned int workerCount = 0);
+
+		/**
+		* @brief Stops the worker threads
+		*
+		* Waits for the jobs already queued to finish, then joins every worker thread.
+		*
+		* @return void
+		*/
+	void Stop();
+
+		/**
+		* @brief Submits a job
+		*
+		* Queues a job to be run on a worker thread. If a counter is given it is incremented
+		* now and decremented once the job has finished. If a dependency is given the job is
+		* not started until every job submitted with that counter has finished. Queued jobs
+		* without unfinished dependencies are run in the order they were submitted.
+		*
+		* @param const Job& job
+		* @param JobCounter* counter
+		* @param JobCounter* dependency
+		* @return void
+		*/
+	void Submit(const Job& job, JobCounter* counter = NULL, JobCounter* dependency = NULL);
+
+		/**
+		* @brief Waits for a group of jobs
+		*
+		* Blocks until every job submitted with the counter has finished. The calling thread
+		* runs the queued jobs of that counter while it waits instead of sleeping, but never the
+		* jobs of other counters, so a wait in the frame cannot pick up a long background job
+		* such as streaming a model in.
+		*
+		* @param JobCounter& counter
+		* @return void
+		*/
+	void Wait(JobCounter& counter);
+
+		/**
+		* @brief Gets the number of worker threads
+		*
+		* @return unsigned int
+		*/
+	unsigned int GetWorkerCount() const { return (unsigned int)m_workers.size(); }
+
+private:
+		/**
+		* @struct QueuedJob
+		* @brief A job waiting to be run, the counter it belongs to and the counter it waits for
+		*/
+	struct QueuedJob
+	{
+		Job job;
+		JobCounter* counter;
+		JobCounter* dependency;
+	};
+
+		/**
+		* @brief Default constructor
+		*
+		* Creates the job system without starting any workers.
+		*
+		* @return null
+		*/
+	JobSystem() : m_stopping(false) { }
+
+		/**
+		* @brief Destructor
+		*
+		* Stops the worker threads.
+		*
+		* @return null
+		*/
+	~JobSystem() { Stop(); }
+
+		/**
+		* @brief Worker thread loop
+		*
+		* Runs queued jobs until the job system is stopped.
+		*
+		* @return void
+		*/
+	void WorkerLoop();
+
+		/**
+		* @brief Takes the first job that can run
+		*
+		* Removes the oldest queued job whose dependency has finished from the queue, only
+		* looking at the jobs of the given counter unless it is NULL. Returns false if there is
+		* none. Must be called with the queue locked.
+		*
+		* @param QueuedJob& queued
+		* @param const JobCounter* counter
+		* @return bool
+		*/
+	bool TakeRunnableJob(QueuedJob& queued, const JobCounter* counter = NULL);
+
+		/**
+		* @brief Runs a queued job
+		*
+		* Runs the job and marks it finished on its counter, waking the workers when that
+		* releases the jobs depending on it.
+		*
+		* @param QueuedJob& queued
+		* @return void
+		*/
+	void RunJob(QueuedJob& queued);
+
+	/// Worker threads
+	std::vector<std::thread> m_workers;
+
+	/// Jobs waiting to be run
+	std::deque<QueuedJob> m_queue;
+
+	/// Guards the queue
+	std::mutex m_mutex;
+
+	/// Signalled when a job is queued, a counter finishes or the workers should stop
+	std::condition_variable m_condition;
+
+	/// Set when the workers should exit
+	bool m_stopping;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+	/**
+	* @class MappedFile
+	* @brief A read only file mapped into memory
+	*
+	* Reading a file into a vector copies every byte through the C runtime before it can be used.
+	* A mapped file is paged in by the operating system as it is touched, so large blobs can be
+	* handed straight to the GPU or hashed without an extra copy, and files that are read again
+	* come from the page cache.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class MappedFile
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates a mapped file with nothing open.
+		*
+		* @return null
+		*/
+	MappedFile();
+
+		/**
+		* @brief Destructor
+		*
+		* Closes the file.
+		*
+		* @return null
+		*/
+	~MappedFile() { Close(); }
+
+		/**
+		* @brief Opens a file
+		*
+		* Maps the whole file read only, closing any file already open. Returns false if the file
+		* cannot be opened or is empty.
+		*
+		* @param const std::string& filePath
+		* @return bool
+		*/
+	bool Open(const std::string& filePath);
+
+		/**
+		* @brief Closes the file
+		*
+		* Unmaps the file, every pointer into it becomes invalid.
+		*
+		* @return void
+		*/
+	void Close();
+
+		/**
+		* @brief Checks if a file is open
+		*
+		* @return bool
+		*/
+	bool IsOpen() const { return m_data != NULL; }
+
+		/**
+		* @brief Gets the contents of the file
+		*
+		* @return const unsigned char*
+		*/
+	const unsigned char* GetData() const { return m_data; }
+
+		/**
+		* @brief Gets the size of the file
+		*
+		* @return size_t
+		*/
+	size_t GetSize() const { return m_size; }
+
+private:
+	/// Start of the mapping and its size
+	const unsigned char* m_data;
+	size_t m_size;
+
+#ifdef _WIN32
+	/// File and file mapping handles
+	void* m_file;
+	void* m_mapping;
+#endif
+};
@@ -0,0 +1,152 @@
+#include "StartupTimeline.h"
+
+/// Number of the longest spans printed in the report
+static const size_t REPORT_LONGEST_SPANS = 10;
+
+void StartupTimeline::Begin()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_start = std::chrono::high_resolution_clock::now();
+	m_spans.clear();
+	m_threads.clear();
+	m_threads.push_back(std::this_thread::get_id());
+	m_reported = false;
+}
+
+double StartupTimeline::Now() const
+{
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - m_start;
+
+	return elapsed.count();
+}
+
+void StartupTimeline::Record(const std::string& name, double startMs)
+{
+	double endMs = Now();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_reported)
+		return;
+
+	TimelineSpan span;
+	span.name = name;
+	span.thread = GetThreadIndex();
+	span.startMs = startMs;
+	span.endMs = endMs;
+	m_spans.push_back(span);
+}
+
+void StartupTimeline::MarkFirstFrame()
+{
+	double firstFrameMs = Now();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_reported)
+			return;
+	}
+
+	Report(firstFrameMs);
+}
+
+unsigned int StartupTimeline::GetThreadIndex()
+{
+	std::thread::id id = std::this_thread::get_id();
+	for (size_t i = 0; i < m_threads.size(); i++)
+	{
+		if (m_threads[i] == id)
+			return (unsigned int)i;
+	}
+
+	m_threads.push_back(id);
+
+	return (unsigned int)m_threads.size() - 1;
+}
+
+void StartupTimeline::Report(double firstFrameMs)
+{
+	std::vector<TimelineSpan> spans;
+	size_t threadCount;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_reported = true;
+		spans = m_spans;
+		threadCount = m_threads.size();
+	}
+
+	// Nested spans on a thread would be counted twice, so busy time only sums the outermost ones
+	std::vector<double> busyMs(threadCount, 0.0);
+	std::vector<double> coveredUntil(threadCount, -1.0);
+	std::vector<TimelineSpan> byStart = spans;
+	std::sort(byStart.begin(), byStart.end(), [](const TimelineSpan& a, const TimelineSpan& b) { return a.startMs < b.startMs; });
+	for (size_t i = 0; i < byStart.size(); i++)
+	{
+		const TimelineSpan& span = byStart[i];
+		double start = std::max(span.startMs, coveredUntil[span.thread]);
+		if (span.endMs > start)
+		{
+			busyMs[span.thread] += span.endMs - start;
+			coveredUntil[span.thread] = span.endMs;
+		}
+	}
+
+	double totalBusyMs = 0.0;
+	for (size_t i = 0; i < busyMs.size(); i++)
+		totalBusyMs += busyMs[i];
+
+	std::cout << "Startup: first frame after " << firstFrameMs << " ms, " << spans.size() << " spans on "
+		<< threadCount << " threads, " << totalBusyMs << " ms of work ("
+		<< (firstFrameMs > 0.0 ? totalBusyMs / firstFrameMs : 0.0) << "x overlap)" << std::endl;
+
+	for (size_t i = 0; i < busyMs.size(); i++)
+		std::cout << "  Thread " << i << (i == 0 ? " (main)" : "") << ": " << busyMs[i] << " ms busy" << std::endl;
+
+	std::vector<TimelineSpan> longest = spans;
+	std::sort(longest.begin(), longest.end(), [](const TimelineSpan& a, const TimelineSpan& b) { return a.endMs - a.startMs > b.endMs - b.startMs; });
+	for (size_t i = 0; i < longest.size() && i < REPORT_LONGEST_SPANS; i++)
+	{
+		std::cout << "  " << longest[i].endMs - longest[i].startMs << " ms " << longest[i].name << " (thread "
+			<< longest[i].thread << ", " << longest[i].startMs << " - " << longest[i].endMs << " ms)" << std::endl;
+	}
+
+	WriteTrace(spans);
+}
+
+// Escapes the characters a JSON string cannot hold, such as the backslashes of Windows paths
+static std::string EscapeJson(const std::string& text)
+{
+	std::string escaped;
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		if (text[i] == '"' || text[i] == '\\')
+			escaped += '\\';
+		escaped += text[i];
+	}
+
+	return escaped;
+}
+
+void StartupTimeline::WriteTrace(const std::vector<TimelineSpan>& spans) const
+{
+	if (m_traceFile.empty())
+		return;
+
+	std::ofstream outfile(m_traceFile.c_str());
+	if (!outfile)
+	{
+		std::cout << "Cannot write startup timeline: " << m_traceFile << std::endl;
+		return;
+	}
+
+	// Complete events in microseconds, one row per thread
+	outfile << "{\"traceEvents\":[" << std::endl;
+	for (size_t i = 0; i < spans.size(); i++)
+	{
+		outfile << "{\"name\":\"" << EscapeJson(spans[i].name) << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << spans[i].thread
+			<< ",\"ts\":" << (long long)(spans[i].startMs * 1000.0) << ",\"dur\":" << (long long)((spans[i].endMs - spans[i].startMs) * 1000.0)
+			<< "}" << (i + 1 < spans.size() ? "," : "") << std::endl;
+	}
+	outfile << "]}" << std::endl;
+
+	std::cout << "Startup timeline written to " << m_traceFile << std::endl;
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+
+	/**
+	* @struct TimelineSpan
+	* @brief A piece of startup work, when it ran and on which thread
+	*/
+struct TimelineSpan
+{
+	/// What was done, eg. the file that was loaded
+	std::string name;
+
+	/// Index of the thread it ran on, 0 is the thread that called StartupTimeline::Begin()
+	unsigned int thread;
+
+	/// Milliseconds since StartupTimeline::Begin()
+	double startMs, endMs;
+};
+
+	/**
+	* @class StartupTimeline
+	* @brief Records the work done between starting the engine and showing the first frame
+	*
+	* Loading runs on the job system workers as well as the main thread, so the time to the first
+	* frame only says how long startup took, not where the time went or how much of it overlapped.
+	* Every load records a span with the thread it ran on. Once the first frame has been shown the
+	* timeline prints the time to the first frame, the busy time of every thread and the longest
+	* spans, and can write the spans as a Chrome trace (chrome://tracing) to see the whole graph.
+	*
+	* Spans recorded after the report are ignored, so streaming during the game does not grow it.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class StartupTimeline
+{
+public:
+		/**
+		* @brief Singleton instance
+		*
+		* This function returns a singleton instance of the startup timeline so that every thread
+		* records into the same timeline.
+		*
+		* @return static StartupTimeline&
+		*/
+	static StartupTimeline& Instance()
+	{
+		static StartupTimeline instance;
+
+		return instance;
+	}
+
+		/**
+		* @brief Starts the timeline
+		*
+		* Clears the spans and measures times from now. The calling thread becomes thread 0.
+		*
+		* @return void
+		*/
+	void Begin();
+
+		/**
+		* @brief Gets the current time
+		*
+		* Returns the milliseconds since Begin().
+		*
+		* @return double
+		*/
+	double Now() const;
+
+		/**
+		* @brief Records a span
+		*
+		* Adds a span on the calling thread that started at startMs and ends now.
+		*
+		* @param const std::string& name
+		* @param double startMs
+		* @return void
+		*/
+	void Record(const std::string& name, double startMs);
+
+		/**
+		* @brief Marks the first frame as shown
+		*
+		* Reports the timeline the first time it is called.
+		*
+		* @return void
+		*/
+	void MarkFirstFrame();
+
+		/**
+		* @brief Sets the trace file
+		*
+		* Sets the file the spans are written to as a Chrome trace when the first frame is
+		* shown. An empty string writes no file.
+		*
+		* @param const std::string& filePath
+		* @return void
+		*/
+	void SetTraceFile(const std::string& filePath) { m_traceFile = filePath; }
+
+private:
+		/**
+		* @brief Default constructor
+		*
+		* Starts the timeline.
+		*
+		* @return null
+		*/
+	StartupTimeline() : m_reported(false) { Begin(); }
+
+		/**
+		* @brief Destructor
+		*
+		* Empty destructor.
+		*
+		* @return null
+		*/
+	~StartupTimeline() { }
+
+		/**
+		* @brief Gets the index of the calling thread
+		*
+		* Must be called with the timeline locked.
+		*
+		* @return unsigned int
+		*/
+	unsigned int GetThreadIndex();
+
+		/**
+		* @brief Prints the timeline
+		*
+		* Prints the time to the first frame, the busy time of every thread and the longest
+		* spans, and writes the trace file.
+		*
+		* @param double firstFrameMs
+		* @return void
+		*/
+	void Report(double firstFrameMs);
+
+		/**
+		* @brief Writes the spans as a Chrome trace
+		*
+		* @param const std::vector<TimelineSpan>& spans
+		* @return void
+		*/
+	void WriteTrace(const std::vector<TimelineSpan>& spans) const;
+
+	/// When Begin() was called
+	std::chrono::high_resolution_clock::time_point m_start;
+
+	/// Spans in the order they finished
+	std::vector<TimelineSpan> m_spans;
+
+	/// Threads that recorded spans, their position is their index
+	std::vector<std::thread::id> m_threads;
+
+	/// Chrome trace written with the report
+	std::string m_traceFile;
+
+	/// Set once the first frame was reported
+	bool m_reported;
+
+	/// Guards the spans and threads
+	std::mutex m_mutex;
+};
+
+	/**
+	* @class TimelineScope
+	* @brief Records a span on the startup timeline from its construction to its destruction
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class TimelineScope
+{
+public:
+		/**
+		* @brief Constructor
+		*
+		* Starts the span.
+		*
+		* @param const std::string& name
+		* @return null
+		*/
+	TimelineScope(const std::string& name) : m_name(name), m_start(StartupTimeline::Instance().Now()) { }
+
+		/**
+		* @brief Destructor
+		*
+		* Records the span.
+		*
+		* @return null
+		*/
+	~TimelineScope() { StartupTimeline::Instance().Record(m_name, m_start); }
+
+private:
+	std::string m_name;
+	double m_start;
+};
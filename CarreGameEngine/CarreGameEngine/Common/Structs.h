@@ -15,6 +15,7 @@
 
 #include <iostream>
 #include <vector>
+#include <GLM\glm.hpp>
 
 /// Struct to hold all of a model types data (positions, scales, filePath to load)
 struct ModelsData
@@ -28,6 +29,13 @@ struct ModelsData
 	std::string affordance;
 };
 
+/// Struct to hold the world streaming settings of the models script
+struct StreamingData
+{
+	float radius = 0.0f;				// Distance from a model the player loads it at, 0 loads every model at startup
+	size_t budgetBytes = 0;				// Mesh memory of the resident models before models out of range are evicted
+};
+
 /// Struct to hold all of heightmaps data (positions, scales, size, filePath to load and texture)
 struct HeightmapsData
 {
@@ -36,6 +44,18 @@ struct HeightmapsData
 	int fileSize;
 	std::vector<float> modelPositions;
 	std::vector<float> modelScales;
+	std::string method = "geomipmap";	// "geomipmap" or "bruteforce"
+	int patchSize = 33;					// Vertices along each side of a geomipmap patch (2^n + 1)
+	bool gpuDisplacement = false;		// Displace geomipmap patches from a height texture in the shader
+	int bitDepth = 0;					// 8 or 16-bit samples, 0 to take it from the file
+	bool collision = false;				// Add heightfield collision around the player
+};
+
+/// Struct to hold a point of a camera path and the point the camera looks at from there
+struct CameraKeyframe
+{
+	glm::vec3 position;
+	glm::vec3 target;
 };
 
 
@@ -0,0 +1,122 @@
+#include "Transform.h"
+#include <algorithm>
+#include "MyMath.h"
+
+unsigned int Transform::s_rebuildCount = 0;
+
+Transform::Transform()
+	: m_position(0.0f), m_rotation(0.0f), m_scale(1.0f), m_localDirty(true), m_worldDirty(true), m_parent(NULL)
+{
+}
+
+Transform::Transform(const Transform& other)
+	: m_position(other.m_position), m_rotation(other.m_rotation), m_scale(other.m_scale),
+	m_localDirty(true), m_worldDirty(true), m_parent(NULL)
+{
+}
+
+Transform& Transform::operator=(const Transform& other)
+{
+	if (this != &other)
+	{
+		SetPosition(other.m_position);
+		SetRotation(other.m_rotation);
+		SetScale(other.m_scale);
+	}
+
+	return *this;
+}
+
+Transform::~Transform()
+{
+	SetParent(NULL);
+
+	for (size_t i = 0; i < m_children.size(); i++)
+	{
+		m_children[i]->m_parent = NULL;
+		m_children[i]->MarkWorldDirty();
+	}
+}
+
+void Transform::SetPosition(const glm::vec3& position)
+{
+	if (position == m_position)
+		return;
+
+	m_position = position;
+	m_localDirty = true;
+	MarkWorldDirty();
+}
+
+void Transform::SetRotation(const glm::vec3& rotation)
+{
+	if (rotation == m_rotation)
+		return;
+
+	m_rotation = rotation;
+	m_localDirty = true;
+	MarkWorldDirty();
+}
+
+void Transform::SetScale(const glm::vec3& scale)
+{
+	if (scale == m_scale)
+		return;
+
+	m_scale = scale;
+	m_localDirty = true;
+	MarkWorldDirty();
+}
+
+void Transform::SetParent(Transform* parent)
+{
+	if (parent == m_parent || parent == this)
+		return;
+
+	if (m_parent)
+		m_parent->m_children.erase(std::remove(m_parent->m_children.begin(), m_parent->m_children.end(), this), m_parent->m_children.end());
+
+	m_parent = parent;
+	if (m_parent)
+		m_parent->m_children.push_back(this);
+
+	MarkWorldDirty();
+}
+
+const glm::mat4& Transform::GetLocalMatrix()
+{
+	if (m_localDirty)
+	{
+		m_localMatrix = CreateTransformationMatrix(m_position, m_rotation, m_scale);
+		m_localDirty = false;
+		s_rebuildCount++;
+	}
+
+	return m_localMatrix;
+}
+
+const glm::mat4& Transform::GetWorldMatrix()
+{
+	if (m_worldDirty)
+	{
+		if (m_parent)
+			m_worldMatrix = m_parent->GetWorldMatrix() * GetLocalMatrix();
+		else
+			m_worldMatrix = GetLocalMatrix();
+
+		m_worldDirty = false;
+		s_rebuildCount++;
+	}
+
+	return m_worldMatrix;
+}
+
+void Transform::MarkWorldDirty()
+{
+	if (m_worldDirty)
+		return;
+
+	m_worldDirty = true;
+	for (size_t i = 0; i < m_children.size(); i++)
+		m_children[i]->MarkWorldDirty();
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <vector>
+#include <GLM\glm.hpp>
+
+	/**
+	* @class Transform
+	* @brief Scene graph transform component
+	*
+	* Holds the local position, rotation and scale of an object and links it to a parent and
+	* children. The local and world matrices are cached and only rebuilt when something changed:
+	* setting a value that differs from the current one marks the local matrix dirty, and marks
+	* the world matrix of this transform and every descendant dirty. Static objects therefore
+	* never rebuild their matrices after the first frame.
+	*
+	* Rotation is in radians around x, then y, then z, the same as CreateTransformationMatrix().
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class Transform
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates an identity transform with no parent.
+		*
+		* @return null
+		*/
+	Transform();
+
+		/**
+		* @brief Copy constructor
+		*
+		* Copies the local position, rotation and scale only. The copy has no parent or children.
+		*
+		* @param const Transform& other
+		* @return null
+		*/
+	Transform(const Transform& other);
+
+		/**
+		* @brief Assignment operator
+		*
+		* Copies the local position, rotation and scale only. Parent and children links are kept.
+		*
+		* @param const Transform& other
+		* @return Transform&
+		*/
+	Transform& operator=(const Transform& other);
+
+		/**
+		* @brief Destructor
+		*
+		* Detaches the transform from its parent and its children.
+		*
+		* @return null
+		*/
+	~Transform();
+
+		/**
+		* @brief Sets the local position
+		*
+		* @param const glm::vec3& position
+		* @return void
+		*/
+	void SetPosition(const glm::vec3& position);
+
+		/**
+		* @brief Sets the local rotation
+		*
+		* @param const glm::vec3& rotation
+		* @return void
+		*/
+	void SetRotation(const glm::vec3& rotation);
+
+		/**
+		* @brief Sets the local scale
+		*
+		* @param const glm::vec3& scale
+		* @return void
+		*/
+	void SetScale(const glm::vec3& scale);
+
+		/**
+		* @brief Gets the local position
+		*
+		* @return const glm::vec3&
+		*/
+	const glm::vec3& GetPosition() const { return m_position; }
+
+		/**
+		* @brief Gets the local rotation
+		*
+		* @return const glm::vec3&
+		*/
+	const glm::vec3& GetRotation() const { return m_rotation; }
+
+		/**
+		* @brief Gets the local scale
+		*
+		* @return const glm::vec3&
+		*/
+	const glm::vec3& GetScale() const { return m_scale; }
+
+		/**
+		* @brief Sets the parent transform
+		*
+		* Attaches this transform as a child of the parent given, or detaches it if the parent
+		* is NULL. The local values are kept, so the world matrix changes to follow the parent.
+		*
+		* @param Transform* parent
+		* @return void
+		*/
+	void SetParent(Transform* parent);
+
+		/**
+		* @brief Gets the parent transform
+		*
+		* @return Transform*
+		*/
+	Transform* GetParent() const { return m_parent; }
+
+		/**
+		* @brief Gets the child transforms
+		*
+		* @return const std::vector<Transform*>&
+		*/
+	const std::vector<Transform*>& GetChildren() const { return m_children; }
+
+		/**
+		* @brief Gets the local matrix
+		*
+		* Returns the translate * rotate * scale matrix of the local values, rebuilding it only
+		* if a value changed since it was last built.
+		*
+		* @return const glm::mat4&
+		*/
+	const glm::mat4& GetLocalMatrix();
+
+		/**
+		* @brief Gets the world matrix
+		*
+		* Returns the parent's world matrix multiplied by the local matrix, rebuilding it only if
+		* this transform or one of its ancestors changed since it was last built.
+		*
+		* @return const glm::mat4&
+		*/
+	const glm::mat4& GetWorldMatrix();
+
+		/**
+		* @brief Gets the world position
+		*
+		* Returns the translation of the world matrix.
+		*
+		* @return glm::vec3
+		*/
+	glm::vec3 GetWorldPosition() { return glm::vec3(GetWorldMatrix()[3]); }
+
+		/**
+		* @brief Gets the number of matrix rebuilds
+		*
+		* Returns how many local and world matrices have been rebuilt by all transforms since the
+		* program started, to check that only moving objects do work.
+		*
+		* @return unsigned int
+		*/
+	static unsigned int GetRebuildCount() { return s_rebuildCount; }
+
+private:
+		/**
+		* @brief Marks the world matrix dirty
+		*
+		* Marks the world matrix of this transform and all of its descendants as needing to be
+		* rebuilt. A dirty transform always has dirty descendants, so the walk stops there.
+		*
+		* @return void
+		*/
+	void MarkWorldDirty();
+
+	/// Local values
+	glm::vec3 m_position, m_rotation, m_scale;
+
+	/// Cached matrices
+	glm::mat4 m_localMatrix, m_worldMatrix;
+
+	/// Matrices that need to be rebuilt
+	bool m_localDirty, m_worldDirty;
+
+	/// Scene graph links
+	Transform* m_parent;
+	std::vector<Transform*> m_children;
+
+	/// Matrix rebuilds by all transforms
+	static unsigned int s_rebuildCount;
+};
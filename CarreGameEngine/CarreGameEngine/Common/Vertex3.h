@@ -10,6 +10,8 @@ struct Vertex3
 	glm::vec2 m_texCoords; // The uv coordinates
 	glm::vec3 m_normal; // The normal coordinates
 	glm::vec4 m_colour; // Colour r,g,b,a
+	unsigned char m_boneIndices[4]; // Skeleton bones the vertex follows
+	unsigned char m_boneWeights[4]; // Influence of each bone, summing to 255
 	//glm::vec3 m_tangent; // unused
 	//glm::vec3 m_biTangent; // unused
 };
\ No newline at end of file
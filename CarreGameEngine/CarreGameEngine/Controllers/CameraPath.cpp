@@ -0,0 +1,40 @@
+#include "CameraPath.h"
+#include "..\Scripting\ScriptManager.h"
+
+bool CameraPath::Load()
+{
+	if (!ScriptManager::Instance().LoadCameraPathLua(m_keyframes))
+	{
+		std::cout << "Failed to load the camera path!" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+void CameraPath::Apply(Camera& camera, int frame) const
+{
+	if (m_keyframes.empty())
+		return;
+
+	// Position along the path in keyframes
+	float progress = 0.0f;
+	if (m_frameCount > 1)
+		progress = glm::clamp(frame / (float)(m_frameCount - 1), 0.0f, 1.0f) * (m_keyframes.size() - 1);
+
+	size_t index = (size_t)progress;
+	if (index >= m_keyframes.size() - 1)
+		index = m_keyframes.size() - 1;
+	size_t next = index + 1 < m_keyframes.size() ? index + 1 : index;
+	float blend = progress - index;
+
+	glm::vec3 position = glm::mix(m_keyframes[index].position, m_keyframes[next].position, blend);
+	glm::vec3 target = glm::mix(m_keyframes[index].target, m_keyframes[next].target, blend);
+
+	// The view matrix turns by yaw about y then pitches about x, looking down -z with positive pitch looking down
+	glm::vec3 direction = target - position;
+	float yaw = atan2(direction.x, -direction.z);
+	float pitch = atan2(-direction.y, glm::length(glm::vec2(direction.x, direction.z)));
+
+	camera.PositionCamera(position.x, position.y, position.z, yaw, pitch);
+}
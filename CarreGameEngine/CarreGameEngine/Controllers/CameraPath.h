@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <GLM\glm.hpp>
+
+#include "Camera.h"
+#include "..\Common\Structs.h"
+
+	/**
+	* @class CameraPath
+	* @brief A fixed path the camera is flown along, one step per frame
+	*
+	* The camera normally follows the player, which depends on input and timing. Headless runs
+	* instead move the camera through the keyframes of Resources/scripts/CameraPath.lua over a
+	* set number of frames, so every run draws the same views and their timings and images can
+	* be compared.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class CameraPath
+{
+public:
+		/**
+		* @brief Constructor
+		*
+		* Creates an empty path flown over the given number of frames.
+		*
+		* @param int frameCount
+		* @return null
+		*/
+	CameraPath(int frameCount) : m_frameCount(frameCount) { }
+
+		/**
+		* @brief Destructor
+		*
+		* Empty destructor.
+		*
+		* @return null
+		*/
+	~CameraPath() { }
+
+		/**
+		* @brief Loads the path
+		*
+		* Reads the keyframes from the camera path script.
+		*
+		* @return bool
+		*/
+	bool Load();
+
+		/**
+		* @brief Sets the keyframes
+		*
+		* @param const std::vector<CameraKeyframe>& keyframes
+		* @return void
+		*/
+	void SetKeyframes(const std::vector<CameraKeyframe>& keyframes) { m_keyframes = keyframes; }
+
+		/**
+		* @brief Gets the frame count
+		*
+		* @return int
+		*/
+	int GetFrameCount() const { return m_frameCount; }
+
+		/**
+		* @brief Positions the camera on the path
+		*
+		* Moves the camera to where the path is at the given frame, interpolating between the
+		* keyframes, and turns it towards the interpolated target. Frames past the end stay at
+		* the last keyframe.
+		*
+		* @param Camera& camera
+		* @param int frame
+		* @return void
+		*/
+	void Apply(Camera& camera, int frame) const;
+
+private:
+	/// Points the camera passes through in order
+	std::vector<CameraKeyframe> m_keyframes;
+
+	/// Frames taken to fly from the first keyframe to the last
+	int m_frameCount;
+};
@@ -1,18 +1,130 @@
 #include "GL\glew.h"
 #include "GLFWManager.h"
+#include "HeadlessManager.h"
+#include "CameraPath.h"
 #include "GameControlEngine.h"
 
-int main()
+int main(int argc, char* argv[])
 {
-	// Create new GLFW window
-	GLFWManager* pWindowManager = new GLFWManager();
+	// --headless draws a fixed camera path offscreen for performance runs without a display
+	bool headless = false;
+	int frames = 600;
+	int captureInterval = 60;
+	std::string captureDirectory;
+	std::string timingsFile = "headless_timings.csv";
+
+	// --benchmark-import times importing a model, eg. the lecture theatre, and exits
+	std::string benchmarkFile;
+	int benchmarkRuns = 10;
+
+	// --tile-heightfield converts a raw heightfield to a tiled one, eg. for a terrain larger than memory, and exits
+	std::string tileInFile, tileOutFile;
+	int tileSize = 256;
+
+	// --no-hot-reload stops changed files being reloaded while the game runs
+	bool hotReload = true;
+
+	// --physics-debug draws the Bullet debug lines of the physics world
+	bool physicsDebug = false;
+
+	// --benchmark-knights adds animated knights around the player, eg. 1000 with --headless
+	int benchmarkKnights = 0;
+
+	// --benchmark-skeletons poses skeletons, of --skeleton-file or a generated one, and exits
+	int benchmarkSkeletons = 0;
+	std::string skeletonFile;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		if (argument == "--headless")
+			headless = true;
+		else if (argument == "--frames" && i + 1 < argc)
+			frames = atoi(argv[++i]);
+		else if (argument == "--capture" && i + 1 < argc)
+			captureDirectory = argv[++i];
+		else if (argument == "--capture-every" && i + 1 < argc)
+			captureInterval = atoi(argv[++i]);
+		else if (argument == "--timings" && i + 1 < argc)
+			timingsFile = argv[++i];
+		else if (argument == "--no-mesh-cache")
+			MeshCooker::Instance().SetEnabled(false);
+		else if (argument == "--recook-meshes")
+			MeshCooker::Instance().SetForceRecook(true);
+		else if (argument == "--benchmark-import" && i + 1 < argc)
+			benchmarkFile = argv[++i];
+		else if (argument == "--benchmark-runs" && i + 1 < argc)
+			benchmarkRuns = atoi(argv[++i]);
+		else if (argument == "--tile-heightfield" && i + 2 < argc)
+		{
+			tileInFile = argv[++i];
+			tileOutFile = argv[++i];
+		}
+		else if (argument == "--heightfield-tile-size" && i + 1 < argc)
+			tileSize = atoi(argv[++i]);
+		else if (argument == "--no-hot-reload")
+			hotReload = false;
+		else if (argument == "--physics-debug")
+			physicsDebug = true;
+		else if (argument == "--benchmark-knights" && i + 1 < argc)
+			benchmarkKnights = atoi(argv[++i]);
+		else if (argument == "--benchmark-skeletons" && i + 1 < argc)
+			benchmarkSkeletons = atoi(argv[++i]);
+		else if (argument == "--skeleton-file" && i + 1 < argc)
+			skeletonFile = argv[++i];
+		else if (argument == "--workers" && i + 1 < argc)
+			JobSystem::Instance().Start(atoi(argv[++i]));
+		else if (argument == "--startup-trace" && i + 1 < argc)
+			StartupTimeline::Instance().SetTraceFile(argv[++i]);
+		else
+			std::cout << "Unknown argument " << argument << std::endl;
+	}
+
+	if (!benchmarkFile.empty())
+		return Model::BenchmarkImport(benchmarkFile, benchmarkRuns);
+
+	if (benchmarkSkeletons > 0)
+		return Model::BenchmarkSkeletons(skeletonFile, benchmarkSkeletons, benchmarkRuns);
+
+	if (!tileInFile.empty())
+	{
+		HeightfieldSource heightfield;
+		return heightfield.Open(tileInFile) && heightfield.WriteTiled(tileOutFile, tileSize) ? 0 : -1;
+	}
 
 	// Create new camera object
 	Camera* camera = new Camera(0.0);
 
 	GameControlEngine engine;
+	IWindowManager* pWindowManager;
+
+	if (headless)
+	{
+		// Create offscreen context that ends the game after the camera path
+		HeadlessManager* pHeadlessManager = new HeadlessManager(frames);
+		pHeadlessManager->SetCaptureDirectory(captureDirectory, captureInterval);
+		pHeadlessManager->SetTimingsFile(timingsFile);
+		pWindowManager = pHeadlessManager;
+
+		CameraPath* cameraPath = new CameraPath(frames);
+		if (cameraPath->Load())
+			engine.SetCameraPath(cameraPath);
+		else
+			delete cameraPath;
+	}
+	else
+	{
+		// Create new GLFW window
+		pWindowManager = new GLFWManager();
+	}
+
 	engine.SetWindowManager(pWindowManager);
 
+	// Headless runs are timed, files changing under them would skew the timings
+	engine.SetHotReload(hotReload && !headless);
+	engine.SetBenchmarkKnights(benchmarkKnights);
+	engine.SetPhysicsDebugDraw(physicsDebug);
+
 	// Pass camera object into engine
 	engine.SetCamera(camera);
 	pWindowManager->GetInputManager()->SetCamera(camera);
@@ -78,6 +190,11 @@ void GLFWManager::SwapTheBuffers()
 	glfwSwapBuffers(m_window);
 }
 
+void GLFWManager::MakeContextCurrent(bool current)
+{
+	glfwMakeContextCurrent(current ? m_window : nullptr);
+}
+
 // This function processes all the application's input and returns a bool to tell us if we should continue
 bool GLFWManager::ProcessInput(bool continueGame = true)
 {
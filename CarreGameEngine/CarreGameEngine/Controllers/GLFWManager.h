@@ -85,6 +85,17 @@ public:
 		*/
 	virtual void Destroy();
 
+		/**
+		* @brief Makes the OpenGL context current
+		*
+		* Makes the OpenGL context of the window current on the calling thread, or releases it
+		* from the calling thread so another thread can make it current.
+		*
+		* @param bool current
+		* @return void
+		*/
+	virtual void MakeContextCurrent(bool current) override;
+
 protected:
 	/// GLFW window object that manages the window and input
 	GLFWwindow* m_window;
@@ -1,6 +1,22 @@
 #include "GameControlEngine.h"
 #include "GL/glew.h"
 
+// The lecture theatre is the static collision mesh and the occluder, people have AI and the player
+// is the camera body, so they are loaded at startup and never streamed
+static bool IsStreamable(const std::string& assetName)
+{
+	return assetName != "lecTheatre" && assetName != "person" && assetName != "player";
+}
+
+/// Model, scale and spacing of the benchmark knights, the model is about 52 units tall
+static const char* KNIGHT_FILE = "Resources/objects/knight.md2";
+static const float KNIGHT_SCALE = 10.0f;
+static const float KNIGHT_SPACING = 400.0f;
+static const float KNIGHT_FRAMES_PER_SECOND = 9.0f;
+
+/// Looping clips of the knight, the deaths end lying down
+static const char* KNIGHT_CLIPS[] = { "stand", "run", "attack", "pain1", "jump", "flip", "salute", "taunt", "wave", "point" };
+
 const int GameControlEngine::RunEngine()
 {
 	Initialize();
@@ -14,21 +30,48 @@ const int GameControlEngine::RunEngine()
 
 void GameControlEngine::Initialize()
 {
-	// Initialize from script
-	ScriptManager::Instance().LoadWindowInitLua(ScreenWidth, ScreenHeight, screenTitle, fullScreen);
-	ScriptManager::Instance().LoadCamInitLua(
-		m_camera->GetPosition(), 
-		m_camera->GetYaw(), 
-		m_camera->GetPitch(), 
-		m_camera->GetFov(), 
-		m_camera->GetNearPlane(), 
-		m_camera->GetFarPlane());
-	ScriptManager::Instance().LoadModelsInitLua(m_allModelsData, m_modelsData);
-	ScriptManager::Instance().LoadHeightmapsInitLua(m_allHeightmapsData, m_heightmapsData);
+	StartupTimeline::Instance().Begin();
+
+	// Initialize from script, the window and camera settings are needed to create the window
+	{
+		TimelineScope scope("Window and camera scripts");
+		ScriptManager::Instance().LoadWindowInitLua(ScreenWidth, ScreenHeight, screenTitle, fullScreen, m_useRenderThread);
+		ScriptManager::Instance().LoadCamInitLua(
+			m_camera->GetPosition(), 
+			m_camera->GetYaw(), 
+			m_camera->GetPitch(), 
+			m_camera->GetFov(), 
+			m_camera->GetNearPlane(), 
+			m_camera->GetFarPlane());
+	}
+
+	// The other scripts are read on the workers while the window is created
+	JobCounter scriptsLoaded;
+	JobSystem::Instance().Submit([this]()
+	{
+		TimelineScope scope("Models script");
+		ScriptManager::Instance().LoadModelsInitLua(m_allModelsData, m_modelsData, m_streamingData);
+	}, &scriptsLoaded);
+	JobSystem::Instance().Submit([this]()
+	{
+		TimelineScope scope("Heightmaps script");
+		ScriptManager::Instance().LoadHeightmapsInitLua(m_allHeightmapsData, m_heightmapsData);
+	}, &scriptsLoaded);
+
+	/// 21/10/18 CSmith Affordance Script Read-in
+	m_affordanceTable = new AffordanceData();
+	JobSystem::Instance().Submit([this]()
+	{
+		TimelineScope scope("Affordance script");
+		ScriptManager::Instance().LoadAffordanceTable(*m_affordanceTable);
+	}, &scriptsLoaded);
 
 	// Exit if error creating window
-	if (!m_windowManager || m_windowManager->Initialize(ScreenWidth, ScreenHeight, screenTitle, fullScreen) != 0)
-		exit(-1);
+	{
+		TimelineScope scope("Create window");
+		if (!m_windowManager || m_windowManager->Initialize(ScreenWidth, ScreenHeight, screenTitle, fullScreen) != 0)
+			exit(-1);
+	}
 
 	// Create viewport
 	glViewport(0, 0, ScreenWidth, ScreenHeight);
@@ -40,6 +83,8 @@ void GameControlEngine::Initialize()
 
 	// Initialize gameworld
 	m_gameWorld = new GameWorld();
+	m_renderThread.SetWindow(m_windowManager);
+	m_gameWorld->SetRenderThread(&m_renderThread);
 
 	// Initialize camera perspective and position
 	m_camera->SetPerspective(glm::radians(m_camera->GetFov()), ScreenWidth / (float)ScreenHeight, m_camera->GetNearPlane(), m_camera->GetFarPlane());
@@ -48,38 +93,60 @@ void GameControlEngine::Initialize()
 	// Create new player
 	m_player = new Player("Player");
 
+	JobSystem::Instance().Wait(scriptsLoaded);
+
+	if (m_benchmarkKnights > 0)
+		AddBenchmarkKnights();
+
+	// Request every script texture now so they are decoded on the workers while the files load,
+	// GetTextureID() then finds them already requested
+	std::unordered_map<std::string, HeightmapsData>::iterator itHeightfields;
+	for (itHeightfields = m_allHeightmapsData.begin(); itHeightfields != m_allHeightmapsData.end(); itHeightfields++)
+		TextureManager::Instance().RequestTexture((*itHeightfields).second.texFilePath);
+
+	std::multimap<std::string, ModelsData>::iterator itModels;
+	for (itModels = m_allModelsData.begin(); itModels != m_allModelsData.end(); itModels++)
+	{
+		if ((*itModels).first != "lecTheatre" && !(*itModels).second.modelPositions.empty())
+			TextureManager::Instance().RequestTexture((*itModels).second.texFilePath);
+	}
+
 	/**********************************Loading of all heightfields at once**************************************/
-	// Get iterator to start of heightfields map
-	std::unordered_map<std::string, HeightmapsData>::iterator itHeightfields = m_allHeightmapsData.begin();
-	
-	// BruteForce variable
-	Bruteforce* bfHeightfield;
+	// Terrain variable
+	Terrain* heightfield;
+
+	// Heightfield files are read on the workers
+	JobCounter heightfieldsRead;
 
 	// Initialize all heightfields in map
-	while (itHeightfields != m_allHeightmapsData.end())
+	for (itHeightfields = m_allHeightmapsData.begin(); itHeightfields != m_allHeightmapsData.end(); itHeightfields++)
 	{
-		// Create new BruteForce
-		bfHeightfield = new Bruteforce((*itHeightfields).second.modelScales[0], (*itHeightfields).second.modelScales[1], (*itHeightfields).second.modelScales[2]);
-		
-		// Initialize data from map and push to terrains vector
-		bfHeightfield->LoadHeightfield((*itHeightfields).second.filePath, (*itHeightfields).second.fileSize);
-		bfHeightfield->GenerateTerrain(TextureManager::Instance().GetTextureID((*itHeightfields).second.texFilePath), (*itHeightfields).second.texFilePath);
-		bfHeightfield->SetPosition(glm::vec3((*itHeightfields).second.modelPositions[0], (*itHeightfields).second.modelPositions[1], (*itHeightfields).second.modelPositions[2]));
-		m_terrains.push_back(bfHeightfield);
-		
-		// Move camera to be on top of terrain 
-		if ((*itHeightfields).first == "terrain")
+		// Create terrain using the method chosen in the script
+		if ((*itHeightfields).second.method == "bruteforce")
+			heightfield = new Bruteforce((*itHeightfields).second.modelScales[0], (*itHeightfields).second.modelScales[1], (*itHeightfields).second.modelScales[2]);
+		else
 		{
-			//m_camera->SetPosition(glm::vec3(m_camera->GetPosition().x, bfHeightfield->GetAverageHeight(m_camera->GetPosition().x, m_camera->GetPosition().z), m_camera->GetPosition().z));
+			Geomipmap* geomipmap = new Geomipmap((*itHeightfields).second.modelScales[0], (*itHeightfields).second.modelScales[1], (*itHeightfields).second.modelScales[2], (*itHeightfields).second.patchSize);
+			geomipmap->SetGpuDisplacement((*itHeightfields).second.gpuDisplacement);
+			heightfield = geomipmap;
 		}
 
-		// Increment iterator
-		itHeightfields++;
+		std::string filePath = (*itHeightfields).second.filePath;
+		int fileSize = (*itHeightfields).second.fileSize;
+		int bitDepth = (*itHeightfields).second.bitDepth;
+		JobSystem::Instance().Submit([heightfield, filePath, fileSize, bitDepth]()
+		{
+			TimelineScope scope("Map " + filePath);
+			heightfield->LoadHeightfield(filePath, fileSize, bitDepth);
+		}, &heightfieldsRead);
+
+		m_terrains.push_back(heightfield);
 	}
 	/**********************************Loading of all heightfields at once**************************************/
 		
 	// Pass camera into gameworld
 	m_gameWorld->SetCamera(m_camera);
+	m_gameWorld->SetCameraPath(m_cameraPath);
 
 	// Initialize asset factory
 	m_assetFactory = new GameAssetFactory();
@@ -101,16 +168,94 @@ void GameControlEngine::Initialize()
 	// Asset xyz position, scale and rotation
 	float assetScaleXYZ[3];
 	float assetPosXYZ[3];
-	
-	// Get iterator to start of models map
-	std::multimap<std::string, ModelsData>::iterator itModels = m_allModelsData.begin();
 
-	// Loop through map until all models created
-	while (itModels != m_allModelsData.end())
+	// Assets in script order, their meshes are loaded on the workers
+	std::vector<IGameAsset*> loadingAssets;
+
+	// Streamed assets with placeholder bounds are loaded once the player comes in range
+	WorldStreamer& streamer = m_gameWorld->GetStreamer();
+	streamer.SetLimits(m_streamingData.radius, m_streamingData.budgetBytes);
+	std::vector<char> placeholders;
+	int placeholderCount = 0;
+
+	// The first model of each file loads it, the others wait for it and share it through the model cache
+	std::map<std::string, JobCounter> filesLoaded;
+	JobCounter instancesLoaded;
+
+	for (itModels = m_allModelsData.begin(); itModels != m_allModelsData.end(); itModels++)
 	{
 		// For each model of same type
 		for (int k = 0; k < (*itModels).second.modelPositions.size(); k++)
 		{
+			if ((*itModels).first != "person")
+			{
+				// Create name asset data and add to asset map
+				modelAsset = m_assetFactory->CreateAsset(ASS_OBJECT, (*itModels).first);
+			}
+			else
+			{
+				// Creates NPC object for person
+				modelAsset = m_assetFactory->CreateAsset(ASS_NPC, (*itModels).first);
+			}
+			loadingAssets.push_back(modelAsset);
+
+			std::string filePath = (*itModels).second.filePath;
+			Model* model = modelAsset->GetModel();
+
+			// Models that were never cooked are loaded now, so their collision bodies get real bounds
+			bool placeholder = streamer.IsEnabled() && IsStreamable((*itModels).first) && model->LoadBounds(filePath);
+			placeholders.push_back(placeholder);
+			if (placeholder)
+			{
+				placeholderCount++;
+				continue;
+			}
+
+			JobSystem::Job load = [model, filePath]() { model->LoadMeshes(filePath); };
+
+			std::map<std::string, JobCounter>::iterator itFile = filesLoaded.find(filePath);
+			if (itFile == filesLoaded.end())
+				JobSystem::Instance().Submit(load, &filesLoaded[filePath]);
+			else
+				JobSystem::Instance().Submit(load, &instancesLoaded, &itFile->second);
+		}
+	}
+
+	// Terrains only need their texture, which the script requested above
+	JobSystem::Instance().Wait(heightfieldsRead);
+
+	std::vector<Terrain*>::iterator itTerrain = m_terrains.begin();
+	for (itHeightfields = m_allHeightmapsData.begin(); itHeightfields != m_allHeightmapsData.end(); itHeightfields++, itTerrain++)
+	{
+		TimelineScope scope("Generate terrain " + (*itHeightfields).first);
+
+		// Initialize data from map
+		heightfield = *itTerrain;
+		heightfield->GenerateTerrain(TextureManager::Instance().GetTextureID((*itHeightfields).second.texFilePath), (*itHeightfields).second.texFilePath);
+		heightfield->SetPosition(glm::vec3((*itHeightfields).second.modelPositions[0], (*itHeightfields).second.modelPositions[1], (*itHeightfields).second.modelPositions[2]));
+		
+		// Move camera to be on top of terrain 
+		if ((*itHeightfields).first == "terrain")
+		{
+			//m_camera->SetPosition(glm::vec3(m_camera->GetPosition().x, heightfield->GetAverageHeight(m_camera->GetPosition().x, m_camera->GetPosition().z), m_camera->GetPosition().z));
+		}
+	}
+
+	std::map<std::string, JobCounter>::iterator itFile;
+	for (itFile = filesLoaded.begin(); itFile != filesLoaded.end(); itFile++)
+		JobSystem::Instance().Wait(itFile->second);
+	JobSystem::Instance().Wait(instancesLoaded);
+
+	// Textures and transforms are set on the main thread, in script order
+	std::vector<IGameAsset*>::iterator itAsset = loadingAssets.begin();
+	std::vector<char>::iterator itPlaceholder = placeholders.begin();
+	for (itModels = m_allModelsData.begin(); itModels != m_allModelsData.end(); itModels++)
+	{
+		// For each model of same type
+		for (int k = 0; k < (*itModels).second.modelPositions.size(); k++, itAsset++, itPlaceholder++)
+		{
+			TimelineScope scope("Finish " + (*itModels).first);
+
 			// Get scales
 			for (int j = 0; j < (*itModels).second.modelScales[k].size(); j++)
 			{
@@ -123,36 +268,28 @@ void GameControlEngine::Initialize()
 				assetPosXYZ[j] = (*itModels).second.modelPositions[k][j];
 			}
 
-			
-			if ((*itModels).first != "person")
+			modelAsset = *itAsset;
+			if (!*itPlaceholder)
 			{
-				// Create name asset data and add to asset map
-				modelAsset = m_assetFactory->CreateAsset(ASS_OBJECT, (*itModels).first);
-				modelAsset->LoadFromFilePath((*itModels).second.filePath);
+				modelAsset->GetModel()->LoadTextures();
 
 				// Not sure why this is here
 				if ((*itModels).first != "lecTheatre")
 				{
 					modelAsset->AddTexutre(TextureManager::Instance().GetTextureID((*itModels).second.texFilePath), (*itModels).second.texFilePath);
 				}
-				modelAsset->SetScale(glm::vec3(assetScaleXYZ[0], assetScaleXYZ[1], assetScaleXYZ[2]));
-				modelAsset->SetPosition(glm::vec3(assetPosXYZ[0], assetPosXYZ[1], assetPosXYZ[2]));
-			}
-			else
-			{
-				// Creates NPC object for person
-				modelAsset = m_assetFactory->CreateAsset(ASS_NPC, (*itModels).first);
-				modelAsset->LoadFromFilePath((*itModels).second.filePath);
-				modelAsset->AddTexutre(TextureManager::Instance().GetTextureID((*itModels).second.texFilePath), (*itModels).second.texFilePath);
-				modelAsset->SetScale(glm::vec3(assetScaleXYZ[0], assetScaleXYZ[1], assetScaleXYZ[2]));
-				modelAsset->SetPosition(glm::vec3(assetPosXYZ[0], assetPosXYZ[1], assetPosXYZ[2]));
 			}
+			modelAsset->SetScale(glm::vec3(assetScaleXYZ[0], assetScaleXYZ[1], assetScaleXYZ[2]));
+			modelAsset->SetPosition(glm::vec3(assetPosXYZ[0], assetPosXYZ[1], assetPosXYZ[2]));
 
 			/// CSmith 
 			///	20/10/18 Dimensions of models calculated here for bouding box
 			modelAsset->CalculateDimensions();
 
 			m_assetFactory->AddAsset(modelAsset);
+
+			if (streamer.IsEnabled() && IsStreamable((*itModels).first))
+				streamer.Add(modelAsset, (*itModels).second.filePath, (*itModels).second.texFilePath, !*itPlaceholder);
 		}
 
 		if ((*itModels).first == "player")
@@ -169,17 +306,22 @@ void GameControlEngine::Initialize()
 			// Initialize player model
 			m_player->SetPosition(glm::vec3(assetPosXYZ[0], assetPosXYZ[1], assetPosXYZ[2]));
 		}
-		
-		// Increment iterator
-		itModels++;
 	}
 
+	StartKnightAnimations();
+
 	/********************Loading of all models at once*******************/
-	m_windowManager->GetInputManager()->SetPlayer(m_player);
+	std::cout << "Model cache: " << ModelCache::Instance().GetLoadCount() << " files loaded, "
+		<< ModelCache::Instance().GetHitCount() << " models sharing a loaded file" << std::endl;
+	std::cout << "Mesh cache: " << MeshCooker::Instance().GetCookedLoads() << " cooked files mapped in "
+		<< MeshCooker::Instance().GetCookedSeconds() * 1000.0 << " ms, " << MeshCooker::Instance().GetImports()
+		<< " imported in " << MeshCooker::Instance().GetImportSeconds() * 1000.0 << " ms, cooked files written in "
+		<< MeshCooker::Instance().GetSaveSeconds() * 1000.0 << " ms" << std::endl;
+	if (streamer.IsEnabled())
+		std::cout << "World streaming: " << placeholderCount << " of " << loadingAssets.size()
+			<< " models left to load when the player comes in range" << std::endl;
 
-	/// 21/10/18 CSmith Affordance Script Read-in
-	m_affordanceTable = new AffordanceData();
-	ScriptManager::Instance().LoadAffordanceTable(*m_affordanceTable);
+	m_windowManager->GetInputManager()->SetPlayer(m_player);
 
 	/********************AI Testing*******************/
 	/*ComputerAI* p = new ComputerAI();
@@ -189,29 +331,92 @@ void GameControlEngine::Initialize()
 	/********************AI Testing*******************/
 
 	// Physics engine initialization
-	InitializePhysics();
+	{
+		TimelineScope scope("Physics");
+		InitializePhysics();
+	}
 
 	// Initialize the game world, pass in terrain, assets and physics engine *** Can be reworked *** 
-	m_gameWorld->Init(m_player, m_assetFactory->GetAssets());
+	{
+		// The OpenGL uploads of every loaded asset happen here
+		TimelineScope scope("Upload to OpenGL");
+		m_gameWorld->Init(m_player, m_assetFactory->GetAssets());
+	}
 	m_gameWorld->SetTerrains(m_terrains);
 	m_gameWorld->SetAI(m_agents);
 	m_gameWorld->SetPhysicsWorld(m_physicsWorld, m_collisionBodies);
+	m_gameWorld->SetPhysicsDebugDraw(m_physicsDebugDraw);
+
+	// Watches the files everything above was created from
+	if (m_hotReload)
+		m_gameWorld->EnableHotReload(m_allModelsData, m_allHeightmapsData);
 }
 
 void GameControlEngine::GameLoop()
 {
+	// The render thread owns the OpenGL context while the game loop runs
+	if (m_useRenderThread)
+		m_renderThread.Start(m_windowManager);
+
 	while (m_windowManager->ProcessInput(true))
 	{
 		// Use our TimeManager singleton to calculate our framerate every frame
 		TimeManager::Instance().CalculateFrameRate(true);
 
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		m_renderThread.SetWireframe(m_windowManager->GetInputManager()->IsWireframe());
 
-		// Update the game world
+		// Update the game world, its frame is drawn and swapped by the render thread
 		m_gameWorld->Update();
+	}
+
+	// Takes the context back so resources can be deleted
+	m_renderThread.Stop();
+}
+
+void GameControlEngine::AddBenchmarkKnights()
+{
+	glm::vec3 centre(0.0f);
+	std::multimap<std::string, ModelsData>::iterator itPlayer = m_allModelsData.find("player");
+	if (itPlayer != m_allModelsData.end() && !(*itPlayer).second.modelPositions.empty())
+	{
+		const std::vector<float>& position = (*itPlayer).second.modelPositions[0];
+		centre = glm::vec3(position[0], position[1], position[2]);
+	}
+
+	// One entry per knight, the way the script lists its models
+	int side = (int)std::ceil(std::sqrt((float)m_benchmarkKnights));
+	for (int i = 0; i < m_benchmarkKnights; i++)
+	{
+		ModelsData knight;
+		knight.objectName = "benchmarkKnight" + std::to_string(i + 1);
+		knight.filePath = KNIGHT_FILE;
+		knight.affordance = "knight";
+
+		float x = centre.x + ((i % side) - (side - 1) * 0.5f) * KNIGHT_SPACING;
+		float z = centre.z + ((i / side) - (side - 1) * 0.5f) * KNIGHT_SPACING;
+		knight.modelPositions.push_back({ x, centre.y, z });
+		knight.modelScales.push_back({ KNIGHT_SCALE, KNIGHT_SCALE, KNIGHT_SCALE });
+		knight.modelRotations.push_back({ 0.0f, 0.0f, 0.0f });
+
+		m_allModelsData.insert(std::pair<std::string, ModelsData>("knight", knight));
+	}
+
+	std::cout << "Benchmark: " << m_benchmarkKnights << " knights added around " << centre.x << " " << centre.y << " " << centre.z << std::endl;
+}
+
+void GameControlEngine::StartKnightAnimations()
+{
+	int knights = 0;
+	std::multimap<std::string, IGameAsset*>::const_iterator itr;
+	for (itr = m_assetFactory->GetAssets().begin(); itr != m_assetFactory->GetAssets().end(); itr++)
+	{
+		if (itr->first != "knight")
+			continue;
 
-		// Swap buffers
-		m_windowManager->SwapTheBuffers();
+		// The clips run for about a second, so the start times are spread over one
+		const char* clip = KNIGHT_CLIPS[knights % (sizeof(KNIGHT_CLIPS) / sizeof(KNIGHT_CLIPS[0]))];
+		itr->second->GetModel()->PlayAnimation(clip, KNIGHT_FRAMES_PER_SECOND, (knights * 0.137f) - std::floor(knights * 0.137f));
+		knights++;
 	}
 }
 
@@ -254,7 +459,7 @@ void GameControlEngine::InitializePhysics()
 			// Debug draw is also used here
 			m_physicsWorld->TriangleMeshTest(itr->second->GetModel()->GetMeshBatch(), true, false);
 			m_collisionBodies.push_back(colBody);
-			// This has to be called after the mesh data is passed in
+			// Creates the debug line renderer the first time it is called
 			m_physicsWorld->InitDebugDraw();
 			continue;
 		}
@@ -296,6 +501,18 @@ void GameControlEngine::InitializePhysics()
 		m_collisionBodies.push_back(colBody);
 	}
 
+	// Heightfield collision is added to the world after every other body
+	std::unordered_map<std::string, HeightmapsData>::iterator itHeightfields;
+	std::vector<Terrain*>::iterator itTerrain = m_terrains.begin();
+	for (itHeightfields = m_allHeightmapsData.begin(); itHeightfields != m_allHeightmapsData.end(); itHeightfields++, itTerrain++)
+	{
+		if (!(*itHeightfields).second.collision || !(*itTerrain)->GetHeightfield().IsOpen())
+			continue;
+
+		m_physicsWorld->AddHeightfield((*itTerrain)->GetHeightfield(), (*itTerrain)->GetHeightfieldScale(),
+			glm::vec3((*itHeightfields).second.modelPositions[0], (*itHeightfields).second.modelPositions[1], (*itHeightfields).second.modelPositions[2]));
+	}
+
 	// Initialize Affordance
 	// Local variable to call initialisation of base affordances
 	Affordance affordance = Affordance("base");
@@ -313,6 +530,17 @@ void GameControlEngine::Destroy()
 	// Destroy game world
 	m_gameWorld->Destroy();
 
+	// Delete shared shader programs and the render thread buffers while the context still exists
+	ShaderManager::Instance().ReleaseAllShaders();
+	m_renderThread.ReleaseResources();
+
+	// Deletes the physics debug draw buffers
+	if (m_physicsWorld)
+	{
+		delete m_physicsWorld;
+		m_physicsWorld = nullptr;
+	}
+
 	// Delete window
 	if (m_windowManager)
 	{
@@ -328,4 +556,11 @@ void GameControlEngine::Destroy()
 		delete m_camera;
 		m_camera = nullptr;
 	}
+
+	// Delete camera path
+	if (m_cameraPath)
+	{
+		delete m_cameraPath;
+		m_cameraPath = nullptr;
+	}
 }
\ No newline at end of file
@@ -4,19 +4,25 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <map>
 
 #include "IWindowManager.h"
 #include "TimeManager.h"
 #include "Camera.h"
+#include "CameraPath.h"
 #include "GameWorld.h"
 #include "..\Input\InputManager.h"
 #include "..\Texture\TextureManager.h"
 #include "..\Scripting\ScriptManager.h"
 #include "..\Renderer\Shader.h"
+#include "..\Renderer\ShaderManager.h"
 #include "..\AssetFactory\Model.h"
 #include "..\AssetFactory\GameAssetFactory.h"
 #include "..\AssetFactory\Player.h"
 #include "..\Renderer\OpenGl.h"
+#include "..\Renderer\RenderThread.h"
+#include "..\Common\JobSystem.h"
+#include "..\Common\StartupTimeline.h"
 
 	/*
 	* @class GameControlEngine
@@ -44,7 +50,7 @@ public:
 		*
 		* @return null
 		*/
-	GameControlEngine() { }
+	GameControlEngine() : m_cameraPath(nullptr), m_hotReload(false), m_physicsDebugDraw(false), m_benchmarkKnights(0), m_physicsWorld(nullptr) { }
 	
 		/**
 		* @brief Destructor
@@ -105,12 +111,61 @@ public:
 		*/
 	void SetCamera(Camera* camera) { m_camera = camera; }
 
+		/**
+		* @brief Sets the camera path
+		*
+		* Flies the camera along the path instead of following the player, for headless runs.
+		* The engine deletes the path when it is destroyed.
+		*
+		* @param CameraPath* cameraPath
+		* @return void
+		*/
+	void SetCameraPath(CameraPath* cameraPath) { m_cameraPath = cameraPath; }
+
+		/**
+		* @brief Sets whether files are hot reloaded
+		*
+		* Shaders, textures, models and the models and terrains scripts changed while the game
+		* runs are reloaded without a restart.
+		*
+		* @param bool hotReload
+		* @return void
+		*/
+	void SetHotReload(bool hotReload) { m_hotReload = hotReload; }
+
+		/**
+		* @brief Sets whether the physics debug lines are drawn
+		*
+		* @param bool physicsDebugDraw
+		* @return void
+		*/
+	void SetPhysicsDebugDraw(bool physicsDebugDraw) { m_physicsDebugDraw = physicsDebugDraw; }
+
+		/**
+		* @brief Sets the number of benchmark knights
+		*
+		* Adds a crowd of animated MD2 knights around the player start to the models of the
+		* script, to time many animated models.
+		*
+		* @param int count
+		* @return void
+		*/
+	void SetBenchmarkKnights(int count) { m_benchmarkKnights = count; }
+
 		/**
 		* @brief Initializes the engine
 		*
 		* This function handles loading any required system that the engine uses
 		* and loading any files into their respected data structures for further use.
 		*
+		* Scripts, heightfields, model meshes and textures are read on the job system workers
+		* while the main thread creates the window, and only the work that needs the OpenGL
+		* context or the texture manager runs on the main thread. Every step is recorded on the
+		* StartupTimeline.
+		*
+		* With world streaming enabled in the models script, props that have been cooked only have
+		* their bounds read, and the WorldStreamer loads them once the player comes in range.
+		*
 		* @return void
 		*/
 	void Initialize();
@@ -134,6 +189,26 @@ public:
 		*/
 	void InitializePhysics();
 
+		/**
+		* @brief Adds the benchmark knights
+		*
+		* Adds the knights set with SetBenchmarkKnights() to the models data, in a square grid
+		* centred on the player start.
+		*
+		* @return void
+		*/
+	void AddBenchmarkKnights();
+
+		/**
+		* @brief Starts the animations of the knights
+		*
+		* Gives every knight one of the looping clips of the model, starting at a different
+		* time, so a crowd does not move in step.
+		*
+		* @return void
+		*/
+	void StartKnightAnimations();
+
 		/**
 		* @brief Memory management
 		*
@@ -158,17 +233,35 @@ protected:
 	/// Full screen
 	bool fullScreen;
 
+	/// Whether frames are drawn on the render thread
+	bool m_useRenderThread;
+
+	/// Draws the frames submitted by the game world
+	RenderThread m_renderThread;
+
 	/// Engines window object
 	IWindowManager* m_windowManager;
 	
 	/// Engines camera object
 	Camera* m_camera;
 
+	/// Path the camera is flown along, if any
+	CameraPath* m_cameraPath;
+
+	/// Whether changed files are reloaded while the game runs
+	bool m_hotReload;
+
+	/// Whether the physics debug lines are drawn
+	bool m_physicsDebugDraw;
+
+	/// Knights added around the player start to benchmark animated models
+	int m_benchmarkKnights;
+
 	/// Game asset factory object
 	GameAssetFactory* m_assetFactory;
 
 	/// Holds Terrains
-	std::vector<Bruteforce*> m_terrains;
+	std::vector<Terrain*> m_terrains;
 
 	/// Physics world
 	PhysicsEngine* m_physicsWorld;
@@ -185,6 +278,9 @@ protected:
 	/// Map containing all models data
 	std::multimap<std::string, ModelsData> m_allModelsData;
 
+	/// Radius and memory budget of the world streaming
+	StreamingData m_streamingData;
+
 	/// Struct containing all heightmaps data
 	HeightmapsData m_heightmapsData;
 
@@ -1,18 +1,50 @@
 #include "GameWorld.h"
 
+/// Skinned models posed by one job, enough work to be worth a job of its own
+static const size_t SKELETONS_PER_JOB = 16;
+
 void GameWorld::Init(Player* player, std::multimap<std::string, IGameAsset*> gameAssets)
 {
 	// Sets this game contexts assets to the  loaded game assets from the control engine
 	SetGameAssets(gameAssets);
 
-	// Each new entity, asset needs its own shader (terrain or anything with multiple meshes especially)
-	ShaderSource mainShader = ParseShaders("Resources/shaders/Default.shader");
-	ShaderSource terrainShader = ParseShaders("Resources/shaders/Terrain.shader");
+	// Shader programs are shared between every model that uses the same shader file
+	Shader* mainShader = ShaderManager::Instance().GetShader("Resources/shaders/Default.shader");
+	Shader* arrayShader = ShaderManager::Instance().GetShader("Resources/shaders/Default.shader", "TEXTURE_ARRAY");
+
+	// Model textures were decoded in the background while loading, they must be complete before packing
+	{
+		TimelineScope scope("Finish texture uploads");
+		TextureManager::Instance().FinishPendingLoads();
+	}
+
+	// Pack the diffuse textures of the player and props into texture arrays so they share binds
+	std::vector<TextureHandle> diffuseTextures;
+	std::multimap<std::string, IGameAsset*>::iterator itr;
+	for (itr = m_gameAssets.begin(); itr != m_gameAssets.end(); itr++)
+	{
+		std::vector<Mesh>& meshes = itr->second->GetModel()->GetMeshBatch();
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			if (!meshes[i].GetTextures().empty())
+				diffuseTextures.push_back(meshes[i].GetTextures()[0].m_handle);
+		}
+	}
+	std::vector<Mesh>& playerMeshes = player->GetModel()->GetMeshBatch();
+	for (size_t i = 0; i < playerMeshes.size(); i++)
+	{
+		if (!playerMeshes[i].GetTextures().empty())
+			diffuseTextures.push_back(playerMeshes[i].GetTextures()[0].m_handle);
+	}
+	TextureManager::Instance().PackTextureArrays(diffuseTextures);
+
+	// Streamed models are prepared when they are loaded
+	m_streamer.SetShaders(mainShader, arrayShader);
 
 	// Prepare player
 	m_player = player;
 	m_player->SetCamera(m_camera);
-	m_glRenderer.Prepare(m_player->GetModel(), mainShader.VertexSource, mainShader.FragmentSource);
+	m_glRenderer.Prepare(m_player->GetModel(), mainShader, arrayShader);
 
 	// Pass player info to camera
 	m_camera->ParsePlayerInfo(m_player->GetPosition(), m_player->GetRotation());
@@ -21,59 +53,226 @@ void GameWorld::Init(Player* player, std::multimap<std::string, IGameAsset*> gam
 	m_camera->CalculateCameraPosition(horizontalDistance, verticalDistance);
 	
 	// Prepare terrains
-	for each (Bruteforce* terrain in m_terrains)
+	for each (Terrain* terrain in m_terrains)
 	{
 		terrain->SetCamera(m_camera);
-		m_glRenderer.Prepare(terrain->GetModel(), terrainShader.VertexSource, terrainShader.FragmentSource);
+		terrain->Prepare(m_glRenderer, ShaderManager::Instance().GetShader("Resources/shaders/Terrain.shader", terrain->GetShaderDefines()));
 	}
 	
 	// Prepare assets
-	std::multimap<std::string, IGameAsset*>::iterator itr;
 	for (itr = m_gameAssets.begin(); itr != m_gameAssets.end(); itr++)
 	{
 		itr->second->SetCamera(m_camera);
-		m_glRenderer.Prepare(itr->second->GetModel(), mainShader.VertexSource, mainShader.FragmentSource);
+		m_glRenderer.Prepare(itr->second->GetModel(), mainShader, arrayShader);
+
+		// The building hides most of the scene from outside
+		if (itr->second->GetAssetName() == "lecTheatre")
+			m_occlusionCuller.AddOccluder(itr->second->GetModel());
 	}
+
+	std::cout << "Shader programs created: " << ShaderManager::Instance().GetProgramCount() << std::endl;
+	std::cout << "Vertex buffers: " << m_glRenderer.GetVertexBufferBytes() / 1024 << " KB packed, "
+		<< m_glRenderer.GetUnpackedVertexBytes() / 1024 << " KB unpacked" << std::endl;
+	std::cout << "Textures: " << TextureCooker::Instance().GetCompressedBytes() / 1024 << " KB compressed, "
+		<< TextureCooker::Instance().GetUncompressedBytes() / 1024 << " KB uncompressed, "
+		<< TextureCooker::Instance().GetCacheHits() << " cache hits, " << TextureCooker::Instance().GetCacheMisses()
+		<< " cooked, " << TextureCooker::Instance().GetCookSeconds() * 1000.0 << " ms" << std::endl;
+	TextureManager::Instance().PrintTextureStats();
 }
 
 void GameWorld::Update()
 {
 	// Camera
-	m_camera->ParsePlayerInfo(m_player->GetPosition(), m_player->GetRotation());
-	float horizontalDistance = m_camera->CalculateHorizontalDistance();
-	float verticalDistance = m_camera->CalculateVerticalDistance();
-	m_camera->CalculateCameraPosition(horizontalDistance, verticalDistance);
+	if (m_cameraPath)
+	{
+		m_cameraPath->Apply(*m_camera, m_pathFrame);
+		m_pathFrame++;
+	}
+	else
+	{
+		m_camera->ParsePlayerInfo(m_player->GetPosition(), m_player->GetRotation());
+		float horizontalDistance = m_camera->CalculateHorizontalDistance();
+		float verticalDistance = m_camera->CalculateVerticalDistance();
+		m_camera->CalculateCameraPosition(horizontalDistance, verticalDistance);
+	}
+
+	// The snapshot is drawn by the render thread while the next frame is simulated
+	RenderSnapshot& snapshot = m_renderThread->BeginFrame();
 
 	// Blue sky
-	glClearColor(0.0, 0.0, 0.5, 1.0);
+	snapshot.clearColour = glm::vec4(0.0f, 0.0f, 0.5f, 1.0f);
+
+	// Terrains make their own OpenGL calls, so they are drawn on the render thread with the snapshot camera
+	for each (Terrain* terrain in m_terrains)
+	{
+		snapshot.commands.push_back([terrain](OpenGl& renderer, Camera* camera)
+		{
+			terrain->SetCamera(camera);
+			terrain->Render(renderer);
+		});
+	}
 
 	// Render player
 	//m_glRenderer.Render(m_player->GetModel());
 
-	/// Debug draw
-	//m_physicsWorld->DebugDraw();
+	// Bullet reads the world, so the lines are collected here and drawn on the render thread before the models
+	if (m_physicsDebugDraw && m_physicsWorld)
+	{
+		// Kept in the snapshot, so the line memory of each snapshot is reused frame after frame
+		m_physicsWorld->CollectDebugLines(snapshot.debugLines);
+
+		PhysicsEngine* physicsWorld = m_physicsWorld;
+		const std::vector<DebugLineVertex>* lines = &snapshot.debugLines;
+		snapshot.commands.push_back([physicsWorld, lines](OpenGl&, Camera* camera)
+		{
+			physicsWorld->DrawDebugLines(*lines, CreateViewMatrix(camera), camera->GetProjectionMatrix());
+		});
+	}
+
+	// Files changed on disk are reloaded before the streamer sees the models
+	m_hotReloader.Update(snapshot);
+
+	// Load the models around the player, or the camera when it is flown along a path
+	m_streamer.Update(m_cameraPath ? m_camera->GetPosition() : m_player->GetPosition(), snapshot);
+
+	// Vertex animated models move on through their clips, the frames are blended when they are drawn
+	std::chrono::high_resolution_clock::time_point animationStart = std::chrono::high_resolution_clock::now();
+	float deltaTime = (float)TimeManager::Instance().DeltaTime;
+	for (size_t i = 0; i < m_bodyModels.size(); i++)
+		m_bodyModels[i]->UpdateAnimation(deltaTime);
+	std::chrono::duration<double, std::milli> animationMs = std::chrono::high_resolution_clock::now() - animationStart;
+	m_animationMs += animationMs.count();
+
+	// Skinned models are posed on the workers, a batch of models per job, before they are rendered
+	m_skinnedModels.clear();
+	for (size_t i = 0; i < m_bodyModels.size(); i++)
+	{
+		if (m_bodyModels[i]->GetSkeleton())
+			m_skinnedModels.push_back(m_bodyModels[i]);
+	}
+	if (!m_skinnedModels.empty())
+	{
+		std::chrono::high_resolution_clock::time_point skinningStart = std::chrono::high_resolution_clock::now();
+		JobCounter posed;
+		for (size_t first = 0; first < m_skinnedModels.size(); first += SKELETONS_PER_JOB)
+		{
+			size_t last = std::min(first + SKELETONS_PER_JOB, m_skinnedModels.size());
+			JobSystem::Instance().Submit([this, first, last, deltaTime]()
+			{
+				for (size_t i = first; i < last; i++)
+					m_skinnedModels[i]->UpdateSkeleton(deltaTime);
+			}, &posed);
+		}
+		JobSystem::Instance().Wait(posed);
+		std::chrono::duration<double, std::milli> skinningMs = std::chrono::high_resolution_clock::now() - skinningStart;
+		m_skinningMs += skinningMs.count();
+	}
 
 	// Update all physics body locations *** All asset rendering is done through here for now because I dont want to have to call asset render twice ***
 	UpdatePhysics();
+
+	// Hand the queued models and the camera they are seen from to the render thread
+	snapshot.camera = *m_camera;
+	snapshot.view = CreateViewMatrix(m_camera);
+	snapshot.projection = m_camera->GetProjectionMatrix();
+	m_glRenderer.TakeDrawQueue(snapshot.drawItems, snapshot.bonePalettes);
+	m_renderThread->SubmitFrame();
+
+	// The first frame may still be being drawn
+	RenderStats stats = m_renderThread->GetRenderStats();
+	if (!m_renderStatsPrinted && stats.drawCalls > 0)
+	{
+		std::cout << "Render queue: " << stats.drawCalls << " draws of " << stats.instances << " meshes, " << stats.shaderBinds << " shader binds, "
+			<< stats.textureBinds << " texture binds (" << stats.unsortedTextureBinds << " unsorted), "
+			<< stats.vertexArrayBinds << " vertex array binds, " << stats.uniformBytes / stats.drawCalls << " uniform bytes per draw" << std::endl;
+		m_renderStatsPrinted = true;
+	}
+
+	double time = TimeManager::Instance().GetTime();
+	if (time - m_cullingReportTime >= 1.0)
+	{
+		const CullingStats& culling = m_occlusionCuller.GetStats();
+		std::cout << "Occlusion culling: " << culling.culled << "/" << culling.tested << " culled ("
+			<< culling.GetCulledPercent() << "%), " << culling.occluderTriangles << " occluder triangles, "
+			<< culling.rasterizeMs << " ms rasterize, " << culling.testMs << " ms test" << std::endl;
+
+		std::cout << "Triangles drawn: " << stats.triangles << " of " << stats.fullDetailTriangles
+			<< " at full detail" << std::endl;
+
+		if (stats.transformStalls > 0 || stats.skippedDraws > 0)
+			std::cout << "Transform buffer: " << stats.transformStalls << " stalls waiting for the GPU, "
+				<< stats.skippedDraws << " draws skipped with palettes larger than a region" << std::endl;
+
+		if (m_streamer.IsEnabled())
+		{
+			StreamingStats streaming = m_streamer.GetStats();
+			std::cout << "World streaming: " << streaming.resident << "/" << streaming.models << " resident, " << streaming.loading
+				<< " loading, " << streaming.residentBytes / 1024 << " KB of " << streaming.budgetBytes / 1024 << " KB, "
+				<< streaming.loads << " loads, " << streaming.evictions << " evictions" << std::endl;
+		}
+
+		if (m_animatedModels > 0)
+		{
+			std::cout << "Keyframe animation: " << m_animatedModels << " models, " << m_animationMs << " ms updating" << std::endl;
+			m_animationMs = 0.0;
+		}
+
+		if (!m_skinnedModels.empty())
+		{
+			std::cout << "Skeletal animation: " << m_skinnedModels.size() << " models, " << m_skinningMs << " ms posing on "
+				<< JobSystem::Instance().GetWorkerCount() << " workers" << std::endl;
+			m_skinningMs = 0.0;
+		}
+
+		FrameTimings timings = m_renderThread->TakeFrameTimings();
+		std::cout << "Frame timings: " << timings.latencyMs << " ms latency, " << timings.simulationMs << " ms simulation, "
+			<< timings.waitMs << " ms waiting, " << timings.renderMs << " ms rendering"
+			<< (m_renderThread->IsRunning() ? " (render thread)" : " (game loop thread)") << std::endl;
+		m_cullingReportTime = time;
+	}
 }
 
 void GameWorld::Destroy()
 {
+	// Models still loading are waited for before the assets go
+	m_hotReloader.Destroy();
+	m_streamer.Destroy();
+
 	std::multimap<std::string, IGameAsset*>::iterator itr;
 	for (itr = m_gameAssets.begin(); itr != m_gameAssets.end(); itr++)
 	{
 		itr->second->Destroy();
 	}
 
-	// Delete all heightmap BruteForce
-	for (int i = 0; i < m_terrains.size()-1; i++)
+	// Delete all heightmap terrains
+	for (size_t i = 0; i < m_terrains.size(); i++)
 		delete m_terrains[i];
+	m_terrains.clear();
+}
+
+void GameWorld::EnableHotReload(const std::multimap<std::string, ModelsData>& modelsData, const std::unordered_map<std::string, HeightmapsData>& heightmapsData)
+{
+	m_hotReloader.Init(m_gameAssets, modelsData, m_terrains, heightmapsData, m_physicsWorld, &m_streamer,
+		ShaderManager::Instance().GetShader("Resources/shaders/Default.shader"),
+		ShaderManager::Instance().GetShader("Resources/shaders/Default.shader", "TEXTURE_ARRAY"));
 }
 
 void GameWorld::SetPhysicsWorld(PhysicsEngine* physicsEngine, std::vector<CollisionBody*>& collisionBodies)
 {
 	m_physicsWorld = physicsEngine;
 	m_collisionBodies = &collisionBodies;
+
+	// Bodies were created one per asset in asset order, looking them up by their type name would
+	// give every instance of a type the first one's model
+	m_bodyModels.clear();
+	m_animatedModels = 0;
+	std::multimap<std::string, IGameAsset*>::iterator itr = m_gameAssets.begin();
+	for (size_t i = 0; i < collisionBodies.size() && itr != m_gameAssets.end(); i++, itr++)
+	{
+		m_bodyModels.push_back(itr->second->GetModel());
+		if (itr->second->GetModel()->GetKeyframes())
+			m_animatedModels++;
+	}
 }
 
 // Update all physics
@@ -93,16 +292,27 @@ void GameWorld::UpdatePhysics()
 	ComputerAI* compAI;
 
 	// Loop through all the rigid bodies to update their position
+	std::vector<Model*> models(m_collisionBodies->size());
 	for (size_t i = 0; i < m_collisionBodies->size(); i++)
 	{
 		glm::vec3 updPosition = BttoGlm(m_collisionBodies->at(i)->m_position);
 		glm::vec3 updRotation = BttoGlm(m_collisionBodies->at(i)->m_rotation);
 		
 		// Search through map using find. If found, update that objects position
-		m_gameAssets.find(m_collisionBodies->at(i)->m_modelName)->second->GetModel()->SetPosition(updPosition);
-		m_gameAssets.find(m_collisionBodies->at(i)->m_modelName)->second->GetModel()->SetRotation(updRotation);
-		// Search through map using find. If found, render the object
-		m_glRenderer.Render(m_gameAssets.find(m_collisionBodies->at(i)->m_modelName)->second->GetModel());
+		models[i] = m_bodyModels[i];
+		models[i]->SetPosition(updPosition);
+		models[i]->SetRotation(updRotation);
+	}
+
+	// Occluders are rasterized once every model has moved, then the hidden models are skipped
+	m_occlusionCuller.BeginFrame(m_camera->GetProjectionMatrix() * CreateViewMatrix(m_camera));
+	m_occlusionCuller.TestModels(models, m_modelVisible);
+
+	for (size_t i = 0; i < models.size(); i++)
+	{
+		// Streamed models keep their collision body while they are not loaded, but are not drawn
+		if (m_modelVisible[i] && models[i]->IsResident())
+			m_glRenderer.Render(models[i]);
 	}
 
 	/// CSmith	20/10/18
@@ -10,7 +10,10 @@
 #include <GLM\gtx\transform2.hpp>
 
 #include "Camera.h"
+#include "CameraPath.h"
 #include "TimeManager.h"
+#include "WorldStreamer.h"
+#include "HotReloader.h"
 #include "..\Physics\PhysicsEngine.h"
 #include "..\Texture\TextureManager.h"
 #include "..\Scripting\ScriptManager.h"
@@ -18,9 +21,13 @@
 #include "..\AssetFactory\Model.h"
 #include "..\AssetFactory\IGameAsset.h"
 #include "..\AssetFactory\Bruteforce.h"
+#include "..\AssetFactory\Geomipmap.h"
 #include "..\AssetFactory\Player.h"
 #include "..\Renderer\OpenGl.h"
+#include "..\Renderer\OcclusionCuller.h"
+#include "..\Renderer\RenderThread.h"
 #include "..\Renderer\Shader.h"
+#include "..\Renderer\ShaderManager.h"
 #include "..\AI\ComputerAI.h"
 #include "glut.h"
 
@@ -47,11 +54,11 @@ public:
 		/**
 		* @brief Default constructor
 		*
-		* Empty default constructor.
+		* Default constructor.
 		*
 		* @return null
 		*/
-	GameWorld() { }
+	GameWorld() : m_physicsDebugDraw(false), m_renderThread(NULL), m_renderStatsPrinted(false), m_cullingReportTime(0.0), m_animatedModels(0), m_animationMs(0.0), m_skinningMs(0.0), m_cameraPath(NULL), m_pathFrame(0) { }
 
 		/**
 		* @brief Destructor
@@ -75,7 +82,8 @@ public:
 		* @brief Updates the game world
 		*
 		* Recieves any changes that have been made due to input, game logic or
-		* physics and updates the current game instance.
+		* physics and updates the current game instance. The frame is drawn from a
+		* snapshot handed to the render thread.
 		*
 		* @return void
 		*/
@@ -115,7 +123,7 @@ public:
 		* @brief Sets the physics world properties
 		*
 		* Passes the initialized physics engine and populated collision bodies to the game world
-		* object to be used.
+		* object to be used. There is one body per asset, in the order of the assets.
 		*
 		* @param PhysicsEngine* physicsEngine
 		* @param std::vector<btVector3> collisionBodies
@@ -149,10 +157,10 @@ public:
 		* Sets the member data structure containing all the terrains to the vector data structure parsed in 
 		* as a parameter.
 		*
-		* @param std::vector<Bruteforce*> terrains
+		* @param std::vector<Terrain*> terrains
 		* @return void
 		*/
-	void SetTerrains(std::vector<Bruteforce*> terrains) { m_terrains = terrains; }
+	void SetTerrains(std::vector<Terrain*> terrains) { m_terrains = terrains; }
 
 		/**
 		* @brief Sets the AI
@@ -165,6 +173,60 @@ public:
 		*/
 	void SetAI(std::vector<ComputerAI*> allAI) { m_agents = allAI; }
 
+		/**
+		* @brief Sets the render thread
+		*
+		* Sets the render thread the snapshot of every frame is submitted to.
+		*
+		* @param RenderThread* renderThread
+		* @return void
+		*/
+	void SetRenderThread(RenderThread* renderThread) { m_renderThread = renderThread; }
+
+		/**
+		* @brief Sets the camera path
+		*
+		* Flies the camera along the path, one step per frame, instead of following the player.
+		* NULL follows the player again.
+		*
+		* @param const CameraPath* cameraPath
+		* @return void
+		*/
+	void SetCameraPath(const CameraPath* cameraPath) { m_cameraPath = cameraPath; m_pathFrame = 0; }
+
+		/**
+		* @brief Gets the world streamer
+		*
+		* Returns the streamer that loads and evicts the models around the player.
+		*
+		* @return WorldStreamer&
+		*/
+	WorldStreamer& GetStreamer() { return m_streamer; }
+
+		/**
+		* @brief Sets whether the physics debug lines are drawn
+		*
+		* Draws the Bullet debug lines of the physics world over the frame. Needs the debug draw
+		* of the physics world to have been initialised.
+		*
+		* @param bool physicsDebugDraw
+		* @return void
+		*/
+	void SetPhysicsDebugDraw(bool physicsDebugDraw) { m_physicsDebugDraw = physicsDebugDraw; }
+
+		/**
+		* @brief Enables hot reload
+		*
+		* Watches the files of the world and reloads the ones that change while the game runs.
+		* Called once the assets, terrains and physics world have been set, with the script data
+		* they were created from.
+		*
+		* @param const std::multimap<std::string, ModelsData>& modelsData
+		* @param const std::unordered_map<std::string, HeightmapsData>& heightmapsData
+		* @return void
+		*/
+	void EnableHotReload(const std::multimap<std::string, ModelsData>& modelsData, const std::unordered_map<std::string, HeightmapsData>& heightmapsData);
+
 protected:
 	/// Shader sources
 	ShaderSource m_assimpShaderSource, m_shaderSource1, m_shaderSource2, m_testShaderSource;
@@ -175,17 +237,59 @@ protected:
 	/// Physics world
 	PhysicsEngine* m_physicsWorld;
 
+	/// Whether the physics debug lines are drawn
+	bool m_physicsDebugDraw;
+
 	/// Vector of all collision objects (static and dynamic)
 	std::vector<CollisionBody*>* m_collisionBodies;
 
+	/// Model of each collision body, bodies only name the type of their model
+	std::vector<Model*> m_bodyModels;
+
 	std::multimap<std::string, IGameAsset*> m_gameAssets;
 
-	std::vector<Bruteforce*> m_terrains;
+	std::vector<Terrain*> m_terrains;
 
 	std::vector<ComputerAI*> m_agents;
 
 	Player* m_player;
 	float s = 0.01;
 
+	/// Queues the model draws of each frame for the snapshot
 	OpenGl m_glRenderer;
+
+	/// Draws the snapshots of the frames
+	RenderThread* m_renderThread;
+
+	/// Whether the render statistics of the first frame have been printed
+	bool m_renderStatsPrinted;
+
+	/// Culls the models hidden inside the lecture theatre
+	OcclusionCuller m_occlusionCuller;
+
+	/// Loads and evicts the models around the player
+	WorldStreamer m_streamer;
+
+	/// Reloads the files changed while the game runs
+	HotReloader m_hotReloader;
+
+	/// Visibility of each collision body model this frame
+	std::vector<char> m_modelVisible;
+
+	/// Time the culling statistics were last printed
+	double m_cullingReportTime;
+
+	/// Vertex animated models and the time spent updating them since the last report
+	int m_animatedModels;
+	double m_animationMs;
+
+	/// Skinned models posed this frame and the time spent posing them since the last report
+	std::vector<Model*> m_skinnedModels;
+	double m_skinningMs;
+
+	/// Path the camera is flown along instead of following the player, if any
+	const CameraPath* m_cameraPath;
+
+	/// Frames flown along the camera path
+	int m_pathFrame;
 };
\ No newline at end of file
@@ -0,0 +1,342 @@
+#include "HeadlessManager.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#include "..\Common\FileUtils.h"
+
+#ifdef CARRE_HEADLESS_EGL
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#endif
+
+HeadlessManager::HeadlessManager(int frameCount)
+	: m_frameCount(frameCount), m_framesStarted(0), m_framesDrawn(0), m_width(0), m_height(0),
+	m_framebuffer(0), m_colourBuffer(0), m_depthBuffer(0), m_captureInterval(0),
+	m_timingsFile("headless_timings.csv"), m_initialized(false)
+{
+#ifdef CARRE_HEADLESS_EGL
+	m_display = EGL_NO_DISPLAY;
+	m_surface = EGL_NO_SURFACE;
+	m_context = EGL_NO_CONTEXT;
+#else
+	m_window = nullptr;
+#endif
+}
+
+int HeadlessManager::Initialize(int width, int height, std::string, bool)
+{
+	m_width = width;
+	m_height = height;
+
+	if (!CreateContext(width, height))
+	{
+		std::cout << "Failed to create an offscreen OpenGL context!" << std::endl;
+		DestroyContext();
+
+		return -1;
+	}
+
+	glewExperimental = GL_TRUE;
+
+	GLenum err = glewInit();
+	if (GLEW_OK != err)
+	{
+		std::cout << "Failed to initialize glew!" << std::endl;
+		DestroyContext();
+
+		return -1;
+	}
+
+	// glewInit() can leave an error behind on core contexts
+	glGetError();
+
+	std::cout << "Headless renderer: " << glGetString(GL_RENDERER) << ", OpenGL " << glGetString(GL_VERSION) << std::endl;
+
+	// Frames are drawn into a framebuffer object, the context may not have a surface of its own
+	glGenRenderbuffers(1, &m_colourBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_colourBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	glGenRenderbuffers(1, &m_depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &m_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_colourBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "Failed to create the headless framebuffer!" << std::endl;
+		m_initialized = true;
+		Destroy();
+
+		return -1;
+	}
+
+	m_frameTimes.reserve(m_frameCount);
+	m_lastSwap = std::chrono::high_resolution_clock::now();
+	m_initialized = true;
+
+	return 0;
+}
+
+bool HeadlessManager::CreateContext(int width, int height)
+{
+#ifdef CARRE_HEADLESS_EGL
+	// Mesa's surfaceless platform needs no display server, other EGL drivers use their default display
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay)
+		m_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	if (m_display == EGL_NO_DISPLAY)
+		m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major, minor;
+	if (m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, &major, &minor))
+	{
+		std::cout << "Failed to initialize EGL!" << std::endl;
+		m_display = EGL_NO_DISPLAY;
+		return false;
+	}
+
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		std::cout << "EGL does not support desktop OpenGL!" << std::endl;
+		return false;
+	}
+
+	const EGLint configAttributes[] =
+	{
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(m_display, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		std::cout << "Failed to find an EGL config!" << std::endl;
+		return false;
+	}
+
+	const EGLint contextAttributes[] =
+	{
+		EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+		EGL_CONTEXT_MINOR_VERSION_KHR, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+		EGL_NONE
+	};
+
+	m_context = eglCreateContext(m_display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (m_context == EGL_NO_CONTEXT)
+	{
+		std::cout << "Failed to create an EGL OpenGL 3.3 context!" << std::endl;
+		return false;
+	}
+
+	// Without surfaceless contexts a small pbuffer is made current, drawing still goes to the framebuffer object
+	const char* extensions = eglQueryString(m_display, EGL_EXTENSIONS);
+	if (extensions == NULL || strstr(extensions, "EGL_KHR_surfaceless_context") == NULL)
+	{
+		const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		m_surface = eglCreatePbufferSurface(m_display, config, surfaceAttributes);
+		if (m_surface == EGL_NO_SURFACE)
+		{
+			std::cout << "Failed to create an EGL pbuffer!" << std::endl;
+			return false;
+		}
+	}
+
+	return eglMakeCurrent(m_display, m_surface, m_surface, m_context) == EGL_TRUE;
+#else
+	if (!glfwInit())
+	{
+		std::cout << "Failed to initialize GLFW!" << std::endl;
+		return false;
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+	m_window = glfwCreateWindow(width, height, "Carre Game Engine (headless)", nullptr, nullptr);
+	if (m_window == nullptr)
+		return false;
+
+	glfwMakeContextCurrent(m_window);
+	glfwSwapInterval(0);
+
+	return true;
+#endif
+}
+
+void HeadlessManager::DestroyContext()
+{
+#ifdef CARRE_HEADLESS_EGL
+	if (m_display != EGL_NO_DISPLAY)
+	{
+		eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (m_context != EGL_NO_CONTEXT)
+			eglDestroyContext(m_display, m_context);
+		if (m_surface != EGL_NO_SURFACE)
+			eglDestroySurface(m_display, m_surface);
+		eglTerminate(m_display);
+	}
+
+	m_display = EGL_NO_DISPLAY;
+	m_surface = EGL_NO_SURFACE;
+	m_context = EGL_NO_CONTEXT;
+#else
+	m_window = nullptr;
+	glfwTerminate();
+#endif
+}
+
+void HeadlessManager::SwapTheBuffers()
+{
+	// Nothing is presented, waiting for the frame makes its time the time it took to draw
+	glFinish();
+
+	std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double, std::milli> frameTime = now - m_lastSwap;
+	m_frameTimes.push_back(frameTime.count());
+
+	if (!m_captureDirectory.empty() && m_framesDrawn % m_captureInterval == 0)
+		CaptureFrame(m_framesDrawn);
+
+	m_framesDrawn++;
+
+	// Capturing is not part of the next frame
+	m_lastSwap = std::chrono::high_resolution_clock::now();
+}
+
+bool HeadlessManager::ProcessInput(bool continueGame)
+{
+#ifndef CARRE_HEADLESS_EGL
+	// Keeps the hidden window responding to the system
+	glfwPollEvents();
+#endif
+
+	if (m_framesStarted >= m_frameCount)
+		return false;
+
+	m_framesStarted++;
+
+	return continueGame;
+}
+
+void HeadlessManager::MakeContextCurrent(bool current)
+{
+#ifdef CARRE_HEADLESS_EGL
+	if (current)
+		eglMakeCurrent(m_display, m_surface, m_surface, m_context);
+	else
+		eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+#else
+	glfwMakeContextCurrent(current ? m_window : nullptr);
+#endif
+}
+
+void HeadlessManager::SetCaptureDirectory(const std::string& directory, int interval)
+{
+	m_captureDirectory = directory;
+	m_captureInterval = interval > 0 ? interval : 1;
+
+	if (!m_captureDirectory.empty() && !MakeDirectory(m_captureDirectory))
+	{
+		std::cout << "Failed to create capture directory " << m_captureDirectory << std::endl;
+		m_captureDirectory.clear();
+	}
+}
+
+void HeadlessManager::CaptureFrame(int frame)
+{
+	std::vector<unsigned char> pixels(m_width * m_height * 3);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glReadPixels(0, 0, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE, &pixels[0]);
+
+	char fileName[32];
+	sprintf(fileName, "frame_%05d.ppm", frame);
+
+	std::ofstream file(m_captureDirectory + "/" + fileName, std::ios::binary);
+	if (!file)
+	{
+		std::cout << "Failed to save frame " << frame << std::endl;
+		return;
+	}
+
+	file << "P6\n" << m_width << " " << m_height << "\n255\n";
+
+	// OpenGL reads the bottom row first, images start at the top
+	for (int y = m_height - 1; y >= 0; y--)
+		file.write((const char*)&pixels[y * m_width * 3], m_width * 3);
+}
+
+void HeadlessManager::WriteTimings()
+{
+	if (m_frameTimes.empty())
+		return;
+
+	if (!m_timingsFile.empty())
+	{
+		std::ofstream file(m_timingsFile);
+		if (file)
+		{
+			file << "frame,ms\n";
+			for (size_t i = 0; i < m_frameTimes.size(); i++)
+				file << i << "," << m_frameTimes[i] << "\n";
+		}
+		else
+		{
+			std::cout << "Failed to write frame timings to " << m_timingsFile << std::endl;
+		}
+	}
+
+	// The first frame also uploads resources, so it is left out of the summary
+	std::vector<double> sorted(m_frameTimes.begin() + (m_frameTimes.size() > 1 ? 1 : 0), m_frameTimes.end());
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+	for (size_t i = 0; i < sorted.size(); i++)
+		total += sorted[i];
+	double average = total / sorted.size();
+
+	std::cout << "Headless run: " << m_frameTimes.size() << " frames, " << average << " ms average ("
+		<< 1000.0 / average << " fps), " << sorted[sorted.size() / 2] << " ms median, "
+		<< sorted[(sorted.size() * 95) / 100] << " ms 95th percentile, "
+		<< sorted[(sorted.size() * 99) / 100] << " ms 99th percentile, " << sorted.back() << " ms worst" << std::endl;
+}
+
+void HeadlessManager::Destroy()
+{
+	if (!m_initialized)
+		return;
+
+	m_initialized = false;
+
+	WriteTimings();
+
+	if (m_framebuffer)
+		glDeleteFramebuffers(1, &m_framebuffer);
+	if (m_colourBuffer)
+		glDeleteRenderbuffers(1, &m_colourBuffer);
+	if (m_depthBuffer)
+		glDeleteRenderbuffers(1, &m_depthBuffer);
+	m_framebuffer = m_colourBuffer = m_depthBuffer = 0;
+
+	DestroyContext();
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include "GL\glew.h"
+#include "IWindowManager.h"
+
+#ifdef CARRE_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
+#include "GLFW\glfw3.h"
+#endif
+
+	/**
+	* @class HeadlessManager
+	* @brief Window manager that draws offscreen, for performance runs without a display
+	*
+	* GLFWManager opens a visible window, which build servers without a display or GPU cannot do.
+	* This manager creates an OpenGL 3.3 core context with no visible surface and binds a
+	* framebuffer object of the window size that every frame is drawn into. It takes no input and
+	* ends the game loop after a set number of frames, which GameControlEngine flies along a
+	* CameraPath.
+	*
+	* Every frame is finished with glFinish() so the time between swaps is the time the frame
+	* took to draw. The frame times are written to a CSV file and summarised when the manager is
+	* destroyed, and every few frames can be saved as PPM images to compare against reference
+	* images.
+	*
+	* Built with CARRE_HEADLESS_EGL the context is created through EGL on Mesa's surfaceless
+	* platform, which needs neither a display server nor a GPU when Mesa falls back to its
+	* llvmpipe software rasterizer. GLEW must then be built with GLEW_EGL so it loads functions
+	* through EGL. Otherwise a hidden GLFW window provides the context, which on Windows build
+	* servers can be Mesa's software opengl32.dll placed next to the executable.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class HeadlessManager : public IWindowManager
+{
+public:
+		/**
+		* @brief Constructor
+		*
+		* Creates a manager that ends the game loop after the given number of frames.
+		*
+		* @param int frameCount
+		* @return null
+		*/
+	HeadlessManager(int frameCount);
+
+		/**
+		* @brief Destructor
+		*
+		* Runs Destroy() to write the timings and release the context.
+		*
+		* @return null
+		*/
+	~HeadlessManager() { Destroy(); }
+
+		/**
+		* @brief Initializes the offscreen context
+		*
+		* Creates the OpenGL context and a framebuffer object of the given size to draw into. The
+		* title and full screen setting are ignored.
+		*
+		* @param int width
+		* @param int height
+		* @param std::string strTitle
+		* @param bool bFullScreen
+		* @return int
+		*/
+	virtual int Initialize(int width, int height, std::string strTitle, bool bFullScreen = false) override;
+
+		/**
+		* @brief Finishes a frame
+		*
+		* Waits for the frame to be drawn, records how long it took since the last one and saves
+		* it as an image if it is one of the captured frames.
+		*
+		* @return void
+		*/
+	virtual void SwapTheBuffers() override;
+
+		/**
+		* @brief Processes the input of the user
+		*
+		* There is no input, the game loop continues until the frame count is reached.
+		*
+		* @param bool continueGame
+		* @return bool
+		*/
+	virtual bool ProcessInput(bool continueGame) override;
+
+		/**
+		* @brief Destroys the offscreen context
+		*
+		* Writes the frame timings, deletes the framebuffer object and destroys the context.
+		*
+		* @return void
+		*/
+	virtual void Destroy() override;
+
+		/**
+		* @brief Makes the OpenGL context current
+		*
+		* @param bool current
+		* @return void
+		*/
+	virtual void MakeContextCurrent(bool current) override;
+
+		/**
+		* @brief Sets where frames are captured
+		*
+		* Saves every interval-th frame as directory/frame_NNNNN.ppm. An empty directory captures
+		* nothing.
+		*
+		* @param const std::string& directory
+		* @param int interval
+		* @return void
+		*/
+	void SetCaptureDirectory(const std::string& directory, int interval);
+
+		/**
+		* @brief Sets the frame timings file
+		*
+		* Sets the CSV file the time of every frame is written to when the manager is destroyed.
+		*
+		* @param const std::string& filePath
+		* @return void
+		*/
+	void SetTimingsFile(const std::string& filePath) { m_timingsFile = filePath; }
+
+private:
+		/**
+		* @brief Creates the OpenGL context
+		*
+		* Creates an OpenGL 3.3 core context and makes it current.
+		*
+		* @param int width
+		* @param int height
+		* @return bool
+		*/
+	bool CreateContext(int width, int height);
+
+		/**
+		* @brief Destroys the OpenGL context
+		*
+		* @return void
+		*/
+	void DestroyContext();
+
+		/**
+		* @brief Saves the framebuffer as an image
+		*
+		* Reads back the colour buffer and writes it as a binary PPM.
+		*
+		* @param int frame
+		* @return void
+		*/
+	void CaptureFrame(int frame);
+
+		/**
+		* @brief Writes the frame timings
+		*
+		* Writes the time of every frame to the timings file and prints the average and
+		* percentiles.
+		*
+		* @return void
+		*/
+	void WriteTimings();
+
+	/// Frames drawn before the game loop is ended
+	int m_frameCount;
+
+	/// Frames started by the game loop and frames swapped
+	int m_framesStarted, m_framesDrawn;
+
+	/// Size of the framebuffer object
+	int m_width, m_height;
+
+	/// Framebuffer object frames are drawn into, with its colour and depth buffers
+	GLuint m_framebuffer, m_colourBuffer, m_depthBuffer;
+
+	/// Directory captured frames are saved to and how many frames apart they are
+	std::string m_captureDirectory;
+	int m_captureInterval;
+
+	/// CSV file the frame times are written to
+	std::string m_timingsFile;
+
+	/// Time each frame took from the previous swap, in milliseconds
+	std::vector<double> m_frameTimes;
+
+	/// When the last frame was swapped
+	std::chrono::high_resolution_clock::time_point m_lastSwap;
+
+	/// Whether Initialize() succeeded and Destroy() has not been called yet
+	bool m_initialized;
+
+#ifdef CARRE_HEADLESS_EGL
+	/// EGL display, surface and context, the surface is EGL_NO_SURFACE when surfaceless
+	EGLDisplay m_display;
+	EGLSurface m_surface;
+	EGLContext m_context;
+#else
+	/// Hidden window owning the context
+	GLFWwindow* m_window;
+#endif
+};
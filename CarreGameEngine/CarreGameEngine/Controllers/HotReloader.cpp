@@ -0,0 +1,457 @@
+#include "HotReloader.h"
+
+/// Scripts read again when they change
+static const std::string MODELS_SCRIPT = "Resources/scripts/ModelsInit.lua";
+static const std::string TERRAINS_SCRIPT = "Resources/scripts/TerrainsInit.lua";
+
+// Instances the engine gives AI, a player body or a collision mesh, which are only created at startup
+static bool IsMovable(const std::string& type)
+{
+	return type != "lecTheatre" && type != "person" && type != "player";
+}
+
+static double GetMilliseconds(const std::chrono::high_resolution_clock::time_point& start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+HotReloader::HotReloader()
+	: m_enabled(false), m_physicsWorld(NULL), m_streamer(NULL), m_shader(NULL), m_arrayShader(NULL)
+{
+}
+
+void HotReloader::Init(const std::multimap<std::string, IGameAsset*>& gameAssets, const std::multimap<std::string, ModelsData>& modelsData,
+	const std::vector<Terrain*>& terrains, const std::unordered_map<std::string, HeightmapsData>& heightmapsData,
+	PhysicsEngine* physicsWorld, WorldStreamer* streamer, Shader* shader, Shader* arrayShader)
+{
+	m_physicsWorld = physicsWorld;
+	m_streamer = streamer;
+	m_shader = shader;
+	m_arrayShader = arrayShader;
+
+	m_watcher.Watch(MODELS_SCRIPT);
+	m_watcher.Watch(TERRAINS_SCRIPT);
+
+	// The engine creates one asset and one collision body per instance, in script order
+	std::multimap<std::string, IGameAsset*>::const_iterator itAsset = gameAssets.begin();
+	std::multimap<std::string, ModelsData>::const_iterator itModels;
+	int bodyIndex = 0;
+	for (itModels = modelsData.begin(); itModels != modelsData.end(); itModels++)
+	{
+		for (size_t k = 0; k < (*itModels).second.modelPositions.size() && itAsset != gameAssets.end(); k++, itAsset++, bodyIndex++)
+		{
+			HotReloadInstance instance;
+			instance.type = (*itModels).first;
+			instance.objectName = (*itModels).second.objectName;
+			instance.data = (*itModels).second;
+			instance.asset = itAsset->second;
+			instance.bodyIndex = bodyIndex;
+			m_instances.push_back(instance);
+
+			m_modelFiles.insert(instance.data.filePath);
+			m_watcher.Watch(instance.data.filePath);
+			m_watcher.Watch(instance.data.texFilePath);
+		}
+	}
+
+	std::vector<Terrain*>::const_iterator itTerrain = terrains.begin();
+	std::unordered_map<std::string, HeightmapsData>::const_iterator itHeightfields;
+	for (itHeightfields = heightmapsData.begin(); itHeightfields != heightmapsData.end() && itTerrain != terrains.end(); itHeightfields++, itTerrain++)
+		m_terrains[(*itHeightfields).first] = std::make_pair(*itTerrain, (*itHeightfields).second);
+
+	std::vector<std::string> filePaths;
+	ShaderManager::Instance().GetShaderFiles(filePaths);
+	for (size_t i = 0; i < filePaths.size(); i++)
+	{
+		m_shaderFiles.insert(filePaths[i]);
+		m_watcher.Watch(filePaths[i]);
+	}
+
+	// Textures are told apart from the other files by not being one of them
+	filePaths.clear();
+	TextureManager::Instance().GetTextureFiles(filePaths);
+	for (size_t i = 0; i < filePaths.size(); i++)
+		m_watcher.Watch(filePaths[i]);
+
+	m_enabled = true;
+
+	std::cout << "Hot reload: watching " << m_watcher.GetWatchCount() << " files" << std::endl;
+}
+
+void HotReloader::Update(RenderSnapshot& snapshot)
+{
+	if (!m_enabled)
+		return;
+
+	UpdateBatches(snapshot);
+
+	std::vector<std::string> changed;
+	m_watcher.Poll(TimeManager::Instance().GetTime(), changed);
+
+	for (size_t i = 0; i < changed.size(); i++)
+	{
+		std::string filePath = changed[i];
+
+		if (filePath == MODELS_SCRIPT)
+		{
+			ReloadModelsScript(snapshot);
+		}
+		else if (filePath == TERRAINS_SCRIPT)
+		{
+			ReloadTerrainsScript(snapshot);
+		}
+		else if (m_shaderFiles.find(filePath) != m_shaderFiles.end())
+		{
+			// Programs are linked on the render thread, the shader pointers stay the same
+			snapshot.commands.push_back([filePath](OpenGl&, Camera*)
+			{
+				std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+				int programs = ShaderManager::Instance().ReloadShaderFile(filePath);
+				std::cout << "Reloaded shader " << filePath << ": " << programs << " programs in " << GetMilliseconds(start) << " ms" << std::endl;
+			});
+		}
+		else if (m_modelFiles.find(filePath) != m_modelFiles.end())
+		{
+			ReloadModelFile(filePath, snapshot);
+		}
+		else
+		{
+			// Decoded on a worker and uploaded into the texture it replaces by the texture manager
+			snapshot.commands.push_back([filePath](OpenGl&, Camera*)
+			{
+				if (!TextureManager::Instance().ReloadTexture(filePath))
+					std::cout << "Texture not reloaded, it is not loaded or is still loading: " << filePath << std::endl;
+			});
+		}
+	}
+}
+
+void HotReloader::UpdateBatches(RenderSnapshot& snapshot)
+{
+	size_t i = 0;
+	while (i < m_batches.size())
+	{
+		HotReloadBatch* batch = m_batches[i];
+
+		if (!batch->swapped)
+		{
+			if (batch->loaded.pending > 0)
+			{
+				i++;
+				continue;
+			}
+
+			// The assets are not drawn until the render thread has uploaded the meshes swapped into them
+			for (size_t j = 0; j < batch->assets.size(); j++)
+			{
+				batch->assets[j]->GetModel()->SwapMeshes(*batch->loaders[j]);
+				batch->assets[j]->GetModel()->SetResident(false);
+			}
+			batch->swapped = true;
+
+			std::vector<IGameAsset*> assets = batch->assets;
+			std::vector<Model*> loaders = batch->loaders;
+			std::string texFilePath = batch->texFilePath;
+			Shader* shader = m_shader;
+			Shader* arrayShader = m_arrayShader;
+			std::atomic<bool>* uploaded = &batch->uploaded;
+			snapshot.commands.push_back([assets, loaders, texFilePath, shader, arrayShader, uploaded](OpenGl& renderer, Camera*)
+			{
+				for (size_t j = 0; j < assets.size(); j++)
+				{
+					Model* model = assets[j]->GetModel();
+					model->LoadTextures();
+					if (assets[j]->GetAssetName() != "lecTheatre" && !model->GetMeshBatch().empty())
+						assets[j]->AddTexutre(TextureManager::Instance().GetTextureID(texFilePath), texFilePath);
+					renderer.Prepare(model, shader, arrayShader);
+				}
+
+				// The loaders hold the old meshes now, their buffers go once no model shares them
+				for (size_t j = 0; j < loaders.size(); j++)
+					delete loaders[j];
+
+				uploaded->store(true, std::memory_order_release);
+			});
+			batch->loaders.clear();
+
+			i++;
+			continue;
+		}
+
+		if (!batch->uploaded.load(std::memory_order_acquire))
+		{
+			i++;
+			continue;
+		}
+
+		// Collision bodies keep the size they were created with
+		for (size_t j = 0; j < batch->assets.size(); j++)
+		{
+			batch->assets[j]->GetModel()->SetResident(true);
+			batch->assets[j]->CalculateDimensions();
+		}
+
+		std::cout << "Reloaded model " << batch->filePath << " for " << batch->assets.size() << " instances in "
+			<< GetMilliseconds(batch->start) << " ms" << std::endl;
+
+		// Instances that changed again while loading are loaded from the files the script now gives them
+		std::vector<HotReloadInstance*> reloads;
+		if (batch->reloadAgain)
+		{
+			for (size_t j = 0; j < m_instances.size(); j++)
+			{
+				if (std::find(batch->assets.begin(), batch->assets.end(), m_instances[j].asset) != batch->assets.end())
+					reloads.push_back(&m_instances[j]);
+			}
+		}
+
+		delete batch;
+		m_batches.erase(m_batches.begin() + i);
+
+		ReloadInstances(reloads, snapshot);
+	}
+}
+
+HotReloadInstance* HotReloader::FindInstance(const std::string& type, const std::string& objectName)
+{
+	for (size_t i = 0; i < m_instances.size(); i++)
+	{
+		if (m_instances[i].type == type && m_instances[i].objectName == objectName)
+			return &m_instances[i];
+	}
+
+	return NULL;
+}
+
+void HotReloader::ReloadModelsScript(RenderSnapshot& snapshot)
+{
+	std::multimap<std::string, ModelsData> allModelsData;
+	ModelsData modelsData;
+	StreamingData streamingData;
+
+	// A script saved half way through an edit only prints its error
+	ScriptManager::Instance().SetPauseOnError(false);
+	bool loaded = ScriptManager::Instance().LoadModelsInitLua(allModelsData, modelsData, streamingData);
+	ScriptManager::Instance().SetPauseOnError(true);
+	if (!loaded)
+		return;
+
+	// Instances are matched by their unique names, the order of a Lua table can change with any edit
+	std::vector<char> found(m_instances.size(), 0);
+	std::vector<HotReloadInstance*> reloads;
+	int moved = 0, scaled = 0;
+
+	std::multimap<std::string, ModelsData>::iterator itModels;
+	for (itModels = allModelsData.begin(); itModels != allModelsData.end(); itModels++)
+	{
+		const std::string& type = (*itModels).first;
+		const ModelsData& data = (*itModels).second;
+
+		HotReloadInstance* instance = FindInstance(type, data.objectName);
+		if (!instance)
+		{
+			std::cout << "Models script: " << data.objectName << " was added, restart to create it" << std::endl;
+			continue;
+		}
+		found[instance - &m_instances[0]] = 1;
+
+		if (data.filePath != instance->data.filePath || data.texFilePath != instance->data.texFilePath)
+		{
+			reloads.push_back(instance);
+
+			if (m_modelFiles.insert(data.filePath).second)
+				m_watcher.Watch(data.filePath);
+			m_watcher.Watch(data.texFilePath);
+		}
+
+		if (!data.modelPositions.empty() && data.modelPositions != instance->data.modelPositions)
+		{
+			glm::vec3 position(data.modelPositions[0][0], data.modelPositions[0][1], data.modelPositions[0][2]);
+			if (IsMovable(type))
+			{
+				instance->asset->SetPosition(position);
+				m_physicsWorld->SetBodyPosition(instance->bodyIndex, GlmtoBt(position));
+				moved++;
+			}
+			else
+			{
+				std::cout << "Models script: " << data.objectName << " was moved, restart to move it" << std::endl;
+			}
+		}
+
+		if (!data.modelScales.empty() && data.modelScales != instance->data.modelScales)
+		{
+			instance->asset->SetScale(glm::vec3(data.modelScales[0][0], data.modelScales[0][1], data.modelScales[0][2]));
+			scaled++;
+		}
+
+		instance->data = data;
+	}
+
+	for (size_t i = 0; i < m_instances.size(); i++)
+	{
+		if (!found[i])
+			std::cout << "Models script: " << m_instances[i].objectName << " was removed, restart to remove it" << std::endl;
+	}
+
+	std::cout << "Reloaded models script: " << moved << " moved, " << scaled << " scaled, " << reloads.size() << " reloading" << std::endl;
+
+	ReloadInstances(reloads, snapshot);
+}
+
+void HotReloader::ReloadTerrainsScript(RenderSnapshot& snapshot)
+{
+	std::unordered_map<std::string, HeightmapsData> allHeightmapsData;
+	HeightmapsData heightmapsData;
+
+	ScriptManager::Instance().SetPauseOnError(false);
+	bool loaded = ScriptManager::Instance().LoadHeightmapsInitLua(allHeightmapsData, heightmapsData);
+	ScriptManager::Instance().SetPauseOnError(true);
+	if (!loaded)
+		return;
+
+	int moved = 0;
+	std::unordered_map<std::string, HeightmapsData>::iterator itHeightfields;
+	for (itHeightfields = allHeightmapsData.begin(); itHeightfields != allHeightmapsData.end(); itHeightfields++)
+	{
+		const std::string& name = (*itHeightfields).first;
+		const HeightmapsData& data = (*itHeightfields).second;
+
+		std::map<std::string, std::pair<Terrain*, HeightmapsData> >::iterator itTerrain = m_terrains.find(name);
+		if (itTerrain == m_terrains.end())
+		{
+			std::cout << "Terrains script: " << name << " was added, restart to create it" << std::endl;
+			continue;
+		}
+
+		Terrain* terrain = itTerrain->second.first;
+		HeightmapsData& current = itTerrain->second.second;
+
+		// Terrains are drawn on the render thread, so they are moved there
+		if (data.modelPositions.size() >= 3 && data.modelPositions != current.modelPositions)
+		{
+			glm::vec3 position(data.modelPositions[0], data.modelPositions[1], data.modelPositions[2]);
+			snapshot.commands.push_back([terrain, position](OpenGl&, Camera*) { terrain->SetPosition(position); });
+			current.modelPositions = data.modelPositions;
+			moved++;
+
+			if (current.collision)
+				std::cout << "Terrains script: the collision of " << name << " stays where it was until a restart" << std::endl;
+		}
+
+		if (data.filePath != current.filePath || data.texFilePath != current.texFilePath || data.fileSize != current.fileSize
+			|| data.modelScales != current.modelScales || data.method != current.method || data.patchSize != current.patchSize
+			|| data.gpuDisplacement != current.gpuDisplacement || data.bitDepth != current.bitDepth || data.collision != current.collision)
+		{
+			std::cout << "Terrains script: " << name << " was changed, restart to build it again" << std::endl;
+		}
+	}
+
+	std::map<std::string, std::pair<Terrain*, HeightmapsData> >::iterator itTerrain;
+	for (itTerrain = m_terrains.begin(); itTerrain != m_terrains.end(); itTerrain++)
+	{
+		if (allHeightmapsData.find(itTerrain->first) == allHeightmapsData.end())
+			std::cout << "Terrains script: " << itTerrain->first << " was removed, restart to remove it" << std::endl;
+	}
+
+	std::cout << "Reloaded terrains script: " << moved << " moved" << std::endl;
+}
+
+void HotReloader::ReloadModelFile(const std::string& filePath, RenderSnapshot& snapshot)
+{
+	// Models loaded from the file before now keep the old meshes, the next load reads the file again
+	ModelCache::Instance().Forget(filePath);
+
+	std::vector<HotReloadInstance*> reloads;
+	for (size_t i = 0; i < m_instances.size(); i++)
+	{
+		if (m_instances[i].data.filePath == filePath)
+			reloads.push_back(&m_instances[i]);
+	}
+
+	ReloadInstances(reloads, snapshot);
+}
+
+void HotReloader::ReloadInstances(const std::vector<HotReloadInstance*>& instances, RenderSnapshot& snapshot)
+{
+	// Instances loaded from the same files are loaded together
+	std::map<std::pair<std::string, std::string>, std::vector<IGameAsset*> > files;
+	for (size_t i = 0; i < instances.size(); i++)
+		files[std::make_pair(instances[i]->data.filePath, instances[i]->data.texFilePath)].push_back(instances[i]->asset);
+
+	std::map<std::pair<std::string, std::string>, std::vector<IGameAsset*> >::iterator itFile;
+	for (itFile = files.begin(); itFile != files.end(); itFile++)
+		ReloadAssets(itFile->second, itFile->first.first, itFile->first.second, snapshot);
+}
+
+void HotReloader::ReloadAssets(const std::vector<IGameAsset*>& assets, const std::string& filePath, const std::string& texFilePath, RenderSnapshot& snapshot)
+{
+	HotReloadBatch* batch = NULL;
+
+	for (size_t i = 0; i < assets.size(); i++)
+	{
+		IGameAsset* asset = assets[i];
+
+		if (m_streamer->Reload(asset, filePath, texFilePath, snapshot))
+			continue;
+
+		// An asset still reloading is reloaded again once it has finished
+		bool reloading = false;
+		for (size_t j = 0; j < m_batches.size() && !reloading; j++)
+		{
+			if (std::find(m_batches[j]->assets.begin(), m_batches[j]->assets.end(), asset) != m_batches[j]->assets.end())
+			{
+				m_batches[j]->reloadAgain = true;
+				reloading = true;
+			}
+		}
+		if (reloading)
+			continue;
+
+		if (!batch)
+		{
+			batch = new HotReloadBatch();
+			batch->filePath = filePath;
+			batch->texFilePath = texFilePath;
+			batch->uploaded = false;
+			batch->swapped = false;
+			batch->reloadAgain = false;
+			batch->start = std::chrono::high_resolution_clock::now();
+		}
+
+		batch->assets.push_back(asset);
+		batch->loaders.push_back(new Model());
+	}
+
+	if (!batch)
+		return;
+
+	// The first loader reads the file, the others share it through the model cache
+	std::vector<Model*> loaders = batch->loaders;
+	std::string path = filePath;
+	JobSystem::Instance().Submit([loaders, path]()
+	{
+		for (size_t i = 0; i < loaders.size(); i++)
+			loaders[i]->LoadMeshes(path);
+	}, &batch->loaded);
+
+	m_batches.push_back(batch);
+}
+
+void HotReloader::Destroy()
+{
+	for (size_t i = 0; i < m_batches.size(); i++)
+	{
+		// The workers may still be writing the loaders
+		JobSystem::Instance().Wait(m_batches[i]->loaded);
+		for (size_t j = 0; j < m_batches[i]->loaders.size(); j++)
+			delete m_batches[i]->loaders[j];
+
+		delete m_batches[i];
+	}
+	m_batches.clear();
+
+	m_instances.clear();
+	m_terrains.clear();
+	m_enabled = false;
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <chrono>
+#include <GLM\glm.hpp>
+
+#include "TimeManager.h"
+#include "WorldStreamer.h"
+#include "..\AssetFactory\IGameAsset.h"
+#include "..\AssetFactory\Model.h"
+#include "..\AssetFactory\ModelCache.h"
+#include "..\AssetFactory\Terrain.h"
+#include "..\Physics\PhysicsEngine.h"
+#include "..\Renderer\RenderThread.h"
+#include "..\Renderer\Shader.h"
+#include "..\Renderer\ShaderManager.h"
+#include "..\Scripting\ScriptManager.h"
+#include "..\Texture\TextureManager.h"
+#include "..\Common\FileWatcher.h"
+#include "..\Common\JobSystem.h"
+#include "..\Common\MyMath.h"
+#include "..\Common\Structs.h"
+
+	/**
+	* @struct HotReloadInstance
+	* @brief A model instance of the models script and the asset created for it
+	*/
+struct HotReloadInstance
+{
+	/// Type and unique name of the instance in the script
+	std::string type, objectName;
+
+	/// Script data the asset was last created or reloaded from
+	ModelsData data;
+
+	/// Asset of the instance
+	IGameAsset* asset;
+
+	/// Index of the collision body of the asset in the physics world
+	int bodyIndex;
+};
+
+	/**
+	* @struct HotReloadBatch
+	* @brief Models being loaded again from a changed file
+	*/
+struct HotReloadBatch
+{
+	/// Model file and the texture the script gives it
+	std::string filePath, texFilePath;
+
+	/// Assets reloaded, and the models the worker loads their meshes into
+	std::vector<IGameAsset*> assets;
+	std::vector<Model*> loaders;
+
+	/// Finished once every loader has its meshes
+	JobCounter loaded;
+
+	/// Set by the render thread once the meshes are uploaded
+	std::atomic<bool> uploaded;
+
+	/// Whether the meshes have been swapped into the assets
+	bool swapped;
+
+	/// The file changed again while it was loading
+	bool reloadAgain;
+
+	/// When the change was seen, for the reload time
+	std::chrono::high_resolution_clock::time_point start;
+};
+
+	/**
+	* @class HotReloader
+	* @brief Reloads the resources whose files change while the game runs
+	*
+	* Watches the shader, texture and model files in use and the models and terrains scripts,
+	* and reloads only what a changed file affects: the programs made from a shader file are
+	* linked again, a texture is uploaded again into the texture object or array layer it has,
+	* and the instances of a model are loaded again and swapped in. Everything keeps its handle,
+	* shader pointers, texture ids and assets stay the same, so nothing that refers to them has
+	* to be told.
+	*
+	* Models are loaded on the job system and swapped in the same way the world streamer swaps
+	* in streamed models, streamed models are simply evicted and stream back in from the new
+	* file. Changes to the models script move and scale the instances in place and reload the
+	* instances whose files changed, changes to the terrains script move the terrains.
+	*
+	* Adding or removing instances, resizing collision bodies and changing terrain heightfields
+	* need a restart, and are reported as such.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class HotReloader
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates a reloader watching nothing.
+		*
+		* @return null
+		*/
+	HotReloader();
+
+		/**
+		* @brief Destructor
+		*
+		* Calls Destroy().
+		*
+		* @return null
+		*/
+	~HotReloader() { Destroy(); }
+
+		/**
+		* @brief Starts watching the files of the world
+		*
+		* The assets must be in the order of the script data, one asset per instance, as the
+		* engine creates them. The heightmaps data must be the map the terrains were created
+		* from, in the same order.
+		*
+		* @param const std::multimap<std::string, IGameAsset*>& gameAssets
+		* @param const std::multimap<std::string, ModelsData>& modelsData
+		* @param const std::vector<Terrain*>& terrains
+		* @param const std::unordered_map<std::string, HeightmapsData>& heightmapsData
+		* @param PhysicsEngine* physicsWorld
+		* @param WorldStreamer* streamer
+		* @param Shader* shader
+		* @param Shader* arrayShader
+		* @return void
+		*/
+	void Init(const std::multimap<std::string, IGameAsset*>& gameAssets, const std::multimap<std::string, ModelsData>& modelsData,
+		const std::vector<Terrain*>& terrains, const std::unordered_map<std::string, HeightmapsData>& heightmapsData,
+		PhysicsEngine* physicsWorld, WorldStreamer* streamer, Shader* shader, Shader* arrayShader);
+
+		/**
+		* @brief Checks if files are being watched
+		*
+		* @return bool
+		*/
+	bool IsEnabled() const { return m_enabled; }
+
+		/**
+		* @brief Reloads the changed files
+		*
+		* Swaps in the models that finished loading and queues the reloads of the files that
+		* changed since the last frame on the snapshot. Called once per frame on the game loop
+		* thread.
+		*
+		* @param RenderSnapshot& snapshot
+		* @return void
+		*/
+	void Update(RenderSnapshot& snapshot);
+
+		/**
+		* @brief Stops watching
+		*
+		* Waits for the models being loaded and deletes them. Called when the game loop has
+		* finished, with the context current on the calling thread.
+		*
+		* @return void
+		*/
+	void Destroy();
+
+private:
+		/**
+		* @brief Swaps in and finishes the models that have loaded
+		*
+		* @param RenderSnapshot& snapshot
+		* @return void
+		*/
+	void UpdateBatches(RenderSnapshot& snapshot);
+
+		/**
+		* @brief Reloads the models of the models script
+		*
+		* Reads the script again and moves, scales or reloads the instances that changed.
+		*
+		* @param RenderSnapshot& snapshot
+		* @return void
+		*/
+	void ReloadModelsScript(RenderSnapshot& snapshot);
+
+		/**
+		* @brief Reloads the terrains of the terrains script
+		*
+		* Reads the script again and moves the terrains that changed.
+		*
+		* @param RenderSnapshot& snapshot
+		* @return void
+		*/
+	void ReloadTerrainsScript(RenderSnapshot& snapshot);
+
+		/**
+		* @brief Reloads every instance loaded from a model file
+		*
+		* @param const std::string& filePath
+		* @param RenderSnapshot& snapshot
+		* @return void
+		*/
+	void ReloadModelFile(const std::string& filePath, RenderSnapshot& snapshot);
+
+		/**
+		* @brief Reloads instances from the files the script gives them
+		*
+		* @param const std::vector<HotReloadInstance*>& instances
+		* @param RenderSnapshot& snapshot
+		* @return void
+		*/
+	void ReloadInstances(const std::vector<HotReloadInstance*>& instances, RenderSnapshot& snapshot);
+
+		/**
+		* @brief Reloads assets from a model file
+		*
+		* Streamed assets are handed to the streamer, the rest are loaded on a worker in one
+		* batch, so the file is only read once.
+		*
+		* @param const std::vector<IGameAsset*>& assets
+		* @param const std::string& filePath
+		* @param const std::string& texFilePath
+		* @param RenderSnapshot& snapshot
+		* @return void
+		*/
+	void ReloadAssets(const std::vector<IGameAsset*>& assets, const std::string& filePath, const std::string& texFilePath, RenderSnapshot& snapshot);
+
+		/**
+		* @brief Finds the instance of the models script with a unique name
+		*
+		* @param const std::string& type
+		* @param const std::string& objectName
+		* @return HotReloadInstance*
+		*/
+	HotReloadInstance* FindInstance(const std::string& type, const std::string& objectName);
+
+	/// Reports the changed files
+	FileWatcher m_watcher;
+
+	/// Whether Init() has been called
+	bool m_enabled;
+
+	/// Instances of the models script, in script order
+	std::vector<HotReloadInstance> m_instances;
+
+	/// Terrains by their name in the terrains script, and the data they were created from
+	std::map<std::string, std::pair<Terrain*, HeightmapsData> > m_terrains;
+
+	/// Collision bodies are moved with the instances
+	PhysicsEngine* m_physicsWorld;
+
+	/// Streams the streamed models back in
+	WorldStreamer* m_streamer;
+
+	/// Shaders the reloaded models are prepared with
+	Shader* m_shader;
+	Shader* m_arrayShader;
+
+	/// Files of each kind being watched
+	std::unordered_set<std::string> m_shaderFiles, m_modelFiles;
+
+	/// Models being loaded again
+	std::vector<HotReloadBatch*> m_batches;
+};
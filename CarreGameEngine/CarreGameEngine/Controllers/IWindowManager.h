@@ -71,6 +71,17 @@ public:
 		*/
 	virtual void Destroy() = 0;
 
+		/**
+		* @brief Makes the OpenGL context current
+		*
+		* Makes the OpenGL context of the window current on the calling thread, or releases it
+		* from the calling thread so another thread can make it current.
+		*
+		* @param bool current
+		* @return void
+		*/
+	virtual void MakeContextCurrent(bool current) = 0;
+
 		/**
 		* @brief Returns the input manager object
 		*
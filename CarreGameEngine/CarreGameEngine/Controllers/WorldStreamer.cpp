@@ -0,0 +1,264 @@
+#include "WorldStreamer.h"
+
+/// Models loading on the workers at once, so the closest ones are not queued behind the rest
+static const int MAX_LOADS_IN_FLIGHT = 4;
+
+/// Models handed to the render thread per frame, each uploads all of its meshes
+static const int MAX_UPLOADS_PER_FRAME = 2;
+
+WorldStreamer::WorldStreamer()
+	: m_radius(0.0f), m_budgetBytes(0), m_shader(NULL), m_arrayShader(NULL), m_frame(0),
+	m_residentBytes(0), m_loads(0), m_evictions(0)
+{
+}
+
+void WorldStreamer::Add(IGameAsset* asset, const std::string& filePath, const std::string& texFilePath, bool resident)
+{
+	Model* model = asset->GetModel();
+
+	StreamedModel* streamed = new StreamedModel();
+	streamed->asset = asset;
+	streamed->filePath = filePath;
+	streamed->texFilePath = texFilePath;
+	streamed->radius = glm::length((model->GetBoundsMax() - model->GetBoundsMin()) * 0.5f * model->GetScale());
+	streamed->state = resident ? STREAM_RESIDENT : STREAM_UNLOADED;
+	streamed->loader = NULL;
+	streamed->uploaded = resident;
+	streamed->lastUsedFrame = 0;
+	streamed->reload = false;
+	m_models.push_back(streamed);
+
+	model->SetResident(resident);
+	if (resident)
+		m_residentBytes = CountResidentBytes();
+}
+
+void WorldStreamer::Update(const glm::vec3& playerPosition, RenderSnapshot& snapshot)
+{
+	if (!IsEnabled() || m_models.empty())
+		return;
+
+	m_frame++;
+
+	int loading = 0, uploads = 0;
+	bool residencyChanged = false;
+	std::vector<std::pair<float, StreamedModel*> > requests;
+
+	for (size_t i = 0; i < m_models.size(); i++)
+	{
+		StreamedModel& streamed = *m_models[i];
+		Model* model = streamed.asset->GetModel();
+
+		// Distance from the player to the bounds of the model
+		glm::vec3 centre = glm::vec3(model->GetTransform().GetWorldMatrix() * glm::vec4((model->GetBoundsMin() + model->GetBoundsMax()) * 0.5f, 1.0f));
+		float distance = glm::length(centre - playerPosition) - streamed.radius;
+		if (distance <= m_radius)
+			streamed.lastUsedFrame = m_frame;
+
+		switch (streamed.state)
+		{
+		case STREAM_UNLOADED:
+			if (distance <= m_radius)
+				requests.push_back(std::make_pair(distance, &streamed));
+			break;
+
+		case STREAM_LOADING:
+			if (streamed.loaded.pending > 0 || uploads >= MAX_UPLOADS_PER_FRAME)
+			{
+				loading++;
+				break;
+			}
+
+			// The asset is not drawn until the render thread has uploaded the meshes swapped into it
+			model->SwapMeshes(*streamed.loader);
+			delete streamed.loader;
+			streamed.loader = NULL;
+			streamed.uploaded = false;
+			streamed.state = STREAM_UPLOADING;
+			uploads++;
+			m_loads++;
+
+			{
+				IGameAsset* asset = streamed.asset;
+				std::string texFilePath = streamed.texFilePath;
+				Shader* shader = m_shader;
+				Shader* arrayShader = m_arrayShader;
+				std::atomic<bool>* uploaded = &streamed.uploaded;
+				snapshot.commands.push_back([asset, texFilePath, shader, arrayShader, uploaded](OpenGl& renderer, Camera*)
+				{
+					asset->GetModel()->LoadTextures();
+					if (!asset->GetModel()->GetMeshBatch().empty())
+						asset->AddTexutre(TextureManager::Instance().GetTextureID(texFilePath), texFilePath);
+					renderer.Prepare(asset->GetModel(), shader, arrayShader);
+					uploaded->store(true, std::memory_order_release);
+				});
+			}
+			break;
+
+		case STREAM_UPLOADING:
+			if (streamed.uploaded.load(std::memory_order_acquire))
+			{
+				model->SetResident(true);
+				streamed.state = STREAM_RESIDENT;
+				residencyChanged = true;
+
+				if (streamed.reload)
+				{
+					streamed.reload = false;
+					Evict(streamed, snapshot);
+				}
+			}
+			break;
+
+		case STREAM_RESIDENT:
+			break;
+		}
+	}
+
+	// Closest models first
+	std::sort(requests.begin(), requests.end(), [](const std::pair<float, StreamedModel*>& a, const std::pair<float, StreamedModel*>& b) { return a.first < b.first; });
+	for (size_t i = 0; i < requests.size() && loading < MAX_LOADS_IN_FLIGHT; i++, loading++)
+	{
+		StreamedModel& streamed = *requests[i].second;
+
+		// Loaded into a model of its own, the asset keeps being moved and tested while it loads
+		Model* loader = new Model();
+		std::string filePath = streamed.filePath;
+		streamed.loader = loader;
+		streamed.state = STREAM_LOADING;
+		JobSystem::Instance().Submit([loader, filePath]() { loader->LoadMeshes(filePath); }, &streamed.loaded);
+	}
+
+	if (!residencyChanged)
+		return;
+
+	// Least recently used models out of range are evicted until the resident meshes fit the budget
+	m_residentBytes = CountResidentBytes();
+	while (m_residentBytes > m_budgetBytes)
+	{
+		StreamedModel* oldest = NULL;
+		for (size_t i = 0; i < m_models.size(); i++)
+		{
+			StreamedModel* streamed = m_models[i];
+			if (streamed->state == STREAM_RESIDENT && streamed->lastUsedFrame != m_frame && (!oldest || streamed->lastUsedFrame < oldest->lastUsedFrame))
+				oldest = streamed;
+		}
+
+		// Models in range are never evicted, the budget is exceeded until the player moves on
+		if (!oldest)
+			break;
+
+		Evict(*oldest, snapshot);
+		m_residentBytes = CountResidentBytes();
+	}
+}
+
+void WorldStreamer::Evict(StreamedModel& streamed, RenderSnapshot& snapshot)
+{
+	Model* model = streamed.asset->GetModel();
+	model->SetResident(false);
+
+	// The buffers and textures are deleted on the render thread, once no model shares them
+	Model* evicted = new Model();
+	model->SwapMeshes(*evicted);
+	snapshot.commands.push_back([evicted](OpenGl&, Camera*) { delete evicted; });
+
+	streamed.state = STREAM_UNLOADED;
+	m_evictions++;
+}
+
+bool WorldStreamer::Reload(IGameAsset* asset, const std::string& filePath, const std::string& texFilePath, RenderSnapshot& snapshot)
+{
+	for (size_t i = 0; i < m_models.size(); i++)
+	{
+		StreamedModel& streamed = *m_models[i];
+		if (streamed.asset != asset)
+			continue;
+
+		streamed.filePath = filePath;
+		streamed.texFilePath = texFilePath;
+
+		// Models still loading finish with the old file and are evicted as soon as they are resident
+		if (streamed.state == STREAM_RESIDENT)
+		{
+			Evict(streamed, snapshot);
+			m_residentBytes = CountResidentBytes();
+		}
+		else if (streamed.state != STREAM_UNLOADED)
+		{
+			streamed.reload = true;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+size_t WorldStreamer::GetMeshBytes(Model* model)
+{
+	size_t bytes = 0;
+	std::vector<Mesh>& meshes = model->GetMeshBatch();
+	for (size_t i = 0; i < meshes.size(); i++)
+	{
+		size_t indexCount = meshes[i].IsCooked() ? meshes[i].GetCookedIndexCount() : meshes[i].GetIndices().size();
+		bytes += meshes[i].GetVertexCount() * meshes[i].GetLayout().GetStride() + indexCount * sizeof(unsigned int);
+	}
+
+	return bytes;
+}
+
+size_t WorldStreamer::CountResidentBytes() const
+{
+	// Models loaded from the same file share the mesh batch
+	std::unordered_set<const void*> counted;
+	size_t bytes = 0;
+	for (size_t i = 0; i < m_models.size(); i++)
+	{
+		if (m_models[i]->state != STREAM_RESIDENT)
+			continue;
+
+		Model* model = m_models[i]->asset->GetModel();
+		if (counted.insert(&model->GetMeshBatch()).second)
+			bytes += GetMeshBytes(model);
+	}
+
+	return bytes;
+}
+
+StreamingStats WorldStreamer::GetStats() const
+{
+	StreamingStats stats;
+	stats.models = (int)m_models.size();
+	stats.resident = 0;
+	stats.loading = 0;
+	for (size_t i = 0; i < m_models.size(); i++)
+	{
+		if (m_models[i]->state == STREAM_RESIDENT)
+			stats.resident++;
+		else if (m_models[i]->state != STREAM_UNLOADED)
+			stats.loading++;
+	}
+	stats.residentBytes = m_residentBytes;
+	stats.budgetBytes = m_budgetBytes;
+	stats.loads = m_loads;
+	stats.evictions = m_evictions;
+
+	return stats;
+}
+
+void WorldStreamer::Destroy()
+{
+	for (size_t i = 0; i < m_models.size(); i++)
+	{
+		// The workers may still be writing the loader
+		if (m_models[i]->loader)
+		{
+			JobSystem::Instance().Wait(m_models[i]->loaded);
+			delete m_models[i]->loader;
+		}
+
+		delete m_models[i];
+	}
+	m_models.clear();
+}
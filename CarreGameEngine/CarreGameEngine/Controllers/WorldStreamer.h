@@ -0,0 +1,266 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <unordered_set>
+#include <GLM\glm.hpp>
+
+#include "..\AssetFactory\IGameAsset.h"
+#include "..\AssetFactory\Model.h"
+#include "..\Renderer\RenderThread.h"
+#include "..\Renderer\Shader.h"
+#include "..\Texture\TextureManager.h"
+#include "..\Common\JobSystem.h"
+
+	/**
+	* @enum StreamState
+	* @brief Where a streamed model is between its file and the screen
+	*/
+enum StreamState
+{
+	STREAM_UNLOADED,	/**< Only the placeholder bounds are known */
+	STREAM_LOADING,		/**< The meshes are being loaded on a worker */
+	STREAM_UPLOADING,	/**< The meshes are loaded, the render thread is uploading them */
+	STREAM_RESIDENT		/**< The model is drawn */
+};
+
+	/**
+	* @struct StreamedModel
+	* @brief A model of the world that is loaded and evicted by the world streamer
+	*/
+struct StreamedModel
+{
+	/// Asset the model belongs to
+	IGameAsset* asset;
+
+	/// Model file and the texture the script gives it
+	std::string filePath, texFilePath;
+
+	/// Radius of the model bounds in world space, added to the streaming radius
+	float radius;
+
+	/// Only changed by the game loop thread
+	StreamState state;
+
+	/// Model the worker loads the meshes into, swapped into the asset once loaded
+	Model* loader;
+
+	/// Finished once the loader has its meshes
+	JobCounter loaded;
+
+	/// Set by the render thread once the meshes are uploaded
+	std::atomic<bool> uploaded;
+
+	/// Last frame the player was in range of the model
+	unsigned int lastUsedFrame;
+
+	/// The files changed while the model was loading, it is evicted once resident to load again
+	bool reload;
+};
+
+	/**
+	* @struct StreamingStats
+	* @brief Residency of the streamed models and the work done to stream them
+	*/
+struct StreamingStats
+{
+	/// Streamed models, and the ones drawn or on their way
+	int models, resident, loading;
+
+	/// Bytes of mesh data of the resident models, and the budget they are evicted to
+	size_t residentBytes, budgetBytes;
+
+	/// Models loaded and evicted since the start
+	int loads, evictions;
+};
+
+	/**
+	* @class WorldStreamer
+	* @brief Loads the models of the world around the player and evicts them when memory runs low
+	*
+	* Loading every model of ModelsInit.lua before the first frame keeps the screen black for
+	* the whole load and every model resident for the whole game, however far away it is. The
+	* world streamer only loads a model once the player comes within the streaming radius of
+	* it, on the job system, and then hands it to the render thread to upload over the following
+	* frames. Models stay resident after the player leaves, until the mesh data of the resident
+	* models goes over the memory budget, then the least recently used models out of range are
+	* evicted.
+	*
+	* The collision bodies of streamed models are created at startup from their placeholder
+	* bounds and never removed, so nothing falls through a model that is still loading. The
+	* asset keeps its transform and collision body while it is not resident, it is only not
+	* drawn.
+	*
+	* Meshes are loaded into a model of their own and swapped into the asset on the game loop
+	* thread, and uploads and evictions are render commands, so the game loop never sees a
+	* model change under it and every OpenGL call is made on the render thread.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class WorldStreamer
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates a streamer with streaming disabled.
+		*
+		* @return null
+		*/
+	WorldStreamer();
+
+		/**
+		* @brief Destructor
+		*
+		* Calls Destroy().
+		*
+		* @return null
+		*/
+	~WorldStreamer() { Destroy(); }
+
+		/**
+		* @brief Sets the streaming radius and memory budget
+		*
+		* Models are loaded once the player is within radius of their bounds. A radius of 0
+		* disables streaming and every model is loaded at startup.
+		*
+		* @param float radius
+		* @param size_t budgetBytes
+		* @return void
+		*/
+	void SetLimits(float radius, size_t budgetBytes) { m_radius = radius; m_budgetBytes = budgetBytes; }
+
+		/**
+		* @brief Checks if streaming is enabled
+		*
+		* @return bool
+		*/
+	bool IsEnabled() const { return m_radius > 0.0f; }
+
+		/**
+		* @brief Sets the shaders streamed models are prepared with
+		*
+		* @param Shader* shader
+		* @param Shader* arrayShader
+		* @return void
+		*/
+	void SetShaders(Shader* shader, Shader* arrayShader) { m_shader = shader; m_arrayShader = arrayShader; }
+
+		/**
+		* @brief Adds a model to stream
+		*
+		* The asset must have its scale, position and bounds set. A resident asset was loaded and
+		* prepared at startup and can be evicted like any other, otherwise it is not drawn until
+		* the player comes in range.
+		*
+		* @param IGameAsset* asset
+		* @param const std::string& filePath
+		* @param const std::string& texFilePath
+		* @param bool resident
+		* @return void
+		*/
+	void Add(IGameAsset* asset, const std::string& filePath, const std::string& texFilePath, bool resident);
+
+		/**
+		* @brief Streams the models around the player
+		*
+		* Starts loading the closest models in range, swaps in the models that finished loading
+		* and queues their uploads and any evictions on the snapshot. Called once per frame on
+		* the game loop thread.
+		*
+		* @param const glm::vec3& playerPosition
+		* @param RenderSnapshot& snapshot
+		* @return void
+		*/
+	void Update(const glm::vec3& playerPosition, RenderSnapshot& snapshot);
+
+		/**
+		* @brief Reloads a streamed model
+		*
+		* Changes the files a streamed asset is loaded from and evicts it if it is resident, so
+		* it is loaded again from the new files while the player is in range. Returns false if
+		* the asset is not streamed.
+		*
+		* @param IGameAsset* asset
+		* @param const std::string& filePath
+		* @param const std::string& texFilePath
+		* @param RenderSnapshot& snapshot
+		* @return bool
+		*/
+	bool Reload(IGameAsset* asset, const std::string& filePath, const std::string& texFilePath, RenderSnapshot& snapshot);
+
+		/**
+		* @brief Gets the streaming statistics
+		*
+		* @return StreamingStats
+		*/
+	StreamingStats GetStats() const;
+
+		/**
+		* @brief Stops streaming
+		*
+		* Waits for the models being loaded and deletes them. Called when the game loop has
+		* finished, with the context current on the calling thread.
+		*
+		* @return void
+		*/
+	void Destroy();
+
+private:
+		/**
+		* @brief Gets the mesh data size of a model
+		*
+		* Returns the bytes of vertex and index data the meshes of the model take on the GPU.
+		*
+		* @param Model* model
+		* @return size_t
+		*/
+	static size_t GetMeshBytes(Model* model);
+
+		/**
+		* @brief Finds the resident mesh data
+		*
+		* Sums the mesh data of every resident model, counting meshes shared by models loaded
+		* from the same file once.
+		*
+		* @return size_t
+		*/
+	size_t CountResidentBytes() const;
+
+		/**
+		* @brief Evicts a model
+		*
+		* Swaps empty meshes into the asset and queues the release of its meshes on the snapshot.
+		*
+		* @param StreamedModel& model
+		* @param RenderSnapshot& snapshot
+		* @return void
+		*/
+	void Evict(StreamedModel& model, RenderSnapshot& snapshot);
+
+	/// Streamed models, in the order they were added
+	std::vector<StreamedModel*> m_models;
+
+	/// Distance from the model bounds the player loads models at
+	float m_radius;
+
+	/// Bytes of resident mesh data before models out of range are evicted
+	size_t m_budgetBytes;
+
+	/// Shaders the uploaded models are prepared with
+	Shader* m_shader;
+	Shader* m_arrayShader;
+
+	/// Frames streamed, used for the least recently used order
+	unsigned int m_frame;
+
+	/// Resident mesh data, counted again whenever a model is swapped in or out
+	size_t m_residentBytes;
+
+	/// Models loaded and evicted since the start
+	int m_loads, m_evictions;
+};
@@ -27,10 +27,10 @@ void InputManager::KeyPressed(InputCodes code)
 			m_player->StrafeRight((float)(TimeManager::Instance().DeltaTime), glm::normalize(glm::cross(m_camera->GetUp(), m_camera->GetView())));
 			break;
 		case q: case Q:
-			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+			m_wireframe = true;
 			break;
 		case 101: case E:
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+			m_wireframe = false;
 			break;
 	}
 }
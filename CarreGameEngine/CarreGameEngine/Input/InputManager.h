@@ -102,6 +102,16 @@ public:
 		* @return Camera*
 		*/
 	Camera* GetCamera() { return m_camera; }
+
+		/**
+		* @brief Checks for wireframe mode
+		*
+		* Returns true if Q switched the world to wireframe, until E switches it back. The
+		* renderer applies the mode, as only the render thread may make OpenGL calls.
+		*
+		* @return bool
+		*/
+	bool IsWireframe() const { return m_wireframe; }
 		
 	void MouseMove(float mouseX, float mouseY);
 
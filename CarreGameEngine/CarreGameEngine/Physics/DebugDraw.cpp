@@ -0,0 +1,136 @@
+#include "DebugDraw.h"
+
+DebugDraw::DebugDraw(size_t lineBudget)
+	: m_lineBudget(lineBudget), m_lineCount(0), m_droppedCount(0), m_lastLineCount(0), m_lastDroppedCount(0),
+	m_debugMode(DBG_DrawWireframe | DBG_DrawAabb), m_debugShader(NULL), m_VAO(0), m_VBO(0)
+{
+	m_vertices.resize(m_lineBudget * 2);
+}
+
+DebugDraw::~DebugDraw()
+{
+	if (m_VBO)
+		glDeleteBuffers(1, &m_VBO);
+	if (m_VAO)
+		glDeleteVertexArrays(1, &m_VAO);
+}
+
+void DebugDraw::Init()
+{
+	// Get the shared debug draw shader program
+	m_debugShader = ShaderManager::Instance().GetShader("Resources/shaders/DebugDraw.shader");
+
+	glGenVertexArrays(1, &m_VAO);
+	glGenBuffers(1, &m_VBO);
+
+	glBindVertexArray(m_VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+	glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(DebugLineVertex), NULL, GL_STREAM_DRAW);
+
+	// vertex positions
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(DebugLineVertex), (GLvoid*)offsetof(DebugLineVertex, position));
+	glEnableVertexAttribArray(0);
+	// vertex colours
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(DebugLineVertex), (GLvoid*)offsetof(DebugLineVertex, colour));
+	glEnableVertexAttribArray(1);
+
+	glBindVertexArray(0);
+}
+
+void DebugDraw::SetLineBudget(size_t lineBudget)
+{
+	m_lineBudget = lineBudget;
+	m_vertices.resize(m_lineBudget * 2);
+
+	if (m_lineCount > m_lineBudget)
+		m_lineCount = m_lineBudget;
+
+	if (m_VBO)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+		glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(DebugLineVertex), NULL, GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+void DebugDraw::drawLine(const btVector3& from, const btVector3& to, const btVector3& color)
+{
+	if (m_lineCount >= m_lineBudget)
+	{
+		m_droppedCount++;
+		return;
+	}
+
+	DebugLineVertex* vertex = &m_vertices[m_lineCount * 2];
+	vertex[0].position = glm::vec3(from.getX(), from.getY(), from.getZ());
+	vertex[0].colour = glm::vec3(color.getX(), color.getY(), color.getZ());
+	vertex[1].position = glm::vec3(to.getX(), to.getY(), to.getZ());
+	vertex[1].colour = vertex[0].colour;
+
+	m_lineCount++;
+}
+
+void DebugDraw::drawContactPoint(const btVector3& pointOnB, const btVector3& normalOnB, btScalar distance, int, const btVector3& color)
+{
+	drawLine(pointOnB, pointOnB + normalOnB * distance, color);
+}
+
+void DebugDraw::reportErrorWarning(const char* warningString)
+{
+	std::cout << "Physics debug draw: " << warningString << std::endl;
+}
+
+void DebugDraw::Flush(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
+{
+	m_lastLineCount = m_lineCount;
+	m_lastDroppedCount = m_droppedCount;
+
+	DrawLines(m_lineCount > 0 ? &m_vertices[0] : NULL, m_lineCount, viewMatrix, projectionMatrix);
+
+	m_lineCount = 0;
+	m_droppedCount = 0;
+}
+
+void DebugDraw::TakeLines(std::vector<DebugLineVertex>& lines)
+{
+	m_lastLineCount = m_lineCount;
+	m_lastDroppedCount = m_droppedCount;
+
+	lines.assign(m_vertices.begin(), m_vertices.begin() + m_lineCount * 2);
+
+	m_lineCount = 0;
+	m_droppedCount = 0;
+}
+
+void DebugDraw::Draw(const std::vector<DebugLineVertex>& lines, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
+{
+	// Never more than the buffer was created for
+	size_t lineCount = std::min(lines.size() / 2, m_lineBudget);
+	DrawLines(lineCount > 0 ? &lines[0] : NULL, lineCount, viewMatrix, projectionMatrix);
+}
+
+void DebugDraw::DrawLines(const DebugLineVertex* vertices, size_t lineCount, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
+{
+	if (lineCount == 0 || !m_VAO || !m_debugShader)
+		return;
+
+	// Orphan last frame's storage so the upload does not wait for it to be drawn
+	glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+	glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(DebugLineVertex), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, lineCount * 2 * sizeof(DebugLineVertex), vertices);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// Bullet gives lines in world space
+	glm::mat4 modelMatrix(1.0f);
+
+	m_debugShader->TurnOn();
+	m_debugShader->SetMatrix4(m_debugShader->GetVariable("model"), 1, false, &modelMatrix[0][0]);
+	m_debugShader->SetMatrix4(m_debugShader->GetVariable("view"), 1, false, &viewMatrix[0][0]);
+	m_debugShader->SetMatrix4(m_debugShader->GetVariable("projection"), 1, false, &projectionMatrix[0][0]);
+
+	glBindVertexArray(m_VAO);
+	glDrawArrays(GL_LINES, 0, (GLsizei)(lineCount * 2));
+	glBindVertexArray(0);
+
+	m_debugShader->TurnOff();
+}
@@ -1,125 +1,198 @@
 #pragma once
 
+#include <iostream>
 #include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <GL\glew.h>
+#include <GLM\glm.hpp>
 #include "LinearMath\btIDebugDraw.h"
 #include "..\Renderer\Shader.h"
-#include "..\Controllers\Camera.h"
-#include "..\Common\MyMath.h"
+#include "..\Renderer\ShaderManager.h"
 
+	/**
+	* @struct DebugLineVertex
+	* @brief Position and colour of a line end
+	*/
+struct DebugLineVertex
+{
+	glm::vec3 position;
+	glm::vec3 colour;
+};
+
+	/**
+	* @class DebugDraw
+	* @brief Batched Bullet debug line renderer
+	*
+	* Implements btIDebugDraw for the physics world. drawLine() only appends the line to a fixed
+	* size CPU buffer while btCollisionWorld::debugDrawWorld() runs. Flush() then uploads every line
+	* of the frame into a streaming vertex buffer, orphaning the previous contents so the driver
+	* never waits for the last frame to finish, and draws them all with a single glDrawArrays call.
+	*
+	* The buffer holds at most the line budget given. Lines past the budget are dropped for that
+	* frame and counted so the budget can be raised.
+	*
+	* When the world is stepped on another thread than the one drawing, TakeLines() copies the
+	* lines out next to the world and Draw() draws the copy on the thread that owns the context.
+	*
+	* @version 02
+	* @date 19/10/2026
+	*/
 class DebugDraw : public btIDebugDraw
 {
 public:
-	DebugDraw() 
-	{
-		// Debug draw shader init
-		m_debugShader = new Shader();
-
-		// Camera object for MVP matrix
-		m_camera = new Camera();
-
-		InitDebugDraw();
-	}
+		/**
+		* @brief Constructor
+		*
+		* Sets the maximum number of lines drawn per frame. No OpenGL objects are created until
+		* Init() is called.
+		*
+		* @param size_t lineBudget
+		* @return null
+		*/
+	DebugDraw(size_t lineBudget = 65536);
 
-	~DebugDraw() { }
+		/**
+		* @brief Destructor
+		*
+		* Deletes the vertex array and vertex buffer.
+		*
+		* @return null
+		*/
+	~DebugDraw();
 
 		/**
 		* @brief Initialises the debug draw
 		*
-		*
+		* Gets the shared debug draw shader and creates the vertex array and streaming vertex
+		* buffer sized for the line budget.
 		*
 		* @return void
 		*/
-	void InitDebugDraw()
-	{
-		// Create a debug shader source (vertext and fragment shader)
-		ShaderSource debugShaderSource = ParseShaders("Resources/shaders/DebugDraw.shader");
-
-		// Initialise the shader program for the physics engine
-		GetDebugShader()->Initialize(debugShaderSource.VertexSource, debugShaderSource.FragmentSource);
-	}
-
-	void SetMatrices(glm::mat4 pViewMatrix, glm::mat4 pProjectionMatrix)
-	{
-		glm::mat4 projectionMatrix = m_camera->GetProjectionMatrix();
-		//glm::mat4 modelMatrix = CreateTransformationMatrix(m_debugMesh->GetPosition(), m_debugMesh->GetRotation(), m_debugMesh->GetScale());
-		glm::mat4 viewMatrix = CreateViewMatrix(m_camera);
-
-		//GLint modelMatrixId = m_debugShader->GetVariable("model");
-		GLint viewMatrixId = m_debugShader->GetVariable("view");
-		GLint projectionMatrixId = m_debugShader->GetVariable("projection");
-
-		//m_debugShader->SetMatrix4(modelMatrixId, 1, false, &m_modelMatrix[0][0]);
-		m_debugShader->SetMatrix4(viewMatrixId, 1, false, &pViewMatrix[0][0]);
-		m_debugShader->SetMatrix4(projectionMatrixId, 1, false, &pProjectionMatrix[0][0]);
-	}
-
-	virtual void drawLine(const btVector3& from, const btVector3& to, const btVector3& color)
-	{
-		glGenVertexArrays(1, &VAO);
-		glGenBuffers(1, &VBO);
+	void Init();
 
-		glBindVertexArray(VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		/**
+		* @brief Sets the line budget
+		*
+		* Sets the maximum number of lines drawn per frame and resizes the buffers.
+		*
+		* @param size_t lineBudget
+		* @return void
+		*/
+	void SetLineBudget(size_t lineBudget);
 
-		glBufferData(GL_ARRAY_BUFFER, sizeof(m_debugLines[0]) * m_debugLines.size(), &m_debugLines[0], GL_STATIC_DRAW);
+		/**
+		* @brief Draws all lines of the frame
+		*
+		* Uploads the lines added since the last flush and draws them in one call, then empties
+		* the line buffer.
+		*
+		* @param const glm::mat4& viewMatrix
+		* @param const glm::mat4& projectionMatrix
+		* @return void
+		*/
+	void Flush(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
 
-		// load the vertex data info
-		glVertexAttribPointer(1,  // the handle for the inPos shader attrib should be at pos 0
-			3,	// there are 3 values xyz
-			GL_FLOAT, // float value
-			GL_FALSE, // don't need to be normalised
-			4 * sizeof(float),  // how many floats to the next one (btVector3 uses 4 floats)
-			(GLvoid*)&m_debugLines[0]  // where do they start as an index); // use 3 values, but add stride each time to get to the next
-		);
+		/**
+		* @brief Takes the lines of the frame
+		*
+		* Copies the lines added since the last flush into lines, two vertices each, and empties
+		* the line buffer without drawing. Makes no OpenGL calls.
+		*
+		* @param std::vector<DebugLineVertex>& lines
+		* @return void
+		*/
+	void TakeLines(std::vector<DebugLineVertex>& lines);
 
-		glBindVertexArray(0);
+		/**
+		* @brief Draws lines
+		*
+		* Uploads and draws lines taken with TakeLines() in one call.
+		*
+		* @param const std::vector<DebugLineVertex>& lines
+		* @param const glm::mat4& viewMatrix
+		* @param const glm::mat4& projectionMatrix
+		* @return void
+		*/
+	void Draw(const std::vector<DebugLineVertex>& lines, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
 
-		m_debugShader->TurnOn();
+		/**
+		* @brief Adds a line
+		*
+		* Adds a line to the frame's line buffer. Called by Bullet for every line it draws.
+		*
+		* @param const btVector3& from
+		* @param const btVector3& to
+		* @param const btVector3& color
+		* @return void
+		*/
+	virtual void drawLine(const btVector3& from, const btVector3& to, const btVector3& color);
 
-		// Bind the VAO
-		glBindVertexArray(VAO);
+		/**
+		* @brief Adds a contact point
+		*
+		* Draws the contact normal as a short line.
+		*
+		* @return void
+		*/
+	virtual void drawContactPoint(const btVector3& pointOnB, const btVector3& normalOnB, btScalar distance, int, const btVector3& color);
 
-		// Enable the position attribute
-		glEnableVertexAttribArray(0);
+	virtual void reportErrorWarning(const char* warningString);
+	virtual void draw3dText(const btVector3&, const char*) { }
+	virtual void setDebugMode(int debugMode) { m_debugMode = debugMode; }
+	virtual int getDebugMode() const { return m_debugMode; }
 
-		// Draw the lines
-		glDrawArrays(GL_TRIANGLES, 0, m_debugLines.size());
+		/**
+		* @brief Gets the number of lines drawn
+		*
+		* Returns the number of lines drawn by the last Flush().
+		*
+		* @return size_t
+		*/
+	size_t GetLineCount() const { return m_lastLineCount; }
 
-		// Disable the position attribute
-		glDisableVertexAttribArray(0);
+		/**
+		* @brief Gets the number of lines dropped
+		*
+		* Returns the number of lines that did not fit in the line budget in the last frame.
+		*
+		* @return size_t
+		*/
+	size_t GetDroppedLineCount() const { return m_lastDroppedCount; }
 
-		// Unbind the VAO
-		glBindVertexArray(0);
+		/**
+		* @brief Gets the debug shader
+		*
+		* @return Shader*
+		*/
+	Shader* GetDebugShader() { return m_debugShader; }
 
-		// Drawn once then cleared
-		//m_debugLines.clear();
+protected:
+		/**
+		* @brief Uploads and draws line vertices
+		*
+		* @param const DebugLineVertex* vertices
+		* @param size_t lineCount
+		* @param const glm::mat4& viewMatrix
+		* @param const glm::mat4& projectionMatrix
+		* @return void
+		*/
+	void DrawLines(const DebugLineVertex* vertices, size_t lineCount, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
 
-		// Disable shader
-		m_debugShader->TurnOff();
-	}
+	/// Lines of the current frame, two vertices each
+	std::vector<DebugLineVertex> m_vertices;
 
-	virtual void drawContactPoint(const btVector3 &, const btVector3 &, btScalar, int, const btVector3 &) { }
-	virtual void reportErrorWarning(const char *) { }
-	virtual void draw3dText(const btVector3 &, const char *) { }
-	virtual void setDebugMode(int p) { m = p; }
-	int getDebugMode(void) const { return 3; }
-	int m;
+	/// Maximum lines per frame, lines added this frame and lines dropped this frame
+	size_t m_lineBudget, m_lineCount, m_droppedCount;
 
-	Shader* GetDebugShader() { return m_debugShader; };
+	/// Statistics of the last flushed frame
+	size_t m_lastLineCount, m_lastDroppedCount;
 
-	void SetCamera(Camera* camera) { m_camera = camera; }
-	
-	unsigned int VBO, VAO;
-	
-protected:
-	std::vector<btVector3> m_debugLines;
+	/// Bullet debug draw mode flags
+	int m_debugMode;
 
 	Shader* m_debugShader;
 
-	// Used to alter the scale, position, rotation of the debug draw (lines)
-	glm::mat4 m_modelMatrix;
-
-	// Mesh* m_debugMesh;
-
-	Camera* m_camera;
-};
\ No newline at end of file
+	/// Vertex array and streaming vertex buffer
+	GLuint m_VAO, m_VBO;
+};
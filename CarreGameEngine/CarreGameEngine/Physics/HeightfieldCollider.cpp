@@ -0,0 +1,115 @@
+#include "HeightfieldCollider.h"
+
+/// Tiles either side of the tile under the player that have collision
+static const int COLLIDER_TILE_RANGE = 1;
+
+HeightfieldCollider::HeightfieldCollider(const HeightfieldSource* heightfield, const glm::vec3& scale, const glm::vec3& position, int userIndex)
+	: m_heightfield(heightfield), m_scale(scale), m_position(position), m_userIndex(userIndex)
+{
+}
+
+void HeightfieldCollider::Update(btDiscreteDynamicsWorld* world, const btVector3& position)
+{
+	if (!m_heightfield->IsOpen())
+		return;
+
+	int tileSize = m_heightfield->GetTileSize();
+	int tilesPerSide = m_heightfield->GetTilesPerSide();
+
+	// Tile under the position, clamped so the edge tiles stay while the player is off the terrain
+	int centreX = (int)std::floor((position.getX() - m_position.x) / (m_scale.x * tileSize));
+	int centreZ = (int)std::floor((position.getZ() - m_position.z) / (m_scale.z * tileSize));
+	centreX = std::max(0, std::min(centreX, tilesPerSide - 1));
+	centreZ = std::max(0, std::min(centreZ, tilesPerSide - 1));
+
+	// Tiles out of range are removed first, so the tile bodies stay at the end of the world
+	std::unordered_map<int, HeightfieldColliderTile>::iterator it = m_tiles.begin();
+	while (it != m_tiles.end())
+	{
+		int tileX = it->first % tilesPerSide;
+		int tileZ = it->first / tilesPerSide;
+		if (std::abs(tileX - centreX) <= COLLIDER_TILE_RANGE && std::abs(tileZ - centreZ) <= COLLIDER_TILE_RANGE)
+		{
+			it++;
+			continue;
+		}
+
+		world->removeRigidBody(it->second.body);
+		delete it->second.body->getMotionState();
+		delete it->second.body;
+		delete it->second.shape;
+		it = m_tiles.erase(it);
+	}
+
+	for (int tileZ = std::max(centreZ - COLLIDER_TILE_RANGE, 0); tileZ <= std::min(centreZ + COLLIDER_TILE_RANGE, tilesPerSide - 1); tileZ++)
+	{
+		for (int tileX = std::max(centreX - COLLIDER_TILE_RANGE, 0); tileX <= std::min(centreX + COLLIDER_TILE_RANGE, tilesPerSide - 1); tileX++)
+		{
+			int index = tileZ * tilesPerSide + tileX;
+			if (m_tiles.find(index) != m_tiles.end())
+				continue;
+
+			HeightfieldColliderTile& tile = m_tiles[index];
+			CreateTile(tileX, tileZ, tile);
+			world->addRigidBody(tile.body);
+		}
+	}
+}
+
+void HeightfieldCollider::CreateTile(int tileX, int tileZ, HeightfieldColliderTile& tile) const
+{
+	int tileSize = m_heightfield->GetTileSize();
+	int size = m_heightfield->GetSize();
+
+	// One sample past the tile, the first sample of the next tile, so the tiles join
+	int startX = tileX * tileSize;
+	int startZ = tileZ * tileSize;
+	int width = std::min(tileSize + 1, size - startX);
+	int length = std::min(tileSize + 1, size - startZ);
+
+	short minHeight = SHRT_MAX, maxHeight = SHRT_MIN;
+	tile.heights.resize((size_t)width * length);
+	for (int z = 0; z < length; z++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			// Back to 16-bit units, then offset into the range of a short
+			int value = (int)(m_heightfield->GetSample(startX + x, startZ + z) * 257.0f + 0.5f) - 32768;
+			short height = (short)std::max(SHRT_MIN, std::min(value, SHRT_MAX));
+			tile.heights[z * width + x] = height;
+			minHeight = std::min(minHeight, height);
+			maxHeight = std::max(maxHeight, height);
+		}
+	}
+
+	btScalar heightScale = m_scale.y / 257.0f;
+	tile.shape = new btHeightfieldTerrainShape(width, length, &tile.heights[0], heightScale, minHeight * heightScale, maxHeight * heightScale, 1, PHY_SHORT, false);
+	tile.shape->setLocalScaling(btVector3(m_scale.x, 1.0f, m_scale.z));
+
+	// Bullet centres the shape on its bounds, so the origin is moved to the centre of the tile
+	// and back up by the offset taken off the samples
+	btTransform transform;
+	transform.setIdentity();
+	transform.setOrigin(btVector3(
+		m_position.x + (startX + (width - 1) * 0.5f) * m_scale.x,
+		m_position.y + 32768.0f * heightScale + (minHeight + maxHeight) * 0.5f * heightScale,
+		m_position.z + (startZ + (length - 1) * 0.5f) * m_scale.z));
+
+	btDefaultMotionState* motionState = new btDefaultMotionState(transform);
+	btRigidBody::btRigidBodyConstructionInfo info(0.0f, motionState, tile.shape, btVector3(0.0f, 0.0f, 0.0f));
+	tile.body = new btRigidBody(info);
+	tile.body->setUserIndex(m_userIndex);
+}
+
+void HeightfieldCollider::Destroy(btDiscreteDynamicsWorld* world)
+{
+	std::unordered_map<int, HeightfieldColliderTile>::iterator it;
+	for (it = m_tiles.begin(); it != m_tiles.end(); it++)
+	{
+		world->removeRigidBody(it->second.body);
+		delete it->second.body->getMotionState();
+		delete it->second.body;
+		delete it->second.shape;
+	}
+	m_tiles.clear();
+}
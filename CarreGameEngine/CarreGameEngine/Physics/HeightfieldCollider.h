@@ -0,0 +1,119 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <cmath>
+#include <climits>
+#include <algorithm>
+#include <GLM\glm.hpp>
+#include "btBulletDynamicsCommon.h"
+#include "BulletCollision\CollisionShapes\btHeightfieldTerrainShape.h"
+#include "..\AssetFactory\HeightfieldSource.h"
+
+	/**
+	* @struct HeightfieldColliderTile
+	* @brief Collision body of one tile of a heightfield
+	*/
+struct HeightfieldColliderTile
+{
+	/// Samples of the tile, offset to signed 16-bit as Bullet reads them in place
+	std::vector<short> heights;
+
+	btHeightfieldTerrainShape* shape;
+	btRigidBody* body;
+};
+
+	/**
+	* @class HeightfieldCollider
+	* @brief Heightfield terrain collision created a tile at a time around the player
+	*
+	* A single btHeightfieldTerrainShape over a large terrain needs every sample in memory for
+	* the whole game. The collider instead creates a shape for each tile of the heightfield
+	* source around the player, copying only the samples of that tile, and removes the tiles
+	* the player has moved away from. Neighbouring tiles share their border samples so there
+	* is no gap between them.
+	*
+	* Samples are stored as 16-bit whatever the bit depth of the source, so 16-bit heightfields
+	* collide at the same precision they are drawn at.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class HeightfieldCollider
+{
+public:
+		/**
+		* @brief Constructor
+		*
+		* The scale is the distance between samples along x and z and the height of one 8-bit
+		* unit, as the terrain is drawn with. The source must stay open while the collider is
+		* updated.
+		*
+		* @param const HeightfieldSource* heightfield
+		* @param const glm::vec3& scale
+		* @param const glm::vec3& position
+		* @param int userIndex
+		* @return null
+		*/
+	HeightfieldCollider(const HeightfieldSource* heightfield, const glm::vec3& scale, const glm::vec3& position, int userIndex);
+
+		/**
+		* @brief Destructor
+		*
+		* The tiles must have been removed from the world with Destroy() first.
+		*
+		* @return null
+		*/
+	~HeightfieldCollider() { }
+
+		/**
+		* @brief Updates the tiles around a position
+		*
+		* Adds the tile under the position and the tiles next to it to the world and removes
+		* the rest.
+		*
+		* @param btDiscreteDynamicsWorld* world
+		* @param const btVector3& position
+		* @return void
+		*/
+	void Update(btDiscreteDynamicsWorld* world, const btVector3& position);
+
+		/**
+		* @brief Removes every tile
+		*
+		* @param btDiscreteDynamicsWorld* world
+		* @return void
+		*/
+	void Destroy(btDiscreteDynamicsWorld* world);
+
+		/**
+		* @brief Gets the number of tiles in the world
+		*
+		* @return int
+		*/
+	int GetTileCount() const { return (int)m_tiles.size(); }
+
+private:
+		/**
+		* @brief Creates the collision body of a tile
+		*
+		* @param int tileX
+		* @param int tileZ
+		* @param HeightfieldColliderTile& tile
+		* @return void
+		*/
+	void CreateTile(int tileX, int tileZ, HeightfieldColliderTile& tile) const;
+
+	/// Source of the samples
+	const HeightfieldSource* m_heightfield;
+
+	/// Sample spacing and height scale, and the position of the first sample
+	glm::vec3 m_scale, m_position;
+
+	/// User index the tile bodies are given
+	int m_userIndex;
+
+	/// Tiles in the world by tile index
+	std::unordered_map<int, HeightfieldColliderTile> m_tiles;
+};
@@ -37,8 +37,8 @@ PhysicsEngine::PhysicsEngine()
 
 	m_newForce.setZero();
 
-	// Debug draw shader init
-	m_debugShader = new Shader();
+	// Debug draw is created in InitDebugDraw()
+	m_debugDrawer = NULL;
 
 	// Camera object for MVP matrix
 	m_camera = new Camera();
@@ -48,8 +48,23 @@ PhysicsEngine::PhysicsEngine()
 	m_dynamicsWorld->deb*/
 }
 
-// De-constructor (not implemented)
-PhysicsEngine::~PhysicsEngine(){};
+// De-constructor
+PhysicsEngine::~PhysicsEngine()
+{
+	// The world must not call the debug drawer once it is gone, the context is current here
+	if (m_debugDrawer)
+	{
+		m_dynamicsWorld->setDebugDrawer(NULL);
+		delete m_debugDrawer;
+		m_debugDrawer = NULL;
+	}
+
+	for (size_t i = 0; i < m_heightfields.size(); i++)
+	{
+		m_heightfields[i]->Destroy(m_dynamicsWorld);
+		delete m_heightfields[i];
+	}
+}
 
 // Create a static rigid body
 void PhysicsEngine::CreateStaticRigidBody(btVector3 &pos)
@@ -219,6 +234,10 @@ btRigidBody* PhysicsEngine::AddSphere(float radius, btVector3 &startPos, Collisi
 // Simulate the dynamic world
 void PhysicsEngine::Simulate(std::vector<CollisionBody*>& collisionBodies, btVector3& playerObj)
 {
+	// Heightfield tiles around the player, added and removed before the step
+	for (size_t i = 0; i < m_heightfields.size(); i++)
+		m_heightfields[i]->Update(m_dynamicsWorld, playerObj);
+
 	m_dynamicsWorld->stepSimulation(1.f / 60.0f, 10);
 
 	btVector3 btFrom(playerObj);
@@ -240,6 +259,10 @@ void PhysicsEngine::Simulate(std::vector<CollisionBody*>& collisionBodies, btVec
 		btTransform trans;
 		ComputerAI* compAI;
 
+		// Heightfield tiles are at the end of the world and have no collision body
+		if (body->getUserIndex() == HEIGHTFIELD)
+			continue;
+
 		// Reset forces on player object prior to next step simulation
 		if (body->getUserIndex() == CAMERA)
 		{
@@ -347,63 +370,32 @@ void PhysicsEngine::Simulate(std::vector<CollisionBody*>& collisionBodies, btVec
 	//std::cout << "/n/n/n/n/n" << std::endl;
 }
 
-// Testing for creating a heightfield terrain shape
-void PhysicsEngine::CreateHeightfieldTerrainShape()
+// Add heightfield terrain collision
+void PhysicsEngine::AddHeightfield(const HeightfieldSource& heightfield, const glm::vec3& scale, const glm::vec3& position)
 {
-	//unsigned char *terrainData;
-	int sizet = 128;
-
-	// Open for binary read, print error if error found
-	std::ifstream infile("Resources/terrain/height128.raw", std::ios::binary);
-	if (!infile)
-	{
-		exit(0);
-	}
-
-	// Allocate memory, return false if no size = 0
-	if (m_terrainData)
-		delete[] m_terrainData;
-	if (sizet>0)
-		m_terrainData = new unsigned char[sizet*sizet];
-	if (m_terrainData == NULL)
-		exit(0);
-
-	// Read in heightfield and get length of file
-	infile.seekg(0, std::ios::end);
-	int length = infile.tellg();
-
-	// Read data in as a block, cast to char*, set size, and close file
-	infile.seekg(0, std::ios::beg);
-	infile.read(reinterpret_cast<char *>(m_terrainData), length);
-	infile.close();
-	this->m_size = sizet;
-
-	// Create heightfield shape
-	btCollisionShape* heightfieldShape = new btHeightfieldTerrainShape(128, 128, &m_terrainData, 1, 1, 128, 1, PHY_UCHAR, false);
-	m_collisionShapes.push_back(heightfieldShape);
-
-	// Initialize transform and location
-	btTransform startTransform;
-	startTransform.setIdentity();
-	startTransform.setOrigin(btVector3(0.0, 0.0, 0.0));
-
-	// Set mass (non-zero for dynamic)
-	m_mass = 0.0;
-	m_isDynamic = (m_mass != 0.0f);
-
-	// Set initial inertia
-	btVector3 localInertia(0.0, 0.0, 0.0);
+	m_heightfields.push_back(new HeightfieldCollider(&heightfield, scale, position, HEIGHTFIELD));
+}
 
-	// Using motionstate is recommended, it provides interpolation capabilities, and only synchronizes 'active' objects
-	btDefaultMotionState* myMotionState = new btDefaultMotionState(startTransform);
-	btRigidBody::btRigidBodyConstructionInfo rbInfo(m_mass, myMotionState, heightfieldShape, localInertia);
-	btRigidBody* body = new btRigidBody(rbInfo);
+// Move a body to a new position
+void PhysicsEngine::SetBodyPosition(int index, const btVector3& position)
+{
+	if (index < 0 || index >= m_dynamicsWorld->getNumCollisionObjects())
+		return;
 
-	// Set the index for the type of rigid body that is being created
-	body->setUserIndex(HEIGHTFIELD);
+	btCollisionObject* obj = m_dynamicsWorld->getCollisionObjectArray()[index];
+	btTransform trans = obj->getWorldTransform();
+	trans.setOrigin(position);
+	obj->setWorldTransform(trans);
 
-	// Add the body to the dynamic world
-	m_dynamicsWorld->addRigidBody(body);
+	btRigidBody* body = btRigidBody::upcast(obj);
+	if (body)
+	{
+		if (body->getMotionState())
+			body->getMotionState()->setWorldTransform(trans);
+		body->setLinearVelocity(btVector3(0, 0, 0));
+		body->setAngularVelocity(btVector3(0, 0, 0));
+	}
+	obj->activate(true);
 }
 
 void PhysicsEngine::ActivateAllObjects()
@@ -422,14 +414,15 @@ btCollisionObject* PhysicsEngine::TriangleMeshTest(std::vector<Mesh> &modelMesh,
 	btTriangleMesh* trimesh = new btTriangleMesh();
 	for (int j = 0; j < modelMesh.size(); j++)
 	{
-		Mesh tempMesh = modelMesh[j];
-		std::vector<Vertex3> tempMeshVertex = tempMesh.GetVertices();
+		// Indexed meshes are expanded to three corners per triangle
+		std::vector<glm::vec3> tempMeshVertex;
+		modelMesh[j].GetTrianglePositions(tempMeshVertex);
 
 		for (int i = 0; i < tempMeshVertex.size(); i+=3)
 		{
-			glm::vec3 p1 = tempMeshVertex[i].m_position;
-			glm::vec3 p2 = tempMeshVertex[i+1].m_position;
-			glm::vec3 p3 = tempMeshVertex[i+2].m_position;
+			glm::vec3 p1 = tempMeshVertex[i];
+			glm::vec3 p2 = tempMeshVertex[i+1];
+			glm::vec3 p3 = tempMeshVertex[i+2];
 
 			btVector3 A, B, C;
 
@@ -438,11 +431,6 @@ btCollisionObject* PhysicsEngine::TriangleMeshTest(std::vector<Mesh> &modelMesh,
 			C = btVector3(p3.x, p3.y, p3.z);
 
 			trimesh->addTriangle(A, B, C);
-
-			// Add points to debug draw array of btVector3s
-			m_debugLines.push_back(A);
-			m_debugLines.push_back(B);
-			m_debugLines.push_back(C);
 		}
 	}
 
@@ -450,7 +438,7 @@ btCollisionObject* PhysicsEngine::TriangleMeshTest(std::vector<Mesh> &modelMesh,
 	trans.setIdentity();
 
 	// Set origin to the position of the object (whatever object is being passed in)
-	trans.setOrigin(btVector3(modelMesh[0].GetPosition().x, modelMesh[0].GetPosition().y, modelMesh[0].GetPosition().z));
+	trans.setOrigin(btVector3(m_modelPosition.x, m_modelPosition.y, m_modelPosition.z));
 
 	// Set trimesh scale
 	trimesh->setScaling(btVector3(m_scale.x, m_scale.y, m_scale.z));
@@ -483,80 +471,55 @@ btCollisionObject* PhysicsEngine::TriangleMeshTest(std::vector<Mesh> &modelMesh,
 	return body;
 }
 
-void PhysicsEngine::InitDebugDraw()
+void PhysicsEngine::InitDebugDraw(size_t lineBudget)
 {
-	// Create a debug shader source (vertext and fragment shader)
-	ShaderSource debugShaderSource = ParseShaders("Resources/shaders/DebugDraw.shader");
-
-	// Initialise the shader program for the physics engine
-	GetDebugShader()->Initialize(debugShaderSource.VertexSource, debugShaderSource.FragmentSource);
+	if (m_debugDrawer)
+		return;
 
-	glGenVertexArrays(1, &VAO);
-	std::cout << VAO << std::endl;
-	glGenBuffers(1, &VBO);
+	m_debugDrawer = new ::DebugDraw(lineBudget);
+	m_debugDrawer->Init();
 
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-
-	glBufferData(GL_ARRAY_BUFFER, sizeof(m_debugLines[0]) * m_debugLines.size(), &m_debugLines[0], GL_STATIC_DRAW);
-
-	// load the vertex data info
-	glVertexAttribPointer(1,  // the handle for the inPos shader attrib should be at pos 0
-		3,	// there are 3 values xyz
-		GL_FLOAT, // float value
-		GL_FALSE, // don't need to be normalised
-		4 * sizeof(float),  // how many floats to the next one (btVector3 uses 4 floats)
-		(GLvoid*)&m_debugLines[0]  // where do they start as an index); // use 3 values, but add stride each time to get to the next
-	);
-
-	glBindVertexArray(0);
+	m_dynamicsWorld->setDebugDrawer(m_debugDrawer);
 }
 
 void PhysicsEngine::DebugDraw()
 {
-	// Enable shader
-	m_debugShader->TurnOn();
+	if (!m_debugDrawer)
+		return;
+
+	// Bullet calls drawLine() for every line, which only fills the line buffer
+	m_dynamicsWorld->debugDrawWorld();
 
 	glm::mat4 projectionMatrix = m_camera->GetProjectionMatrix();
-	//glm::mat4 modelMatrix = CreateTransformationMatrix(m_debugMesh->GetPosition(), m_debugMesh->GetRotation(), m_debugMesh->GetScale());
 	glm::mat4 viewMatrix = CreateViewMatrix(m_camera);
 
-	GLint modelMatrixId = m_debugShader->GetVariable("model");
-	GLint viewMatrixId = m_debugShader->GetVariable("view");
-	GLint projectionMatrixId = m_debugShader->GetVariable("projection");
-
-	m_debugShader->SetMatrix4(modelMatrixId, 1, false, &m_modelMatrix[0][0]);
-	m_debugShader->SetMatrix4(viewMatrixId, 1, false, &viewMatrix[0][0]);
-	m_debugShader->SetMatrix4(projectionMatrixId, 1, false, &projectionMatrix[0][0]);
-
-	// Bind the VAO
-	glBindVertexArray(VAO);
-
-	// Enable the position attribute
-	glEnableVertexAttribArray(0);
+	m_debugDrawer->Flush(viewMatrix, projectionMatrix);
+}
 
-	// Draw the lines
-	glDrawArrays(GL_LINES, 0, sizeof(m_debugLines[0]) * m_debugLines.size());
+void PhysicsEngine::CollectDebugLines(std::vector<DebugLineVertex>& lines)
+{
+	lines.clear();
+	if (!m_debugDrawer)
+		return;
 
-	// Disable the position attribute
-	glDisableVertexAttribArray(0);
-	
-	// Unbind the VAO
-	glBindVertexArray(0);
+	// Bullet calls drawLine() for every line, which only fills the line buffer
+	m_dynamicsWorld->debugDrawWorld();
+	m_debugDrawer->TakeLines(lines);
+}
 
-	// Disable shader
-	m_debugShader->TurnOff();
+void PhysicsEngine::DrawDebugLines(const std::vector<DebugLineVertex>& lines, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
+{
+	if (m_debugDrawer)
+		m_debugDrawer->Draw(lines, viewMatrix, projectionMatrix);
 }
 
 void PhysicsEngine::ParseModel(Model* model)
 {
 	// Model matrix changes
 	// Store as member variable
-	m_scale = glm::vec3(model->GetMeshBatch()[0].GetScale().x, model->GetMeshBatch()[0].GetScale().y, model->GetMeshBatch()[0].GetScale().z);
-	m_modelMatrix = CreateTransformationMatrix(
-		glm::vec3(model->GetMeshBatch()[0].GetPosition().x, model->GetMeshBatch()[0].GetPosition().y, model->GetMeshBatch()[0].GetPosition().z),
-		glm::vec3(0),
-		glm::vec3(m_scale.x, m_scale.y, m_scale.z));
+	m_modelPosition = model->GetPosition();
+	m_scale = model->GetScale();
+	m_modelMatrix = CreateTransformationMatrix(m_modelPosition, glm::vec3(0), m_scale);
 }
 
 
@@ -58,7 +58,6 @@
 
 // Includes
 #include <vector>
-#include <fstream>	// Used for testing of heightfield terrain shape (will be removed later)
 #include <cmath>
 #include "btBulletDynamicsCommon.h"
 #include "BulletCollision\CollisionShapes\btHeightfieldTerrainShape.h"
@@ -68,6 +67,7 @@
 #include "..\..\Dependencies\GLM\include\GLM\vec3.hpp"
 #include "..\AI\Affordance\Affordance.h"
 #include "DebugDraw.h"
+#include "HeightfieldCollider.h"
 
 /*************************************NEW**************************************/
 ///  Struct of point mass data for an object (for determining cente of gravity and other info)
@@ -231,13 +231,30 @@ class PhysicsEngine
 		btRigidBody* AddSphere(float radius, btVector3 &startPos, CollisionBody* colBody);
 
 			/**
-			* @brief Create a heightfield terrain shape
+			* @brief Adds heightfield terrain collision
 			*
-			* This is a test function that creates a heightfield terrain shape
+			* Creates a collider that adds the tiles of the heightfield around the player to the world
+			* as heightfield terrain shapes each time Simulate() is called. The scale is the sample
+			* spacing and height scale the terrain is drawn with. The heightfield must stay open.
 			*
+			* @param const HeightfieldSource& heightfield
+			* @param const glm::vec3& scale
+			* @param const glm::vec3& position
 			* @return void
 			*/
-		void CreateHeightfieldTerrainShape();
+		void AddHeightfield(const HeightfieldSource& heightfield, const glm::vec3& scale, const glm::vec3& position);
+
+			/**
+			* @brief Moves a body
+			*
+			* Places the body at the given index of the world at a new position and stops it. Bodies
+			* are in the order InitializePhysics() created them.
+			*
+			* @param int index
+			* @param const btVector3& position
+			* @return void
+			*/
+		void SetBodyPosition(int index, const btVector3& position);
 
 			/**
 			* @brief Activates all objects
@@ -257,28 +274,51 @@ class PhysicsEngine
 			/**
 			* @brief Initialises the debug draw
 			*
+			* Creates the batched debug line renderer and registers it with the dynamics world.
+			* Only the first call does anything.
 			*
-			*
+			* @param size_t lineBudget - Maximum number of debug lines drawn per frame
 			* @return void
 			*/
-		void InitDebugDraw();
+		void InitDebugDraw(size_t lineBudget = 65536);
 
 			/**
-			* @brief Sets up the debug draw lines to be rendered
+			* @brief Draws the physics debug lines
 			*
-			* 
+			* Collects the debug lines of the dynamics world and draws them in a single batch.
 			*
 			* @return void
 			*/
 		void DebugDraw();
 
-		Shader* GetDebugShader() { return m_debugShader; };
+			/**
+			* @brief Collects the physics debug lines
+			*
+			* Copies the debug lines of the dynamics world into lines without drawing them, so they
+			* can be drawn with DrawDebugLines() on the thread that owns the context while the world
+			* is stepped again. Makes no OpenGL calls.
+			*
+			* @param std::vector<DebugLineVertex>& lines
+			* @return void
+			*/
+		void CollectDebugLines(std::vector<DebugLineVertex>& lines);
+
+			/**
+			* @brief Draws collected physics debug lines
+			*
+			* @param const std::vector<DebugLineVertex>& lines
+			* @param const glm::mat4& viewMatrix
+			* @param const glm::mat4& projectionMatrix
+			* @return void
+			*/
+		void DrawDebugLines(const std::vector<DebugLineVertex>& lines, const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+
+		Shader* GetDebugShader() { return m_debugDrawer ? m_debugDrawer->GetDebugShader() : NULL; };
 
 		void SetCamera(Camera* camera) { m_camera = camera; }
 
 		void ParseModel(Model* model);
 
-		unsigned int VAO, VBO;
 		
 		/*************************************NEW**************************************/
 		/**
@@ -427,19 +467,15 @@ class PhysicsEngine
 			*/
 		//void CreateHeightFieldTerrainShape(Data &objectData);
 
-			/// Size of heightfield data (used for testing)
-		int m_size;
-
-			/// Holds all heightfield data (used for testing)
-		unsigned char *m_terrainData;
-
-			/// Debug draw
-		std::vector<btVector3> m_debugLines;
+			/// Heightfield terrain colliders, their tiles are added to the world after every other body
+		std::vector<HeightfieldCollider*> m_heightfields;
 
-		Shader* m_debugShader;
+			/// Batched debug line renderer, NULL until InitDebugDraw()
+		::DebugDraw* m_debugDrawer;
 
 		// Used to alter the scale, position, rotation of the debug draw (lines)
 		glm::mat4 m_modelMatrix;
+		glm::vec3 m_modelPosition;
 		glm::vec3 m_scale;
 
 		Camera* m_camera;
@@ -0,0 +1,386 @@
+#include "OcclusionCuller.h"
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <xmmintrin.h>
+
+/// Occluder triangles projected by each job
+static const size_t TRIANGLES_PER_JOB = 2048;
+
+/// Rows of the depth buffer rasterized by each job
+static const int ROWS_PER_BAND = 16;
+
+/// Models tested by each job
+static const size_t MODELS_PER_JOB = 64;
+
+/// Smallest clip space w treated as in front of the camera
+static const float MIN_CLIP_W = 1e-5f;
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+	: m_width((std::max(width, 4) + 3) & ~3), m_height(std::max(height, 1)), m_viewProjection(1.0f)
+{
+	m_depth.assign((size_t)m_width * m_height, 1.0f);
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+void OcclusionCuller::AddOccluder(Model* model)
+{
+	Occluder occluder;
+	occluder.model = model;
+
+	// Three corners per triangle
+	std::vector<Mesh>& meshes = model->GetMeshBatch();
+	for (size_t i = 0; i < meshes.size(); i++)
+		meshes[i].GetTrianglePositions(occluder.vertices);
+
+	std::cout << "Occluder added: " << occluder.vertices.size() / 3 << " triangles" << std::endl;
+	m_occluders.push_back(occluder);
+}
+
+bool OcclusionCuller::IsOccluder(const Model* model) const
+{
+	for (size_t i = 0; i < m_occluders.size(); i++)
+	{
+		if (m_occluders[i].model == model)
+			return true;
+	}
+
+	return false;
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	m_viewProjection = viewProjection;
+	std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+	memset(&m_stats, 0, sizeof(m_stats));
+
+	size_t jobCount = 0;
+	for (size_t i = 0; i < m_occluders.size(); i++)
+		jobCount += (m_occluders[i].vertices.size() / 3 + TRIANGLES_PER_JOB - 1) / TRIANGLES_PER_JOB;
+	m_screenTriangles.resize(jobCount);
+
+	// Project the occluder triangles, world matrices are read here as they are cached on first use
+	JobCounter projected;
+	size_t job = 0;
+	for (size_t i = 0; i < m_occluders.size(); i++)
+	{
+		const Occluder& occluder = m_occluders[i];
+		glm::mat4 worldViewProjection = viewProjection * occluder.model->GetTransform().GetWorldMatrix();
+		size_t triangleCount = occluder.vertices.size() / 3;
+
+		for (size_t first = 0; first < triangleCount; first += TRIANGLES_PER_JOB, job++)
+		{
+			size_t last = std::min(first + TRIANGLES_PER_JOB, triangleCount);
+			std::vector<ScreenTriangle>* triangles = &m_screenTriangles[job];
+			triangles->clear();
+
+			JobSystem::Instance().Submit([this, &occluder, worldViewProjection, first, last, triangles]()
+			{
+				ProjectTriangles(occluder, worldViewProjection, first, last, *triangles);
+			}, &projected);
+		}
+	}
+	JobSystem::Instance().Wait(projected);
+
+	for (size_t i = 0; i < m_screenTriangles.size(); i++)
+		m_stats.occluderTriangles += (int)m_screenTriangles[i].size();
+
+	// Each band only writes its own rows, so the bands need no locking
+	JobCounter rasterized;
+	for (int minY = 0; minY < m_height; minY += ROWS_PER_BAND)
+	{
+		int maxY = std::min(minY + ROWS_PER_BAND, m_height) - 1;
+		JobSystem::Instance().Submit([this, minY, maxY]() { RasterizeBand(minY, maxY); }, &rasterized);
+	}
+	JobSystem::Instance().Wait(rasterized);
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	m_stats.rasterizeMs = elapsed.count();
+}
+
+bool OcclusionCuller::IsVisible(Model* model) const
+{
+	if (IsOccluder(model))
+		return true;
+
+	return TestBox(model->GetBoundsMin(), model->GetBoundsMax(), m_viewProjection * model->GetTransform().GetWorldMatrix());
+}
+
+void OcclusionCuller::TestModels(const std::vector<Model*>& models, std::vector<char>& visible)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	visible.assign(models.size(), 1);
+
+	// Matrices and occluder checks are done here, the jobs only read them
+	std::vector<glm::mat4> worldViewProjections(models.size());
+	std::vector<char> occluders(models.size());
+	for (size_t i = 0; i < models.size(); i++)
+	{
+		occluders[i] = IsOccluder(models[i]);
+		if (!occluders[i])
+			worldViewProjections[i] = m_viewProjection * models[i]->GetTransform().GetWorldMatrix();
+	}
+
+	JobCounter tested;
+	for (size_t first = 0; first < models.size(); first += MODELS_PER_JOB)
+	{
+		size_t last = std::min(first + MODELS_PER_JOB, models.size());
+
+		JobSystem::Instance().Submit([this, &models, &visible, &worldViewProjections, &occluders, first, last]()
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				if (!occluders[i])
+					visible[i] = TestBox(models[i]->GetBoundsMin(), models[i]->GetBoundsMax(), worldViewProjections[i]);
+			}
+		}, &tested);
+	}
+	JobSystem::Instance().Wait(tested);
+
+	for (size_t i = 0; i < models.size(); i++)
+	{
+		if (occluders[i])
+			continue;
+
+		m_stats.tested++;
+		if (!visible[i])
+			m_stats.culled++;
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+	m_stats.testMs += elapsed.count();
+}
+
+bool OcclusionCuller::SaveDepthImage(const std::string& filePath) const
+{
+	std::ofstream outfile(filePath.c_str(), std::ios::binary);
+	if (!outfile)
+	{
+		std::cout << "Cannot write depth image: " << filePath << std::endl;
+		return false;
+	}
+
+	outfile << "P5\n" << m_width << " " << m_height << "\n255\n";
+
+	// Row 0 of the depth buffer is the bottom of the screen
+	std::vector<unsigned char> row(m_width);
+	for (int y = m_height - 1; y >= 0; y--)
+	{
+		for (int x = 0; x < m_width; x++)
+		{
+			float depth = std::min(std::max(m_depth[(size_t)y * m_width + x], -1.0f), 1.0f);
+			row[x] = (unsigned char)((depth * 0.5f + 0.5f) * 255.0f);
+		}
+		outfile.write(reinterpret_cast<const char*>(&row[0]), m_width);
+	}
+
+	return true;
+}
+
+void OcclusionCuller::ProjectTriangles(const Occluder& occluder, const glm::mat4& worldViewProjection, size_t first, size_t last,
+	std::vector<ScreenTriangle>& triangles) const
+{
+	for (size_t i = first; i < last; i++)
+	{
+		glm::vec4 clip[3];
+		float distance[3];
+		int inside = 0;
+		for (int j = 0; j < 3; j++)
+		{
+			clip[j] = worldViewProjection * glm::vec4(occluder.vertices[i * 3 + j], 1.0f);
+
+			// Distance in front of the near plane
+			distance[j] = clip[j].z + clip[j].w;
+			if (distance[j] >= 0.0f)
+				inside++;
+		}
+
+		if (inside == 0)
+			continue;
+
+		if (inside == 3)
+		{
+			AddScreenTriangle(clip[0], clip[1], clip[2], triangles);
+			continue;
+		}
+
+		// Clip against the near plane, leaving a triangle or a quad
+		glm::vec4 polygon[4];
+		int count = 0;
+		for (int j = 0; j < 3; j++)
+		{
+			int k = (j + 1) % 3;
+			if (distance[j] >= 0.0f)
+				polygon[count++] = clip[j];
+
+			if ((distance[j] >= 0.0f) != (distance[k] >= 0.0f))
+			{
+				float t = distance[j] / (distance[j] - distance[k]);
+				polygon[count++] = clip[j] + (clip[k] - clip[j]) * t;
+			}
+		}
+
+		for (int j = 1; j + 1 < count; j++)
+			AddScreenTriangle(polygon[0], polygon[j], polygon[j + 1], triangles);
+	}
+}
+
+void OcclusionCuller::AddScreenTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c, std::vector<ScreenTriangle>& triangles) const
+{
+	if (a.w < MIN_CLIP_W || b.w < MIN_CLIP_W || c.w < MIN_CLIP_W)
+		return;
+
+	const glm::vec4* corners[3] = { &a, &b, &c };
+
+	ScreenTriangle triangle;
+	triangle.depth = -1.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		float invW = 1.0f / corners[i]->w;
+		triangle.x[i] = (corners[i]->x * invW * 0.5f + 0.5f) * m_width;
+		triangle.y[i] = (corners[i]->y * invW * 0.5f + 0.5f) * m_height;
+		triangle.depth = std::max(triangle.depth, corners[i]->z * invW);
+	}
+
+	// Occluders are seen from both sides, so back facing triangles are turned around
+	float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0])
+		- (triangle.y[1] - triangle.y[0]) * (triangle.x[2] - triangle.x[0]);
+	if (std::fabs(area) < 1e-6f)
+		return;
+	if (area < 0.0f)
+	{
+		std::swap(triangle.x[1], triangle.x[2]);
+		std::swap(triangle.y[1], triangle.y[2]);
+	}
+
+	// Pixels are covered when their centre is inside the triangle
+	float minX = std::min(triangle.x[0], std::min(triangle.x[1], triangle.x[2]));
+	float maxX = std::max(triangle.x[0], std::max(triangle.x[1], triangle.x[2]));
+	float minY = std::min(triangle.y[0], std::min(triangle.y[1], triangle.y[2]));
+	float maxY = std::max(triangle.y[0], std::max(triangle.y[1], triangle.y[2]));
+
+	int firstColumn = std::max((int)std::ceil(minX - 0.5f), 0);
+	int lastColumn = std::min((int)std::floor(maxX - 0.5f), m_width - 1);
+	triangle.minY = std::max((int)std::ceil(minY - 0.5f), 0);
+	triangle.maxY = std::min((int)std::floor(maxY - 0.5f), m_height - 1);
+	if (firstColumn > lastColumn || triangle.minY > triangle.maxY)
+		return;
+
+	triangles.push_back(triangle);
+}
+
+void OcclusionCuller::RasterizeBand(int minY, int maxY)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 pixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+	for (size_t list = 0; list < m_screenTriangles.size(); list++)
+	{
+		const std::vector<ScreenTriangle>& triangles = m_screenTriangles[list];
+		for (size_t i = 0; i < triangles.size(); i++)
+		{
+			const ScreenTriangle& triangle = triangles[i];
+			if (triangle.maxY < minY || triangle.minY > maxY)
+				continue;
+
+			int firstRow = std::max(triangle.minY, minY);
+			int lastRow = std::min(triangle.maxY, maxY);
+
+			float minX = std::min(triangle.x[0], std::min(triangle.x[1], triangle.x[2]));
+			float maxX = std::max(triangle.x[0], std::max(triangle.x[1], triangle.x[2]));
+			int firstColumn = std::max((int)std::ceil(minX - 0.5f), 0) & ~3;
+			int lastColumn = std::min((int)std::floor(maxX - 0.5f), m_width - 1);
+
+			// Edge functions e = a * x + b * y + c, positive inside the counter clockwise triangle
+			float a[3], b[3], c[3];
+			for (int j = 0; j < 3; j++)
+			{
+				int k = (j + 1) % 3;
+				a[j] = triangle.y[j] - triangle.y[k];
+				b[j] = triangle.x[k] - triangle.x[j];
+				c[j] = triangle.x[j] * triangle.y[k] - triangle.x[k] * triangle.y[j];
+			}
+
+			__m128 a0 = _mm_set1_ps(a[0]), a1 = _mm_set1_ps(a[1]), a2 = _mm_set1_ps(a[2]);
+			__m128 depth = _mm_set1_ps(triangle.depth);
+
+			for (int y = firstRow; y <= lastRow; y++)
+			{
+				float pixelY = y + 0.5f;
+				__m128 row0 = _mm_set1_ps(b[0] * pixelY + c[0]);
+				__m128 row1 = _mm_set1_ps(b[1] * pixelY + c[1]);
+				__m128 row2 = _mm_set1_ps(b[2] * pixelY + c[2]);
+				float* depthRow = &m_depth[(size_t)y * m_width];
+
+				// The width is a multiple of four, so the last group never runs past the row
+				for (int x = firstColumn; x <= lastColumn; x += 4)
+				{
+					__m128 pixelX = _mm_add_ps(_mm_set1_ps((float)x), pixelOffsets);
+					__m128 edge0 = _mm_add_ps(_mm_mul_ps(a0, pixelX), row0);
+					__m128 edge1 = _mm_add_ps(_mm_mul_ps(a1, pixelX), row1);
+					__m128 edge2 = _mm_add_ps(_mm_mul_ps(a2, pixelX), row2);
+
+					__m128 covered = _mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_and_ps(_mm_cmpge_ps(edge1, zero), _mm_cmpge_ps(edge2, zero)));
+					if (_mm_movemask_ps(covered) == 0)
+						continue;
+
+					__m128 current = _mm_loadu_ps(depthRow + x);
+					__m128 nearest = _mm_min_ps(current, depth);
+					_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(covered, nearest), _mm_andnot_ps(covered, current)));
+				}
+			}
+		}
+	}
+}
+
+bool OcclusionCuller::TestBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& worldViewProjection) const
+{
+	glm::vec3 screenMin(1e30f), screenMax(-1e30f);
+	for (int i = 0; i < 8; i++)
+	{
+		glm::vec4 corner((i & 1) ? boundsMax.x : boundsMin.x, (i & 2) ? boundsMax.y : boundsMin.y,
+			(i & 4) ? boundsMax.z : boundsMin.z, 1.0f);
+		glm::vec4 clip = worldViewProjection * corner;
+
+		// A box reaching past the near plane surrounds the camera
+		if (clip.w < MIN_CLIP_W || clip.z < -clip.w)
+			return true;
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		screenMin = glm::min(screenMin, ndc);
+		screenMax = glm::max(screenMax, ndc);
+	}
+
+	// Outside the view
+	if (screenMax.x < -1.0f || screenMin.x > 1.0f || screenMax.y < -1.0f || screenMin.y > 1.0f || screenMin.z > 1.0f)
+		return false;
+
+	int firstColumn = std::max((int)std::floor((screenMin.x * 0.5f + 0.5f) * m_width), 0);
+	int lastColumn = std::min((int)std::floor((screenMax.x * 0.5f + 0.5f) * m_width), m_width - 1);
+	int firstRow = std::max((int)std::floor((screenMin.y * 0.5f + 0.5f) * m_height), 0);
+	int lastRow = std::min((int)std::floor((screenMax.y * 0.5f + 0.5f) * m_height), m_height - 1);
+
+	// Visible if any pixel has no occluder in front of the nearest point of the box
+	__m128 boxDepth = _mm_set1_ps(screenMin.z);
+	for (int y = firstRow; y <= lastRow; y++)
+	{
+		const float* depthRow = &m_depth[(size_t)y * m_width];
+		for (int x = firstColumn & ~3; x <= lastColumn; x += 4)
+		{
+			int lanes = 0xF;
+			if (x < firstColumn)
+				lanes &= 0xF << (firstColumn - x);
+			if (x + 3 > lastColumn)
+				lanes &= 0xF >> (x + 3 - lastColumn);
+
+			if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(depthRow + x), boxDepth)) & lanes)
+				return true;
+		}
+	}
+
+	return false;
+}
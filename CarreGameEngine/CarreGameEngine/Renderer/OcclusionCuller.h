@@ -0,0 +1,256 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <GLM\glm.hpp>
+
+#include "..\AssetFactory\Model.h"
+#include "..\Common\JobSystem.h"
+
+	/**
+	* @struct CullingStats
+	* @brief Results and cost of the occlusion culling of a frame
+	*/
+struct CullingStats
+{
+	/// Models tested against the depth buffer, occluders excluded
+	int tested;
+
+	/// Tested models that were hidden behind the occluders or outside the view
+	int culled;
+
+	/// Occluder triangles rasterized into the depth buffer
+	int occluderTriangles;
+
+	/// Time spent rasterizing the occluders and testing the models
+	double rasterizeMs, testMs;
+
+		/**
+		* @brief Gets the culled percentage
+		*
+		* @return float
+		*/
+	float GetCulledPercent() const { return tested > 0 ? 100.0f * culled / tested : 0.0f; }
+};
+
+	/**
+	* @class OcclusionCuller
+	* @brief Software occlusion culler
+	*
+	* The lecture theatre hides almost everything inside it from the outside, but every model
+	* would still be drawn. The occlusion culler rasterizes the triangles of a few large occluder
+	* models into a small depth buffer on the CPU, then tests the bounding box of every other
+	* model against it so hidden models are never submitted to the renderer.
+	*
+	* Occluders are written with the farthest depth of each triangle, and a box is only culled
+	* if every pixel it covers has an occluder in front of its nearest point, so the culler never
+	* hides a visible model. Rasterization is split into horizontal bands and testing into
+	* groups of models, both run on the job system and processing four pixels at a time with
+	* SSE.
+	*
+	* The culler makes no OpenGL calls, so it can run without a window.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class OcclusionCuller
+{
+public:
+		/**
+		* @brief Constructor
+		*
+		* Creates a depth buffer of the given size. The width is rounded up to a multiple of four.
+		*
+		* @param int width
+		* @param int height
+		* @return null
+		*/
+	OcclusionCuller(int width = 256, int height = 128);
+
+		/**
+		* @brief Destructor
+		*
+		* Empty destructor.
+		*
+		* @return null
+		*/
+	~OcclusionCuller() { }
+
+		/**
+		* @brief Adds an occluder
+		*
+		* Copies the triangles of the model to be rasterized every frame with the current world
+		* matrix of the model. Occluders are never culled themselves.
+		*
+		* @param Model* model
+		* @return void
+		*/
+	void AddOccluder(Model* model);
+
+		/**
+		* @brief Removes every occluder
+		*
+		* @return void
+		*/
+	void ClearOccluders() { m_occluders.clear(); }
+
+		/**
+		* @brief Checks if a model is an occluder
+		*
+		* @param const Model* model
+		* @return bool
+		*/
+	bool IsOccluder(const Model* model) const;
+
+		/**
+		* @brief Starts a frame
+		*
+		* Clears the depth buffer and rasterizes every occluder with the given view projection
+		* matrix. Must be called after the occluders have been moved for the frame and before
+		* any model is tested.
+		*
+		* @param const glm::mat4& viewProjection
+		* @return void
+		*/
+	void BeginFrame(const glm::mat4& viewProjection);
+
+		/**
+		* @brief Tests a single model
+		*
+		* Returns false if the bounding box of the model is hidden behind the occluders or
+		* outside the view. Occluders are always visible.
+		*
+		* @param Model* model
+		* @return bool
+		*/
+	bool IsVisible(Model* model) const;
+
+		/**
+		* @brief Tests a list of models
+		*
+		* Tests every model on the job system and sets visible[i] to 1 if models[i] must be
+		* drawn, or 0 if it was culled. Updates the statistics of the frame.
+		*
+		* @param const std::vector<Model*>& models
+		* @param std::vector<char>& visible
+		* @return void
+		*/
+	void TestModels(const std::vector<Model*>& models, std::vector<char>& visible);
+
+		/**
+		* @brief Gets the statistics of the frame
+		*
+		* @return const CullingStats&
+		*/
+	const CullingStats& GetStats() const { return m_stats; }
+
+		/**
+		* @brief Saves the depth buffer
+		*
+		* Writes the depth buffer as a greyscale PGM image, near occluders dark and empty pixels
+		* white, to check the occluders without a window.
+		*
+		* @param const std::string& filePath
+		* @return bool
+		*/
+	bool SaveDepthImage(const std::string& filePath) const;
+
+private:
+		/**
+		* @struct Occluder
+		* @brief An occluder model and its model space triangles
+		*/
+	struct Occluder
+	{
+		Model* model;
+		std::vector<glm::vec3> vertices;
+	};
+
+		/**
+		* @struct ScreenTriangle
+		* @brief An occluder triangle projected to the depth buffer
+		*/
+	struct ScreenTriangle
+	{
+		/// Pixel positions of the corners, wound counter clockwise
+		float x[3], y[3];
+
+		/// Farthest normalized device depth of the triangle
+		float depth;
+
+		/// Rows covered by the triangle
+		int minY, maxY;
+	};
+
+		/**
+		* @brief Projects occluder triangles
+		*
+		* Transforms the triangles in [first, last) of an occluder to the depth buffer, clipping
+		* them against the near plane.
+		*
+		* @param const Occluder& occluder
+		* @param const glm::mat4& worldViewProjection
+		* @param size_t first
+		* @param size_t last
+		* @param std::vector<ScreenTriangle>& triangles
+		* @return void
+		*/
+	void ProjectTriangles(const Occluder& occluder, const glm::mat4& worldViewProjection, size_t first, size_t last,
+		std::vector<ScreenTriangle>& triangles) const;
+
+		/**
+		* @brief Adds a projected triangle
+		*
+		* Converts a triangle in clip space to pixels and adds it, unless it covers no pixels.
+		*
+		* @param const glm::vec4& a
+		* @param const glm::vec4& b
+		* @param const glm::vec4& c
+		* @param std::vector<ScreenTriangle>& triangles
+		* @return void
+		*/
+	void AddScreenTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c, std::vector<ScreenTriangle>& triangles) const;
+
+		/**
+		* @brief Rasterizes a band of the depth buffer
+		*
+		* Writes every projected triangle into the rows [minY, maxY] of the depth buffer.
+		*
+		* @param int minY
+		* @param int maxY
+		* @return void
+		*/
+	void RasterizeBand(int minY, int maxY);
+
+		/**
+		* @brief Tests a bounding box
+		*
+		* Returns false if the box is hidden behind the occluders or outside the view.
+		*
+		* @param const glm::vec3& boundsMin
+		* @param const glm::vec3& boundsMax
+		* @param const glm::mat4& worldViewProjection
+		* @return bool
+		*/
+	bool TestBox(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& worldViewProjection) const;
+
+	/// Size of the depth buffer in pixels
+	int m_width, m_height;
+
+	/// Normalized device depth of the nearest occluder in each pixel, 1 where there is none
+	std::vector<float> m_depth;
+
+	/// Occluders rasterized every frame
+	std::vector<Occluder> m_occluders;
+
+	/// Occluder triangles projected this frame, one list per projection job
+	std::vector<std::vector<ScreenTriangle>> m_screenTriangles;
+
+	/// View projection matrix of the frame
+	glm::mat4 m_viewProjection;
+
+	/// Statistics of the frame
+	CullingStats m_stats;
+};
@@ -1,111 +1,430 @@
 #include "OpenGl.h"
 
-void OpenGl::Prepare(Model* model, std::string vertShader, std::string fragShader)
+/// Screen height share of a model below which it moves to the next coarser level of detail
+static const float LOD_SCREEN_SIZES[] = { 0.5f, 0.25f, 0.1f };
+
+/// Number of levels of detail, the full mesh included
+static const int LOD_LEVELS = sizeof(LOD_SCREEN_SIZES) / sizeof(LOD_SCREEN_SIZES[0]) + 1;
+
+/// Fraction a model must be past a threshold before its level of detail changes
+static const float LOD_HYSTERESIS = 0.15f;
+
+void OpenGl::Prepare(Model* model, Shader* shader, Shader* arrayShader)
 {
-	model->GetShader()->Initialize(vertShader, fragShader);
+	model->SetShader(shader);
+
+	std::vector<unsigned char> packedVertices;
+
+	// Vertex animated models read their positions from the keyframes, once they are on the GPU
+	KeyframeSet* keyframes = model->GetKeyframes();
+	bool animated = keyframes && keyframes->Upload();
 
 	int meshBatchSize = model->GetMeshBatch().size();
 	for (int i = 0; i < meshBatchSize; i++)
 	{
-		glGenVertexArrays(1, &model->GetMeshBatch()[i].VAO);
-		//std::cout << model->GetMeshBatch()[i].VAO << std::endl;
-		glGenBuffers(1, &model->GetMeshBatch()[i].VBO);
-		glGenBuffers(1, &model->GetMeshBatch()[i].EBO);
+		Mesh& mesh = model->GetMeshBatch()[i];
+
+		// Models loaded from the same file share their meshes, which only need preparing once
+		if (mesh.VAO)
+			continue;
 
-		glBindVertexArray(model->GetMeshBatch()[i].VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, model->GetMeshBatch()[i].VBO);
+		// Meshes whose diffuse texture was packed into a texture array use the array shader
+		Shader* meshShader = shader;
+		if (arrayShader && !mesh.GetTextures().empty() && TextureManager::Instance().ResolveTexture(mesh.GetTextures()[0]))
+			meshShader = arrayShader;
+		if (animated)
+			meshShader = ShaderManager::Instance().GetVariant(meshShader, "KEYFRAMES");
+		else if (mesh.GetLayout().HasAttribute(ATTRIB_BONE_INDICES))
+			meshShader = ShaderManager::Instance().GetVariant(meshShader, "SKINNING");
+		mesh.SetShader(meshShader);
 
-		glBufferData(GL_ARRAY_BUFFER, sizeof(model->GetMeshBatch()[i].GetVertices()[0]) * model->GetMeshBatch()[i].GetVertices().size(), &model->GetMeshBatch()[i].GetVertices()[0], GL_STATIC_DRAW);
+		// Attributes the shader never reads are not uploaded
+		unsigned int shaderAttributes = meshShader->GetActiveAttributeMask();
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model->GetMeshBatch()[i].EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, model->GetMeshBatch()[i].GetIndices().size() * sizeof(unsigned int), &model->GetMeshBatch()[i].GetIndices()[0], GL_STATIC_DRAW);
+		VertexLayout layout = mesh.GetLayout();
+		const unsigned char* vertexData = NULL;
+		size_t vertexBytes = 0;
+		const unsigned int* indexData = NULL;
+		size_t indexCount = 0;
+
+		if (mesh.IsCooked())
+		{
+			// Cooked blobs are uploaded straight from the mapped file, unread attributes are only disabled
+			vertexData = mesh.GetCookedVertices();
+			vertexBytes = mesh.GetVertexCount() * layout.GetStride();
+			indexData = mesh.GetCookedIndices();
+			indexCount = mesh.GetCookedIndexCount();
+		}
+		else
+		{
+			if (shaderAttributes)
+				layout = layout.Filter(shaderAttributes);
+			layout.Pack(mesh.GetVertices(), packedVertices);
+
+			vertexData = packedVertices.empty() ? NULL : &packedVertices[0];
+			vertexBytes = packedVertices.size();
+			indexData = mesh.GetIndices().empty() ? NULL : &mesh.GetIndices()[0];
+			indexCount = mesh.GetIndices().size();
+		}
 
-		// vertex positions
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(model->GetMeshBatch()[i].GetVertices()[0]), 0);
-		// vertex texture coords
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(model->GetMeshBatch()[i].GetVertices()[0]), (GLvoid*)sizeof(model->GetMeshBatch()[i].GetVertices()[0].m_position));
-		// vertex normals
-		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(model->GetMeshBatch()[i].GetVertices()[0]), (GLvoid*)sizeof(model->GetMeshBatch()[i].GetVertices()[0].m_texCoords));
-		// vertex colours
-		glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(model->GetMeshBatch()[i].GetVertices()[0]), (GLvoid*)sizeof(model->GetMeshBatch()[i].GetVertices()[0].m_normal));
+		glGenVertexArrays(1, &mesh.VAO);
+		//std::cout << mesh.VAO << std::endl;
+		glGenBuffers(1, &mesh.VBO);
+		glGenBuffers(1, &mesh.EBO);
+
+		glBindVertexArray(mesh.VAO);
+		glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+
+		if (vertexBytes > 0)
+			glBufferData(GL_ARRAY_BUFFER, vertexBytes, vertexData, GL_STATIC_DRAW);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+		if (indexCount > 0)
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indexData, GL_STATIC_DRAW);
+
+		// Vertex attributes come from the layout and are stored in the VAO
+		layout.ApplyAttributes(shaderAttributes ? shaderAttributes : ~0u);
 
 		glBindVertexArray(0);
+
+		m_vertexBufferBytes += vertexBytes;
+		m_unpackedVertexBytes += mesh.GetVertexCount() * sizeof(Vertex3);
 	}
 }
 
 void OpenGl::Render(Model* model)
 {
-	model->GetShader()->TurnOn();
+	// Every mesh is drawn with the models cached world matrix
+	glm::mat4 modelMatrix = model->GetTransform().GetWorldMatrix();
+	int lodLevel = SelectLod(model);
+
+	// The frames a vertex animated model is between ride in the bottom row of its world matrix,
+	// which is always (0, 0, 0, 1), so models in different frames still draw as instances
+	GLuint keyframeTexture = 0;
+	GLint keyframeVertexCount = 0;
+	KeyframeSet* keyframes = model->GetKeyframes();
+	if (keyframes && keyframes->IsUploaded())
+	{
+		int from, to;
+		float blend;
+		keyframes->Sample(model->GetPlayback(), from, to, blend);
+
+		modelMatrix[0][3] = (float)from;
+		modelMatrix[1][3] = (float)to;
+		modelMatrix[2][3] = blend;
+		keyframeTexture = keyframes->GetTexture();
+		keyframeVertexCount = keyframes->GetVertexCount();
+	}
+
+	// Skinned meshes share the bone palette of their model, posed before the model is rendered
+	GLuint paletteOffset = 0;
+	GLsizei paletteSize = 0;
+	const std::vector<glm::mat4>& palette = model->GetBonePalette();
+	if (model->GetSkeleton() && !palette.empty())
+	{
+		paletteOffset = (GLuint)m_paletteQueue.size();
+		paletteSize = (GLsizei)palette.size();
+		m_paletteQueue.insert(m_paletteQueue.end(), palette.begin(), palette.end());
+	}
 
 	int meshBatchSize = model->GetMeshBatch().size();
 	for (int i = 0; i < meshBatchSize; i++)
 	{
-		unsigned int diffuseNr = 1;
-		unsigned int specularNr = 1;
-		unsigned int normalNr = 1;
-		unsigned int heightNr = 1;
+		Mesh& mesh = model->GetMeshBatch()[i];
+
+		DrawItem item;
+		item.shader = mesh.GetShader() ? mesh.GetShader() : model->GetShader();
+		item.vao = mesh.VAO;
+		item.texture = 0;
+		item.textureTarget = GL_TEXTURE_2D;
+		item.textureLayer = 0;
+		// Imported meshes are indexed, meshes built in code draw their vertices in order
+		item.count = mesh.GetFullIndexCount() ? (GLsizei)mesh.GetFullIndexCount() : (GLsizei)mesh.GetVertexCount();
+		item.firstIndex = 0;
+		item.indexed = mesh.GetFullIndexCount() > 0;
+		item.fullDetailCount = item.count;
+		item.modelMatrix = modelMatrix;
+		item.keyframeTexture = keyframeTexture;
+		item.keyframeVertexCount = keyframeVertexCount;
+		item.paletteOffset = paletteOffset;
+		item.paletteSize = mesh.GetLayout().HasAttribute(ATTRIB_BONE_INDICES) ? paletteSize : 0;
 
-		int textureListSize = meshBatchSize;
-		for (int j = 0; j < textureListSize; j++)
+		// Reduced levels are ranges of the index buffer, meshes with fewer levels use their coarsest
+		const std::vector<MeshLod>& lods = mesh.GetLods();
+		if (lodLevel > 0 && !lods.empty())
 		{
-			glActiveTexture(GL_TEXTURE0 + j); // activate proper texture unit before binding
-												// retrieve texture number (the N in diffuse_textureN)
-			std::string number;
-			std::string name;
-			if (model->GetMeshBatch()[i].GetTextures().size() <= 0)
-				break;
-
-			name = model->GetMeshBatch()[i].GetTextures()[0].m_type;
-
-			if (name == "texture_diffuse")
-				number = std::to_string(diffuseNr++);
-			else if (name == "texture_specular")
-				number = std::to_string(specularNr++);
-			else if (name == "texture_normal")
-				number = std::to_string(normalNr++);
-			else if (name == "texture_height")
-				number = std::to_string(heightNr++);
-			else
+			const MeshLod& lod = lods[std::min((size_t)lodLevel, lods.size()) - 1];
+			item.count = (GLsizei)lod.indexCount;
+			item.firstIndex = lod.firstIndex;
+			item.indexed = true;
+		}
+
+		// Only the diffuse texture is read by the shader
+		if (!mesh.GetTextures().empty())
+		{
+			const Texture& texture = mesh.GetTextures()[0];
+			if (texture.m_type != "texture_diffuse")
 				std::cout << "Incorrect texture Id in OpenGl renderer" << std::endl;
 
-			GLuint textureUniformId = model->GetShader()->GetVariable((name + number).c_str());
-			model->GetShader()->SetFloat(textureUniformId, j);
-			glBindTexture(GL_TEXTURE_2D, model->GetMeshBatch()[i].GetTextures()[0].m_id);
+			item.texture = texture.m_id;
+			item.textureTarget = texture.m_target;
+			item.textureLayer = texture.m_layer;
+		}
+
+		item.sortKey = ((unsigned long long)(item.shader->GetProgramId() & 0xFFFF) << 48)
+			| ((unsigned long long)(item.texture & 0xFFFFFF) << 24)
+			| (unsigned long long)(item.vao & 0xFFFFFF);
+
+		m_drawQueue.push_back(item);
+	}
+}
+
+int OpenGl::SelectLod(Model* model)
+{
+	Camera* camera = model->GetCamera();
+	if (!camera)
+		return 0;
+
+	// Bounding sphere of the model in world space
+	const glm::mat4& world = model->GetTransform().GetWorldMatrix();
+	glm::vec3 halfSize = (model->GetBoundsMax() - model->GetBoundsMin()) * 0.5f;
+	glm::vec3 centre = glm::vec3(world * glm::vec4(model->GetBoundsMin() + halfSize, 1.0f));
+	float scale = std::max(glm::length(glm::vec3(world[0])), std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+	float radius = glm::length(halfSize) * scale;
+
+	float distance = glm::length(centre - camera->GetPosition());
+	int level = model->GetLodLevel();
+	if (distance <= radius)
+	{
+		level = 0;
+	}
+	else
+	{
+		// Share of the screen height covered by the sphere
+		float screenSize = radius / distance * camera->GetProjectionMatrix()[1][1];
+
+		while (level < LOD_LEVELS - 1 && screenSize < LOD_SCREEN_SIZES[level] * (1.0f - LOD_HYSTERESIS))
+			level++;
+		while (level > 0 && screenSize > LOD_SCREEN_SIZES[level - 1] * (1.0f + LOD_HYSTERESIS))
+			level--;
+	}
+
+	model->SetLodLevel(level);
+	return level;
+}
+
+// Sorts draws by their state key, then groups the same level of detail so it can be instanced
+static bool CompareDrawItems(const DrawItem& a, const DrawItem& b)
+{
+	if (a.sortKey != b.sortKey)
+		return a.sortKey < b.sortKey;
+	if (a.textureLayer != b.textureLayer)
+		return a.textureLayer < b.textureLayer;
+	return a.firstIndex < b.firstIndex;
+}
+
+// Checks if two draws only differ by their world matrix
+static bool IsSameMesh(const DrawItem& a, const DrawItem& b)
+{
+	return a.shader == b.shader && a.vao == b.vao && a.texture == b.texture && a.textureTarget == b.textureTarget
+		&& a.textureLayer == b.textureLayer && a.count == b.count && a.firstIndex == b.firstIndex && a.indexed == b.indexed
+		&& a.keyframeTexture == b.keyframeTexture;
+}
+
+/// Texture unit the transform buffer is bound to
+static const GLuint TRANSFORM_TEXTURE_UNIT = 1;
+
+/// Texture unit the keyframes of vertex animated meshes are bound to
+static const GLuint KEYFRAME_TEXTURE_UNIT = 2;
+
+void OpenGl::TakeDrawQueue(std::vector<DrawItem>& items, std::vector<glm::mat4>& palettes)
+{
+	// Swapping hands the old list back to the queue so its memory is reused
+	items.swap(m_drawQueue);
+	m_drawQueue.clear();
+	palettes.swap(m_paletteQueue);
+	m_paletteQueue.clear();
+}
+
+void OpenGl::Draw(std::vector<DrawItem>& items, const std::vector<glm::mat4>& palettes, const glm::mat4& view, const glm::mat4& projection)
+{
+	if (items.empty() || !m_transforms.Initialize())
+		return;
 
-			if (meshBatchSize == 1)
-				break;
+	// Count the texture binds drawing in submission order would cost, to compare against
+	GLuint lastTexture = 0;
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		if (i == 0 || items[i].texture != lastTexture)
+			m_renderStats.unsortedTextureBinds++;
+		lastTexture = items[i].texture;
+	}
+
+	std::stable_sort(items.begin(), items.end(), CompareDrawItems);
+
+	Shader* shader = NULL;
+	GLuint texture = 0;
+	GLenum textureTarget = GL_TEXTURE_2D;
+	GLuint vao = 0;
+	GLint modelMatrixId = -1, layerId = -1, transformBaseId = -1, keyframeVertexCountId = -1;
+	GLuint keyframeTexture = 0;
+	GLint keyframeVertexCount = -1;
+
+	m_transforms.Bind(TRANSFORM_TEXTURE_UNIT);
+
+	bool textureBound = false;
+
+	// Lists longer than a region of the transform buffer are drawn a region at a time, each draw
+	// taking its world matrix and the palette of its skeleton
+	size_t capacity = m_transforms.GetRegionCapacity();
+	size_t chunkEnd = 0;
+	for (size_t chunkStart = 0; chunkStart < items.size(); chunkStart = chunkEnd)
+	{
+		size_t matrixCount = 0;
+		chunkEnd = chunkStart;
+		while (chunkEnd < items.size() && matrixCount + 1 + items[chunkEnd].paletteSize <= capacity)
+		{
+			matrixCount += 1 + items[chunkEnd].paletteSize;
+			chunkEnd++;
 		}
-		glActiveTexture(GL_TEXTURE0);
 
-		glm::mat4 projectionMatrix = model->GetCamera()->GetProjectionMatrix();
-		glm::mat4 modelMatrix = CreateTransformationMatrix(model->GetPosition(), model->GetRotation(), model->GetScale());
-		glm::mat4 viewMatrix = CreateViewMatrix(model->GetCamera());
+		// A palette larger than a region cannot be drawn, only that draw is skipped
+		if (chunkEnd == chunkStart)
+		{
+			m_renderStats.skippedDraws++;
+			chunkEnd++;
+			continue;
+		}
+
+		GLint base = 0;
+		glm::mat4* matrices = m_transforms.Map(matrixCount, base);
+		if (!matrices)
+		{
+			std::cout << "Failed to map the transform buffer" << std::endl;
+			break;
+		}
+
+		// Palettes follow the world matrices, the bottom row of a skinned draw's matrix holds where its palette starts
+		size_t paletteStart = chunkEnd - chunkStart;
+		for (size_t i = chunkStart; i < chunkEnd; i++)
+		{
+			glm::mat4 matrix = items[i].modelMatrix;
+			if (items[i].paletteSize > 0)
+			{
+				matrix[0][3] = (float)(base + (GLint)paletteStart);
+				std::copy(palettes.begin() + items[i].paletteOffset, palettes.begin() + items[i].paletteOffset + items[i].paletteSize, matrices + paletteStart);
+				paletteStart += items[i].paletteSize;
+			}
+			matrices[i - chunkStart] = matrix;
+		}
+		m_transforms.Unmap();
+
+		size_t i = chunkStart;
+		while (i < chunkEnd)
+		{
+			const DrawItem& item = items[i];
+
+			if (item.shader != shader)
+			{
+				shader = item.shader;
+				shader->TurnOn();
+				m_renderStats.shaderBinds++;
 
-		GLint modelMatrixId = model->GetShader()->GetVariable("model");
-		GLint viewMatrixId = model->GetShader()->GetVariable("view");
-		GLint projectionMatrixId = model->GetShader()->GetVariable("projection");
+				// View and projection are the same for every draw of the frame
+				shader->SetMatrix4(shader->GetVariable("view"), 1, false, &view[0][0]);
+				shader->SetMatrix4(shader->GetVariable("projection"), 1, false, &projection[0][0]);
+				shader->SetInt(shader->GetVariable("texture_diffuse1"), 0);
+				shader->SetInt(shader->GetVariable("transforms"), TRANSFORM_TEXTURE_UNIT);
+				shader->SetInt(shader->GetVariable("keyframes"), KEYFRAME_TEXTURE_UNIT);
 
-		model->GetShader()->SetMatrix4(modelMatrixId, 1, false, &modelMatrix[0][0]);
-		model->GetShader()->SetMatrix4(viewMatrixId, 1, false, &viewMatrix[0][0]);
-		model->GetShader()->SetMatrix4(projectionMatrixId, 1, false, &projectionMatrix[0][0]);
+				modelMatrixId = shader->GetVariable("model");
+				layerId = shader->GetVariable("textureLayer");
+				transformBaseId = shader->GetVariable("transformBase");
+				keyframeVertexCountId = shader->GetVariable("keyframeVertexCount");
+				keyframeVertexCount = -1;
+			}
 
-		glBindVertexArray(model->GetMeshBatch()[i].VAO);
+			if (item.keyframeTexture != keyframeTexture)
+			{
+				keyframeTexture = item.keyframeTexture;
+				glActiveTexture(GL_TEXTURE0 + KEYFRAME_TEXTURE_UNIT);
+				glBindTexture(GL_TEXTURE_BUFFER, keyframeTexture);
+				glActiveTexture(GL_TEXTURE0);
+				m_renderStats.textureBinds++;
+			}
 
-		glEnableVertexAttribArray(0);
-		glEnableVertexAttribArray(1);
-		glEnableVertexAttribArray(2);
-		glEnableVertexAttribArray(3);
+			if (keyframeVertexCountId >= 0 && item.keyframeVertexCount != keyframeVertexCount)
+			{
+				keyframeVertexCount = item.keyframeVertexCount;
+				shader->SetInt(keyframeVertexCountId, keyframeVertexCount);
+				m_renderStats.uniformBytes += sizeof(GLint);
+			}
 
-		glDrawArrays(GL_TRIANGLES, 0, model->GetMeshBatch()[i].GetVertices().size());
-		//glDrawElements(GL_TRIANGLES, model->GetMeshBatch()[i].GetIndices().size(), GL_UNSIGNED_INT, 0);
+			if (item.texture != texture || item.textureTarget != textureTarget || !textureBound)
+			{
+				if (item.textureTarget != textureTarget)
+					glBindTexture(textureTarget, 0);
 
-		glDisableVertexAttribArray(0);
-		glDisableVertexAttribArray(1);
-		glDisableVertexAttribArray(2);
-		glDisableVertexAttribArray(3);
+				texture = item.texture;
+				textureTarget = item.textureTarget;
+				glBindTexture(textureTarget, texture);
+				textureBound = true;
+				m_renderStats.textureBinds++;
+			}
 
-		glBindVertexArray(0);
+			if (item.vao != vao)
+			{
+				vao = item.vao;
+				glBindVertexArray(vao);
+				m_renderStats.vertexArrayBinds++;
+			}
+
+			if (layerId >= 0)
+			{
+				shader->SetFloat(layerId, (GLfloat)item.textureLayer);
+				m_renderStats.uniformBytes += sizeof(GLfloat);
+			}
 
+			// Shaders reading the transform buffer draw a run of the same mesh as instances
+			GLsizei instances = 1;
+			if (transformBaseId >= 0)
+			{
+				while (i + instances < chunkEnd && IsSameMesh(item, items[i + instances]))
+					instances++;
+
+				shader->SetInt(transformBaseId, base + (GLint)(i - chunkStart));
+				m_renderStats.uniformBytes += sizeof(GLint);
+			}
+			else
+			{
+				shader->SetMatrix4(modelMatrixId, 1, false, &item.modelMatrix[0][0]);
+				m_renderStats.uniformBytes += sizeof(glm::mat4);
+			}
+
+			if (item.indexed)
+				glDrawElementsInstanced(GL_TRIANGLES, item.count, GL_UNSIGNED_INT, (const GLvoid*)(item.firstIndex * sizeof(unsigned int)), instances);
+			else
+				glDrawArraysInstanced(GL_TRIANGLES, 0, item.count, instances);
+			m_renderStats.drawCalls++;
+			m_renderStats.instances += instances;
+			m_renderStats.triangles += item.count / 3 * instances;
+			m_renderStats.fullDetailTriangles += item.fullDetailCount / 3 * instances;
+
+			i += instances;
+		}
+
+		m_transforms.Fence();
+	}
+	m_renderStats.transformStalls = m_transforms.GetStallCount();
+
+	glBindVertexArray(0);
+	glBindTexture(textureTarget, 0);
+	if (keyframeTexture)
+	{
+		glActiveTexture(GL_TEXTURE0 + KEYFRAME_TEXTURE_UNIT);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+		glActiveTexture(GL_TEXTURE0);
 	}
-	model->GetShader()->TurnOff();
+	if (shader)
+		shader->TurnOff();
 }
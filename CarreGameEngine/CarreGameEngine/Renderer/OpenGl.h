@@ -1,12 +1,83 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
+#include <cstring>
 #include <GL\glew.h>
 
 #include "..\Common\MyMath.h"
 #include "..\AssetFactory\Model.h"
+#include "ShaderManager.h"
+#include "TransformBuffer.h"
 //#include "IRenderer.h" // Will make this class use IRenderer later
 
+	/**
+	* @struct DrawItem
+	* @brief A single mesh draw waiting in the render queue
+	*/
+struct DrawItem
+{
+	/// Shader program, vertex array and texture state of the draw
+	Shader* shader;
+	GLuint vao;
+	GLuint texture;
+	GLenum textureTarget;
+	int textureLayer;
+
+	/// Number of vertices drawn, or indices from firstIndex when the draw is indexed
+	GLsizei count;
+	GLuint firstIndex;
+	bool indexed;
+
+	/// Number of vertices of the mesh at full detail
+	GLsizei fullDetailCount;
+
+	/// World matrix of the model the mesh belongs to, vertex animated meshes carry their frames in its bottom row
+	glm::mat4 modelMatrix;
+
+	/// Bone palette of skinned meshes in the palettes of the queue, 0 matrices for meshes without bones
+	GLuint paletteOffset;
+	GLsizei paletteSize;
+
+	/// Buffer texture of the keyframes and vertices in a frame, 0 for static meshes
+	GLuint keyframeTexture;
+	GLint keyframeVertexCount;
+
+	/// Orders draws by shader, then texture, then vertex array
+	unsigned long long sortKey;
+};
+
+	/**
+	* @struct RenderStats
+	* @brief Draw and state change counts of a flushed render queue
+	*/
+struct RenderStats
+{
+	/// Draw calls issued
+	int drawCalls;
+
+	/// glUseProgram(), glBindTexture() and glBindVertexArray() calls issued
+	int shaderBinds, textureBinds, vertexArrayBinds;
+
+	/// Texture binds the same draws would have needed drawn in submission order
+	int unsortedTextureBinds;
+
+	/// Triangles drawn, and the triangles the same draws would have cost at full detail
+	int triangles, fullDetailTriangles;
+
+	/// Meshes drawn, more than the draw calls when repeated meshes are drawn as instances
+	int instances;
+
+	/// Bytes of uniforms set for the draws, not counting the per shader uniforms
+	int uniformBytes;
+
+	/// Draws skipped because their palette does not fit in a region of the transform buffer
+	int skippedDraws;
+
+	/// Maps that waited for the GPU to release a transform buffer region, since the renderer was created
+	int transformStalls;
+};
+
 	/**
 	* @class OpenGl
 	* @brief OpenGl renderer class
@@ -27,11 +98,14 @@ public:
 		/**
 		* @brief Default constructor
 		*
-		* Empty default constructor.
+		* Sets the vertex buffer and render statistics to zero.
 		*
 		* @return null
 		*/
-	OpenGl() { }
+	OpenGl() : m_vertexBufferBytes(0), m_unpackedVertexBytes(0)
+	{
+		memset(&m_renderStats, 0, sizeof(m_renderStats));
+	}
 
 		/**
 		* @brief Destructor
@@ -45,29 +119,146 @@ public:
 		/**
 		* @brief Prepare
 		*
-		* Takes model data, vertex shader string and fragment shader string and prepares
+		* Takes model data and the shared shader program to render it with and prepares
 		* the VAO, VBO and EBO attribute data. It stored the correct data in each attribute of
-		* the models VAO, VBO and EBO to be used in the rendering process later on.
+		* the models VAO, VBO and EBO to be used in the rendering process later on. Vertices are
+		* packed into the meshes vertex layout, keeping only the attributes the shader reads.
+		*
+		* Mesh textures that were packed into a texture array are resolved to their array layer
+		* and those meshes are drawn with arrayShader, the TEXTURE_ARRAY variant of the shader.
+		* arrayShader must be given for every model once textures have been packed.
+		* Meshes shared with a model that was already prepared keep their buffers and shader.
 		*
 		* @param Model* model
-		* @param std::string vertShader
-		* @param std::string fragShader
+		* @param Shader* shader
+		* @param Shader* arrayShader
 		* @return void
 		*/
-	void Prepare(Model* model, std::string vertShader, std::string fragShader);
+	void Prepare(Model* model, Shader* shader, Shader* arrayShader = NULL);
 
 		/**
 		* @brief Render
 		*
-		* Takes model data that is parsed in as a parameter and accesses the necessary opneGl
-		* components to render the model to the screen. This includes the textures associated
-		* with the model data and its respective mesh data.
+		* Takes model data that is parsed in as a parameter and queues a draw for each of its
+		* meshes, with the texture and world matrix of the model. Nothing is drawn until Draw()
+		* is called with the queue. Meshes are drawn at the level of detail chosen by SelectLod().
 		*
 		* @param Model* model
 		* @return void
 		*/
 	void Render(Model* model);
 
+		/**
+		* @brief Selects the level of detail of a model
+		*
+		* Picks the level of detail from the share of the screen height the bounding sphere of
+		* the model covers, and stores it in the model. A model only moves to another level
+		* once its size is past the threshold by a margin, so models near a threshold do not
+		* switch back and forth every frame.
+		*
+		* @param Model* model
+		* @return int
+		*/
+	int SelectLod(Model* model);
+
+		/**
+		* @brief Takes the render queue
+		*
+		* Moves the draws queued by Render() since the last call into items, and the bone palettes
+		* of their skinned models into palettes, leaving the queue empty, so they can be drawn
+		* later or on another thread.
+		*
+		* @param std::vector<DrawItem>& items
+		* @param std::vector<glm::mat4>& palettes
+		* @return void
+		*/
+	void TakeDrawQueue(std::vector<DrawItem>& items, std::vector<glm::mat4>& palettes);
+
+		/**
+		* @brief Draws a list of draws
+		*
+		* Sorts the draws by shader, texture and vertex array and draws them, only changing state
+		* between draws when it differs. Meshes whose textures share a texture array are drawn
+		* back to back with a single texture bind. The statistics of the draws are added to the
+		* render statistics.
+		*
+		* The world matrices of the draws are written into the transform buffer, so shaders that
+		* read their matrix from it only need the index of the first matrix per draw, and runs of
+		* the same mesh are drawn as instances. Shaders with a model uniform instead get their
+		* matrix set before each draw.
+		*
+		* The bone palette of a skinned draw is written after the world matrices, and where it
+		* starts in the buffer rides in the bottom row of the draw's matrix, so skinned models in
+		* different poses still draw as instances.
+		*
+		* @param std::vector<DrawItem>& items
+		* @param const std::vector<glm::mat4>& palettes
+		* @param const glm::mat4& view
+		* @param const glm::mat4& projection
+		* @return void
+		*/
+	void Draw(std::vector<DrawItem>& items, const std::vector<glm::mat4>& palettes, const glm::mat4& view, const glm::mat4& projection);
+
+		/**
+		* @brief Resets the render statistics
+		*
+		* Sets the statistics to zero, called at the start of every frame.
+		*
+		* @return void
+		*/
+	void ResetRenderStats() { memset(&m_renderStats, 0, sizeof(m_renderStats)); }
+
+		/**
+		* @brief Gets the render statistics
+		*
+		* Returns the draw and bind counts since the statistics were last reset.
+		*
+		* @return const RenderStats&
+		*/
+	const RenderStats& GetRenderStats() const { return m_renderStats; }
+
+		/**
+		* @brief Releases the OpenGL resources of the renderer
+		*
+		* Deletes the transform buffer, called with the context current before it is destroyed.
+		*
+		* @return void
+		*/
+	void ReleaseResources() { m_transforms.Release(); }
+
+		/**
+		* @brief Gets the vertex buffer size
+		*
+		* Returns the total number of bytes of packed vertex data uploaded by Prepare().
+		*
+		* @return size_t
+		*/
+	size_t GetVertexBufferBytes() const { return m_vertexBufferBytes; }
+
+		/**
+		* @brief Gets the unpacked vertex size
+		*
+		* Returns the number of bytes the vertex data uploaded by Prepare() would take as
+		* unpacked Vertex3 structures, to compare against GetVertexBufferBytes().
+		*
+		* @return size_t
+		*/
+	size_t GetUnpackedVertexBytes() const { return m_unpackedVertexBytes; }
+
 protected:
+	/// Vertex buffer statistics
+	size_t m_vertexBufferBytes, m_unpackedVertexBytes;
+
+	/// Draws queued by Render() since the last TakeDrawQueue()
+	std::vector<DrawItem> m_drawQueue;
+
+	/// Bone palettes of the skinned models queued, copied as the models pose the next frame while it is drawn
+	std::vector<glm::mat4> m_paletteQueue;
+
+	/// Statistics of the draws since the last ResetRenderStats()
+	RenderStats m_renderStats;
+
+	/// World matrices of the draws, read by shaders through a buffer texture
+	TransformBuffer m_transforms;
 
 };
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "RenderThread.h"
+#include <cstring>
+
+#include "..\Texture\TextureManager.h"
+#include "..\Common\StartupTimeline.h"
+
+RenderThread::RenderThread()
+	: m_window(NULL), m_submittedFrames(0), m_drawnFrames(0), m_stopping(false), m_wireframe(false)
+{
+	memset(&m_renderStats, 0, sizeof(m_renderStats));
+	memset(&m_timings, 0, sizeof(m_timings));
+}
+
+void RenderThread::Start(IWindowManager* window)
+{
+	if (IsRunning())
+		return;
+
+	m_window = window;
+	m_stopping = false;
+
+	// A context can only be current on one thread at a time
+	m_window->MakeContextCurrent(false);
+	m_thread = std::thread(&RenderThread::ThreadLoop, this);
+}
+
+void RenderThread::Stop()
+{
+	if (!IsRunning())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_condition.notify_all();
+	m_thread.join();
+
+	// Resources are deleted on the calling thread after the game loop
+	m_window->MakeContextCurrent(true);
+}
+
+RenderSnapshot& RenderThread::BeginFrame()
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	unsigned long long frame = m_submittedFrames;
+	{
+		// The frame two before this one used the same snapshot
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this, frame] { return m_drawnFrames + 1 >= frame; });
+	}
+
+	RenderSnapshot& snapshot = m_snapshots[frame % 2];
+	snapshot.drawItems.clear();
+	snapshot.bonePalettes.clear();
+	snapshot.commands.clear();
+	snapshot.debugLines.clear();
+	snapshot.wireframe = m_wireframe;
+	snapshot.clearColour = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	snapshot.simulationStart = start;
+
+	m_simulationResumed = std::chrono::high_resolution_clock::now();
+
+	std::chrono::duration<double, std::milli> waited = m_simulationResumed - start;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_timings.waitMs += waited.count();
+
+	return snapshot;
+}
+
+void RenderThread::SubmitFrame()
+{
+	std::chrono::duration<double, std::milli> simulated = std::chrono::high_resolution_clock::now() - m_simulationResumed;
+
+	if (!IsRunning())
+	{
+		// Without the render thread the frame is drawn before the next one is simulated
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_timings.simulationMs += simulated.count();
+			m_submittedFrames++;
+		}
+
+		DrawSnapshot(m_snapshots[(m_submittedFrames - 1) % 2]);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_drawnFrames++;
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_timings.simulationMs += simulated.count();
+		m_submittedFrames++;
+	}
+	m_condition.notify_all();
+}
+
+RenderStats RenderThread::GetRenderStats()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_renderStats;
+}
+
+FrameTimings RenderThread::TakeFrameTimings()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	FrameTimings timings = m_timings;
+	if (timings.frames > 0)
+	{
+		timings.latencyMs /= timings.frames;
+		timings.simulationMs /= timings.frames;
+		timings.waitMs /= timings.frames;
+		timings.renderMs /= timings.frames;
+	}
+	memset(&m_timings, 0, sizeof(m_timings));
+
+	return timings;
+}
+
+void RenderThread::ThreadLoop()
+{
+	m_window->MakeContextCurrent(true);
+
+	while (true)
+	{
+		unsigned long long frame;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this] { return m_stopping || m_submittedFrames > m_drawnFrames; });
+
+			// Submitted frames are still drawn when stopping
+			if (m_submittedFrames == m_drawnFrames)
+				break;
+
+			frame = m_drawnFrames;
+		}
+
+		DrawSnapshot(m_snapshots[frame % 2]);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_drawnFrames++;
+		}
+		m_condition.notify_all();
+	}
+
+	m_window->MakeContextCurrent(false);
+}
+
+void RenderThread::DrawSnapshot(RenderSnapshot& snapshot)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	// Upload textures streamed in by the workers
+	TextureManager::Instance().Update();
+
+	glPolygonMode(GL_FRONT_AND_BACK, snapshot.wireframe ? GL_LINE : GL_FILL);
+	glClearColor(snapshot.clearColour.r, snapshot.clearColour.g, snapshot.clearColour.b, snapshot.clearColour.a);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	m_renderer.ResetRenderStats();
+
+	for (size_t i = 0; i < snapshot.commands.size(); i++)
+		snapshot.commands[i](m_renderer, &snapshot.camera);
+
+	// Commands may queue model draws of their own
+	m_renderer.TakeDrawQueue(m_commandItems, m_commandPalettes);
+	m_renderer.Draw(m_commandItems, m_commandPalettes, snapshot.view, snapshot.projection);
+	m_renderer.Draw(snapshot.drawItems, snapshot.bonePalettes, snapshot.view, snapshot.projection);
+
+	m_window->SwapTheBuffers();
+
+	// Only this thread changes the drawn frame count
+	if (m_drawnFrames == 0)
+		StartupTimeline::Instance().MarkFirstFrame();
+
+	std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+	std::chrono::duration<double, std::milli> rendered = end - start;
+	std::chrono::duration<double, std::milli> latency = end - snapshot.simulationStart;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_renderStats = m_renderer.GetRenderStats();
+	m_timings.frames++;
+	m_timings.renderMs += rendered.count();
+	m_timings.latencyMs += latency.count();
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <GL\glew.h>
+
+#include "OpenGl.h"
+#include "..\Controllers\Camera.h"
+#include "..\Controllers\IWindowManager.h"
+#include "..\Physics\DebugDraw.h"
+
+	/**
+	* @brief Work that must run on the render thread
+	*
+	* Called with the render thread renderer and the camera of the snapshot, for drawing that
+	* makes its own OpenGL calls such as terrains.
+	*/
+typedef std::function<void(OpenGl& renderer, Camera* camera)> RenderCommand;
+
+	/**
+	* @struct RenderSnapshot
+	* @brief Everything the render thread needs to draw a frame
+	*
+	* Filled by the simulation between RenderThread::BeginFrame() and RenderThread::SubmitFrame(),
+	* then only read by the render thread, so the simulation can move on to the next frame while
+	* it is drawn.
+	*/
+struct RenderSnapshot
+{
+	/// Copy of the world camera when the frame was simulated
+	Camera camera;
+
+	/// View and projection matrices of the camera
+	glm::mat4 view, projection;
+
+	/// Colour the frame is cleared to
+	glm::vec4 clearColour;
+
+	/// Whether the frame is drawn as wireframe
+	bool wireframe;
+
+	/// Model draws queued by OpenGl::Render(), with their world matrices
+	std::vector<DrawItem> drawItems;
+
+	/// Bone palettes of the skinned models drawn, indexed by the draws
+	std::vector<glm::mat4> bonePalettes;
+
+	/// Work run on the render thread before the draws
+	std::vector<RenderCommand> commands;
+
+	/// Physics debug lines of the frame, drawn by one of the commands
+	std::vector<DebugLineVertex> debugLines;
+
+	/// When the simulation of the frame started, to measure the latency until it is shown
+	std::chrono::high_resolution_clock::time_point simulationStart;
+};
+
+	/**
+	* @struct FrameTimings
+	* @brief Average timings of the frames drawn since they were last read
+	*/
+struct FrameTimings
+{
+	/// Frames drawn
+	int frames;
+
+	/// Time from the start of the simulation of a frame until its buffers were swapped
+	double latencyMs;
+
+	/// Time spent simulating a frame, and waiting for the render thread to free a snapshot
+	double simulationMs, waitMs;
+
+	/// Time the render thread spent drawing a frame, swap included
+	double renderMs;
+};
+
+	/**
+	* @class RenderThread
+	* @brief Draws frames on a thread of its own from double buffered snapshots
+	*
+	* The game loop used to simulate a frame and then make its OpenGL calls on the same thread,
+	* so neither could start before the other finished. The render thread owns the OpenGL context
+	* and draws frame N from its snapshot while the simulation fills the other snapshot with
+	* frame N + 1. The simulation is never more than one frame ahead, as BeginFrame() waits for
+	* the snapshot it returns to be free.
+	*
+	* Drawing a frame a frame later adds latency, so the time from the start of the simulation of
+	* a frame until its buffers are swapped is measured. If the thread is not started frames are
+	* drawn on the calling thread by SubmitFrame(), to compare against.
+	*
+	* Only the render thread may make OpenGL calls while it runs, including texture uploads,
+	* which it processes at the start of every frame.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class RenderThread
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates the render thread without starting it.
+		*
+		* @return null
+		*/
+	RenderThread();
+
+		/**
+		* @brief Destructor
+		*
+		* Stops the render thread.
+		*
+		* @return null
+		*/
+	~RenderThread() { Stop(); }
+
+		/**
+		* @brief Starts the render thread
+		*
+		* Releases the OpenGL context of the window on the calling thread and makes it current on
+		* the render thread, which swaps the buffers of the window after every frame.
+		*
+		* @param IWindowManager* window
+		* @return void
+		*/
+	void Start(IWindowManager* window);
+
+		/**
+		* @brief Stops the render thread
+		*
+		* Draws the frames already submitted, then hands the OpenGL context back to the calling
+		* thread.
+		*
+		* @return void
+		*/
+	void Stop();
+
+		/**
+		* @brief Checks if the render thread is running
+		*
+		* @return bool
+		*/
+	bool IsRunning() const { return m_thread.joinable(); }
+
+		/**
+		* @brief Sets the window frames are shown in
+		*
+		* Sets the window whose buffers are swapped when frames are drawn without the render
+		* thread.
+		*
+		* @param IWindowManager* window
+		* @return void
+		*/
+	void SetWindow(IWindowManager* window) { m_window = window; }
+
+		/**
+		* @brief Starts a frame
+		*
+		* Returns the empty snapshot of the next frame, waiting for the render thread to finish
+		* drawing the frame that last used it.
+		*
+		* @return RenderSnapshot&
+		*/
+	RenderSnapshot& BeginFrame();
+
+		/**
+		* @brief Submits a frame
+		*
+		* Hands the snapshot returned by BeginFrame() to the render thread, or draws it straight
+		* away if the render thread is not running. The snapshot must not be changed afterwards.
+		*
+		* @return void
+		*/
+	void SubmitFrame();
+
+		/**
+		* @brief Sets wireframe drawing
+		*
+		* Frames started after this call are drawn as wireframe or filled.
+		*
+		* @param bool wireframe
+		* @return void
+		*/
+	void SetWireframe(bool wireframe) { m_wireframe = wireframe; }
+
+		/**
+		* @brief Gets the render statistics
+		*
+		* Returns the draw and bind counts of the last frame drawn.
+		*
+		* @return RenderStats
+		*/
+	RenderStats GetRenderStats();
+
+		/**
+		* @brief Gets the frame timings
+		*
+		* Returns the average timings of the frames drawn since the last call, and starts
+		* measuring again.
+		*
+		* @return FrameTimings
+		*/
+	FrameTimings TakeFrameTimings();
+
+		/**
+		* @brief Releases the OpenGL resources of the render thread
+		*
+		* Deletes the resources of the render thread renderer. Called after Stop() while the
+		* context still exists.
+		*
+		* @return void
+		*/
+	void ReleaseResources() { m_renderer.ReleaseResources(); }
+
+private:
+		/**
+		* @brief Render thread loop
+		*
+		* Draws every submitted snapshot in order until the thread is stopped.
+		*
+		* @return void
+		*/
+	void ThreadLoop();
+
+		/**
+		* @brief Draws a snapshot
+		*
+		* Uploads streamed textures, runs the commands of the snapshot, draws its models and swaps
+		* the buffers of the window.
+		*
+		* @param RenderSnapshot& snapshot
+		* @return void
+		*/
+	void DrawSnapshot(RenderSnapshot& snapshot);
+
+	/// Window whose context the render thread owns
+	IWindowManager* m_window;
+
+	std::thread m_thread;
+
+	/// Renderer used on the render thread
+	OpenGl m_renderer;
+
+	/// Snapshot of frame n is m_snapshots[n % 2]
+	RenderSnapshot m_snapshots[2];
+
+	/// Frames submitted by the simulation and frames the render thread has finished
+	unsigned long long m_submittedFrames, m_drawnFrames;
+
+	/// Guards the frame counters, statistics and timings
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+
+	/// Set when the render thread should exit
+	bool m_stopping;
+
+	/// Wireframe setting copied into new snapshots
+	bool m_wireframe;
+
+	/// Draws queued by terrain commands on the render thread
+	std::vector<DrawItem> m_commandItems;
+
+	/// Bone palettes of the command draws
+	std::vector<glm::mat4> m_commandPalettes;
+
+	/// Statistics of the last frame drawn
+	RenderStats m_renderStats;
+
+	/// Timings summed since TakeFrameTimings() was last called
+	FrameTimings m_timings;
+
+	/// When BeginFrame() returned the snapshot being filled
+	std::chrono::high_resolution_clock::time_point m_simulationResumed;
+};
@@ -19,12 +19,12 @@ std::string Shader::LoadShaderFile(std::string filePath)
 	return strText;
 }
 
-void Shader::Initialize(std::string strVertexFile, std::string strFragmentFile)
+bool Shader::Initialize(std::string strVertexFile, std::string strFragmentFile)
 {
 	std::string vShaderStr, fShaderStr;
 
 	if ( !strVertexFile.length() || !strFragmentFile.length() )
-		return;
+		return false;
 
 	if ( m_vertexShaderId || m_fragmentShaderId || m_shaderProgramId )
 		Destroy();
@@ -55,6 +55,10 @@ void Shader::Initialize(std::string strVertexFile, std::string strFragmentFile)
 	glAttachShader(m_shaderProgramId, m_vertexShaderId);
 	glAttachShader(m_shaderProgramId, m_fragmentShaderId);
 
+	// Allow the linked program to be retrieved with glGetProgramBinary() for the shader cache
+	if ( GLEW_ARB_get_program_binary )
+		glProgramParameteri(m_shaderProgramId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
 	// Link our program with OpenGL
 	glLinkProgram(m_shaderProgramId);
 
@@ -65,6 +69,71 @@ void Shader::Initialize(std::string strVertexFile, std::string strFragmentFile)
 		std::cout << "ERROR: Could not create the shader program with error Id: " << ErrorCheckValue << std::endl;
 		exit(-1);
 	}
+
+	return CheckLinkStatus();
+}
+
+bool Shader::InitializeFromBinary(GLenum binaryFormat, const std::vector<char>& binary)
+{
+	if ( !GLEW_ARB_get_program_binary || binary.empty() )
+		return false;
+
+	if ( m_vertexShaderId || m_fragmentShaderId || m_shaderProgramId )
+		Destroy();
+
+	// A program created from a binary has no shader objects attached
+	m_shaderProgramId = glCreateProgram();
+	glProgramBinary(m_shaderProgramId, binaryFormat, &binary[0], (GLsizei)binary.size());
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(m_shaderProgramId, GL_LINK_STATUS, &linked);
+
+	// The driver rejected the binary, clean up so the caller can compile from source
+	if ( linked != GL_TRUE )
+	{
+		Destroy();
+		return false;
+	}
+
+	return true;
+}
+
+bool Shader::GetBinary(GLenum& binaryFormat, std::vector<char>& binary)
+{
+	if ( !GLEW_ARB_get_program_binary || !m_shaderProgramId )
+		return false;
+
+	GLint length = 0;
+	glGetProgramiv(m_shaderProgramId, GL_PROGRAM_BINARY_LENGTH, &length);
+
+	if ( length <= 0 )
+		return false;
+
+	binary.resize(length);
+	glGetProgramBinary(m_shaderProgramId, length, nullptr, &binaryFormat, &binary[0]);
+
+	return true;
+}
+
+bool Shader::CheckLinkStatus()
+{
+	GLint linked = GL_FALSE;
+	glGetProgramiv(m_shaderProgramId, GL_LINK_STATUS, &linked);
+
+	if ( linked != GL_TRUE )
+	{
+		GLint logLength = 0;
+		glGetProgramiv(m_shaderProgramId, GL_INFO_LOG_LENGTH, &logLength);
+
+		std::vector<char> log(logLength + 1, '\0');
+		if ( logLength > 0 )
+			glGetProgramInfoLog(m_shaderProgramId, logLength, nullptr, &log[0]);
+
+		std::cout << "ERROR: Could not link the shader program: " << &log[0] << std::endl;
+		return false;
+	}
+
+	return true;
 }
 
 GLint Shader::GetVariable(std::string strVariable)
@@ -75,6 +144,33 @@ GLint Shader::GetVariable(std::string strVariable)
 	return glGetUniformLocation(m_shaderProgramId, strVariable.c_str());
 }
 
+unsigned int Shader::GetActiveAttributeMask()
+{
+	if (!m_shaderProgramId)
+		return 0;
+
+	GLint attributeCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(m_shaderProgramId, GL_ACTIVE_ATTRIBUTES, &attributeCount);
+	glGetProgramiv(m_shaderProgramId, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxNameLength);
+
+	unsigned int mask = 0;
+	std::vector<char> name(maxNameLength + 1);
+	for (GLint i = 0; i < attributeCount; i++)
+	{
+		GLint size;
+		GLenum type;
+		glGetActiveAttrib(m_shaderProgramId, i, (GLsizei)name.size(), NULL, &size, &type, &name[0]);
+
+		// Built in inputs such as gl_VertexID have no location
+		GLint location = glGetAttribLocation(m_shaderProgramId, &name[0]);
+		if (location >= 0 && location < 32)
+			mask |= 1 << location;
+	}
+
+	return mask;
+}
+
 void Shader::Destroy()
 {
 	if(m_vertexShaderId)
@@ -93,7 +189,7 @@ void Shader::Destroy()
 
 	if(m_shaderProgramId)
 	{
-		glDeleteShader(m_shaderProgramId);
+		glDeleteProgram(m_shaderProgramId);
 		m_shaderProgramId = 0;
 	}
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <string>										
 #include <fstream>
 #include <sstream>
+#include <vector>
+#include <utility>
 #include "GL\glew.h"									
 
 /// Struct to hold both vertex and fragment shaders (needs to be moved)
@@ -32,11 +34,11 @@ public:
 		/**
 		* @brief Default constructor
 		*
-		* This is the default constuctor that is empyty.
+		* This is the default constuctor that sets the shader and program ids to 0.
 		*
 		* @return null
 		*/
-	Shader() { }
+	Shader() : m_vertexShaderId(0), m_fragmentShaderId(0), m_shaderProgramId(0) { }
 
 		/**
 		* @brief Destructor
@@ -69,10 +71,45 @@ public:
 		* and assiged to their respected ids. The shader program is created and assigned
 		* to the m_shaderProgramId member variable and the two shaders are attached to this
 		* program. The program is then linked and it runs a check for any GL errors.
+		* Returns true if the program linked successfully.
 		*
-		* @return void
+		* @return bool
+		*/
+	bool Initialize(std::string vertShader, std::string fragShader);
+
+		/**
+		* @brief Initializes the shader program from a program binary
+		*
+		* Creates the program from a binary previously returned by GetBinary() instead of
+		* compiling the sources. Drivers may reject a binary after an update, so this returns
+		* false if the program did not link and the caller should fall back to Initialize().
+		*
+		* @param GLenum binaryFormat
+		* @param const std::vector<char>& binary
+		* @return bool
+		*/
+	bool InitializeFromBinary(GLenum binaryFormat, const std::vector<char>& binary);
+
+		/**
+		* @brief Gets the linked program binary
+		*
+		* Retrieves the driver specific binary of the linked program so it can be cached on disk.
+		* Returns false if program binaries are not supported or the program is not linked.
+		*
+		* @param GLenum& binaryFormat
+		* @param std::vector<char>& binary
+		* @return bool
 		*/
-	void Initialize(std::string vertShader, std::string fragShader);
+	bool GetBinary(GLenum& binaryFormat, std::vector<char>& binary);
+
+		/**
+		* @brief Gets the program id
+		*
+		* Returns the OpenGL id of the linked shader program.
+		*
+		* @return GLuint
+		*/
+	GLuint GetProgramId() const { return m_shaderProgramId; }
 	
 		/**
 		* @brief Gets the uniform variable
@@ -84,6 +121,17 @@ public:
 		*/
 	GLint GetVariable(std::string variable);
 
+		/**
+		* @brief Gets the vertex attributes the program reads
+		*
+		* Returns a bit mask of the attribute locations that are active in the linked program.
+		* Inputs that are declared but never used are removed by the compiler and are not
+		* included. Bit n is set if the attribute at location n is read.
+		*
+		* @return unsigned int
+		*/
+	unsigned int GetActiveAttributeMask();
+
 		/**
 		* @brief Sets uniform value to int
 		*
@@ -108,6 +156,19 @@ public:
 		*/
 	void SetFloat(GLint id, GLfloat newValue) { glUniform1f(id, newValue); }
 	
+		/**
+		* @brief Selects uniform value to be changed
+		*
+		* Calls glUniform2i() taking the id associated to the shader variable and changing
+		* the value according to the int parameters specified.
+		*
+		* @param GLint id
+		* @param int v0
+		* @param int v1
+		* @return void
+		*/
+	void SetInt2(GLint id, int v0, int v1) { glUniform2i(id, v0, v1); }
+
 		/**
 		* @brief Selects uniform value to be changed
 		*
@@ -192,7 +253,32 @@ public:
 		*/
 	void Destroy();
 
+		/**
+		* @brief Swaps programs with another shader
+		*
+		* Exchanges the shader and program ids, so a program built into another shader can
+		* replace this one while everything holding this Shader keeps using it.
+		*
+		* @param Shader& other
+		* @return void
+		*/
+	void Swap(Shader& other)
+	{
+		std::swap(m_vertexShaderId, other.m_vertexShaderId);
+		std::swap(m_fragmentShaderId, other.m_fragmentShaderId);
+		std::swap(m_shaderProgramId, other.m_shaderProgramId);
+	}
+
 protected:
+		/**
+		* @brief Checks the link status of the program
+		*
+		* Prints the program info log if linking failed and returns the link status.
+		*
+		* @return bool
+		*/
+	bool CheckLinkStatus();
+
 	/// Stores vertex shader information
 	GLuint m_vertexShaderId;
 
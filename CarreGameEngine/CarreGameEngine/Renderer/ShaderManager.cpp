@@ -0,0 +1,233 @@
+#include "ShaderManager.h"
+#include <cstring>
+
+/// Identifies a program binary file written by the shader manager
+static const uint32_t SHADER_BINARY_MAGIC = 0x42485343; // "CSHB"
+
+ShaderManager::ShaderManager()
+	: m_cacheDirectory("Resources/shaders/cache")
+{
+}
+
+ShaderManager::~ShaderManager()
+{
+	ReleaseAllShaders();
+}
+
+Shader* ShaderManager::GetShader(const std::string& filePath, const std::string& defines)
+{
+	// Return the shared program if this combination has already been created
+	std::string key = filePath + "|" + defines;
+	std::unordered_map<std::string, Shader*>::iterator it = m_shaders.find(key);
+	if (it != m_shaders.end())
+		return it->second;
+
+	Shader* shader = new Shader();
+	BuildProgram(shader, filePath, defines);
+	m_shaders[key] = shader;
+
+	return shader;
+}
+
+Shader* ShaderManager::GetVariant(Shader* shader, const std::string& define)
+{
+	std::unordered_map<std::string, Shader*>::iterator it;
+	for (it = m_shaders.begin(); it != m_shaders.end(); it++)
+	{
+		if (it->second != shader)
+			continue;
+
+		size_t separator = it->first.find('|');
+		std::string filePath = it->first.substr(0, separator);
+		std::string defines = it->first.substr(separator + 1);
+
+		// Already the variant
+		std::string list = ";" + defines + ";";
+		if (list.find(";" + define + ";") != std::string::npos)
+			return shader;
+
+		return GetShader(filePath, defines.empty() ? define : defines + ";" + define);
+	}
+
+	return shader;
+}
+
+int ShaderManager::ReloadShaderFile(const std::string& filePath)
+{
+	if (m_sources.find(filePath) == m_sources.end())
+		return 0;
+
+	// Read the file again
+	m_sources.erase(filePath);
+
+	int rebuilt = 0;
+	std::string prefix = filePath + "|";
+	std::unordered_map<std::string, Shader*>::iterator it;
+	for (it = m_shaders.begin(); it != m_shaders.end(); it++)
+	{
+		if (it->first.compare(0, prefix.size(), prefix) != 0)
+			continue;
+
+		// Built aside, so a broken edit leaves the old program drawing
+		Shader replacement;
+		if (!BuildProgram(&replacement, filePath, it->first.substr(prefix.size())))
+		{
+			std::cout << "Shader reload failed, keeping the old program: " << it->first << std::endl;
+			continue;
+		}
+
+		it->second->Swap(replacement);
+		rebuilt++;
+	}
+
+	return rebuilt;
+}
+
+void ShaderManager::GetShaderFiles(std::vector<std::string>& filePaths) const
+{
+	std::unordered_map<std::string, ShaderSource>::const_iterator it;
+	for (it = m_sources.begin(); it != m_sources.end(); it++)
+		filePaths.push_back(it->first);
+}
+
+bool ShaderManager::BuildProgram(Shader* shader, const std::string& filePath, const std::string& defines)
+{
+	const ShaderSource& source = GetShaderSource(filePath);
+	std::string vertexSource = InjectDefines(source.VertexSource, defines);
+	std::string fragmentSource = InjectDefines(source.FragmentSource, defines);
+
+	// The binary is only valid for the exact sources and driver it was built with
+	uint64_t sourceHash = HashString(vertexSource);
+	sourceHash = HashString(fragmentSource, sourceHash);
+	sourceHash = HashString((const char*)glGetString(GL_VENDOR), sourceHash);
+	sourceHash = HashString((const char*)glGetString(GL_RENDERER), sourceHash);
+	sourceHash = HashString((const char*)glGetString(GL_VERSION), sourceHash);
+
+	std::string cachePath;
+	if (!m_cacheDirectory.empty())
+		cachePath = m_cacheDirectory + "/" + HashToString(sourceHash) + ".bin";
+
+	if (!cachePath.empty() && LoadProgramBinary(shader, cachePath, sourceHash))
+	{
+		std::cout << "Shader loaded from cache: " << filePath << " [" << defines << "]" << std::endl;
+		return true;
+	}
+
+	bool linked = shader->Initialize(vertexSource, fragmentSource);
+	std::cout << "Shader compiled: " << filePath << " [" << defines << "]" << std::endl;
+
+	if (linked && !cachePath.empty())
+		SaveProgramBinary(shader, cachePath, sourceHash);
+
+	return linked;
+}
+
+const ShaderSource& ShaderManager::GetShaderSource(const std::string& filePath)
+{
+	std::unordered_map<std::string, ShaderSource>::iterator it = m_sources.find(filePath);
+	if (it != m_sources.end())
+		return it->second;
+
+	m_sources[filePath] = ParseShaders(filePath);
+
+	return m_sources[filePath];
+}
+
+void ShaderManager::ReleaseAllShaders()
+{
+	std::unordered_map<std::string, Shader*>::iterator it = m_shaders.begin();
+
+	while (it != m_shaders.end())
+	{
+		delete it->second;
+		++it;
+	}
+
+	m_shaders.clear();
+	m_sources.clear();
+}
+
+std::string ShaderManager::InjectDefines(const std::string& source, const std::string& defines)
+{
+	if (defines.empty())
+		return source;
+
+	// Build a #define line for each entry, NAME=VALUE becomes #define NAME VALUE
+	std::string defineLines;
+	std::stringstream ss(defines);
+	std::string define;
+	while (getline(ss, define, ';'))
+	{
+		if (define.empty())
+			continue;
+
+		size_t equals = define.find('=');
+		if (equals != std::string::npos)
+			define[equals] = ' ';
+
+		defineLines += "#define " + define + "\n";
+	}
+
+	// #version must stay the first statement of the shader
+	size_t versionPos = source.find("#version");
+	if (versionPos == std::string::npos)
+		return defineLines + source;
+
+	size_t lineEnd = source.find('\n', versionPos);
+	if (lineEnd == std::string::npos)
+		return source + "\n" + defineLines;
+
+	return source.substr(0, lineEnd + 1) + defineLines + source.substr(lineEnd + 1);
+}
+
+bool ShaderManager::LoadProgramBinary(Shader* shader, const std::string& cachePath, uint64_t sourceHash)
+{
+	if (!GLEW_ARB_get_program_binary)
+		return false;
+
+	std::vector<char> data;
+	if (!ReadFileBytes(cachePath, data))
+		return false;
+
+	// Header is magic, binary format and the hash of the sources it was built from
+	size_t headerSize = sizeof(uint32_t) + sizeof(GLenum) + sizeof(uint64_t);
+	if (data.size() <= headerSize)
+		return false;
+
+	uint32_t magic;
+	GLenum binaryFormat;
+	uint64_t storedHash;
+	memcpy(&magic, &data[0], sizeof(uint32_t));
+	memcpy(&binaryFormat, &data[sizeof(uint32_t)], sizeof(GLenum));
+	memcpy(&storedHash, &data[sizeof(uint32_t) + sizeof(GLenum)], sizeof(uint64_t));
+
+	if (magic != SHADER_BINARY_MAGIC || storedHash != sourceHash)
+		return false;
+
+	std::vector<char> binary(data.begin() + headerSize, data.end());
+
+	return shader->InitializeFromBinary(binaryFormat, binary);
+}
+
+void ShaderManager::SaveProgramBinary(Shader* shader, const std::string& cachePath, uint64_t sourceHash)
+{
+	GLenum binaryFormat;
+	std::vector<char> binary;
+	if (!shader->GetBinary(binaryFormat, binary))
+		return;
+
+	if (!MakeDirectory(m_cacheDirectory))
+		return;
+
+	std::ofstream outfile(cachePath.c_str(), std::ios::binary);
+	if (!outfile)
+	{
+		std::cout << "Cannot write shader cache: " << cachePath << std::endl;
+		return;
+	}
+
+	outfile.write(reinterpret_cast<const char*>(&SHADER_BINARY_MAGIC), sizeof(uint32_t));
+	outfile.write(reinterpret_cast<const char*>(&binaryFormat), sizeof(GLenum));
+	outfile.write(reinterpret_cast<const char*>(&sourceHash), sizeof(uint64_t));
+	outfile.write(&binary[0], binary.size());
+}
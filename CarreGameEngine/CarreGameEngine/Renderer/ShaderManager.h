@@ -0,0 +1,217 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "GL\glew.h"
+
+#include "Shader.h"
+#include "..\Common\FileUtils.h"
+
+	/**
+	* @class ShaderManager
+	* @brief Shader library that shares compiled shader programs
+	*
+	* Every model used to own its own Shader and compile Default.shader again, so the engine
+	* ended up with one identical GL program per model. The shader manager compiles each unique
+	* (file, defines) combination once and hands out the same Shader to every caller. Shader files
+	* are only read and parsed once, and linked programs are cached on disk with glGetProgramBinary
+	* when the driver supports it, so later runs skip compiling entirely.
+	*
+	* Defines are given as a semicolon separated list such as "TEXTURE_ARRAY;MAX_BONES=64" and are
+	* injected after the #version line of both stages.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class ShaderManager
+{
+public:
+		/**
+		* @brief Singleton instance
+		*
+		* This function returns a singleton instance of the shader manager class so that there is only
+		* one shader library.
+		*
+		* @return static ShaderManager&
+		*/
+	static ShaderManager& Instance()
+	{
+		static ShaderManager instance;
+
+		return instance;
+	}
+
+		/**
+		* @brief Gets a shared shader program
+		*
+		* Returns the shader program for the given shader file and defines. The program is created
+		* the first time the combination is requested, either from the on-disk program binary cache
+		* or by compiling the sources, and every later call returns the same Shader.
+		*
+		* @param const std::string& filePath
+		* @param const std::string& defines
+		* @return Shader*
+		*/
+	Shader* GetShader(const std::string& filePath, const std::string& defines = "");
+
+		/**
+		* @brief Gets a variant of a shared shader program
+		*
+		* Returns the program of the same file as the shader with the define added to its
+		* defines, such as the "KEYFRAMES" variant of a program. Returns the shader itself if it
+		* was not made by the shader manager or already has the define.
+		*
+		* @param Shader* shader
+		* @param const std::string& define
+		* @return Shader*
+		*/
+	Shader* GetVariant(Shader* shader, const std::string& define);
+
+		/**
+		* @brief Gets the parsed source of a shader file
+		*
+		* Returns the vertex and fragment source of a shader file. Each file is only read from disk
+		* and split into its stages once.
+		*
+		* @param const std::string& filePath
+		* @return const ShaderSource&
+		*/
+	const ShaderSource& GetShaderSource(const std::string& filePath);
+
+		/**
+		* @brief Reloads a shader file
+		*
+		* Reads the shader file again and rebuilds every program made from it, with the same
+		* defines. A rebuilt program is swapped into the existing Shader, so every holder of it
+		* draws with the new program. A program that fails to link keeps the old one. Returns the
+		* number of programs rebuilt. Must be called on the thread the context is current on.
+		*
+		* Uniform locations are looked up every frame, so they may move. Vertex attributes added
+		* by the edit are not in the vertex arrays prepared for the old program.
+		*
+		* @param const std::string& filePath
+		* @return int
+		*/
+	int ReloadShaderFile(const std::string& filePath);
+
+		/**
+		* @brief Gets the shader files read
+		*
+		* Adds the path of every shader file programs have been made from to filePaths.
+		*
+		* @param std::vector<std::string>& filePaths
+		* @return void
+		*/
+	void GetShaderFiles(std::vector<std::string>& filePaths) const;
+
+		/**
+		* @brief Sets the program binary cache directory
+		*
+		* Sets the directory that linked program binaries are written to and read from. An
+		* empty string disables the on-disk cache.
+		*
+		* @param const std::string& directory
+		* @return void
+		*/
+	void SetBinaryCacheDirectory(const std::string& directory) { m_cacheDirectory = directory; }
+
+		/**
+		* @brief Gets the number of shader programs
+		*
+		* Returns the number of distinct shader programs that have been created.
+		*
+		* @return int
+		*/
+	int GetProgramCount() const { return (int)m_shaders.size(); }
+
+		/**
+		* @brief Release all shaders
+		*
+		* Deletes every shader program and forgets all parsed sources. Must be called while the
+		* OpenGL context is still current.
+		*
+		* @return void
+		*/
+	void ReleaseAllShaders();
+
+private:
+		/**
+		* @brief Default constructor
+		*
+		* Sets the default binary cache directory.
+		*
+		* @return null
+		*/
+	ShaderManager();
+
+		/**
+		* @brief Destructor
+		*
+		* Releases all shaders.
+		*
+		* @return null
+		*/
+	~ShaderManager();
+
+		/**
+		* @brief Builds a shader program
+		*
+		* Creates the program of the shader file and defines into the shader, from the on-disk
+		* program binary cache if it has the sources, otherwise by compiling them. Returns false
+		* if the program did not link.
+		*
+		* @param Shader* shader
+		* @param const std::string& filePath
+		* @param const std::string& defines
+		* @return bool
+		*/
+	bool BuildProgram(Shader* shader, const std::string& filePath, const std::string& defines);
+
+		/**
+		* @brief Adds defines to shader source
+		*
+		* Inserts a #define line for each entry of the semicolon separated defines list directly
+		* after the #version line of the source.
+		*
+		* @param const std::string& source
+		* @param const std::string& defines
+		* @return std::string
+		*/
+	std::string InjectDefines(const std::string& source, const std::string& defines);
+
+		/**
+		* @brief Loads a cached program binary
+		*
+		* Tries to create the shader program from the binary stored at the cache path. Returns
+		* false if there is no usable binary.
+		*
+		* @param Shader* shader
+		* @param const std::string& cachePath
+		* @param uint64_t sourceHash
+		* @return bool
+		*/
+	bool LoadProgramBinary(Shader* shader, const std::string& cachePath, uint64_t sourceHash);
+
+		/**
+		* @brief Saves a program binary
+		*
+		* Writes the binary of the linked shader program to the cache path.
+		*
+		* @param Shader* shader
+		* @param const std::string& cachePath
+		* @param uint64_t sourceHash
+		* @return void
+		*/
+	void SaveProgramBinary(Shader* shader, const std::string& cachePath, uint64_t sourceHash);
+
+	/// Shader programs keyed by file path and defines
+	std::unordered_map<std::string, Shader*> m_shaders;
+
+	/// Parsed shader sources keyed by file path
+	std::unordered_map<std::string, ShaderSource> m_sources;
+
+	/// Directory the program binaries are cached in
+	std::string m_cacheDirectory;
+};
@@ -0,0 +1,146 @@
+#include "TransformBuffer.h"
+#include <algorithm>
+
+/// Regions in the ring, enough for the two draw lists of each of three frames in flight
+static const int TRANSFORM_REGIONS = 6;
+
+/// Largest region, smaller if the buffer texture size limit does not fit all regions
+static const size_t MAX_REGION_MATRICES = 4096;
+
+/// Longest single wait for a region before waiting again, in nanoseconds
+static const GLuint64 FENCE_TIMEOUT = 1000000000;
+
+TransformBuffer::TransformBuffer()
+	: m_buffer(0), m_texture(0), m_regionCapacity(0), m_region(0), m_fences(NULL), m_persistent(NULL), m_stalls(0)
+{
+}
+
+bool TransformBuffer::Initialize()
+{
+	if (m_buffer)
+		return true;
+
+	// A matrix is four RGBA32F texels
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	m_regionCapacity = std::min(MAX_REGION_MATRICES, (size_t)maxTexels / 4 / TRANSFORM_REGIONS);
+	if (m_regionCapacity == 0)
+	{
+		std::cout << "Buffer textures are too small for the transform buffer!" << std::endl;
+		return false;
+	}
+
+	GLsizeiptr size = (GLsizeiptr)(m_regionCapacity * TRANSFORM_REGIONS * sizeof(glm::mat4));
+
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+
+	if (GLEW_ARB_buffer_storage)
+	{
+		// Mapped once for the life of the buffer, coherent so writes need no flush
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_TEXTURE_BUFFER, size, NULL, flags);
+		m_persistent = (glm::mat4*)glMapBufferRange(GL_TEXTURE_BUFFER, 0, size, flags);
+	}
+	else
+	{
+		glBufferData(GL_TEXTURE_BUFFER, size, NULL, GL_STREAM_DRAW);
+	}
+
+	glGenTextures(1, &m_texture);
+	glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_buffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	m_fences = new GLsync[TRANSFORM_REGIONS];
+	for (int i = 0; i < TRANSFORM_REGIONS; i++)
+		m_fences[i] = 0;
+	m_region = TRANSFORM_REGIONS - 1;
+
+	std::cout << "Transform buffer: " << TRANSFORM_REGIONS << " regions of " << m_regionCapacity << " matrices, "
+		<< (m_persistent ? "persistently mapped" : "mapped per region") << std::endl;
+
+	return true;
+}
+
+void TransformBuffer::Release()
+{
+	if (!m_buffer)
+		return;
+
+	for (int i = 0; i < TRANSFORM_REGIONS; i++)
+	{
+		if (m_fences[i])
+			glDeleteSync(m_fences[i]);
+	}
+	delete[] m_fences;
+	m_fences = NULL;
+
+	if (m_persistent)
+	{
+		glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+		glUnmapBuffer(GL_TEXTURE_BUFFER);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+		m_persistent = NULL;
+	}
+
+	glDeleteTextures(1, &m_texture);
+	glDeleteBuffers(1, &m_buffer);
+	m_texture = 0;
+	m_buffer = 0;
+}
+
+glm::mat4* TransformBuffer::Map(size_t count, GLint& base)
+{
+	m_region = (m_region + 1) % TRANSFORM_REGIONS;
+
+	// Wait for the draws that last read the region
+	GLsync& fence = m_fences[m_region];
+	if (fence)
+	{
+		// Any wait at all is a stall, the GPU is behind by the whole ring
+		GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		if (result != GL_ALREADY_SIGNALED)
+		{
+			m_stalls++;
+			while (result == GL_TIMEOUT_EXPIRED)
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+		}
+
+		glDeleteSync(fence);
+		fence = 0;
+	}
+
+	size_t first = m_region * m_regionCapacity;
+	base = (GLint)first;
+
+	if (m_persistent)
+		return m_persistent + first;
+
+	// The fence already guarantees the GPU is done with the range, so the map does not synchronize
+	glBindBuffer(GL_TEXTURE_BUFFER, m_buffer);
+	return (glm::mat4*)glMapBufferRange(GL_TEXTURE_BUFFER, first * sizeof(glm::mat4), std::max(count, (size_t)1) * sizeof(glm::mat4),
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+}
+
+void TransformBuffer::Unmap()
+{
+	if (m_persistent)
+		return;
+
+	glUnmapBuffer(GL_TEXTURE_BUFFER);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TransformBuffer::Fence()
+{
+	m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void TransformBuffer::Bind(GLuint unit)
+{
+	glActiveTexture(GL_TEXTURE0 + unit);
+	glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+	glActiveTexture(GL_TEXTURE0);
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <iostream>
+#include <GL\glew.h>
+#include <GLM\glm.hpp>
+
+	/**
+	* @class TransformBuffer
+	* @brief Ring of world matrices read by shaders through a buffer texture
+	*
+	* Uploading a model matrix with glUniformMatrix4fv before every draw made the driver the
+	* bottleneck with many moving bodies. Instead every matrix of a draw list is written into one
+	* region of this buffer, which shaders read as a samplerBuffer of four RGBA32F texels per
+	* matrix, so each draw only sets the index of its first matrix.
+	*
+	* The buffer is split into regions used in turn, and a fence is placed after the draws that
+	* read a region. A region is only written again once its fence has signalled, so the CPU never
+	* overwrites matrices the GPU has not read yet, without stalling on the frames in flight. With
+	* ARB_buffer_storage the buffer is persistently mapped once, otherwise each region is mapped
+	* unsynchronized while it is written.
+	*
+	* Buffer textures are used as uniform buffers are too small for a frame of matrices on
+	* OpenGL 3.3 and shader storage buffers need OpenGL 4.3.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class TransformBuffer
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates the ring without any OpenGL objects, they are created by Initialize().
+		*
+		* @return null
+		*/
+	TransformBuffer();
+
+		/**
+		* @brief Destructor
+		*
+		* Empty destructor, Release() deletes the OpenGL objects while the context exists.
+		*
+		* @return null
+		*/
+	~TransformBuffer() { }
+
+		/**
+		* @brief Creates the buffer
+		*
+		* Creates the buffer and its buffer texture on the calling thread's context if they do not
+		* exist yet. Returns false if they could not be created.
+		*
+		* @return bool
+		*/
+	bool Initialize();
+
+		/**
+		* @brief Deletes the buffer
+		*
+		* Deletes the buffer, its buffer texture and the fences.
+		*
+		* @return void
+		*/
+	void Release();
+
+		/**
+		* @brief Maps the next region
+		*
+		* Waits until the GPU has finished with the next region and returns where count matrices
+		* can be written into it. base is set to the index the shader reads the first of them at.
+		* count must not be larger than GetRegionCapacity().
+		*
+		* @param size_t count
+		* @param GLint& base
+		* @return glm::mat4*
+		*/
+	glm::mat4* Map(size_t count, GLint& base);
+
+		/**
+		* @brief Unmaps the region
+		*
+		* Makes the matrices written since Map() visible to the GPU.
+		*
+		* @return void
+		*/
+	void Unmap();
+
+		/**
+		* @brief Fences the region
+		*
+		* Called after the draws reading the region, which is not written again until they are
+		* finished.
+		*
+		* @return void
+		*/
+	void Fence();
+
+		/**
+		* @brief Binds the buffer texture
+		*
+		* Binds the buffer texture to the given texture unit, leaving unit 0 active.
+		*
+		* @param GLuint unit
+		* @return void
+		*/
+	void Bind(GLuint unit);
+
+		/**
+		* @brief Gets the region capacity
+		*
+		* Returns the number of matrices that fit in a region.
+		*
+		* @return size_t
+		*/
+	size_t GetRegionCapacity() const { return m_regionCapacity; }
+
+		/**
+		* @brief Checks if the buffer is persistently mapped
+		*
+		* @return bool
+		*/
+	bool IsPersistent() const { return m_persistent != NULL; }
+
+		/**
+		* @brief Gets the number of stalls
+		*
+		* Returns the number of times Map() had to wait for the GPU to release a region, however
+		* short the wait.
+		*
+		* @return int
+		*/
+	int GetStallCount() const { return m_stalls; }
+
+private:
+	/// Buffer holding the matrices and the buffer texture shaders read it through
+	GLuint m_buffer, m_texture;
+
+	/// Matrices per region
+	size_t m_regionCapacity;
+
+	/// Region last returned by Map()
+	int m_region;
+
+	/// Fence after the last draws that read each region
+	GLsync* m_fences;
+
+	/// Start of the buffer while persistently mapped
+	glm::mat4* m_persistent;
+
+	/// Maps that had to wait for the GPU
+	int m_stalls;
+};
@@ -0,0 +1,282 @@
+#include "VertexLayout.h"
+#include <cstring>
+#include <GLM\gtc\packing.hpp>
+
+VertexLayout VertexLayout::CreatePacked(bool texCoords, bool normals, bool colours, bool wideTexCoords)
+{
+	VertexLayout layout;
+
+	layout.AddElement(ATTRIB_POSITION, FORMAT_FLOAT3);
+	if (texCoords)
+		layout.AddElement(ATTRIB_TEXCOORD, wideTexCoords ? FORMAT_FLOAT2 : FORMAT_HALF2);
+	if (normals)
+		layout.AddElement(ATTRIB_NORMAL, FORMAT_SNORM_10_10_10_2);
+	if (colours)
+		layout.AddElement(ATTRIB_COLOUR, FORMAT_UNORM8_4);
+
+	return layout;
+}
+
+void VertexLayout::AddElement(VertexAttribute attribute, VertexFormat format)
+{
+	VertexElement element;
+	element.attribute = attribute;
+	element.format = format;
+	element.offset = m_stride;
+
+	m_elements.push_back(element);
+	m_stride += GetFormatSize(format);
+}
+
+VertexLayout VertexLayout::Filter(unsigned int attributeMask) const
+{
+	VertexLayout layout;
+
+	for (size_t i = 0; i < m_elements.size(); i++)
+	{
+		if (attributeMask & (1 << m_elements[i].attribute))
+			layout.AddElement(m_elements[i].attribute, m_elements[i].format);
+	}
+
+	return layout;
+}
+
+bool VertexLayout::HasAttribute(VertexAttribute attribute) const
+{
+	for (size_t i = 0; i < m_elements.size(); i++)
+	{
+		if (m_elements[i].attribute == attribute)
+			return true;
+	}
+
+	return false;
+}
+
+unsigned int VertexLayout::GetFormatSize(VertexFormat format)
+{
+	switch (format)
+	{
+	case FORMAT_FLOAT2:
+		return 8;
+	case FORMAT_FLOAT3:
+		return 12;
+	case FORMAT_FLOAT4:
+		return 16;
+	case FORMAT_HALF2:
+	case FORMAT_SNORM_10_10_10_2:
+	case FORMAT_UNORM8_4:
+	case FORMAT_UINT8_4:
+		return 4;
+	}
+
+	return 0;
+}
+
+// Converts a vec4 to the given format and writes it to dest
+static void PackElement(VertexFormat format, const glm::vec4& value, unsigned char* dest)
+{
+	switch (format)
+	{
+	case FORMAT_FLOAT2:
+	case FORMAT_FLOAT3:
+	case FORMAT_FLOAT4:
+		memcpy(dest, &value[0], VertexLayout::GetFormatSize(format));
+		break;
+	case FORMAT_HALF2:
+	{
+		glm::uint16 half[2];
+		half[0] = glm::packHalf1x16(value.x);
+		half[1] = glm::packHalf1x16(value.y);
+		memcpy(dest, half, sizeof(half));
+		break;
+	}
+	case FORMAT_SNORM_10_10_10_2:
+	{
+		glm::uint32 packed = glm::packSnorm3x10_1x2(glm::vec4(glm::vec3(value), 0.0f));
+		memcpy(dest, &packed, sizeof(packed));
+		break;
+	}
+	case FORMAT_UNORM8_4:
+	{
+		glm::vec4 clamped = glm::clamp(value, 0.0f, 1.0f);
+		for (int i = 0; i < 4; i++)
+			dest[i] = (unsigned char)(clamped[i] * 255.0f + 0.5f);
+		break;
+	}
+	case FORMAT_UINT8_4:
+		for (int i = 0; i < 4; i++)
+			dest[i] = (unsigned char)glm::clamp(value[i], 0.0f, 255.0f);
+		break;
+	}
+}
+
+void VertexLayout::Pack(const std::vector<Vertex3>& vertices, std::vector<unsigned char>& data) const
+{
+	data.resize(vertices.size() * m_stride);
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		unsigned char* vertex = &data[i * m_stride];
+
+		for (size_t j = 0; j < m_elements.size(); j++)
+		{
+			glm::vec4 value;
+			switch (m_elements[j].attribute)
+			{
+			case ATTRIB_POSITION:
+				value = glm::vec4(vertices[i].m_position, 1.0f);
+				break;
+			case ATTRIB_TEXCOORD:
+				value = glm::vec4(vertices[i].m_texCoords, 0.0f, 0.0f);
+				break;
+			case ATTRIB_NORMAL:
+				value = glm::vec4(vertices[i].m_normal, 0.0f);
+				break;
+			case ATTRIB_COLOUR:
+				value = vertices[i].m_colour;
+				break;
+			case ATTRIB_BONE_INDICES:
+				for (int k = 0; k < 4; k++)
+					value[k] = vertices[i].m_boneIndices[k];
+				break;
+			case ATTRIB_BONE_WEIGHTS:
+				for (int k = 0; k < 4; k++)
+					value[k] = vertices[i].m_boneWeights[k] / 255.0f;
+				break;
+			default:
+				break;
+			}
+
+			PackElement(m_elements[j].format, value, vertex + m_elements[j].offset);
+		}
+	}
+}
+
+// Reads an element in the given format back into a vec4
+static glm::vec4 UnpackElement(VertexFormat format, const unsigned char* source)
+{
+	glm::vec4 value(0.0f);
+
+	switch (format)
+	{
+	case FORMAT_FLOAT2:
+	case FORMAT_FLOAT3:
+	case FORMAT_FLOAT4:
+		memcpy(&value[0], source, VertexLayout::GetFormatSize(format));
+		break;
+	case FORMAT_HALF2:
+	{
+		glm::uint16 half[2];
+		memcpy(half, source, sizeof(half));
+		value.x = glm::unpackHalf1x16(half[0]);
+		value.y = glm::unpackHalf1x16(half[1]);
+		break;
+	}
+	case FORMAT_SNORM_10_10_10_2:
+	{
+		glm::uint32 packed;
+		memcpy(&packed, source, sizeof(packed));
+		value = glm::vec4(glm::vec3(glm::unpackSnorm3x10_1x2(packed)), 0.0f);
+		break;
+	}
+	case FORMAT_UNORM8_4:
+		for (int i = 0; i < 4; i++)
+			value[i] = source[i] / 255.0f;
+		break;
+	case FORMAT_UINT8_4:
+		for (int i = 0; i < 4; i++)
+			value[i] = source[i];
+		break;
+	}
+
+	return value;
+}
+
+void VertexLayout::Unpack(const unsigned char* data, size_t count, std::vector<Vertex3>& vertices) const
+{
+	vertices.resize(count);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const unsigned char* vertex = data + i * m_stride;
+		Vertex3& unpacked = vertices[i];
+		unpacked.m_position = glm::vec3(0.0f);
+		unpacked.m_texCoords = glm::vec2(0.0f);
+		unpacked.m_normal = glm::vec3(0.0f);
+		unpacked.m_colour = glm::vec4(1.0f);
+		memset(unpacked.m_boneIndices, 0, sizeof(unpacked.m_boneIndices));
+		memset(unpacked.m_boneWeights, 0, sizeof(unpacked.m_boneWeights));
+		unpacked.m_boneWeights[0] = 255;
+
+		for (size_t j = 0; j < m_elements.size(); j++)
+		{
+			glm::vec4 value = UnpackElement(m_elements[j].format, vertex + m_elements[j].offset);
+			switch (m_elements[j].attribute)
+			{
+			case ATTRIB_POSITION:
+				unpacked.m_position = glm::vec3(value);
+				break;
+			case ATTRIB_TEXCOORD:
+				unpacked.m_texCoords = glm::vec2(value);
+				break;
+			case ATTRIB_NORMAL:
+				unpacked.m_normal = glm::vec3(value);
+				break;
+			case ATTRIB_COLOUR:
+				unpacked.m_colour = value;
+				break;
+			case ATTRIB_BONE_INDICES:
+				for (int k = 0; k < 4; k++)
+					unpacked.m_boneIndices[k] = (unsigned char)value[k];
+				break;
+			case ATTRIB_BONE_WEIGHTS:
+				for (int k = 0; k < 4; k++)
+					unpacked.m_boneWeights[k] = (unsigned char)(value[k] * 255.0f + 0.5f);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+}
+
+void VertexLayout::ApplyAttributes(unsigned int attributeMask) const
+{
+	for (int i = 0; i < ATTRIB_COUNT; i++)
+		glDisableVertexAttribArray(i);
+
+	for (size_t i = 0; i < m_elements.size(); i++)
+	{
+		const VertexElement& element = m_elements[i];
+		if (!(attributeMask & (1 << element.attribute)))
+			continue;
+		const GLvoid* offset = (const GLvoid*)(size_t)element.offset;
+
+		switch (element.format)
+		{
+		case FORMAT_FLOAT2:
+			glVertexAttribPointer(element.attribute, 2, GL_FLOAT, GL_FALSE, m_stride, offset);
+			break;
+		case FORMAT_FLOAT3:
+			glVertexAttribPointer(element.attribute, 3, GL_FLOAT, GL_FALSE, m_stride, offset);
+			break;
+		case FORMAT_FLOAT4:
+			glVertexAttribPointer(element.attribute, 4, GL_FLOAT, GL_FALSE, m_stride, offset);
+			break;
+		case FORMAT_HALF2:
+			glVertexAttribPointer(element.attribute, 2, GL_HALF_FLOAT, GL_FALSE, m_stride, offset);
+			break;
+		case FORMAT_SNORM_10_10_10_2:
+			glVertexAttribPointer(element.attribute, 4, GL_INT_2_10_10_10_REV, GL_TRUE, m_stride, offset);
+			break;
+		case FORMAT_UNORM8_4:
+			glVertexAttribPointer(element.attribute, 4, GL_UNSIGNED_BYTE, GL_TRUE, m_stride, offset);
+			break;
+		case FORMAT_UINT8_4:
+			glVertexAttribIPointer(element.attribute, 4, GL_UNSIGNED_BYTE, m_stride, offset);
+			break;
+		}
+
+		glEnableVertexAttribArray(element.attribute);
+	}
+}
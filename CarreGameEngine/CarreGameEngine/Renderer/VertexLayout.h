@@ -0,0 +1,194 @@
+#pragma once
+
+#include <vector>
+#include <GL\glew.h>
+#include <GLM\glm.hpp>
+
+#include "..\Common\Vertex3.h"
+
+	/**
+	* @brief Vertex attributes
+	*
+	* The attribute locations used by every shader, eg. layout(location = 1) in vec2 inTexCoord.
+	*/
+enum VertexAttribute
+{
+	ATTRIB_POSITION = 0,
+	ATTRIB_TEXCOORD = 1,
+	ATTRIB_NORMAL = 2,
+	ATTRIB_COLOUR = 3,
+	ATTRIB_BONE_INDICES = 4,
+	ATTRIB_BONE_WEIGHTS = 5,
+	ATTRIB_COUNT
+};
+
+	/**
+	* @brief Vertex attribute storage formats
+	*/
+enum VertexFormat
+{
+	FORMAT_FLOAT2,			// 2 x 32 bit float, 8 bytes
+	FORMAT_FLOAT3,			// 3 x 32 bit float, 12 bytes
+	FORMAT_FLOAT4,			// 4 x 32 bit float, 16 bytes
+	FORMAT_HALF2,			// 2 x 16 bit float, 4 bytes
+	FORMAT_SNORM_10_10_10_2,	// 3 x 10 bit signed normalized + 2 bit, 4 bytes
+	FORMAT_UNORM8_4,		// 4 x 8 bit unsigned normalized, 4 bytes
+	FORMAT_UINT8_4			// 4 x 8 bit unsigned integer read as uvec4, 4 bytes
+};
+
+	/**
+	* @struct VertexElement
+	* @brief A single attribute of a vertex layout
+	*/
+struct VertexElement
+{
+	VertexAttribute attribute;
+	VertexFormat format;
+	unsigned int offset;
+};
+
+	/**
+	* @class VertexLayout
+	* @brief Describes how vertices are stored in a vertex buffer
+	*
+	* A vertex layout lists the attributes a vertex buffer holds and the packed format of each one.
+	* Meshes keep their vertices as Vertex3 on the CPU and are packed into the layout when uploaded,
+	* so a mesh only pays GPU memory and bandwidth for the attributes its material actually uses.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class VertexLayout
+{
+public:
+		/**
+		* @brief Default constructor
+		*
+		* Creates an empty layout.
+		*
+		* @return null
+		*/
+	VertexLayout() : m_stride(0) { }
+
+		/**
+		* @brief Creates the standard packed layout
+		*
+		* Returns a layout with a float position followed by half float texture coordinates,
+		* 10_10_10_2 normals and 8 bit colours for the attributes that are requested. Half floats
+		* lose sub-texel precision on texture coordinates that tile far outside of 0..1, so
+		* wideTexCoords keeps them as 32 bit floats.
+		*
+		* @param bool texCoords
+		* @param bool normals
+		* @param bool colours
+		* @param bool wideTexCoords
+		* @return VertexLayout
+		*/
+	static VertexLayout CreatePacked(bool texCoords, bool normals, bool colours, bool wideTexCoords = false);
+
+		/**
+		* @brief Adds an attribute
+		*
+		* Appends an attribute in the given format to the end of the vertex.
+		*
+		* @param VertexAttribute attribute
+		* @param VertexFormat format
+		* @return void
+		*/
+	void AddElement(VertexAttribute attribute, VertexFormat format);
+
+		/**
+		* @brief Keeps only the given attributes
+		*
+		* Returns a copy of this layout containing only the attributes set in the mask, with the
+		* offsets and stride recalculated. Bit n of the mask is the attribute at location n.
+		*
+		* @param unsigned int attributeMask
+		* @return VertexLayout
+		*/
+	VertexLayout Filter(unsigned int attributeMask) const;
+
+		/**
+		* @brief Checks for an attribute
+		*
+		* Returns true if the layout contains the attribute.
+		*
+		* @param VertexAttribute attribute
+		* @return bool
+		*/
+	bool HasAttribute(VertexAttribute attribute) const;
+
+		/**
+		* @brief Gets the vertex stride
+		*
+		* Returns the size of a single packed vertex in bytes.
+		*
+		* @return unsigned int
+		*/
+	unsigned int GetStride() const { return m_stride; }
+
+		/**
+		* @brief Gets the layout elements
+		*
+		* Returns the attributes of the layout in the order they are stored.
+		*
+		* @return const std::vector<VertexElement>&
+		*/
+	const std::vector<VertexElement>& GetElements() const { return m_elements; }
+
+		/**
+		* @brief Packs vertices
+		*
+		* Converts the vertices into this layout and writes them to the data vector.
+		*
+		* @param const std::vector<Vertex3>& vertices
+		* @param std::vector<unsigned char>& data
+		* @return void
+		*/
+	void Pack(const std::vector<Vertex3>& vertices, std::vector<unsigned char>& data) const;
+
+		/**
+		* @brief Unpacks vertices
+		*
+		* Converts count vertices stored in this layout back into Vertex3, the inverse of Pack().
+		* Attributes not in the layout are zero, colours white and the whole weight on bone 0.
+		*
+		* @param const unsigned char* data
+		* @param size_t count
+		* @param std::vector<Vertex3>& vertices
+		* @return void
+		*/
+	void Unpack(const unsigned char* data, size_t count, std::vector<Vertex3>& vertices) const;
+
+		/**
+		* @brief Sets up the vertex attributes
+		*
+		* Calls glVertexAttribPointer() and enables each attribute of the layout for the vertex
+		* buffer currently bound. Attributes not in the layout are disabled. The state is stored
+		* in the currently bound vertex array.
+		*
+		* Only the attributes set in the mask are enabled, so a buffer holding attributes the
+		* shader does not read can be drawn as it is.
+		*
+		* @param unsigned int attributeMask
+		* @return void
+		*/
+	void ApplyAttributes(unsigned int attributeMask = ~0u) const;
+
+		/**
+		* @brief Gets the size of a format
+		*
+		* Returns the number of bytes a single attribute of the given format takes.
+		*
+		* @param VertexFormat format
+		* @return unsigned int
+		*/
+	static unsigned int GetFormatSize(VertexFormat format);
+
+private:
+	/// Attributes in the order they are stored
+	std::vector<VertexElement> m_elements;
+
+	/// Size of a packed vertex in bytes
+	unsigned int m_stride;
+};
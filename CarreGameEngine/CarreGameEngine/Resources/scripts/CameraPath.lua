@@ -0,0 +1,14 @@
+--CameraPath.lua
+--Date: 19/10/2026
+--Brief: Camera path flown by headless performance runs
+--Notes:	The camera moves through the keyframes in order at a constant frame rate
+--			pos is where the camera is, target is the point it looks at
+cameraPath=
+{
+	{ pos = "12000.0 1500.0 10100.0", target = "7000.0 500.0 5200.0" },
+	{ pos = "12000.0 1500.0 1000.0", target = "7000.0 500.0 5200.0" },
+	{ pos = "2000.0 1500.0 1000.0", target = "7000.0 500.0 5200.0" },
+	{ pos = "2000.0 1500.0 10100.0", target = "7000.0 500.0 5200.0" },
+	{ pos = "7000.0 400.0 9000.0", target = "7000.0 400.0 5200.0" },
+	{ pos = "12000.0 1500.0 10100.0", target = "7000.0 500.0 5200.0" },
+}
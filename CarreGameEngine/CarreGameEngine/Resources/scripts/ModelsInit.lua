@@ -6,6 +6,11 @@
 --Note: Use this file to load model .obj, scale, and position only
 --Note: "player" MUST BE present and MUST BE spelt correctly
 --Note: Needs improvements
+--Models other than the lecture theatre, people and the player are only loaded once the player
+--is within streamRadius of them, and the least recently used ones out of range are evicted
+--once their meshes take more than streamBudgetMB. Remove streamRadius to load every model at startup
+streamRadius=6000.0
+streamBudgetMB=64
 AllModels=
 {
 	lecTheatre=
@@ -82,6 +87,25 @@ AllModels=
 			Affordance = "ball"
 		},
 	},
+	knight=
+	{
+		knight1=
+		{
+			filePath = "Resources/objects/knight.md2", 
+			scale = "10.0 10.0 10.0", 
+			pos = "12500.0 1200.0 10700.0", 
+			rot = "0.0 0.0 0.0", 
+			Affordance = "knight"
+		},
+		knight2=
+		{
+			filePath = "Resources/objects/knight.md2", 
+			scale = "10.0 10.0 10.0", 
+			pos = "13000.0 1200.0 10700.0", 
+			rot = "0.0 0.0 0.0", 
+			Affordance = "knight"
+		},
+	},
 	person=
 	{
 		person1=
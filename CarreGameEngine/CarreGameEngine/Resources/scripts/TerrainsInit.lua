@@ -5,12 +5,16 @@
 --Note: Make filePath relative to CarreGameEngine.vcxproj
 --Note: Use this file to load all heightmap data
 --Note: "player" MUST BE present and MUST BE spelt correctly
+--Note: method is "geomipmap" (default) or "bruteforce", patchSize must be 2^n + 1
+--Note: gpuDisplacement = true displaces geomipmap patches from a height texture on the GPU
+--Note: filePath is a raw or tiled (--tile-heightfield) heightfield, bitDepth is 8 or 16 (default taken from the file size)
+--Note: collision = true adds heightfield collision around the player
 --Note: Needs improvements
 AllHeightmaps=
 {
 	terrain=
 	{
-		{filePath = "Resources/terrain/newcity.raw", texFilePath = "Resources/terrain/grass.jpg", fileSize = 128, scaleX = 100.0, scaleY = 5.0, scaleZ = 100.0, posX = 0.0, posY = 0.0, posZ = 0.0},
+		{filePath = "Resources/terrain/newcity.raw", texFilePath = "Resources/terrain/grass.jpg", fileSize = 128, scaleX = 100.0, scaleY = 5.0, scaleZ = 100.0, posX = 0.0, posY = 0.0, posZ = 0.0, method = "geomipmap", patchSize = 33, gpuDisplacement = true},
 	},
 	buildings=
 	{
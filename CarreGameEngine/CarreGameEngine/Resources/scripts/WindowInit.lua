@@ -6,4 +6,6 @@
 screenWidth=1280
 screenHeight=720
 screenTitle="Carre Game Engine"
-fullScreen=false
\ No newline at end of file
+fullScreen=false
+--Draw on a render thread that overlaps the next frame, false to draw on the game loop thread
+renderThread=true
\ No newline at end of file
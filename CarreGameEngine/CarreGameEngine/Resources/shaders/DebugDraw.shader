@@ -2,6 +2,9 @@
 #version 330 core
 
 layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inColor;
+
+out vec3 LineColor;
 
 uniform mat4 model;
 uniform mat4 view;
@@ -9,6 +12,7 @@ uniform mat4 projection;
 
 void main()
 {
+	LineColor = inColor;
 	gl_Position = projection * view * model * vec4(inPos, 1.0f);
 }
 
@@ -17,7 +21,9 @@ void main()
 
 out vec4 FragColor;
 
+in vec3 LineColor;
+
 void main()
 {
-	FragColor = vec4(1.0, 0.5, 0.0, 1.0); // show a plain colour
+	FragColor = vec4(LineColor, 1.0); // colour given by Bullet for each line
 }
\ No newline at end of file
@@ -8,14 +8,69 @@ layout(location = 3) in vec4 inColor;
 
 out vec2 TexCoord;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// World matrices of the frame as four texels each, the draw's first matrix is at transformBase
+uniform samplerBuffer transforms;
+uniform int transformBase;
+
+#ifdef KEYFRAMES
+// Positions of every frame, keyframeVertexCount texels a frame in the order of the vertices
+uniform samplerBuffer keyframes;
+uniform int keyframeVertexCount;
+#endif
+
+#ifdef SKINNING
+// Up to four bones of the bone palette each vertex follows, the weights sum to one
+layout(location = 4) in uvec4 inBoneIndices;
+layout(location = 5) in vec4 inBoneWeights;
+
+// Reads a matrix of the transform buffer
+mat4 FetchTransform(int index)
+{
+	return mat4(texelFetch(transforms, index * 4), texelFetch(transforms, index * 4 + 1),
+		texelFetch(transforms, index * 4 + 2), texelFetch(transforms, index * 4 + 3));
+}
+#endif
+
 void main()
 {
+	// Runs of the same mesh are drawn as instances with consecutive matrices
+	int index = (transformBase + gl_InstanceID) * 4;
+	mat4 model = mat4(texelFetch(transforms, index), texelFetch(transforms, index + 1),
+		texelFetch(transforms, index + 2), texelFetch(transforms, index + 3));
+
+#ifdef KEYFRAMES
+	// The bottom row holds the two frames the model is between and how far it is between them
+	vec3 frames = vec3(model[0][3], model[1][3], model[2][3]);
+	model[0][3] = 0.0f;
+	model[1][3] = 0.0f;
+	model[2][3] = 0.0f;
+
+	vec3 from = texelFetch(keyframes, int(frames.x) * keyframeVertexCount + gl_VertexID).xyz;
+	vec3 to = texelFetch(keyframes, int(frames.y) * keyframeVertexCount + gl_VertexID).xyz;
+	vec3 position = mix(from, to, frames.z);
+#elif defined(SKINNING)
+	// The bottom row holds where the palette of the model starts, 0 if it has not been posed
+	int paletteBase = int(model[0][3]);
+	model[0][3] = 0.0f;
+
+	vec3 position = inPos;
+	if (paletteBase > 0 && dot(inBoneWeights, vec4(1.0f)) > 0.0f)
+	{
+		mat4 skin = FetchTransform(paletteBase + int(inBoneIndices.x)) * inBoneWeights.x
+			+ FetchTransform(paletteBase + int(inBoneIndices.y)) * inBoneWeights.y
+			+ FetchTransform(paletteBase + int(inBoneIndices.z)) * inBoneWeights.z
+			+ FetchTransform(paletteBase + int(inBoneIndices.w)) * inBoneWeights.w;
+		position = (skin * vec4(inPos, 1.0f)).xyz;
+	}
+#else
+	vec3 position = inPos;
+#endif
+
 	TexCoord = inTexCoord;
-    gl_Position = projection * view * model * vec4(inPos, 1.0f);
+    gl_Position = projection * view * model * vec4(position, 1.0f);
 }
 
 #shader fragment
@@ -25,9 +80,19 @@ out vec4 FragColor;
 
 in vec2 TexCoord;
 
+#ifdef TEXTURE_ARRAY
+// Diffuse textures of the same size are packed into the layers of one array
+uniform sampler2DArray texture_diffuse1;
+uniform float textureLayer;
+#else
 uniform sampler2D texture_diffuse1;
+#endif
 
 void main()
 {
+#ifdef TEXTURE_ARRAY
+    FragColor = texture(texture_diffuse1, vec3(TexCoord, textureLayer));
+#else
     FragColor = texture(texture_diffuse1, TexCoord);
+#endif
 }
\ No newline at end of file
@@ -1,10 +1,14 @@
 #shader vertex
 #version 330 core
 
+#ifndef GPU_DISPLACEMENT
 layout(location = 0) in vec3 inPos;
+#endif
+#ifndef GEOMIPMAP
 layout(location = 1) in vec2 inTexCoord;
 layout(location = 2) in vec3 inNormal;
 layout(location = 3) in vec4 inColor;
+#endif
 
 out vec2 TexCoord;
 
@@ -12,9 +16,38 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+#ifdef GEOMIPMAP
+// Geomipmap patches only store positions, texture coordinates span the whole terrain
+uniform vec2 terrainSize;
+#endif
+
+#ifdef GPU_DISPLACEMENT
+// There are no vertex attributes, the base vertex of each draw is the first vertex of its patch
+// so gl_VertexID gives the patch and the grid vertex inside it, displaced by the heightmap
+uniform sampler2D heightmap;
+uniform vec3 terrainScale;
+uniform int heightfieldSize;
+uniform int patchSize;
+uniform int patchesPerSide;
+#endif
+
 void main()
 {
+#ifdef GPU_DISPLACEMENT
+	int patchVertices = patchSize * patchSize;
+	int patchIndex = gl_VertexID / patchVertices;
+	int vertex = gl_VertexID - patchIndex * patchVertices;
+	ivec2 patchOrigin = ivec2(patchIndex % patchesPerSide, patchIndex / patchesPerSide) * (patchSize - 1);
+	ivec2 texel = min(patchOrigin + ivec2(vertex % patchSize, vertex / patchSize), ivec2(heightfieldSize - 1));
+	float height = texelFetch(heightmap, texel, 0).r;
+	vec3 inPos = vec3(texel.x, height, texel.y) * terrainScale;
+#endif
+
+#ifdef GEOMIPMAP
+	TexCoord = (inPos.xz / terrainSize) * 20;
+#else
 	TexCoord = inTexCoord * 20;
+#endif
     gl_Position = projection * view * model * vec4(inPos, 1.0f);
 }
 
@@ -7,7 +7,7 @@
 #include "ScriptManager.h"
 
 // Default constructor
-ScriptManager::ScriptManager(){}
+ScriptManager::ScriptManager() : m_pauseOnError(true) {}
 
 // De-constructor
 ScriptManager::~ScriptManager(){}
@@ -16,7 +16,7 @@ ScriptManager::~ScriptManager(){}
 void ScriptManager::LoadAllLuaScripts(){}
 
 // Load all camera and window init variables
-bool ScriptManager::LoadWindowInitLua(int &width, int &height, std::string &name, bool &fullScreen)
+bool ScriptManager::LoadWindowInitLua(int &width, int &height, std::string &name, bool &fullScreen, bool &renderThread)
 {
 	// Create lua state
 	lua_State* Environment = lua_open();
@@ -45,6 +45,7 @@ bool ScriptManager::LoadWindowInitLua(int &width, int &height, std::string &name
 	lua_getglobal(Environment, "screenHeight");
 	lua_getglobal(Environment, "screenTitle");
 	lua_getglobal(Environment, "fullScreen");
+	lua_getglobal(Environment, "renderThread");
 
 	// Set values
 	width = (int)lua_tonumber(Environment, 1);
@@ -52,6 +53,9 @@ bool ScriptManager::LoadWindowInitLua(int &width, int &height, std::string &name
 	name = lua_tostring(Environment, 3);
 	fullScreen = lua_toboolean(Environment, 4);
 
+	// Scripts without the setting draw on a render thread
+	renderThread = lua_isnil(Environment, 5) || lua_toboolean(Environment, 5);
+
 	// Close environment
 	lua_close(Environment);
 
@@ -178,7 +182,7 @@ bool ScriptManager::LoadTexturesInitLua()
 }
 
 // Load all model data
-bool ScriptManager::LoadModelsInitLua(std::multimap<std::string, ModelsData> &allModelData, ModelsData &modelData)
+bool ScriptManager::LoadModelsInitLua(std::multimap<std::string, ModelsData> &allModelData, ModelsData &modelData, StreamingData &streamingData)
 {
 	// Create lua state
 	lua_State* Environment = lua_open();
@@ -196,11 +200,20 @@ bool ScriptManager::LoadModelsInitLua(std::multimap<std::string, ModelsData> &al
 	// Load and run script
 	if (luaL_dofile(Environment, "Resources/scripts/ModelsInit.lua"))
 	{
-		std::cout << "Error opening file.." << std::endl;
-		getchar();
+		std::cout << "Error opening file.. " << lua_tostring(Environment, -1) << std::endl;
+		lua_close(Environment);
+		if (m_pauseOnError)
+			getchar();
 		return false;
 	}
 
+	// Scripts without the settings load every model at startup
+	lua_settop(Environment, 0);
+	lua_getglobal(Environment, "streamRadius");
+	lua_getglobal(Environment, "streamBudgetMB");
+	streamingData.radius = (float)lua_tonumber(Environment, 1);
+	streamingData.budgetBytes = (size_t)(lua_tonumber(Environment, 2) * 1024.0 * 1024.0);
+
 	// Read from script
 	lua_settop(Environment, 0);
 	lua_getglobal(Environment, "AllModels");
@@ -343,8 +356,10 @@ bool ScriptManager::LoadHeightmapsInitLua(std::unordered_map<std::string, Height
 	// Load and run script
 	if (luaL_dofile(Environment, "Resources/scripts/TerrainsInit.lua"))
 	{
-		std::cout << "Error opening file.." << std::endl;
-		getchar();
+		std::cout << "Error opening file.. " << lua_tostring(Environment, -1) << std::endl;
+		lua_close(Environment);
+		if (m_pauseOnError)
+			getchar();
 		return false;
 	}
 
@@ -358,7 +373,7 @@ bool ScriptManager::LoadHeightmapsInitLua(std::unordered_map<std::string, Height
 	std::string heightfieldType;
 
 	// Different types of data being read in
-	std::string values[9];
+	std::string values[14];
 	values[0] = "filePath";
 	values[1] = "texFilePath";
 	values[2] = "fileSize";
@@ -368,6 +383,11 @@ bool ScriptManager::LoadHeightmapsInitLua(std::unordered_map<std::string, Height
 	values[6] = "posX";
 	values[7] = "posY";
 	values[8] = "posZ";
+	values[9] = "method";
+	values[10] = "patchSize";
+	values[11] = "gpuDisplacement";
+	values[12] = "bitDepth";
+	values[13] = "collision";
 
 	//temp values
 	std::string temp;
@@ -412,6 +432,16 @@ bool ScriptManager::LoadHeightmapsInitLua(std::unordered_map<std::string, Height
 					tempPos.y = lua_tonumber(Environment, -1);
 				if (temp.compare(values[8]) == 0)
 					tempPos.z = lua_tonumber(Environment, -1);
+				if (temp.compare(values[9]) == 0)
+					heightmapsData.method = lua_tostring(Environment, -1);
+				if (temp.compare(values[10]) == 0)
+					heightmapsData.patchSize = lua_tonumber(Environment, -1);
+				if (temp.compare(values[11]) == 0)
+					heightmapsData.gpuDisplacement = lua_toboolean(Environment, -1) != 0;
+				if (temp.compare(values[12]) == 0)
+					heightmapsData.bitDepth = lua_tonumber(Environment, -1);
+				if (temp.compare(values[13]) == 0)
+					heightmapsData.collision = lua_toboolean(Environment, -1) != 0;
 
 				// Pop out of current table
 				lua_pop(Environment, 1);
@@ -443,6 +473,11 @@ bool ScriptManager::LoadHeightmapsInitLua(std::unordered_map<std::string, Height
 			heightmapsData.fileSize = 0;
 			heightmapsData.filePath = "";
 			heightmapsData.texFilePath = "";
+			heightmapsData.method = "geomipmap";
+			heightmapsData.patchSize = 33;
+			heightmapsData.gpuDisplacement = false;
+			heightmapsData.bitDepth = 0;
+			heightmapsData.collision = false;
 
 			// Pop out of current table
 			lua_pop(Environment, 1);
@@ -568,6 +603,76 @@ bool ScriptManager::LoadAffordanceTable(AffordanceData& affordanceTable)
 	return true;
 }
 
+// Load the keyframes of the headless camera path
+bool ScriptManager::LoadCameraPathLua(std::vector<CameraKeyframe> &keyframes)
+{
+	// Create lua state
+	lua_State* Environment = lua_open();
+	if (Environment == NULL)
+	{
+		std::cout << "Error Initializing lua.." << std::endl;
+		return false;
+	}
+
+	// Load standard lua library functions
+	luaL_openlibs(Environment);
+
+	// Load and run script
+	if (luaL_dofile(Environment, "Resources/scripts/CameraPath.lua"))
+	{
+		std::cout << "Error opening file.." << std::endl;
+		lua_close(Environment);
+		return false;
+	}
+
+	// Read from script
+	lua_settop(Environment, 0);
+	lua_getglobal(Environment, "cameraPath");
+
+	keyframes.clear();
+
+	// Keyframes are read by index, as lua_next does not keep their order
+	int count = (int)lua_objlen(Environment, 1);
+	for (int i = 1; i <= count; i++)
+	{
+		lua_rawgeti(Environment, 1, i);
+
+		CameraKeyframe keyframe;
+		keyframe.position = glm::vec3(0.0f);
+		keyframe.target = glm::vec3(0.0f);
+
+		lua_getfield(Environment, -1, "pos");
+		if (lua_isstring(Environment, -1))
+		{
+			std::string pos = lua_tostring(Environment, -1);
+			std::vector<std::string> values = split(pos);
+			for (size_t j = 0; j < values.size() && j < 3; j++)
+				keyframe.position[j] = toFloat(values[j]);
+		}
+		lua_pop(Environment, 1);
+
+		lua_getfield(Environment, -1, "target");
+		if (lua_isstring(Environment, -1))
+		{
+			std::string target = lua_tostring(Environment, -1);
+			std::vector<std::string> values = split(target);
+			for (size_t j = 0; j < values.size() && j < 3; j++)
+				keyframe.target[j] = toFloat(values[j]);
+		}
+		lua_pop(Environment, 1);
+
+		keyframes.push_back(keyframe);
+
+		// Pop out of current table
+		lua_pop(Environment, 1);
+	}
+
+	// Close environment
+	lua_close(Environment);
+
+	return !keyframes.empty();
+}
+
 //space delimited string splitter
 std::vector<std::string> ScriptManager::split(std::string& source) {
 	std::vector<std::string> results;
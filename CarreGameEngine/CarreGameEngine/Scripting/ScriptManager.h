@@ -84,10 +84,11 @@ class ScriptManager
 			* @param height - Screen height
 			* @param name - Screen name
 			* @param fullScreen - True if fullscreen, false otherwise
+			* @param renderThread - True to draw on a render thread, false to draw on the game loop thread
 			*
 			* @return bool - True if load success, else false
 			*/
-		bool LoadWindowInitLua(int &width, int &height, std::string &name, bool &fullScreen);
+		bool LoadWindowInitLua(int &width, int &height, std::string &name, bool &fullScreen, bool &renderThread);
 
 			/**
 			* @brief Load cam initilization
@@ -117,11 +118,12 @@ class ScriptManager
 			/**
 			* @brief Load all models
 			*
-			* Loads all models, their xyz position, and their xyz scale
+			* Loads all models, their xyz position, and their xyz scale, and the world streaming
+			* settings
 			*
 			* @return bool - True if load success, else false
 			*/
-		bool LoadModelsInitLua(std::multimap<std::string, ModelsData> &allModelData, ModelsData &modelData);
+		bool LoadModelsInitLua(std::multimap<std::string, ModelsData> &allModelData, ModelsData &modelData, StreamingData &streamingData);
 
 			/**
 			* @brief Load all models
@@ -142,6 +144,28 @@ class ScriptManager
 			*/
 		bool LoadAffordanceTable(AffordanceData& m_affordanceTable);
 
+			/**
+			* @brief Load the camera path
+			*
+			* Loads the keyframes of the fixed camera path flown by headless runs, in order
+			*
+			* @param keyframes - Filled with the position and look at target of each keyframe
+			* @return bool - True if load success, else false
+			*/
+		bool LoadCameraPathLua(std::vector<CameraKeyframe> &keyframes);
+
+			/**
+			* @brief Set whether script errors wait for a key
+			*
+			* Scripts loaded at startup wait for a key on an error so it can be read. Scripts
+			* reloaded while the game runs only print the error, so a half saved script does not
+			* stop the game.
+			*
+			* @param pause - Wait for a key after printing an error
+			* @return void
+			*/
+		void SetPauseOnError(bool pause) { m_pauseOnError = pause; }
+
 	private:
 
 			/**
@@ -179,6 +203,9 @@ class ScriptManager
 			 * @return A vector of each part of the source string.
 			 */
 		std::vector<std::string> split(std::string& source);
+
+			/// Wait for a key after printing a script error
+		bool m_pauseOnError;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "TextureCooker.h"
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+
+#include "stb_image.h"
+
+// image_DXT.h has no C++ guards of its own
+extern "C"
+{
+#include "image_DXT.h"
+}
+
+/// Identifies a cooked texture file written by the texture cooker
+static const uint32_t COOKED_TEXTURE_MAGIC = 0x58455443; // "CTEX"
+
+/// Changing the cooking code must change this so old cache files are cooked again
+static const uint32_t COOKED_TEXTURE_VERSION = 1;
+
+/**
+* @struct CookedTextureHeader
+* @brief Header at the start of a cooked texture file, followed by each mip level as its size then its blocks
+*/
+struct CookedTextureHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceHash;
+	uint32_t format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipCount;
+};
+
+TextureCooker::TextureCooker()
+	: m_cacheDirectory("Resources/textures/cache"), m_cacheHits(0), m_cacheMisses(0),
+	m_compressedBytes(0), m_uncompressedBytes(0), m_cookSeconds(0.0)
+{
+}
+
+bool TextureCooker::IsSupported() const
+{
+	return GLEW_EXT_texture_compression_s3tc != 0;
+}
+
+bool TextureCooker::Cook(const std::string& filePath, CookedTexture& cooked)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	std::vector<char> source;
+	if (!ReadFileBytes(filePath, source) || source.empty())
+		return false;
+
+	// Cooked textures are keyed by their contents, so an edited source is cooked again
+	uint64_t sourceHash = HashBytes(&source[0], source.size());
+	sourceHash = HashBytes(&COOKED_TEXTURE_VERSION, sizeof(COOKED_TEXTURE_VERSION), sourceHash);
+
+	std::string cachePath;
+	if (!m_cacheDirectory.empty())
+		cachePath = m_cacheDirectory + "/" + HashToString(sourceHash) + ".ctex";
+
+	bool success = true;
+	bool cacheHit = !cachePath.empty() && LoadCooked(cachePath, sourceHash, cooked);
+	if (!cacheHit)
+	{
+		success = CookImage(source, cooked);
+
+		if (success)
+		{
+			std::cout << "Cooked texture: " << filePath << std::endl;
+
+			if (!cachePath.empty())
+				SaveCooked(cachePath, sourceHash, cooked);
+		}
+		else
+		{
+			std::cout << "Texture failed to cook: " << filePath << " - " << stbi_failure_reason() << std::endl;
+		}
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+	std::lock_guard<std::mutex> lock(m_statsMutex);
+	if (cacheHit)
+		m_cacheHits++;
+	else
+		m_cacheMisses++;
+
+	if (success)
+	{
+		for (size_t i = 0; i < cooked.mips.size(); i++)
+		{
+			m_compressedBytes += cooked.mips[i].data.size();
+			m_uncompressedBytes += (size_t)cooked.mips[i].width * cooked.mips[i].height * 4;
+		}
+	}
+	m_cookSeconds += elapsed.count();
+
+	return success;
+}
+
+bool TextureCooker::LoadUncompressed(const std::string& filePath, CookedTexture& decoded)
+{
+	std::vector<char> source;
+	if (!ReadFileBytes(filePath, source) || source.empty())
+		return false;
+
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load_from_memory((const stbi_uc*)&source[0], (int)source.size(), &width, &height, &nrComponents, 4);
+	if (!data)
+		return false;
+
+	decoded.format = GL_RGBA8;
+	decoded.mips.resize(1);
+	decoded.mips[0].width = width;
+	decoded.mips[0].height = height;
+	decoded.mips[0].data.assign(data, data + (size_t)width * height * 4);
+	stbi_image_free(data);
+
+	return true;
+}
+
+void TextureCooker::Upload(const CookedTexture& cooked, GLuint texID)
+{
+	glBindTexture(GL_TEXTURE_2D, texID);
+
+	if (cooked.format == GL_RGBA8)
+	{
+		const CookedMipLevel& mip = cooked.mips[0];
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &mip.data[0]);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+	else
+	{
+		for (size_t i = 0; i < cooked.mips.size(); i++)
+		{
+			const CookedMipLevel& mip = cooked.mips[i];
+			glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, cooked.format, mip.width, mip.height, 0,
+				(GLsizei)mip.data.size(), &mip.data[0]);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)cooked.mips.size() - 1);
+	}
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+// Halves an RGBA image with a 2x2 box filter, clamping at the edges of odd sized images
+static void DownsampleRGBA(const unsigned char* src, int width, int height, std::vector<unsigned char>& dest)
+{
+	int destWidth = std::max(width / 2, 1);
+	int destHeight = std::max(height / 2, 1);
+	dest.resize((size_t)destWidth * destHeight * 4);
+
+	for (int y = 0; y < destHeight; y++)
+	{
+		int y0 = std::min(y * 2, height - 1);
+		int y1 = std::min(y * 2 + 1, height - 1);
+
+		for (int x = 0; x < destWidth; x++)
+		{
+			int x0 = std::min(x * 2, width - 1);
+			int x1 = std::min(x * 2 + 1, width - 1);
+
+			for (int c = 0; c < 4; c++)
+			{
+				int sum = src[(y0 * width + x0) * 4 + c] + src[(y0 * width + x1) * 4 + c]
+					+ src[(y1 * width + x0) * 4 + c] + src[(y1 * width + x1) * 4 + c];
+				dest[(y * destWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+			}
+		}
+	}
+}
+
+bool TextureCooker::CookImage(const std::vector<char>& source, CookedTexture& cooked)
+{
+	int width, height, nrComponents;
+	unsigned char* data = stbi_load_from_memory((const stbi_uc*)&source[0], (int)source.size(), &width, &height, &nrComponents, 4);
+	if (!data)
+		return false;
+
+	// Only pay for an alpha channel if some pixel is actually transparent
+	bool hasAlpha = false;
+	if (nrComponents == 2 || nrComponents == 4)
+	{
+		for (size_t i = 3; i < (size_t)width * height * 4 && !hasAlpha; i += 4)
+			hasAlpha = data[i] != 255;
+	}
+
+	cooked.format = hasAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	cooked.mips.clear();
+
+	std::vector<unsigned char> level(data, data + (size_t)width * height * 4);
+	std::vector<unsigned char> nextLevel;
+	stbi_image_free(data);
+
+	while (true)
+	{
+		int compressedSize = 0;
+		unsigned char* compressed = hasAlpha
+			? convert_image_to_DXT5(&level[0], width, height, 4, &compressedSize)
+			: convert_image_to_DXT1(&level[0], width, height, 4, &compressedSize);
+		if (!compressed)
+			return false;
+
+		CookedMipLevel mip;
+		mip.width = width;
+		mip.height = height;
+		mip.data.assign(compressed, compressed + compressedSize);
+		cooked.mips.push_back(mip);
+		free(compressed);
+
+		if (width == 1 && height == 1)
+			break;
+
+		DownsampleRGBA(&level[0], width, height, nextLevel);
+		level.swap(nextLevel);
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+	}
+
+	return true;
+}
+
+bool TextureCooker::LoadCooked(const std::string& cachePath, uint64_t sourceHash, CookedTexture& cooked)
+{
+	std::vector<char> data;
+	if (!ReadFileBytes(cachePath, data) || data.size() < sizeof(CookedTextureHeader))
+		return false;
+
+	CookedTextureHeader header;
+	memcpy(&header, &data[0], sizeof(header));
+	if (header.magic != COOKED_TEXTURE_MAGIC || header.version != COOKED_TEXTURE_VERSION || header.sourceHash != sourceHash
+		|| header.mipCount == 0)
+		return false;
+
+	cooked.format = header.format;
+	cooked.mips.resize(header.mipCount);
+
+	size_t offset = sizeof(header);
+	int width = (int)header.width;
+	int height = (int)header.height;
+	for (uint32_t i = 0; i < header.mipCount; i++)
+	{
+		uint32_t size;
+		if (offset + sizeof(size) > data.size())
+			return false;
+		memcpy(&size, &data[offset], sizeof(size));
+		offset += sizeof(size);
+
+		if (offset + size > data.size())
+			return false;
+
+		cooked.mips[i].width = width;
+		cooked.mips[i].height = height;
+		cooked.mips[i].data.assign(data.begin() + offset, data.begin() + offset + size);
+		offset += size;
+
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+	}
+
+	return true;
+}
+
+void TextureCooker::SaveCooked(const std::string& cachePath, uint64_t sourceHash, const CookedTexture& cooked)
+{
+	if (!MakeDirectory(m_cacheDirectory))
+		return;
+
+	std::ofstream outfile(cachePath.c_str(), std::ios::binary);
+	if (!outfile)
+	{
+		std::cout << "Cannot write texture cache: " << cachePath << std::endl;
+		return;
+	}
+
+	CookedTextureHeader header;
+	header.magic = COOKED_TEXTURE_MAGIC;
+	header.version = COOKED_TEXTURE_VERSION;
+	header.sourceHash = sourceHash;
+	header.format = cooked.format;
+	header.width = cooked.mips.empty() ? 0 : cooked.mips[0].width;
+	header.height = cooked.mips.empty() ? 0 : cooked.mips[0].height;
+	header.mipCount = (uint32_t)cooked.mips.size();
+	outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	for (size_t i = 0; i < cooked.mips.size(); i++)
+	{
+		uint32_t size = (uint32_t)cooked.mips[i].data.size();
+		outfile.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		outfile.write(reinterpret_cast<const char*>(&cooked.mips[i].data[0]), size);
+	}
+}
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <mutex>
+#include <GL\glew.h>
+
+#include "..\Common\FileUtils.h"
+
+	/**
+	* @struct CookedMipLevel
+	* @brief A single block compressed mip level
+	*/
+struct CookedMipLevel
+{
+	/// Size of the level in pixels
+	int width, height;
+
+	/// Compressed blocks of the level
+	std::vector<unsigned char> data;
+};
+
+	/**
+	* @struct CookedTexture
+	* @brief A block compressed texture with its full mip chain
+	*/
+struct CookedTexture
+{
+	/// GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, or GL_RGBA8 for a single uncompressed level
+	GLenum format;
+
+	/// Mip levels from the full size image down to 1x1
+	std::vector<CookedMipLevel> mips;
+};
+
+	/**
+	* @class TextureCooker
+	* @brief Converts source images to block compressed textures and caches them on disk
+	*
+	* Decoding a JPEG and calling glGenerateMipmap() for every texture on every run costs startup
+	* time, and leaves uncompressed textures in video memory. The texture cooker decodes a source
+	* image once, builds its mip chain on the CPU and compresses every level to BC1 (DXT1), or BC3
+	* (DXT5) when the image has transparent pixels. The result is written to the cache directory
+	* under the hash of the source file contents, so later runs read the cooked levels straight
+	* from disk and upload them with glCompressedTexImage2D().
+	*
+	* BC1 takes 4 bits and BC3 8 bits per pixel, against 24 or 32 bits uncompressed.
+	*
+	* Cook() and LoadUncompressed() make no OpenGL calls and may be called from worker threads.
+	*
+	* @version 01
+	* @date 19/10/2026
+	*/
+class TextureCooker
+{
+public:
+		/**
+		* @brief Singleton instance
+		*
+		* This function returns a singleton instance of the texture cooker class so that there is only
+		* one texture cache.
+		*
+		* @return static TextureCooker&
+		*/
+	static TextureCooker& Instance()
+	{
+		static TextureCooker instance;
+
+		return instance;
+	}
+
+		/**
+		* @brief Checks for compressed texture support
+		*
+		* Returns true if the driver supports S3TC compressed textures. Must be called with a
+		* current OpenGL context.
+		*
+		* @return bool
+		*/
+	bool IsSupported() const;
+
+		/**
+		* @brief Gets a cooked texture
+		*
+		* Reads the cooked texture for the source image from the cache, cooking and caching it
+		* first if the source has changed or was never cooked. Returns false if the source image
+		* cannot be read.
+		*
+		* @param const std::string& filePath
+		* @param CookedTexture& cooked
+		* @return bool
+		*/
+	bool Cook(const std::string& filePath, CookedTexture& cooked);
+
+		/**
+		* @brief Loads a source image uncompressed
+		*
+		* Decodes the source image into a single GL_RGBA8 level, for drivers without compressed
+		* texture support. Returns false if the source image cannot be read.
+		*
+		* @param const std::string& filePath
+		* @param CookedTexture& decoded
+		* @return bool
+		*/
+	bool LoadUncompressed(const std::string& filePath, CookedTexture& decoded);
+
+		/**
+		* @brief Uploads a cooked texture
+		*
+		* Uploads every mip level of the cooked texture to the given texture name with
+		* glCompressedTexImage2D() and sets the same wrapping and filtering as uncompressed
+		* textures. Uncompressed textures have their mipmaps generated.
+		*
+		* @param const CookedTexture& cooked
+		* @param GLuint texID
+		* @return void
+		*/
+	void Upload(const CookedTexture& cooked, GLuint texID);
+
+		/**
+		* @brief Sets the cache directory
+		*
+		* Sets the directory cooked textures are written to and read from. An empty string
+		* disables the on-disk cache, so textures are cooked on every run.
+		*
+		* @param const std::string& directory
+		* @return void
+		*/
+	void SetCacheDirectory(const std::string& directory) { m_cacheDirectory = directory; }
+
+		/**
+		* @brief Gets the number of cache hits
+		*
+		* Returns the number of textures read from the cache.
+		*
+		* @return int
+		*/
+	int GetCacheHits() const { return m_cacheHits; }
+
+		/**
+		* @brief Gets the number of cache misses
+		*
+		* Returns the number of textures that had to be cooked from their source image.
+		*
+		* @return int
+		*/
+	int GetCacheMisses() const { return m_cacheMisses; }
+
+		/**
+		* @brief Gets the compressed texture size
+		*
+		* Returns the total number of bytes of compressed texture data, all mip levels included,
+		* returned by Cook().
+		*
+		* @return size_t
+		*/
+	size_t GetCompressedBytes() const { return m_compressedBytes; }
+
+		/**
+		* @brief Gets the uncompressed texture size
+		*
+		* Returns the number of bytes the textures returned by Cook() would take as uncompressed
+		* RGBA with mipmaps, to compare against GetCompressedBytes().
+		*
+		* @return size_t
+		*/
+	size_t GetUncompressedBytes() const { return m_uncompressedBytes; }
+
+		/**
+		* @brief Gets the time spent cooking
+		*
+		* Returns the total number of seconds spent in Cook(), reading the cache included.
+		*
+		* @return double
+		*/
+	double GetCookSeconds() const { return m_cookSeconds; }
+
+private:
+		/**
+		* @brief Default constructor
+		*
+		* Sets the default cache directory.
+		*
+		* @return null
+		*/
+	TextureCooker();
+
+		/**
+		* @brief Destructor
+		*
+		* Empty destructor.
+		*
+		* @return null
+		*/
+	~TextureCooker() { }
+
+		/**
+		* @brief Cooks a source image
+		*
+		* Decodes the source image, builds its mip chain and compresses every level.
+		*
+		* @param const std::vector<char>& source
+		* @param CookedTexture& cooked
+		* @return bool
+		*/
+	bool CookImage(const std::vector<char>& source, CookedTexture& cooked);
+
+		/**
+		* @brief Loads a cooked texture from the cache
+		*
+		* Returns false if the cache file does not exist or was cooked from a different source.
+		*
+		* @param const std::string& cachePath
+		* @param uint64_t sourceHash
+		* @param CookedTexture& cooked
+		* @return bool
+		*/
+	bool LoadCooked(const std::string& cachePath, uint64_t sourceHash, CookedTexture& cooked);
+
+		/**
+		* @brief Saves a cooked texture to the cache
+		*
+		* @param const std::string& cachePath
+		* @param uint64_t sourceHash
+		* @param const CookedTexture& cooked
+		* @return void
+		*/
+	void SaveCooked(const std::string& cachePath, uint64_t sourceHash, const CookedTexture& cooked);
+
+	/// Directory the cooked textures are cached in
+	std::string m_cacheDirectory;
+
+	/// Cache statistics
+	int m_cacheHits, m_cacheMisses;
+
+	/// Compressed and uncompressed size of every cooked texture
+	size_t m_compressedBytes, m_uncompressedBytes;
+
+	/// Time spent in Cook()
+	double m_cookSeconds;
+
+	/// Guards the statistics, which are updated from worker threads
+	std::mutex m_statsMutex;
+};
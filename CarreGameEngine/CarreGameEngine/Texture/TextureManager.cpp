@@ -6,11 +6,24 @@
 //Includes
 #include "TextureManager.h"
 #include <sstream>
+#include <map>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <thread>
 
 // Default constructor
 TextureManager::TextureManager()
 {
 	m_numTextures = 0;
+	m_compressTextures = true;
+	m_pendingLoads = 0;
+	m_uploadBudget = 4 * 1024 * 1024;
+	m_uploadBuffer = 0;
+	m_frame = 0;
+	m_releaseDelay = 120;
+	m_nextSerial = 1;
+	m_textureMemory = 0;
 }
 
 // De-constructor
@@ -33,12 +46,19 @@ bool TextureManager::SetActiveTexture(unsigned int texID)
 int TextureManager::LoadTexture(std::string filePath)
 {
 	// Check to see if texture is already loaded and in map, and return texID if true
-	if (TexLoaded(filePath) != 0)
+	TextureHandle handle = FindTexture(filePath);
+	if (handle != 0)
 	{
 		std::cout << "File already loaded: " << filePath << std::endl;
-		return TexLoaded(filePath);
+		return GetTextureName(handle);
 	}
 
+	return GetTextureName(LoadRecord(filePath));
+}
+
+// Load a texture from file into a new record
+TextureHandle TextureManager::LoadRecord(const std::string& filePath)
+{
 	// Load in the file
 	//GLuint newTex = SOIL_load_OGL_texture
 	//(
@@ -58,6 +78,27 @@ int TextureManager::LoadTexture(std::string filePath)
 	// Generate a new texID
 	GLuint newTex;
 	glGenTextures(1, &newTex);
+	TextureHandle handle = CreateRecord(filePath, newTex);
+
+	// Use the block compressed texture and mips from the texture cache, cooking them if needed
+	CookedTexture cooked;
+	if (m_compressTextures && TextureCooker::Instance().IsSupported() && TextureCooker::Instance().Cook(filePath, cooked))
+	{
+		TextureCooker::Instance().Upload(cooked, newTex);
+
+		m_width = cooked.mips[0].width;
+		m_height = cooked.mips[0].height;
+
+		size_t bytes = 0;
+		for (size_t i = 0; i < cooked.mips.size(); i++)
+			bytes += cooked.mips[i].data.size();
+		SetRecordSize(handle, m_width, m_height, bytes);
+
+		m_numTextures++;
+		std::cout << "Successfully added compressed Texture. Texture Count = " << m_numTextures << std::endl;
+
+		return handle;
+	}
 
 	int width, height, nrComponents;
 	unsigned char* data = stbi_load(filePath.c_str(), &width, &height, &nrComponents, 0);
@@ -86,6 +127,9 @@ int TextureManager::LoadTexture(std::string filePath)
 
 		stbi_image_free(data);
 
+		// A third more for the mipmaps
+		SetRecordSize(handle, width, height, (size_t)width * height * nrComponents * 4 / 3);
+
 		// Increment number of textures and return ID
 		m_numTextures++;
 		std::cout << "Successfully added Texture. Texture Count = " << m_numTextures << std::endl;
@@ -96,86 +140,654 @@ int TextureManager::LoadTexture(std::string filePath)
 		stbi_image_free(data);
 	}
 
-	// Add new texture to make
-	AddTextureToMap(filePath, newTex);
-
-	return newTex;
+	return handle;
 }
 
 // Add loaded texture to map
 void TextureManager::AddTextureToMap(std::string filename, int texID)
 {
 	// If loaded texture is not already in map, load it
-	if (!m_textureMap[filename])
-	{
-		m_textureMap[filename] = texID;
-	}
+	if (FindTexture(filename) == 0)
+		CreateRecord(filename, texID);
 }
 
 // Return a texture ID
 int TextureManager::GetTextureID(std::string filename)
 {
-	// Get iterator to start of map
-	std::unordered_map<std::string, unsigned int>::iterator it = m_textureMap.begin();
+	// If texture found, return the given ID
+	TextureHandle handle = FindTexture(filename);
+	if (handle != 0)
+		return GetTextureName(handle);
+
+	// If texture is not in map, load it in and add to map
+	return LoadTexture(filename);
+}
 
-	// Search map for texture
-	while (it != m_textureMap.end())
+// Release all textures from memory
+void TextureManager::ReleaseAllTextures()
+{
+	// Loop through the records, unloading all textures
+	for (size_t i = 0; i < m_records.size(); i++)
 	{
-		// If texture found, return the given ID
-		if ((*it).first == filename)
+		TextureRecord& record = m_records[i];
+		if (record.m_id == 0)
+			continue;
+
+		std::cout << "unloading Texture: " << record.m_path << ", ID: " << record.m_id;
+
+		// Texture arrays are deleted below
+		if (record.m_target == GL_TEXTURE_2D)
+			glDeleteTextures(1, &record.m_id);
+		std::cout << " ... done" << std::endl;
+	}
+
+	// Clear the records
+	m_records.clear();
+	m_freeHandles.clear();
+	m_pathLookup.clear();
+	m_releaseQueue.clear();
+	m_textureMemory = 0;
+
+	if (!m_textureArrays.empty())
+		glDeleteTextures((GLsizei)m_textureArrays.size(), &m_textureArrays[0]);
+	m_textureArrays.clear();
+
+	// Textures still streaming in find their record gone and are dropped when they arrive
+	m_uploads.clear();
+	m_pendingLoads = 0;
+
+	if (m_uploadBuffer)
+		glDeleteBuffers(1, &m_uploadBuffer);
+	m_uploadBuffer = 0;
+}
+
+// Check to see if a texture is already loaded or not
+int TextureManager::TexLoaded(std::string filePath)
+{
+	// Return the texID if found, 0 if not
+	return GetTextureName(FindTexture(filePath));
+}
+
+// Pack textures of the same size into texture arrays
+int TextureManager::PackTextureArrays(const std::vector<TextureHandle>& handles, int maxSize)
+{
+	// Group the textures by internal format and size, ignoring duplicates and textures that are already packed
+	typedef std::pair<GLint, std::pair<int, int> > GroupKey;
+	std::map<GroupKey, std::vector<TextureHandle> > groups;
+	for (size_t i = 0; i < handles.size(); i++)
+	{
+		const TextureRecord* record = GetTextureRecord(handles[i]);
+		if (!record || record->m_target != GL_TEXTURE_2D || record->m_streaming)
+			continue;
+
+		GLuint texID = record->m_id;
+
+		GLint width = 0, height = 0, internalFormat = 0, compressed = GL_FALSE;
+		glBindTexture(GL_TEXTURE_2D, texID);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED, &compressed);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+		if (width <= 0 || height <= 0 || width > maxSize || height > maxSize)
+			continue;
+
+		// Uncompressed textures are all copied into RGBA8 arrays
+		if (!compressed)
+			internalFormat = GL_RGBA8;
+
+		std::vector<TextureHandle>& group = groups[GroupKey(internalFormat, std::make_pair((int)width, (int)height))];
+		if (std::find(group.begin(), group.end(), handles[i]) == group.end())
+			group.push_back(handles[i]);
+	}
+
+	GLint maxLayers = 256;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+	int arraysCreated = 0;
+	std::vector<unsigned char> pixels;
+
+	std::map<GroupKey, std::vector<TextureHandle> >::iterator it;
+	for (it = groups.begin(); it != groups.end(); it++)
+	{
+		GLint internalFormat = it->first.first;
+		int width = it->first.second.first;
+		int height = it->first.second.second;
+		std::vector<TextureHandle>& group = it->second;
+
+		// Packing a single texture saves no binds
+		for (size_t first = 0; first + 1 < group.size(); first += maxLayers)
 		{
-			return (*it).second;
+			int layers = (int)std::min(group.size() - first, (size_t)maxLayers);
+
+			GLuint arrayId;
+			glGenTextures(1, &arrayId);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, arrayId);
+
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+			bool generateMipmaps = internalFormat == GL_RGBA8;
+			if (generateMipmaps)
+			{
+				// Copy the top level of each texture into its layer, the mipmaps are rebuilt for the whole array
+				glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, width, height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+				pixels.resize((size_t)width * height * 4);
+				for (int layer = 0; layer < layers; layer++)
+				{
+					glBindTexture(GL_TEXTURE_2D, GetTextureName(group[first + layer]));
+					glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+					glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+				}
+			}
+			else
+			{
+				// Cooked textures keep their compressed blocks, every mip level is copied as it is
+				int levels = 1;
+				while ((width >> levels) > 0 || (height >> levels) > 0)
+					levels++;
+
+				glBindTexture(GL_TEXTURE_2D, GetTextureName(group[first]));
+				for (int level = 0; level < levels; level++)
+				{
+					GLint levelSize = 0;
+					glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &levelSize);
+					glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, internalFormat, std::max(width >> level, 1),
+						std::max(height >> level, 1), layers, 0, levelSize * layers, NULL);
+				}
+
+				for (int layer = 0; layer < layers; layer++)
+				{
+					glBindTexture(GL_TEXTURE_2D, GetTextureName(group[first + layer]));
+					for (int level = 0; level < levels; level++)
+					{
+						GLint levelSize = 0;
+						glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &levelSize);
+						pixels.resize(levelSize);
+						glGetCompressedTexImage(GL_TEXTURE_2D, level, &pixels[0]);
+						glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, std::max(width >> level, 1),
+							std::max(height >> level, 1), 1, internalFormat, levelSize, &pixels[0]);
+					}
+				}
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+			}
+
+			// The 2D textures are no longer needed, their records now point at the array
+			for (int layer = 0; layer < layers; layer++)
+			{
+				TextureRecord& record = m_records[group[first + layer] - 1];
+				glDeleteTextures(1, &record.m_id);
+				record.m_id = arrayId;
+				record.m_target = GL_TEXTURE_2D_ARRAY;
+				record.m_layer = layer;
+			}
+
+			glPixelStorei(GL_PACK_ALIGNMENT, 4);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+			if (generateMipmaps)
+				glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+			m_textureArrays.push_back(arrayId);
+			arraysCreated++;
+
+			std::cout << "Packed " << layers << " textures of " << width << "x" << height
+				<< " into texture array " << arrayId << std::endl;
 		}
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	return arraysCreated;
+}
+
+// Point a texture at the texture array layer it was packed into
+bool TextureManager::ResolveTexture(Texture& texture)
+{
+	const TextureRecord* record = GetTextureRecord(texture.m_handle);
+	if (!record)
+		return false;
+
+	texture.m_id = record->m_id;
+	texture.m_target = record->m_target;
+	texture.m_layer = record->m_layer;
+
+	return texture.m_target == GL_TEXTURE_2D_ARRAY;
+}
+
+// Request a texture to be loaded in the background
+int TextureManager::RequestTexture(std::string filePath)
+{
+	TextureHandle handle = FindTexture(filePath);
+	if (handle != 0)
+		return GetTextureName(handle);
+
+	return GetTextureName(StreamRecord(filePath));
+}
+
+// Create a placeholder texture and decode the file on a worker
+TextureHandle TextureManager::StreamRecord(const std::string& filePath)
+{
+	GLuint newTex;
+	glGenTextures(1, &newTex);
+	TextureHandle handle = CreateRecord(filePath, newTex);
+
+	// The texture is a single grey texel until the real one is uploaded
+	const unsigned char placeholder[4] = { 128, 128, 128, 255 };
+	glBindTexture(GL_TEXTURE_2D, newTex);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	SetRecordSize(handle, 1, 1, 4);
+	DecodeRecord(handle, false);
+
+	return handle;
+}
 
-		// Increment iterator
-		it++;
+// Decode the file of a texture on a worker
+void TextureManager::DecodeRecord(TextureHandle handle, bool reload)
+{
+	TextureRecord& record = m_records[handle - 1];
+	record.m_streaming = true;
+	m_pendingLoads++;
+
+	// Support has to be checked here, the workers have no OpenGL context
+	bool compress = m_compressTextures && TextureCooker::Instance().IsSupported();
+	std::string filePath = record.m_path;
+	GLuint texID = record.m_id;
+	unsigned int serial = record.m_serial;
+
+	JobSystem::Instance().Submit([this, filePath, handle, texID, compress, serial, reload]()
+	{
+		TimelineScope scope("Decode " + filePath);
+
+		PendingUpload upload;
+		upload.m_handle = handle;
+		upload.m_texID = texID;
+		upload.m_filePath = filePath;
+		upload.m_serial = serial;
+		upload.m_reload = reload;
+		upload.m_loaded = compress ? TextureCooker::Instance().Cook(filePath, upload.m_texture)
+			: TextureCooker::Instance().LoadUncompressed(filePath, upload.m_texture);
+		upload.m_nextLevel = upload.m_loaded ? (int)upload.m_texture.mips.size() - 1 : -1;
+
+		std::lock_guard<std::mutex> lock(m_decodedMutex);
+		m_decoded.push_back(std::move(upload));
+	});
+}
+
+// Decode a loaded texture again into the same texture name
+bool TextureManager::ReloadTexture(const std::string& filePath)
+{
+	TextureHandle handle = FindTexture(filePath);
+	if (handle == 0 || m_records[handle - 1].m_streaming)
+		return false;
+
+	DecodeRecord(handle, true);
+
+	return true;
+}
+
+// Paths of every loaded texture
+void TextureManager::GetTextureFiles(std::vector<std::string>& filePaths) const
+{
+	for (size_t i = 0; i < m_records.size(); i++)
+	{
+		if (m_records[i].m_id != 0)
+			filePaths.push_back(m_records[i].m_path);
 	}
+}
 
-	// If texture is not in map, load it in and add to map
-	int texID = LoadTexture(filename);
+// Upload streamed textures within the per frame budget
+void TextureManager::Update()
+{
+	ProcessUploads(m_uploadBudget);
 
-	// Return texture ID
-	return texID;
+	m_frame++;
+	ProcessReleases();
 }
 
-// Release all textures from memory
-void TextureManager::ReleaseAllTextures()
+// Wait for every requested texture
+void TextureManager::FinishPendingLoads()
 {
-	// Get iterator to start of map
-	std::unordered_map<std::string, unsigned int>::iterator it = m_textureMap.begin();
+	while (m_pendingLoads > 0)
+	{
+		ProcessUploads(0);
+
+		if (m_pendingLoads > 0)
+			std::this_thread::yield();
+	}
+}
 
-	// Loop through map, unloading all textures from map
-	while (it != m_textureMap.end())
+// Upload decoded textures until the budget is spent
+void TextureManager::ProcessUploads(size_t budget)
+{
 	{
-		std::cout << "unloading Texture: " << (*it).first << ", ID: " << (*it).second;
-		glDeleteTextures(1, &(*it).second);
-		std::cout << " ... done" << std::endl;
-		++it;
+		std::lock_guard<std::mutex> lock(m_decodedMutex);
+		while (!m_decoded.empty())
+		{
+			m_uploads.push_back(std::move(m_decoded.front()));
+			m_decoded.pop_front();
+		}
 	}
 
-	// Clear the map
-	m_textureMap.clear();
+	size_t uploaded = 0;
+	while (!m_uploads.empty())
+	{
+		PendingUpload& upload = m_uploads.front();
+
+		// The texture was released or all textures were released while it was decoding
+		if (upload.m_handle > m_records.size() || m_records[upload.m_handle - 1].m_serial != upload.m_serial)
+		{
+			m_uploads.pop_front();
+			continue;
+		}
+
+		if (!upload.m_loaded)
+		{
+			std::cout << "Texture failed to load: " << upload.m_filePath << std::endl;
+			m_records[upload.m_handle - 1].m_streaming = false;
+			m_pendingLoads--;
+			m_uploads.pop_front();
+			continue;
+		}
+
+		// Textures packed into an array are replaced in their layer all at once
+		if (m_records[upload.m_handle - 1].m_target == GL_TEXTURE_2D_ARRAY)
+		{
+			UploadLayer(upload);
+			uploaded += upload.m_texture.mips[0].data.size();
+			m_records[upload.m_handle - 1].m_streaming = false;
+			m_pendingLoads--;
+			m_uploads.pop_front();
+			continue;
+		}
+
+		// At least one level goes up per call so textures larger than the budget still arrive
+		size_t levelBytes = upload.m_texture.mips[upload.m_nextLevel].data.size();
+		if (budget != 0 && uploaded != 0 && uploaded + levelBytes > budget)
+			break;
+
+		UploadLevel(upload);
+		uploaded += levelBytes;
+
+		if (upload.m_nextLevel < 0)
+		{
+			const CookedTexture& texture = upload.m_texture;
+			m_width = texture.mips[0].width;
+			m_height = texture.mips[0].height;
+
+			size_t bytes = 0;
+			for (size_t i = 0; i < texture.mips.size(); i++)
+				bytes += texture.mips[i].data.size();
+			if (texture.format == GL_RGBA8)
+				bytes = bytes * 4 / 3;
+			SetRecordSize(upload.m_handle, m_width, m_height, bytes);
+			m_records[upload.m_handle - 1].m_streaming = false;
+
+			if (upload.m_reload)
+			{
+				std::cout << "Reloaded texture: " << upload.m_filePath << std::endl;
+			}
+			else
+			{
+				m_numTextures++;
+				std::cout << "Successfully streamed Texture: " << upload.m_filePath << ". Texture Count = " << m_numTextures << std::endl;
+			}
+
+			m_pendingLoads--;
+			m_uploads.pop_front();
+		}
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
-// Check to see if a texture is already loaded or not
-int TextureManager::TexLoaded(std::string filePath)
+// Upload the next mip level of a texture through the pixel buffer object
+void TextureManager::UploadLevel(PendingUpload& upload)
 {
-	// Get iterator to start of map
-	std::unordered_map<std::string, unsigned int>::iterator it = m_textureMap.begin();
+	const CookedTexture& texture = upload.m_texture;
+	int level = upload.m_nextLevel;
+	const CookedMipLevel& mip = texture.mips[level];
+
+	if (!m_uploadBuffer)
+		glGenBuffers(1, &m_uploadBuffer);
 
-	// Search map for texture
-	while (it != m_textureMap.end())
+	// Orphan the buffer so the copy never waits for the previous upload to be read
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_uploadBuffer);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, mip.data.size(), NULL, GL_STREAM_DRAW);
+	void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, mip.data.size(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (mapped)
 	{
-		// If texture found, return true
-		if ((*it).first == filePath)
+		memcpy(mapped, &mip.data[0], mip.data.size());
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	}
+	else
+	{
+		glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, mip.data.size(), &mip.data[0]);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, upload.m_texID);
+	if (texture.format == GL_RGBA8)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const GLvoid*)0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		upload.m_nextLevel = -1;
+	}
+	else
+	{
+		// Only the levels uploaded so far are sampled, the placeholder below them is ignored
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, texture.format, mip.width, mip.height, 0, (GLsizei)mip.data.size(), (const GLvoid*)0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)texture.mips.size() - 1);
+		upload.m_nextLevel--;
+	}
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+// Replace the array layer of a reloaded texture
+void TextureManager::UploadLayer(const PendingUpload& upload)
+{
+	const TextureRecord& record = m_records[upload.m_handle - 1];
+	const CookedTexture& texture = upload.m_texture;
+
+	GLint internalFormat = 0, maxLevel = 0;
+	glBindTexture(GL_TEXTURE_2D_ARRAY, record.m_id);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+	glGetTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+
+	// Every layer of an array has the same size and format
+	if (texture.mips[0].width != record.m_width || texture.mips[0].height != record.m_height || (GLint)texture.format != internalFormat)
+	{
+		std::cout << "Texture " << upload.m_filePath << " changed size or format, it keeps the old one in its texture array until restarted" << std::endl;
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		return;
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (texture.format == GL_RGBA8)
+	{
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, record.m_layer, record.m_width, record.m_height, 1, GL_RGBA, GL_UNSIGNED_BYTE, &texture.mips[0].data[0]);
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	}
+	else
+	{
+		for (int level = 0; level < (int)texture.mips.size() && level <= maxLevel; level++)
 		{
-			return (*it).second;;
+			const CookedMipLevel& mip = texture.mips[level];
+			glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, record.m_layer, mip.width, mip.height, 1,
+				texture.format, (GLsizei)mip.data.size(), &mip.data[0]);
 		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	std::cout << "Reloaded texture: " << upload.m_filePath << " into array layer " << record.m_layer << std::endl;
+}
 
-		// Increment iterator
-		it++;
+// Find a texture by the hash of its path
+TextureHandle TextureManager::FindTexture(const std::string& filePath) const
+{
+	std::unordered_map<uint64_t, TextureHandle>::const_iterator it = m_pathLookup.find(HashString(filePath));
+	if (it == m_pathLookup.end())
+		return 0;
+
+	// Guard against the rare hash collision
+	if (m_records[it->second - 1].m_path != filePath)
+		return 0;
+
+	return it->second;
+}
+
+// Add a reference to a texture, loading it if needed
+TextureHandle TextureManager::AcquireTexture(const std::string& filePath, bool stream)
+{
+	TextureHandle handle = FindTexture(filePath);
+	if (handle != 0)
+	{
+		// Acquiring a texture waiting to be deleted keeps it
+		m_records[handle - 1].m_refCount++;
+		return handle;
+	}
+
+	// New records start without references, this is the first
+	handle = stream ? StreamRecord(filePath) : LoadRecord(filePath);
+	m_records[handle - 1].m_refCount = 1;
+	return handle;
+}
+
+// Remove a reference from a texture
+void TextureManager::ReleaseTexture(TextureHandle handle)
+{
+	if (!GetTextureRecord(handle))
+		return;
+
+	TextureRecord& record = m_records[handle - 1];
+	if (record.m_refCount <= 0)
+		return;
+
+	record.m_refCount--;
+	if (record.m_refCount == 0)
+	{
+		record.m_releaseFrame = m_frame;
+		m_releaseQueue.push_back(handle);
+	}
+}
+
+// Print the memory of every texture
+void TextureManager::PrintTextureStats() const
+{
+	for (size_t i = 0; i < m_records.size(); i++)
+	{
+		const TextureRecord& record = m_records[i];
+		if (record.m_id == 0)
+			continue;
+
+		std::cout << "Texture " << (i + 1) << ": " << record.m_path << " " << record.m_width << "x" << record.m_height
+			<< ", " << record.m_bytes / 1024 << " KB, " << record.m_refCount << " references"
+			<< (record.m_target == GL_TEXTURE_2D_ARRAY ? ", array layer " + std::to_string(record.m_layer) : "") << std::endl;
+	}
+
+	std::cout << "Texture memory: " << m_textureMemory / 1024 << " KB in " << GetTextureCount() << " textures" << std::endl;
+}
+
+// Add a record for a texture name
+TextureHandle TextureManager::CreateRecord(const std::string& filePath, GLuint texID)
+{
+	TextureHandle handle;
+	if (!m_freeHandles.empty())
+	{
+		handle = m_freeHandles.back();
+		m_freeHandles.pop_back();
+	}
+	else
+	{
+		m_records.push_back(TextureRecord());
+		handle = (TextureHandle)m_records.size();
+	}
+
+	TextureRecord& record = m_records[handle - 1];
+	record.m_id = texID;
+	record.m_target = GL_TEXTURE_2D;
+	record.m_layer = 0;
+	record.m_path = filePath;
+	record.m_pathHash = HashString(filePath);
+	record.m_refCount = 0;
+	record.m_releaseFrame = 0;
+	record.m_width = 0;
+	record.m_height = 0;
+	record.m_bytes = 0;
+	record.m_serial = m_nextSerial++;
+	record.m_streaming = false;
+
+	m_pathLookup[record.m_pathHash] = handle;
+
+	return handle;
+}
+
+// Update the memory statistics of a texture
+void TextureManager::SetRecordSize(TextureHandle handle, int width, int height, size_t bytes)
+{
+	TextureRecord& record = m_records[handle - 1];
+
+	m_textureMemory -= record.m_bytes;
+	record.m_width = width;
+	record.m_height = height;
+	record.m_bytes = bytes;
+	m_textureMemory += bytes;
+}
+
+// Delete a texture and free its handle
+void TextureManager::DestroyRecord(TextureHandle handle)
+{
+	TextureRecord& record = m_records[handle - 1];
+
+	// Texture arrays are shared by other textures, so packed layers are only freed with the array
+	if (record.m_target == GL_TEXTURE_2D)
+		glDeleteTextures(1, &record.m_id);
+
+	m_pathLookup.erase(record.m_pathHash);
+	m_textureMemory -= record.m_bytes;
+
+	record.m_id = 0;
+	record.m_path.clear();
+	record.m_bytes = 0;
+	record.m_serial = m_nextSerial++;
+
+	m_freeHandles.push_back(handle);
+}
+
+// Delete textures that stayed unreferenced for the release delay
+void TextureManager::ProcessReleases()
+{
+	size_t kept = 0;
+	for (size_t i = 0; i < m_releaseQueue.size(); i++)
+	{
+		TextureHandle handle = m_releaseQueue[i];
+		TextureRecord& record = m_records[handle - 1];
+
+		// Acquired again since it was released
+		if (record.m_id == 0 || record.m_refCount > 0)
+			continue;
+
+		// Textures are not deleted under an upload, they wait for it to finish
+		if (!record.m_streaming && m_frame - record.m_releaseFrame >= m_releaseDelay)
+			DestroyRecord(handle);
+		else
+			m_releaseQueue[kept++] = handle;
 	}
 
-	// If texture not found, return 0
-	return 0;
-}
\ No newline at end of file
+	m_releaseQueue.resize(kept);
+}
@@ -29,17 +29,72 @@
 #include <unordered_map>
 #include <string>
 #include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 
 #include "GL\glew.h"
 #include "soil2.h"
 #include "stb_image.h"
+#include "TextureCooker.h"
+#include "..\Common\JobSystem.h"
+#include "..\Common\StartupTimeline.h"
+
+/// Index of a texture in the texture manager, 0 is no texture
+typedef unsigned int TextureHandle;
 
 struct Texture
 {
 	unsigned int m_id;
 	std::string m_type;
 	std::string m_path;
+
+	/// Texture manager handle the ID was taken from
+	TextureHandle m_handle = 0;
+
+	/// GL_TEXTURE_2D, or GL_TEXTURE_2D_ARRAY once the texture has been packed into an array
+	unsigned int m_target = GL_TEXTURE_2D;
+
+	/// Layer of the texture array the texture was packed into
+	int m_layer = 0;
+};
+
+	/**
+	* @struct TextureRecord
+	* @brief Everything the texture manager knows about a single texture
+	*/
+struct TextureRecord
+{
+	/// OpenGL texture name, a texture array once the texture has been packed
+	GLuint m_id;
+
+	/// GL_TEXTURE_2D or GL_TEXTURE_2D_ARRAY
+	GLenum m_target;
+
+	/// Layer of the texture array the texture was packed into
+	int m_layer;
+
+	/// File the texture was loaded from and its interned hash
+	std::string m_path;
+	uint64_t m_pathHash;
+
+	/// Number of holders, the texture is released some frames after this reaches 0
+	int m_refCount;
+
+	/// Frame the reference count reached 0
+	unsigned int m_releaseFrame;
+
+	/// Size in pixels and estimated video memory, mipmaps included
+	int m_width, m_height;
+	size_t m_bytes;
+
+	/// Changes every time the record is reused, so streamed uploads can tell they are stale
+	unsigned int m_serial;
+
+	/// Still being decoded or uploaded by the streaming path
+	bool m_streaming;
 };
 
 class TextureManager
@@ -126,8 +181,374 @@ class TextureManager
 			*/
 		int TexLoaded(std::string filePath);
 
+			/**
+			* @brief Pack textures into texture arrays
+			*
+			* Groups the given 2D textures by size and copies every group of two or more into the
+			* layers of a single GL_TEXTURE_2D_ARRAY, so meshes using any texture of the group can be
+			* drawn without binding another texture. Textures larger than maxSize are left alone.
+			* The packed 2D textures are deleted and their records point at the array; call
+			* ResolveTexture() on every Texture that referenced them afterwards. Packed textures keep
+			* their array layer until ReleaseAllTextures().
+			*
+			* @param handles - Handles of the 2D textures to pack
+			* @param maxSize - Largest width or height of a texture that is packed
+			*
+			* @return int - Number of texture arrays created
+			*/
+		int PackTextureArrays(const std::vector<TextureHandle>& handles, int maxSize = 1024);
+
+			/**
+			* @brief Point a texture at its texture array
+			*
+			* Refreshes the ID, target and layer of a texture from its record, so a texture packed by
+			* PackTextureArrays() points at the texture array layer it was copied into.
+			*
+			* @param texture - Texture to resolve
+			*
+			* @return bool - True if the texture was packed
+			*/
+		bool ResolveTexture(Texture& texture);
+
+			/**
+			* @brief Enable or disable texture compression
+			*
+			* When enabled, LoadTexture() loads textures block compressed through the texture cooker
+			* if the driver supports it. Textures that are already loaded are not changed.
+			*
+			* @param enabled - Whether to compress textures
+			*
+			* @return void
+			*/
+		void SetTextureCompression(bool enabled) { m_compressTextures = enabled; }
+
+			/**
+			* @brief Request a texture without waiting for it
+			*
+			* Returns a texture ID straight away, holding a grey placeholder. The file is decoded (or
+			* read from the texture cache) on a worker thread and uploaded into the same ID by
+			* Update() over the following frames, so whatever holds the ID picks up the real texture
+			* when it lands. Textures already loaded or requested return their existing ID.
+			*
+			* @param filePath - Name of file to load
+			*
+			* @return int - texID (given ID of requested texture)
+			*/
+		int RequestTexture(std::string filePath);
+
+			/**
+			* @brief Upload streamed textures
+			*
+			* Uploads decoded textures through a pixel buffer object, spending at most the upload
+			* budget per call. Compressed textures are uploaded one mip level at a time from the
+			* smallest up, so a texture sharpens over several frames instead of stalling one. Also
+			* deletes textures whose release delay has passed. Called once per frame on the main
+			* thread.
+			*
+			* @return void
+			*/
+		void Update();
+
+			/**
+			* @brief Finish every requested texture
+			*
+			* Blocks until every texture requested with RequestTexture() has been decoded and
+			* uploaded, ignoring the upload budget.
+			*
+			* @return void
+			*/
+		void FinishPendingLoads();
+
+			/**
+			* @brief Set the upload budget
+			*
+			* Sets the number of texture bytes Update() may upload per frame. At least one mip level
+			* is uploaded per frame however large it is.
+			*
+			* @param bytes - Bytes uploaded per frame
+			*
+			* @return void
+			*/
+		void SetUploadBudget(size_t bytes) { m_uploadBudget = bytes; }
+
+			/**
+			* @brief Get the number of textures still loading
+			*
+			* @return int - Requested textures that have not been fully uploaded
+			*/
+		int GetPendingLoadCount() const { return m_pendingLoads; }
+
+			/**
+			* @brief Find a texture
+			*
+			* Looks a texture up by the hash of its path without loading it.
+			*
+			* @param filePath - File path of texture
+			*
+			* @return TextureHandle - Handle of the texture, or 0 if it is not loaded
+			*/
+		TextureHandle FindTexture(const std::string& filePath) const;
+
+			/**
+			* @brief Acquire a texture
+			*
+			* Returns the handle of a texture and adds a reference to it, loading the texture first if
+			* it is not loaded. Streamed textures hold a placeholder until Update() uploads them.
+			* Every acquire must be matched by a ReleaseTexture().
+			*
+			* @param filePath - Name of file to load
+			* @param stream - Decode in the background instead of waiting
+			*
+			* @return TextureHandle - Handle of the texture
+			*/
+		TextureHandle AcquireTexture(const std::string& filePath, bool stream = true);
+
+			/**
+			* @brief Release a texture
+			*
+			* Removes a reference from a texture. Once nothing references it the texture is deleted
+			* after the release delay, unless it is acquired again first. LoadTexture(), GetTextureID()
+			* and RequestTexture() hold no reference, a texture they loaded stays until it has been
+			* acquired and released again, or ReleaseAllTextures() is called.
+			*
+			* @param handle - Texture to release
+			*
+			* @return void
+			*/
+		void ReleaseTexture(TextureHandle handle);
+
+			/**
+			* @brief Get the OpenGL name of a texture
+			*
+			* @param handle - Texture handle
+			*
+			* @return GLuint - texID, or 0 for an invalid handle
+			*/
+		GLuint GetTextureName(TextureHandle handle) const
+		{
+			return (handle != 0 && handle <= m_records.size()) ? m_records[handle - 1].m_id : 0;
+		}
+
+			/**
+			* @brief Get the record of a texture
+			*
+			* @param handle - Texture handle
+			*
+			* @return const TextureRecord* - Record of the texture, or NULL for an invalid handle
+			*/
+		const TextureRecord* GetTextureRecord(TextureHandle handle) const
+		{
+			return (handle != 0 && handle <= m_records.size() && m_records[handle - 1].m_id != 0) ? &m_records[handle - 1] : NULL;
+		}
+
+			/**
+			* @brief Reload a texture
+			*
+			* Decodes the file of a loaded texture again on a worker and uploads it by Update() into
+			* the same texture name, or into the same layer of the texture array it was packed into,
+			* so whatever holds the texture draws the new one. A packed texture that changed size or
+			* format keeps the old one. Returns false if the texture is not loaded or still loading.
+			*
+			* @param filePath - File path of texture
+			*
+			* @return bool - Whether the texture is being reloaded
+			*/
+		bool ReloadTexture(const std::string& filePath);
+
+			/**
+			* @brief Get the texture files
+			*
+			* Adds the file path of every loaded texture to filePaths.
+			*
+			* @param filePaths - Paths of the loaded textures
+			*
+			* @return void
+			*/
+		void GetTextureFiles(std::vector<std::string>& filePaths) const;
+
+			/**
+			* @brief Set the release delay
+			*
+			* Sets the number of frames an unreferenced texture is kept before it is deleted, so a
+			* texture released and acquired again soon after is not reloaded.
+			*
+			* @param frames - Frames to keep unreferenced textures
+			*
+			* @return void
+			*/
+		void SetReleaseDelay(unsigned int frames) { m_releaseDelay = frames; }
+
+			/**
+			* @brief Get the texture memory
+			*
+			* @return size_t - Estimated video memory of every loaded texture in bytes
+			*/
+		size_t GetTextureMemory() const { return m_textureMemory; }
+
+			/**
+			* @brief Get the number of textures
+			*
+			* @return int - Number of textures currently loaded
+			*/
+		int GetTextureCount() const { return (int)(m_records.size() - m_freeHandles.size()); }
+
+			/**
+			* @brief Print texture statistics
+			*
+			* Prints the size, memory and reference count of every loaded texture and the total.
+			*
+			* @return void
+			*/
+		void PrintTextureStats() const;
+
 	private:
 
+			/**
+			* @struct PendingUpload
+			* @brief A requested texture on its way to the GPU
+			*/
+		struct PendingUpload
+		{
+			/// Texture holding the placeholder
+			TextureHandle m_handle;
+			GLuint m_texID;
+
+			/// File the texture was requested from
+			std::string m_filePath;
+
+			/// Serial of the record when it was requested
+			unsigned int m_serial;
+
+			/// Whether the file was decoded successfully
+			bool m_loaded;
+
+			/// Decoded texture
+			CookedTexture m_texture;
+
+			/// Next mip level to upload, counting down to 0
+			int m_nextLevel;
+
+			/// Replaces a texture that was already uploaded
+			bool m_reload;
+		};
+
+			/**
+			* @brief Decode a texture on a worker
+			*
+			* Submits a job that decodes the file of the record, or reads it from the texture cache,
+			* and queues it for ProcessUploads().
+			*
+			* @param handle - Texture to decode
+			* @param reload - Whether the texture replaces one already uploaded
+			*
+			* @return void
+			*/
+		void DecodeRecord(TextureHandle handle, bool reload);
+
+			/**
+			* @brief Upload a texture into its array layer
+			*
+			* Replaces every mip level of the layer a reloaded texture was packed into, if the
+			* decoded texture has the size and format of the array.
+			*
+			* @param upload - Decoded texture
+			*
+			* @return void
+			*/
+		void UploadLayer(const PendingUpload& upload);
+
+			/**
+			* @brief Upload decoded textures
+			*
+			* Moves textures decoded by the workers to the upload queue and uploads mip levels until
+			* the budget is spent. A budget of 0 uploads everything.
+			*
+			* @param budget - Bytes to upload
+			*
+			* @return void
+			*/
+		void ProcessUploads(size_t budget);
+
+			/**
+			* @brief Upload a single mip level
+			*
+			* Copies the next mip level of a pending texture into the pixel buffer object and
+			* uploads it from there.
+			*
+			* @param upload - Texture to upload a level of
+			*
+			* @return void
+			*/
+		void UploadLevel(PendingUpload& upload);
+
+			/**
+			* @brief Load a texture record
+			*
+			* Loads a texture from file straight away and creates its record with one reference.
+			*
+			* @param filePath - Name of file to load
+			*
+			* @return TextureHandle - Handle of the new texture
+			*/
+		TextureHandle LoadRecord(const std::string& filePath);
+
+			/**
+			* @brief Stream a texture record
+			*
+			* Creates a record with one reference for a placeholder texture and queues the file to be
+			* decoded on a worker thread.
+			*
+			* @param filePath - Name of file to load
+			*
+			* @return TextureHandle - Handle of the new texture
+			*/
+		TextureHandle StreamRecord(const std::string& filePath);
+
+			/**
+			* @brief Create a texture record
+			*
+			* Adds a record for a texture name under its path, reusing a free handle if there is one.
+			*
+			* @param filePath - File path of texture
+			* @param texID - ID of texture
+			*
+			* @return TextureHandle - Handle of the new record
+			*/
+		TextureHandle CreateRecord(const std::string& filePath, GLuint texID);
+
+			/**
+			* @brief Set the memory of a texture
+			*
+			* @param handle - Texture handle
+			* @param width - Width of the top level
+			* @param height - Height of the top level
+			* @param bytes - Video memory of the texture
+			*
+			* @return void
+			*/
+		void SetRecordSize(TextureHandle handle, int width, int height, size_t bytes);
+
+			/**
+			* @brief Delete a texture record
+			*
+			* Deletes the texture name, forgets its path and frees the handle for reuse.
+			*
+			* @param handle - Texture handle
+			*
+			* @return void
+			*/
+		void DestroyRecord(TextureHandle handle);
+
+			/**
+			* @brief Delete released textures
+			*
+			* Deletes textures that have been unreferenced for longer than the release delay.
+			*
+			* @return void
+			*/
+		void ProcessReleases();
+
+
 			/**
 			* @brief Default constructor
 			*
@@ -144,16 +565,55 @@ class TextureManager
 			*/
 		~TextureManager();
 
-			/**
-			* @brief
-			*
-			* An unordered map containing all textures for easy lookup
-			*/
-		std::unordered_map<std::string, unsigned int> m_textureMap;
+		/// Texture records, indexed by handle - 1
+		std::vector<TextureRecord> m_records;
+
+		/// Handles of records that can be reused
+		std::vector<TextureHandle> m_freeHandles;
+
+		/// Handles keyed by the hash of their path, for lookup without string compares
+		std::unordered_map<uint64_t, TextureHandle> m_pathLookup;
+
+		/// Handles whose reference count reached 0
+		std::vector<TextureHandle> m_releaseQueue;
+
+		/// Frames counted by Update() and the frames unreferenced textures are kept
+		unsigned int m_frame, m_releaseDelay;
+
+		/// Next record serial
+		unsigned int m_nextSerial;
+
+		/// Estimated video memory of every texture
+		size_t m_textureMemory;
 
 		/// Number of textures
 		int m_numTextures;
 
+		/// Load textures block compressed through the texture cooker
+		bool m_compressTextures;
+
+		/// Textures decoded by the workers, waiting for the main thread
+		std::deque<PendingUpload> m_decoded;
+
+		/// Guards m_decoded
+		std::mutex m_decodedMutex;
+
+		/// Textures being uploaded by the main thread
+		std::deque<PendingUpload> m_uploads;
+
+		/// Requested textures that have not been fully uploaded
+		std::atomic<int> m_pendingLoads;
+
+		/// Bytes uploaded per frame by Update()
+		size_t m_uploadBudget;
+
+		/// Pixel buffer object textures are uploaded through
+		GLuint m_uploadBuffer;
+
+
+		/// Texture arrays created by PackTextureArrays()
+		std::vector<unsigned int> m_textureArrays;
+
 	protected:
 
 		/// Width of texture loaded